@@ -44,32 +44,40 @@ public extension ChaCha20Poly1305 {
             let keyBytes = key.bytes
             try verifyKey(bytes: keyBytes)
 
-            let messageBytes = message.bytes
-            let messageLength = UInt64(messageBytes.count)
-
-            let contextBytes = context.bytes
-            let contextLength = UInt64(contextBytes.count)
+            return try encrypt(
+                messageBytes: message.bytes,
+                contextBytes: context.bytes,
+                keyBytes: keyBytes
+            )
+        }
 
-            let nonceBytes = generateRandomNonceBytes()
+        /// Encrypts several messages with the same key.
+        ///
+        /// Sodium is initialized and the key and context are prepared once
+        /// for all messages, each message gets its own random nonce.
+        ///
+        /// - Parameters:
+        ///  - messages: The message data to encrypt.
+        ///  - context: Publicly known contextual data to be bound to the ciphertexts.
+        ///  - key: The key used to encrypt.
+        ///
+        /// - Returns: The ciphertexts and public nonces, in the order of the messages.
 
-            var ciphertextBytes = createByteArray(length: ciphertextLength(forMessageLength: Int(messageLength)))
-            var actualCiphertextLength: UInt64 = 0
+        public static func encrypt(messages: [Data], context: Data, key: Data) throws -> [(ciphertext: Data, nonce: Data)] {
+            try initializeSodium()
 
-            crypto_aead_chacha20poly1305_ietf_encrypt(
-                &ciphertextBytes,          // buffer in which enrypted data is written to
-                &actualCiphertextLength,   // actual size of encrypted data
-                messageBytes,              // message to encrypt
-                messageLength,             // length of message to encrypt
-                contextBytes,              // additional (non encrypted) data
-                contextLength,             // additional data length
-                nil,                       // nsec, not used by this function
-                nonceBytes,                // unique nonce used as initizalization vector
-                keyBytes                   // key used to encrypt the message
-            )
+            let keyBytes = key.bytes
+            try verifyKey(bytes: keyBytes)
 
-            try verifyCiphertext(length: actualCiphertextLength, messageLength: messageLength)
+            let contextBytes = context.bytes
 
-            return (ciphertextBytes.data, nonceBytes.data)
+            return try messages.map {
+                try encrypt(
+                    messageBytes: $0.bytes,
+                    contextBytes: contextBytes,
+                    keyBytes: keyBytes
+                )
+            }
         }
 
         /// Decrypts a ciphertext with a public nonce and a key.
@@ -88,33 +96,42 @@ public extension ChaCha20Poly1305 {
             let keyBytes = key.bytes
             try verifyKey(bytes: keyBytes)
 
-            let nonceBytes = nonce.bytes
-            try verifyNonce(bytes: nonceBytes)
-
-            let ciphertextBytes = ciphertext.bytes
-            let ciphertextLength = UInt64(ciphertextBytes.count)
+            return try decrypt(
+                ciphertextBytes: ciphertext.bytes,
+                nonceBytes: nonce.bytes,
+                contextBytes: context.bytes,
+                keyBytes: keyBytes
+            )
+        }
 
-            let contextBytes = context.bytes
-            let contextLength = UInt64(contextBytes.count)
+        /// Decrypts several ciphertexts that were encrypted with the same key.
+        ///
+        /// Sodium is initialized and the key and context are prepared once
+        /// for all ciphertexts.
+        ///
+        /// - Parameters:
+        ///  - ciphertexts: The data to decrypt, along with the public nonce used to encrypt it.
+        ///  - context: The public contextual data bound to the ciphertexts.
+        ///  - key: The key used to encrypt the original messages.
+        ///
+        /// - Returns: The plaintext message data, in the order of the ciphertexts.
 
-            var messageBytes = createByteArray(length: messageLength(forCiphertextLength: Int(ciphertextLength)))
-            var actualMessageLength: UInt64 = 0
+        public static func decrypt(ciphertexts: [(ciphertext: Data, nonce: Data)], context: Data, key: Data) throws -> [Data] {
+            try initializeSodium()
 
-            let result = crypto_aead_chacha20poly1305_ietf_decrypt(
-                &messageBytes,              // buffer in which decrypted data is written to
-                &actualMessageLength,       // actual size of decrypted data
-                nil,                        // nsec, not used by this function
-                ciphertextBytes,            // ciphertext to decrypt
-                ciphertextLength,           // length of ciphertext
-                contextBytes,               // additional (non encrypted) data
-                contextLength,              // additional data length
-                nonceBytes,                 // the unique nonce used to encrypt the original message
-                keyBytes                    // the key used to encrypt the original message
-            )
+            let keyBytes = key.bytes
+            try verifyKey(bytes: keyBytes)
 
-            guard result == 0 else { throw EncryptionError.failedToDecrypt }
+            let contextBytes = context.bytes
 
-            return Data(messageBytes)
+            return try ciphertexts.map {
+                try decrypt(
+                    ciphertextBytes: $0.ciphertext.bytes,
+                    nonceBytes: $0.nonce.bytes,
+                    contextBytes: contextBytes,
+                    keyBytes: keyBytes
+                )
+            }
         }
 
         public enum EncryptionError: LocalizedError {
@@ -148,6 +165,67 @@ public extension ChaCha20Poly1305 {
             guard sodium_init() >= 0 else { throw EncryptionError.failedToInitializeSodium }
         }
 
+        private static func encrypt(
+            messageBytes: [Byte],
+            contextBytes: [Byte],
+            keyBytes: [Byte]
+        ) throws -> (ciphertext: Data, nonce: Data) {
+            let messageLength = UInt64(messageBytes.count)
+            let contextLength = UInt64(contextBytes.count)
+
+            let nonceBytes = generateRandomNonceBytes()
+
+            var ciphertextBytes = createByteArray(length: ciphertextLength(forMessageLength: Int(messageLength)))
+            var actualCiphertextLength: UInt64 = 0
+
+            crypto_aead_chacha20poly1305_ietf_encrypt(
+                &ciphertextBytes,          // buffer in which enrypted data is written to
+                &actualCiphertextLength,   // actual size of encrypted data
+                messageBytes,              // message to encrypt
+                messageLength,             // length of message to encrypt
+                contextBytes,              // additional (non encrypted) data
+                contextLength,             // additional data length
+                nil,                       // nsec, not used by this function
+                nonceBytes,                // unique nonce used as initizalization vector
+                keyBytes                   // key used to encrypt the message
+            )
+
+            try verifyCiphertext(length: actualCiphertextLength, messageLength: messageLength)
+
+            return (ciphertextBytes.data, nonceBytes.data)
+        }
+
+        private static func decrypt(
+            ciphertextBytes: [Byte],
+            nonceBytes: [Byte],
+            contextBytes: [Byte],
+            keyBytes: [Byte]
+        ) throws -> Data {
+            try verifyNonce(bytes: nonceBytes)
+
+            let ciphertextLength = UInt64(ciphertextBytes.count)
+            let contextLength = UInt64(contextBytes.count)
+
+            var messageBytes = createByteArray(length: messageLength(forCiphertextLength: Int(ciphertextLength)))
+            var actualMessageLength: UInt64 = 0
+
+            let result = crypto_aead_chacha20poly1305_ietf_decrypt(
+                &messageBytes,              // buffer in which decrypted data is written to
+                &actualMessageLength,       // actual size of decrypted data
+                nil,                        // nsec, not used by this function
+                ciphertextBytes,            // ciphertext to decrypt
+                ciphertextLength,           // length of ciphertext
+                contextBytes,               // additional (non encrypted) data
+                contextLength,              // additional data length
+                nonceBytes,                 // the unique nonce used to encrypt the original message
+                keyBytes                    // the key used to encrypt the original message
+            )
+
+            guard result == 0 else { throw EncryptionError.failedToDecrypt }
+
+            return Data(messageBytes)
+        }
+
         // MARK: - Verification
 
         private static func verifyKey(bytes: [Byte]) throws {
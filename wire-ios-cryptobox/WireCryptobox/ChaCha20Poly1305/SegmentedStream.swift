@@ -0,0 +1,297 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+extension ChaCha20Poly1305.StreamEncryption {
+
+    /// The body of a version 2 backup: a sequence of independently authenticated segments.
+    ///
+    /// Layout after the file header:
+    ///
+    ///     segment size (4 bytes, big endian) | nonce prefix (16 bytes) | segment 0 | segment 1 | ...
+    ///
+    /// Every segment is the XChaCha20-Poly1305 encryption of `segmentSize` plaintext bytes,
+    /// only the final one may be shorter. The nonce of a segment is the nonce prefix followed
+    /// by the big endian segment index, and its additional data is the segment index and a
+    /// flag marking the final segment, so segments can't be reordered, dropped or truncated.
+    ///
+    /// Since segments don't depend on each other, up to `concurrency` of them are encrypted
+    /// or decrypted in parallel. Reading and writing stay sequential, which keeps the output
+    /// in order and the memory bounded by about `2 * concurrency * segmentSize`.
+    enum SegmentedStream {
+
+        private static let segmentSizeLength = 4
+        private static let noncePrefixLength = 16
+        private static let authenticationBytesLength = Int(crypto_aead_xchacha20poly1305_ietf_ABYTES)
+        /// Larger segment sizes are rejected when decrypting, to bound memory use.
+        private static let maximumSegmentSize = 64 * 1024 * 1024
+
+        /// A segment as read from the input stream.
+        private struct Segment {
+            let index: UInt64
+            let bytes: [UInt8]
+            let isFinal: Bool
+        }
+
+        // MARK: - Encryption
+
+        /// Encrypts the rest of the input stream.
+        ///
+        /// - Returns: number of bytes written to the output stream
+        static func encrypt(
+            input: InputStream,
+            output: OutputStream,
+            key: Key,
+            segmentSize: Int,
+            concurrency: Int
+        ) throws -> Int {
+            var noncePrefix = [UInt8](repeating: 0, count: noncePrefixLength)
+            randombytes_buf(&noncePrefix, noncePrefixLength)
+
+            var segmentHeader = [UInt8]()
+            withUnsafeBytes(of: UInt32(segmentSize).bigEndian) { segmentHeader.append(contentsOf: $0) }
+            segmentHeader.append(contentsOf: noncePrefix)
+            try write(segmentHeader, to: output)
+
+            let reader = SegmentReader(input: input, segmentSize: segmentSize)
+            let totalBytesWritten = try process(reader: reader, output: output, concurrency: concurrency) { segment in
+                try seal(segment, noncePrefix: noncePrefix, key: key)
+            }
+
+            return segmentHeader.count + totalBytesWritten
+        }
+
+        // MARK: - Decryption
+
+        /// Decrypts the rest of the input stream.
+        ///
+        /// - Returns: number of bytes written to the output stream
+        static func decrypt(
+            input: InputStream,
+            output: OutputStream,
+            key: Key,
+            concurrency: Int
+        ) throws -> Int {
+            let segmentHeader = try read(count: segmentSizeLength + noncePrefixLength, from: input)
+
+            guard segmentHeader.count == segmentSizeLength + noncePrefixLength else {
+                throw EncryptionError.malformedHeader
+            }
+
+            let segmentSize = segmentHeader.prefix(segmentSizeLength).reduce(0) { $0 << 8 | Int($1) }
+            let noncePrefix = Array(segmentHeader.suffix(noncePrefixLength))
+
+            guard segmentSize > 0, segmentSize <= maximumSegmentSize else {
+                throw EncryptionError.malformedHeader
+            }
+
+            let reader = SegmentReader(input: input, segmentSize: segmentSize + authenticationBytesLength)
+            return try process(reader: reader, output: output, concurrency: concurrency) { segment in
+                try open(segment, noncePrefix: noncePrefix, key: key)
+            }
+        }
+
+        // MARK: - Pipeline
+
+        /// Reads batches of `concurrency` segments, transforms them in parallel and writes
+        /// the results in order.
+        private static func process(
+            reader: SegmentReader,
+            output: OutputStream,
+            concurrency: Int,
+            transform: (Segment) throws -> [UInt8]
+        ) throws -> Int {
+            let concurrency = max(concurrency, 1)
+            var totalBytesWritten = 0
+
+            while true {
+                var batch = [Segment]()
+                while batch.count < concurrency, let segment = try reader.next() {
+                    batch.append(segment)
+                }
+
+                guard !batch.isEmpty else { break }
+
+                var results = [Result<[UInt8], Error>](repeating: .failure(EncryptionError.unknown), count: batch.count)
+
+                results.withUnsafeMutableBufferPointer { results in
+                    DispatchQueue.concurrentPerform(iterations: batch.count) { index in
+                        results[index] = Result { try transform(batch[index]) }
+                    }
+                }
+
+                for result in results {
+                    let bytes = try result.get()
+                    try write(bytes, to: output)
+                    totalBytesWritten += bytes.count
+                }
+
+                if batch.last?.isFinal == true { break }
+            }
+
+            return totalBytesWritten
+        }
+
+        // MARK: - Segments
+
+        private static func seal(_ segment: Segment, noncePrefix: [UInt8], key: Key) throws -> [UInt8] {
+            let nonce = self.nonce(prefix: noncePrefix, index: segment.index)
+            let additionalData = self.additionalData(for: segment)
+            var ciphertext = [UInt8](repeating: 0, count: segment.bytes.count + authenticationBytesLength)
+            var ciphertextLength: UInt64 = 0
+
+            guard crypto_aead_xchacha20poly1305_ietf_encrypt(
+                &ciphertext,
+                &ciphertextLength,
+                segment.bytes,
+                UInt64(segment.bytes.count),
+                additionalData,
+                UInt64(additionalData.count),
+                nil,
+                nonce,
+                key.buffer
+            ) == 0 else {
+                throw EncryptionError.encryptionFailed
+            }
+
+            return ciphertext
+        }
+
+        private static func open(_ segment: Segment, noncePrefix: [UInt8], key: Key) throws -> [UInt8] {
+            guard segment.bytes.count >= authenticationBytesLength else {
+                throw EncryptionError.decryptionFailed
+            }
+
+            let nonce = self.nonce(prefix: noncePrefix, index: segment.index)
+            let additionalData = self.additionalData(for: segment)
+            var message = [UInt8](repeating: 0, count: segment.bytes.count - authenticationBytesLength)
+            var messageLength: UInt64 = 0
+
+            guard crypto_aead_xchacha20poly1305_ietf_decrypt(
+                &message,
+                &messageLength,
+                nil,
+                segment.bytes,
+                UInt64(segment.bytes.count),
+                additionalData,
+                UInt64(additionalData.count),
+                nonce,
+                key.buffer
+            ) == 0 else {
+                throw EncryptionError.decryptionFailed
+            }
+
+            return Array(message.prefix(Int(messageLength)))
+        }
+
+        private static func nonce(prefix: [UInt8], index: UInt64) -> [UInt8] {
+            var nonce = prefix
+            withUnsafeBytes(of: index.bigEndian) { nonce.append(contentsOf: $0) }
+            return nonce
+        }
+
+        private static func additionalData(for segment: Segment) -> [UInt8] {
+            var additionalData = [UInt8]()
+            withUnsafeBytes(of: segment.index.bigEndian) { additionalData.append(contentsOf: $0) }
+            additionalData.append(segment.isFinal ? 1 : 0)
+            return additionalData
+        }
+
+        // MARK: - Streams
+
+        /// Splits an input stream into segments, reading one segment ahead to find the final one.
+        private final class SegmentReader {
+
+            private let input: InputStream
+            private let segmentSize: Int
+            private var lookahead: [UInt8]?
+            private var nextIndex: UInt64 = 0
+            private var reachedEnd = false
+
+            init(input: InputStream, segmentSize: Int) {
+                self.input = input
+                self.segmentSize = segmentSize
+            }
+
+            func next() throws -> Segment? {
+                guard !reachedEnd else { return nil }
+
+                let bytes = try lookahead ?? read(count: segmentSize, from: input)
+                lookahead = nil
+
+                if bytes.count == segmentSize {
+                    let following = try read(count: segmentSize, from: input)
+                    if following.isEmpty {
+                        reachedEnd = true
+                    } else {
+                        lookahead = following
+                    }
+                } else {
+                    reachedEnd = true
+                }
+
+                defer { nextIndex += 1 }
+                return Segment(index: nextIndex, bytes: bytes, isFinal: reachedEnd)
+            }
+
+        }
+
+        /// Reads up to `count` bytes, fewer only if the end of the stream is reached.
+        private static func read(count: Int, from input: InputStream) throws -> [UInt8] {
+            var buffer = [UInt8](repeating: 0, count: count)
+            var bytesRead = 0
+
+            while bytesRead < count {
+                let result = buffer.withUnsafeMutableBufferPointer {
+                    input.read($0.baseAddress! + bytesRead, maxLength: count - bytesRead)
+                }
+
+                if result < 0 {
+                    throw EncryptionError.readError(input.streamError ?? EncryptionError.unknown)
+                }
+
+                if result == 0 { break }
+
+                bytesRead += result
+            }
+
+            buffer.removeLast(count - bytesRead)
+            return buffer
+        }
+
+        /// Writes all bytes, failing if the output stream doesn't accept them.
+        private static func write(_ bytes: [UInt8], to output: OutputStream) throws {
+            var bytesWritten = 0
+
+            while bytesWritten < bytes.count {
+                let result = bytes.withUnsafeBufferPointer {
+                    output.write($0.baseAddress! + bytesWritten, maxLength: bytes.count - bytesWritten)
+                }
+
+                guard result > 0 else {
+                    throw EncryptionError.writeError(output.streamError ?? EncryptionError.unexpectedStreamEnd)
+                }
+
+                bytesWritten += result
+            }
+        }
+
+    }
+
+}
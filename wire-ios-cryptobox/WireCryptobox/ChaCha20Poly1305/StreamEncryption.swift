@@ -24,6 +24,9 @@ public extension ChaCha20Poly1305 {
 
         private static let bufferSize = 1024 * 1024
 
+        /// Size of the plaintext segments written by `encrypt`.
+        static let segmentSize = 1024 * 1024
+
         public enum EncryptionError: Error {
             /// Couldn't read corrupt message header
             case malformedHeader
@@ -80,15 +83,20 @@ public extension ChaCha20Poly1305 {
                 }
             }
 
-            public static let version: UInt16 = 1
+            /// Version 1 is a single `crypto_secretstream` stream, version 2 a
+            /// sequence of independently authenticated segments.
+            public static let version: UInt16 = 2
+            public static let legacyVersion: UInt16 = 1
             public static let platform = "WBUI".data(using: .ascii)!
 
             let buffer: [UInt8]
+            let version: UInt16
             let salt: [UInt8]
             let uuidHash: [UInt8]
 
             init(buffer: [UInt8]) throws {
 
+                var version: UInt16 = 0
                 var salt: [UInt8] = [UInt8](repeating: 0, count: Field.salt.rawValue)
                 var hash: [UInt8] = [UInt8](repeating: 0, count: Field.uuidHash.rawValue)
 
@@ -101,7 +109,8 @@ public extension ChaCha20Poly1305 {
                     case .emptySpace:
                         break
                     case .version:
-                        guard UInt16(bigEndian: Data(Array(partition)).withUnsafeBytes { $0.baseAddress!.assumingMemoryBound(to: UInt16.self).pointee }) == Header.version else {
+                        version = UInt16(bigEndian: Data(Array(partition)).withUnsafeBytes { $0.baseAddress!.assumingMemoryBound(to: UInt16.self).pointee })
+                        guard version == Header.version || version == Header.legacyVersion else {
                             throw EncryptionError.malformedHeader
                         }
                     case .salt:
@@ -111,26 +120,28 @@ public extension ChaCha20Poly1305 {
                     }
                 }
 
+                self.version = version
                 self.salt = salt
                 self.uuidHash = hash
                 self.buffer = buffer
             }
 
-            init(uuid: UUID) throws {
+            init(uuid: UUID, version: UInt16 = Header.version) throws {
                 var buffer = [UInt8]()
-                var version = Header.version.bigEndian
+                var bigEndianVersion = version.bigEndian
                 var salt = [UInt8](repeating: 0, count: Int(crypto_pwhash_argon2i_SALTBYTES))
                 randombytes_buf(&salt, Int(UInt64(crypto_pwhash_argon2i_SALTBYTES)))
                 let uuidHash = try Header.hash(uuid: uuid, salt: salt)
 
                 buffer.append(contentsOf: [UInt8](Header.platform))
                 buffer.append(0)
-                withUnsafeBytes(of: &version) { versionBytes in
+                withUnsafeBytes(of: &bigEndianVersion) { versionBytes in
                     buffer.append(contentsOf: versionBytes)
                 }
                 buffer.append(contentsOf: salt)
                 buffer.append(contentsOf: uuidHash)
 
+                self.version = version
                 self.salt = salt
                 self.uuidHash = uuidHash
                 self.buffer = buffer
@@ -182,7 +193,7 @@ public extension ChaCha20Poly1305 {
         /// ChaCha20 Key
         internal struct Key {
 
-            fileprivate let buffer: [UInt8]
+            let buffer: [UInt8]
 
             /// Generate a key from a passphrase.
             /// - passphrase: string which is used to derive the key
@@ -204,9 +215,13 @@ public extension ChaCha20Poly1305 {
                 self.buffer = buffer
             }
 
+            init(bytes: [UInt8]) {
+                self.buffer = bytes
+            }
+
         }
 
-        fileprivate static func initializeSodium() throws {
+        static func initializeSodium() throws {
             guard sodium_init() >= 0 else {
                 throw EncryptionError.failureInitializingSodium
             }
@@ -217,10 +232,17 @@ public extension ChaCha20Poly1305 {
         /// - output: decrypted output stream
         /// - passphrase: passphrase
         ///
+        /// The stream is split into segments which are encrypted in parallel,
+        /// see `SegmentedStream`.
+        ///
         /// - Throws: Stream errors.
         /// - Returns: number of encrypted bytes written to the output stream
         @discardableResult
         public static func encrypt(input: InputStream, output: OutputStream, passphrase: Passphrase) throws -> Int {
+            try encrypt(input: input, output: output, passphrase: passphrase, version: Header.version)
+        }
+
+        static func encrypt(input: InputStream, output: OutputStream, passphrase: Passphrase, version: UInt16) throws -> Int {
 
             try initializeSodium()
 
@@ -232,21 +254,36 @@ public extension ChaCha20Poly1305 {
                 output.close()
             }
 
-            var totalBytesWritten = 0
-            var bytesWritten = -1
-            var bytesRead = -1
-            var bytesReadReadAhead = -1
-
-            let fileHeader = try Header(uuid: passphrase.uuid)
+            let fileHeader = try Header(uuid: passphrase.uuid, version: version)
             let key = try fileHeader.deriveKey(from: passphrase)
 
-            bytesWritten = output.write(fileHeader.buffer, maxLength: fileHeader.buffer.count)
-            totalBytesWritten += bytesWritten
+            let bytesWritten = output.write(fileHeader.buffer, maxLength: fileHeader.buffer.count)
 
             guard bytesWritten > 0 else {
                 throw EncryptionError.writeError(output.streamError ?? EncryptionError.unexpectedStreamEnd)
             }
 
+            if version == Header.legacyVersion {
+                return try bytesWritten + encryptLegacyStream(input: input, output: output, key: key)
+            } else {
+                return try bytesWritten + SegmentedStream.encrypt(
+                    input: input,
+                    output: output,
+                    key: key,
+                    segmentSize: segmentSize,
+                    concurrency: ProcessInfo.processInfo.activeProcessorCount
+                )
+            }
+        }
+
+        /// Encrypts the rest of the input stream into a single `crypto_secretstream`.
+        private static func encryptLegacyStream(input: InputStream, output: OutputStream, key: Key) throws -> Int {
+
+            var totalBytesWritten = 0
+            var bytesWritten = -1
+            var bytesRead = -1
+            var bytesReadReadAhead = -1
+
             var chachaHeader = [UInt8](repeating: 0, count: Int(crypto_secretstream_xchacha20poly1305_HEADERBYTES))
             var state = crypto_secretstream_xchacha20poly1305_state()
 
@@ -328,10 +365,6 @@ public extension ChaCha20Poly1305 {
                 output.close()
             }
 
-            var totalBytesWritten = 0
-            var bytesWritten = -1
-            var bytesRead = -1
-
             var fileHeaderBuffer = [UInt8](repeating: 0, count: Int(Header.Field.sizeOfAllFields))
 
             guard input.read(&fileHeaderBuffer, maxLength: Header.Field.sizeOfAllFields) > 0  else {
@@ -340,6 +373,26 @@ public extension ChaCha20Poly1305 {
 
             let fileHeader = try Header(buffer: fileHeaderBuffer)
             let key = try fileHeader.deriveKey(from: passphrase)
+
+            if fileHeader.version == Header.legacyVersion {
+                return try decryptLegacyStream(input: input, output: output, key: key)
+            } else {
+                return try SegmentedStream.decrypt(
+                    input: input,
+                    output: output,
+                    key: key,
+                    concurrency: ProcessInfo.processInfo.activeProcessorCount
+                )
+            }
+        }
+
+        /// Decrypts the rest of the input stream as a single `crypto_secretstream`.
+        private static func decryptLegacyStream(input: InputStream, output: OutputStream, key: Key) throws -> Int {
+
+            var totalBytesWritten = 0
+            var bytesWritten = -1
+            var bytesRead = -1
+
             var state = crypto_secretstream_xchacha20poly1305_state()
             var chachaHeader = [UInt8](repeating: 0, count: Int(crypto_secretstream_xchacha20poly1305_HEADERBYTES))
 
@@ -53,6 +53,38 @@ class ChaCha20AEADEncryptionTests: XCTestCase {
         XCTAssertEqual(decryptedMessage, message)
     }
 
+    func testThatItEncryptsAndDecryptsMessagesInBulk() throws {
+        // Given
+        let messages = (0..<10).map { Data("Message \($0)".utf8) }
+        let key = Data.zmRandomSHA256Key()
+
+        // When
+        let encrypted = try Sut.encrypt(messages: messages, context: context, key: key)
+
+        // Then
+        XCTAssertEqual(encrypted.count, messages.count)
+        XCTAssertEqual(Set(encrypted.map(\.nonce)).count, messages.count)
+
+        // When
+        let decrypted = try Sut.decrypt(ciphertexts: encrypted, context: context, key: key)
+
+        // Then
+        XCTAssertEqual(decrypted, messages)
+    }
+
+    func testThatItDecryptsSingleMessagesEncryptedInBulk() throws {
+        // Given
+        let message = Data("Hello, world".utf8)
+        let key = Data.zmRandomSHA256Key()
+        let encrypted = try XCTUnwrap(Sut.encrypt(messages: [message], context: context, key: key).first)
+
+        // When
+        let decryptedMessage = try Sut.decrypt(ciphertext: encrypted.ciphertext, nonce: encrypted.nonce, context: context, key: key)
+
+        // Then
+        XCTAssertEqual(decryptedMessage, message)
+    }
+
     // MARK: - Negative Tests
 
     func testThatItFailsToEncryptIfKeyIsMalformed() throws {
@@ -123,6 +155,23 @@ class ChaCha20AEADEncryptionTests: XCTestCase {
         }
     }
 
+    func testThatItFailsToDecryptInBulkIfOneNonceIsMalformed() throws {
+        // Given
+        let key = Data.zmRandomSHA256Key()
+        var encrypted = try Sut.encrypt(messages: [Data("a".utf8), Data("b".utf8)], context: context, key: key)
+        encrypted[1].nonce = encrypted[1].nonce.dropLast()
+
+        do {
+            // When
+            _ = try Sut.decrypt(ciphertexts: encrypted, context: context, key: key)
+        } catch let error as Sut.EncryptionError {
+            // Then
+            XCTAssertEqual(error, .malformedNonce)
+        } catch {
+            XCTFail("Unexpected error: \(error.localizedDescription)")
+        }
+    }
+
     func testThatItFailsToDecryptWithDifferentNonce() throws {
         // Given
         let message = Data("Hello, world".utf8)
@@ -327,7 +327,7 @@ class ChaCha20StreamEncryptionTests: XCTestCase {
         do {
             let encryptedMessage = try encrypt(message, passphrase: Sut.Passphrase(password: password, uuid: uuid1))
             var modifiedMessage = [UInt8](encryptedMessage)
-            modifiedMessage[6] = 2 // change version number
+            modifiedMessage[6] = 3 // change version number
             _ = try decrypt(Data(modifiedMessage), passphrase: Sut.Passphrase(password: password, uuid: uuid2))
         } catch Sut.EncryptionError.malformedHeader {
             return // success
@@ -336,4 +336,204 @@ class ChaCha20StreamEncryptionTests: XCTestCase {
         }
     }
 
+    // MARK: - Formats
+
+    func testThatTheLegacyFormatCanStillBeDecrypted() throws {
+
+        // given
+        let passphrase = Sut.Passphrase(password: "1235678", uuid: UUID())
+        let messageData = Data("123456789".utf8)
+        let inputStream = InputStream(data: messageData)
+        let outputStream = OutputStream.toMemory()
+        try Sut.encrypt(input: inputStream, output: outputStream, passphrase: passphrase, version: Sut.Header.legacyVersion)
+        let encryptedMessage = try XCTUnwrap(outputStream.property(forKey: .dataWrittenToMemoryStreamKey) as? Data)
+
+        // when
+        let decryptedMessage = try decrypt(encryptedMessage, passphrase: passphrase)
+
+        // then
+        XCTAssertEqual(encryptedMessage[6], 1)
+        XCTAssertEqual(decryptedMessage, messageData)
+    }
+
+    func testThatItWritesTheSegmentedFormat() throws {
+
+        // given
+        let passphrase = Sut.Passphrase(password: "1235678", uuid: UUID())
+
+        // when
+        let encryptedMessage = try encrypt(Data("123456789".utf8), passphrase: passphrase)
+
+        // then
+        XCTAssertEqual(encryptedMessage[6], 2)
+    }
+
+}
+
+class ChaCha20SegmentedStreamTests: XCTestCase {
+
+    private typealias Segments = ChaCha20Poly1305.StreamEncryption.SegmentedStream
+
+    private var key: ChaCha20Poly1305.StreamEncryption.Key!
+
+    override func setUp() {
+        super.setUp()
+        var bytes = [UInt8](repeating: 0, count: Int(crypto_aead_xchacha20poly1305_ietf_KEYBYTES))
+        randombytes_buf(&bytes, bytes.count)
+        key = ChaCha20Poly1305.StreamEncryption.Key(bytes: bytes)
+    }
+
+    override func tearDown() {
+        key = nil
+        super.tearDown()
+    }
+
+    private func randomData(count: Int) -> Data {
+        var bytes = [UInt8](repeating: 0, count: count)
+        randombytes_buf(&bytes, count)
+        return Data(bytes)
+    }
+
+    private func encrypt(_ message: Data, segmentSize: Int, concurrency: Int) throws -> Data {
+        let input = InputStream(data: message)
+        let output = OutputStream.toMemory()
+        input.open()
+        output.open()
+        defer {
+            input.close()
+            output.close()
+        }
+
+        let bytesWritten = try Segments.encrypt(input: input, output: output, key: key, segmentSize: segmentSize, concurrency: concurrency)
+        let ciphertext = try XCTUnwrap(output.property(forKey: .dataWrittenToMemoryStreamKey) as? Data)
+        XCTAssertEqual(bytesWritten, ciphertext.count)
+        return ciphertext
+    }
+
+    private func decrypt(_ ciphertext: Data, concurrency: Int) throws -> Data {
+        let input = InputStream(data: ciphertext)
+        let output = OutputStream.toMemory()
+        input.open()
+        output.open()
+        defer {
+            input.close()
+            output.close()
+        }
+
+        let bytesWritten = try Segments.decrypt(input: input, output: output, key: key, concurrency: concurrency)
+        let message = output.property(forKey: .dataWrittenToMemoryStreamKey) as? Data ?? Data()
+        XCTAssertEqual(bytesWritten, message.count)
+        return message
+    }
+
+    private func assertDecryptionFails(_ ciphertext: Data, file: StaticString = #file, line: UInt = #line) {
+        XCTAssertThrowsError(try decrypt(ciphertext, concurrency: 4), file: file, line: line) { error in
+            guard case Sut.EncryptionError.decryptionFailed = error else {
+                return XCTFail("unexpected error: \(error)", file: file, line: line)
+            }
+        }
+    }
+
+    // MARK: - Round trips
+
+    func testThatMessagesOfAnySizeCanBeDecrypted() throws {
+        for count in [0, 1, 999, 1000, 1001, 10000, 10500] {
+            // given
+            let message = randomData(count: count)
+
+            // when
+            let ciphertext = try encrypt(message, segmentSize: 1000, concurrency: 4)
+            let decryptedMessage = try decrypt(ciphertext, concurrency: 3)
+
+            // then
+            XCTAssertEqual(decryptedMessage, message, "message of \(count) bytes")
+        }
+    }
+
+    func testThatTheOutputDoesNotDependOnTheConcurrency() throws {
+        // given
+        let message = randomData(count: 10500)
+
+        // when
+        let ciphertext = try encrypt(message, segmentSize: 1000, concurrency: 1)
+
+        // then
+        XCTAssertEqual(try decrypt(ciphertext, concurrency: 1), message)
+        XCTAssertEqual(try decrypt(ciphertext, concurrency: 8), message)
+    }
+
+    // MARK: - Tampering
+
+    /// Segment header (4 + 16 bytes), then segments of 1000 + 16 bytes.
+    private let segmentsOffset = 20
+    private let sealedSegmentSize = 1016
+
+    func testThatItDetectsATruncatedStream() throws {
+        // given
+        let ciphertext = try encrypt(randomData(count: 3000), segmentSize: 1000, concurrency: 4)
+
+        // then
+        assertDecryptionFails(ciphertext.prefix(segmentsOffset + 2 * sealedSegmentSize))
+    }
+
+    func testThatItDetectsReorderedSegments() throws {
+        // given
+        let ciphertext = try encrypt(randomData(count: 3000), segmentSize: 1000, concurrency: 4)
+        let first = ciphertext.subdata(in: segmentsOffset..<segmentsOffset + sealedSegmentSize)
+        let second = ciphertext.subdata(in: segmentsOffset + sealedSegmentSize..<segmentsOffset + 2 * sealedSegmentSize)
+
+        // when
+        var modified = ciphertext
+        modified.replaceSubrange(segmentsOffset..<segmentsOffset + sealedSegmentSize, with: second)
+        modified.replaceSubrange(segmentsOffset + sealedSegmentSize..<segmentsOffset + 2 * sealedSegmentSize, with: first)
+
+        // then
+        assertDecryptionFails(modified)
+    }
+
+    func testThatItDetectsAModifiedSegment() throws {
+        // given
+        var ciphertext = try encrypt(randomData(count: 3000), segmentSize: 1000, concurrency: 4)
+
+        // when
+        ciphertext[segmentsOffset + sealedSegmentSize + 10] ^= 0xFF
+
+        // then
+        assertDecryptionFails(ciphertext)
+    }
+
+    // MARK: - Performance
+
+    func testThatThroughputScalesWithTheNumberOfCores() throws {
+        // given
+        let message = randomData(count: 64 * 1024 * 1024)
+        let segmentSize = ChaCha20Poly1305.StreamEncryption.segmentSize
+        let cores = ProcessInfo.processInfo.activeProcessorCount
+
+        func throughput(concurrency: Int) throws -> (encryption: Double, decryption: Double) {
+            let encryptionStart = Date()
+            let ciphertext = try encrypt(message, segmentSize: segmentSize, concurrency: concurrency)
+            let encryptionDuration = Date().timeIntervalSince(encryptionStart)
+
+            let decryptionStart = Date()
+            let decryptedMessage = try decrypt(ciphertext, concurrency: concurrency)
+            let decryptionDuration = Date().timeIntervalSince(decryptionStart)
+
+            XCTAssertEqual(decryptedMessage, message)
+
+            let megabytes = Double(message.count) / (1024 * 1024)
+            return (megabytes / encryptionDuration, megabytes / decryptionDuration)
+        }
+
+        // when
+        let sequential = try throughput(concurrency: 1)
+        let parallel = try throughput(concurrency: cores)
+
+        // then
+        print("""
+        stream encryption with 1 thread: \(Int(sequential.encryption)) MB/s encrypt, \(Int(sequential.decryption)) MB/s decrypt
+        stream encryption with \(cores) threads: \(Int(parallel.encryption)) MB/s encrypt, \(Int(parallel.decryption)) MB/s decrypt
+        """)
+    }
+
 }
@@ -205,7 +205,9 @@ public class EARService: EARServiceInterface {
     /// biometric authentication. Sensitive data in the database will be encrypted with
     /// the newly generated database key (unless `skipMigration` is `true`). If an error
     /// occurs during this process, the keys will be destroyed, the migration is rolled
-    /// back and encryption at rest will remain disabled.
+    /// back and encryption at rest will remain disabled. If a previous migration was
+    /// interrupted, its keys are reused and never destroyed, since part of the data is
+    /// encrypted with them.
     ///
     /// - Parameters:
     ///   - context: The context in which to perform the migration.
@@ -226,9 +228,18 @@ public class EARService: EARServiceInterface {
             guard let self else { return }
 
             do {
-                try self.deleteExistingKeys()
-                try self.generateKeys()
-                let databaseKey = try self.fetchDecryptedDatabaseKey()
+                let databaseKey: VolatileData
+
+                if context.hasInterruptedEncryptionAtRestMigration {
+                    // Part of the data is encrypted with the existing key, new keys
+                    // would make it unreadable. Give up if the key can't be loaded.
+                    WireLogger.ear.info("resuming interrupted migration with existing keys")
+                    databaseKey = try self.fetchDecryptedDatabaseKey()
+                } else {
+                    try self.deleteExistingKeys()
+                    try self.generateKeys()
+                    databaseKey = try self.fetchDecryptedDatabaseKey()
+                }
 
                 if !skipMigration {
                     try context.migrateTowardEncryptionAtRest(databaseKey: databaseKey)
@@ -242,7 +253,13 @@ public class EARService: EARServiceInterface {
                 context.databaseKey = nil
                 context.encryptMessagesAtRest = false
                 self.earStorage.enableEAR(false)
-                try? self.deleteExistingKeys()
+
+                // Keep the keys if some data was already encrypted, so the
+                // migration can be resumed.
+                if !context.hasInterruptedEncryptionAtRestMigration {
+                    try? self.deleteExistingKeys()
+                }
+
                 throw error
             }
         }
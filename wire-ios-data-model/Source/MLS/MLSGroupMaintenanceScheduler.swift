@@ -0,0 +1,164 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// Counters describing a run of an `MLSGroupMaintenanceScheduler`.
+public struct MLSGroupMaintenanceProgress: Equatable {
+
+    /// The number of groups the run was asked to maintain.
+    public var total = 0
+
+    /// The number of groups that were maintained successfully.
+    public var succeeded = 0
+
+    /// The number of groups for which the operation failed.
+    public var failed = 0
+
+    /// The number of groups that were skipped because they are backing off
+    /// after earlier failures.
+    public var deferred = 0
+
+    /// Whether every group was either processed or deferred.
+    public var isFinished: Bool {
+        succeeded + failed + deferred == total
+    }
+
+}
+
+/// Runs a maintenance operation, such as updating key material or repairing
+/// an out of sync conversation, on many MLS groups.
+///
+/// At most `maximumConcurrentOperations` groups are maintained at the same time.
+/// A group whose operation failed is skipped by subsequent runs until its
+/// backoff expires. The backoff doubles with every consecutive failure and is
+/// cleared by a success.
+actor MLSGroupMaintenanceScheduler {
+
+    struct Configuration {
+
+        var maximumConcurrentOperations = 8
+        var initialBackoff: TimeInterval = 30
+        var maximumBackoff: TimeInterval = .oneHour
+
+    }
+
+    private struct Backoff {
+
+        var failures: Int
+        var nextAttempt: Date
+
+    }
+
+    private let configuration: Configuration
+    private let currentDate: () -> Date
+    private var backoffs = [MLSGroupID: Backoff]()
+
+    /// The progress of the current or last run.
+    private(set) var progress = MLSGroupMaintenanceProgress()
+
+    init(
+        configuration: Configuration = Configuration(),
+        currentDate: @escaping () -> Date = Date.init
+    ) {
+        self.configuration = configuration
+        self.currentDate = currentDate
+    }
+
+    /// Performs the operation for every group that isn't backing off.
+    ///
+    /// - Parameters:
+    ///   - groups: The groups to maintain.
+    ///   - operation: The operation to perform for a single group.
+    ///
+    /// - Returns: The progress once all groups are processed.
+    @discardableResult
+    func run(
+        groups: [MLSGroupID],
+        operation: @escaping (MLSGroupID) async throws -> Void
+    ) async -> MLSGroupMaintenanceProgress {
+        let now = currentDate()
+        let dueGroups = groups.filter { groupID in
+            backoffs[groupID].map { $0.nextAttempt <= now } ?? true
+        }
+
+        progress = MLSGroupMaintenanceProgress(
+            total: groups.count,
+            deferred: groups.count - dueGroups.count
+        )
+
+        await withTaskGroup(of: (groupID: MLSGroupID, succeeded: Bool).self) { taskGroup in
+            var remainingGroups = dueGroups.makeIterator()
+
+            func addTask(for groupID: MLSGroupID) {
+                taskGroup.addTask {
+                    do {
+                        try await operation(groupID)
+                        return (groupID, true)
+                    } catch {
+                        return (groupID, false)
+                    }
+                }
+            }
+
+            for _ in 0..<max(configuration.maximumConcurrentOperations, 1) {
+                guard let groupID = remainingGroups.next() else { break }
+                addTask(for: groupID)
+            }
+
+            while let result = await taskGroup.next() {
+                record(result.groupID, succeeded: result.succeeded)
+
+                if let nextGroupID = remainingGroups.next() {
+                    addTask(for: nextGroupID)
+                }
+            }
+        }
+
+        return progress
+    }
+
+    /// Whether a group is skipped by runs until its backoff expires.
+    func isBackingOff(_ groupID: MLSGroupID) -> Bool {
+        backoffs[groupID].map { $0.nextAttempt > currentDate() } ?? false
+    }
+
+    // MARK: - Helpers
+
+    private func record(_ groupID: MLSGroupID, succeeded: Bool) {
+        if succeeded {
+            progress.succeeded += 1
+            backoffs[groupID] = nil
+            return
+        }
+
+        progress.failed += 1
+
+        let failures = (backoffs[groupID]?.failures ?? 0) + 1
+        let delay = min(
+            configuration.initialBackoff * pow(2, Double(failures - 1)),
+            configuration.maximumBackoff
+        )
+
+        backoffs[groupID] = Backoff(
+            failures: failures,
+            nextAttempt: currentDate().addingTimeInterval(delay)
+        )
+    }
+
+}
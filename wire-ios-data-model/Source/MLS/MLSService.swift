@@ -319,18 +319,28 @@ public protocol MLSServiceInterface: MLSEncryptionServiceInterface, MLSDecryptio
     ///
     /// Starts by getting a list of groups that have pending proposals.
     /// This is done by fetching conversations that have a ``ZMConversation/commitPendingProposalDate`` set.
-    /// We then compile the ``MLSGroupID`` of each conversation and their subconversation
+    /// Groups that are already scheduled for that date are skipped. For the others we compile
+    /// the ``MLSGroupID`` of each conversation and their subconversation
     /// (if they exist) associated with the pending proposal date.
-    /// The groups are then sorted by the date of the pending proposal.
-    ///
-    /// We then iterate through each group and check if the pending proposal date has been passed.
-    /// If it has, we commit the pending proposal by calling ``MLSService/commitPendingProposals(in:)``
-    /// Otherwise, we wait until the pending proposal date has passed. Then we commit the pending proposal.
+    /// The groups are then handed to a scheduler that keeps a single wakeup for the earliest
+    /// pending proposal date, and commits the proposals of all groups that are due together
+    /// by calling ``MLSService/commitPendingProposals(in:)``.
     ///
     /// [confluence use case](https://wearezeta.atlassian.net/wiki/spaces/ENGINEERIN/pages/601522340/Use+Case+Committing+pending+proposals+MLS)
 
     func commitPendingProposalsIfNeeded()
 
+    /// Schedules a commit of the pending proposals in a group, and in its conference subgroup if it has one.
+    ///
+    /// - Parameters:
+    ///   - groupID: The ID of the group that received a proposal
+    ///   - commitDate: The date at which the proposals should be committed
+    ///
+    /// Unlike ``commitPendingProposalsIfNeeded()`` this doesn't fetch all groups with pending proposals,
+    /// it only adds the group to the scheduled commits.
+
+    func scheduleCommitPendingProposals(in groupID: MLSGroupID, at commitDate: Date) async
+
     /// Commits pending proposals for a group.
     ///
     /// - Parameter groupID: The group ID to commit pending proposals for
@@ -356,7 +366,9 @@ public protocol MLSServiceInterface: MLSEncryptionServiceInterface, MLSDecryptio
     /// to get the groups with stale key material.
     ///
     /// Then, for each stale group, it updates the key material
-    /// by calling ``MLSActionExecutor/updateKeyMaterial(for:)``
+    /// by calling ``MLSActionExecutor/updateKeyMaterial(for:)``.
+    /// Several groups are updated concurrently, and groups that failed recently are skipped
+    /// until their backoff expires.
     ///
     /// If successful it notifies that the key material has been updated 
     /// via ``StaleMLSKeyDetector/keyingMaterialUpdated(for:)``,
@@ -531,6 +543,8 @@ public final class MLSService: MLSServiceInterface {
     private let userDefaults: PrivateUserDefaults<Keys>
     private let logger = WireLogger.mls
     private let groupsBeingRepaired = GroupsBeingRepaired()
+    private let keyMaterialUpdateScheduler: MLSGroupMaintenanceScheduler
+    private let outOfSyncRepairScheduler: MLSGroupMaintenanceScheduler
     private let syncStatus: SyncStatusProtocol
     private let featureRepository: FeatureRepositoryInterface
 
@@ -544,7 +558,7 @@ public final class MLSService: MLSServiceInterface {
         case keyPackageQueriedTime
     }
 
-    var pendingProposalCommitTimers = [MLSGroupID: Timer]()
+    private let pendingProposalCommitScheduler: PendingProposalCommitScheduler
 
     let targetUnclaimedKeyPackageCount = 100
     let actionsProvider: MLSActionsProviderProtocol
@@ -601,13 +615,18 @@ public final class MLSService: MLSServiceInterface {
         syncStatus: SyncStatusProtocol,
         userID: UUID,
         featureRepository: FeatureRepositoryInterface,
-        subconversationGroupIDRepository: SubconversationGroupIDRepositoryInterface = SubconversationGroupIDRepository()
+        subconversationGroupIDRepository: SubconversationGroupIDRepositoryInterface = SubconversationGroupIDRepository(),
+        groupMaintenanceConfiguration: MLSGroupMaintenanceScheduler.Configuration = .init(),
+        pendingProposalCommitClock: PendingProposalCommitClock = SystemPendingProposalCommitClock()
     ) {
         let commitSender = CommitSender(
             coreCryptoProvider: coreCryptoProvider,
             notificationContext: context.notificationContext
         )
 
+        // The scheduler is created before `self` is available, so it reaches the service through this reference.
+        weak var weakSelf: MLSService?
+
         self.context = context
         self.notificationContext = notificationContext
         self.coreCryptoProvider = coreCryptoProvider
@@ -624,6 +643,8 @@ public final class MLSService: MLSServiceInterface {
         self.delegate = delegate
         self.syncStatus = syncStatus
         self.subconversationGroupIDRepository = subconversationGroupIDRepository
+        self.keyMaterialUpdateScheduler = MLSGroupMaintenanceScheduler(configuration: groupMaintenanceConfiguration)
+        self.outOfSyncRepairScheduler = MLSGroupMaintenanceScheduler(configuration: groupMaintenanceConfiguration)
 
         self.encryptionService = encryptionService ?? MLSEncryptionService(
             coreCryptoProvider: coreCryptoProvider
@@ -635,6 +656,11 @@ public final class MLSService: MLSServiceInterface {
             subconversationGroupIDRepository: subconversationGroupIDRepository
         )
 
+        self.pendingProposalCommitScheduler = PendingProposalCommitScheduler(clock: pendingProposalCommitClock) { groupIDs in
+            await weakSelf?.commitScheduledPendingProposals(in: groupIDs)
+        }
+
+        weakSelf = self
         schedulePeriodicKeyMaterialUpdateCheck()
     }
 
@@ -780,8 +806,17 @@ public final class MLSService: MLSServiceInterface {
 
         WireLogger.mls.info("found \(staleGroups.count) groups with stale key material")
 
-        for staleGroup in staleGroups {
-            try? await updateKeyMaterial(for: staleGroup)
+        let progress = await keyMaterialUpdateScheduler.run(groups: Array(staleGroups)) { [weak self] groupID in
+            try await self?.updateKeyMaterial(for: groupID)
+        }
+
+        WireLogger.mls.info("updated key material for \(progress.succeeded) groups, \(progress.failed) failed, \(progress.deferred) deferred")
+    }
+
+    /// The progress of the current or last update of stale key material.
+    public var keyMaterialUpdateProgress: MLSGroupMaintenanceProgress {
+        get async {
+            await keyMaterialUpdateScheduler.progress
         }
     }
 
@@ -1248,19 +1283,44 @@ public final class MLSService: MLSServiceInterface {
 
         logger.info("found \(outOfSyncConversationInfos.count) conversations out of sync")
 
-        for conversationInfo in outOfSyncConversationInfos {
+        // Repair the conversations in the order they were found.
+        var conversations = [MLSGroupID: ZMConversation]()
+        var groupIDs = [MLSGroupID]()
+
+        for conversationInfo in outOfSyncConversationInfos where conversations[conversationInfo.mlsGroupId] == nil {
+            conversations[conversationInfo.mlsGroupId] = conversationInfo.conversation
+            groupIDs.append(conversationInfo.mlsGroupId)
+        }
+
+        let progress = await outOfSyncRepairScheduler.run(groups: groupIDs) { groupID in
+            guard let conversation = conversations[groupID] else { return }
+            var repairError: Error?
 
-            await launchGroupRepairTaskIfNotInProgress(for: conversationInfo.mlsGroupId) {
+            await self.launchGroupRepairTaskIfNotInProgress(for: groupID) {
                 do {
                     try await self.joinGroupAndAppendGapSystemMessage(
-                        groupID: conversationInfo.mlsGroupId,
-                        conversation: conversationInfo.conversation,
+                        groupID: groupID,
+                        conversation: conversation,
                         context: context
                     )
                 } catch {
-                    self.logger.warn("failed to repair out of sync conversation (\(conversationInfo.mlsGroupId.safeForLoggingDescription)). error: \(String(reflecting: error))")
+                    self.logger.warn("failed to repair out of sync conversation (\(groupID.safeForLoggingDescription)). error: \(String(reflecting: error))")
+                    repairError = error
                 }
             }
+
+            if let repairError {
+                throw repairError
+            }
+        }
+
+        logger.info("repaired \(progress.succeeded) out of sync conversations, \(progress.failed) failed, \(progress.deferred) deferred")
+    }
+
+    /// The progress of the current or last repair of out of sync conversations.
+    public var outOfSyncRepairProgress: MLSGroupMaintenanceProgress {
+        get async {
+            await outOfSyncRepairScheduler.progress
         }
     }
 
@@ -1403,25 +1463,38 @@ public final class MLSService: MLSServiceInterface {
 
     private func outOfSyncConversations(in context: NSManagedObjectContext) async throws -> [OutOfSyncConversationInfo] {
 
-        let conversations = try await coreCrypto.perform { coreCrypto in
+        // Read all remote epochs in one hop to the context and all local epochs
+        // in one core crypto transaction, instead of one of each per conversation.
+        let candidates = await context.perform {
+            ZMConversation.fetchMLSConversations(in: context).compactMap { conversation in
+                conversation.mlsGroupID.map { (groupID: $0, epoch: conversation.epoch, conversation: conversation) }
+            }
+        }
 
-            let allMLSConversations = await context.perform { ZMConversation.fetchMLSConversations(in: context) }
+        let localEpochs = try await coreCrypto.perform { coreCrypto in
+            var localEpochs = [MLSGroupID: UInt64]()
 
-            var outOfSyncConversations = [ZMConversation]()
-            for conversation in allMLSConversations {
-                guard await isConversationOutOfSync(conversation, coreCrypto: coreCrypto, context: context) else { continue }
-                outOfSyncConversations.append(conversation)
+            for candidate in candidates {
+                do {
+                    localEpochs[candidate.groupID] = try await coreCrypto.conversationEpoch(conversationId: candidate.groupID.data)
+                } catch {
+                    logger.info("cannot resolve conversation epoch \(String(describing: error)) for (\(candidate.groupID.safeForLoggingDescription))")
+                }
             }
-            return outOfSyncConversations
+
+            return localEpochs
         }
-        return await context.perform {
-            conversations.compactMap {
-                if let groupId = $0.mlsGroupID {
-                    return (groupId, $0)
-                } else {
-                    return nil
-                }
+
+        return candidates.compactMap { candidate in
+            guard
+                let localEpoch = localEpochs[candidate.groupID],
+                localEpoch < candidate.epoch
+            else {
+                return nil
             }
+
+            logger.info("epochs(remote: \(candidate.epoch), local: \(localEpoch)) for (\(candidate.groupID.safeForLoggingDescription))")
+            return (candidate.groupID, candidate.conversation)
         }
     }
 
@@ -1688,30 +1761,45 @@ public final class MLSService: MLSServiceInterface {
 
         logger.info("committing any scheduled pending proposals")
 
-        let groupsWithPendingCommits = await self.sortedGroupsWithPendingCommits()
+        // Groups that received their proposals while the scheduler was running are already
+        // scheduled, only the ones it doesn't know yet are looked up and added.
+        let unscheduledGroups = await pendingProposalCommitScheduler.unscheduledCommits(
+            in: groupsWithPendingCommits()
+        )
+        let commits = await includingSubconversations(of: unscheduledGroups)
+
+        logger.info("\(unscheduledGroups.count) groups with unscheduled pending proposals")
+
+        await pendingProposalCommitScheduler.schedule(commits)
+        await pendingProposalCommitScheduler.waitUntilIdle()
+    }
 
-        logger.info("\(groupsWithPendingCommits.count) groups with scheduled pending proposals")
+    public func scheduleCommitPendingProposals(in groupID: MLSGroupID, at commitDate: Date) async {
+        var commits = [(groupID: groupID, commitDate: commitDate)]
+
+        // The pending proposal might be for the subconversation,
+        // so include it just in case.
+        if let subgroupID = await subconversationGroupIDRepository.fetchSubconversationGroupID(
+            forType: .conference,
+            parentGroupID: groupID
+        ) {
+            commits.append((subgroupID, commitDate))
+        }
+
+        await pendingProposalCommitScheduler.schedule(commits)
+    }
+
+    /// Commits the pending proposals of groups that fell due together.
+    private func commitScheduledPendingProposals(in groupIDs: [MLSGroupID]) async {
+        logger.info("scheduled commits are ready for \(groupIDs.count) groups, committing...")
 
         // Committing proposals for each group is independent and should not wait for
         // each other.
         await withTaskGroup(of: Void.self) { taskGroup in
-            for (groupID, timestamp) in groupsWithPendingCommits {
+            for groupID in groupIDs {
                 taskGroup.addTask { [self] in
                     do {
-                        if timestamp.isInThePast {
-                            logger.info("commit scheduled in the past, committing...")
-                            try await commitPendingProposals(in: groupID)
-                        } else {
-                            logger.info("commit scheduled in the future, waiting...")
-
-                            let timeIntervalSinceNow = timestamp.timeIntervalSinceNow
-                            if timeIntervalSinceNow > 0 {
-                                try await Task.sleep(nanoseconds: timeIntervalSinceNow.nanoseconds)
-                            }
-                            logger.info("scheduled commit is ready, committing...")
-                            try await commitPendingProposals(in: groupID)
-                        }
-
+                        try await commitPendingProposals(in: groupID)
                     } catch {
                         logger.error("failed to commit pending proposals: \(String(describing: error))")
                     }
@@ -1720,41 +1808,42 @@ public final class MLSService: MLSServiceInterface {
         }
     }
 
-    private func sortedGroupsWithPendingCommits() async -> [(MLSGroupID, Date)] {
+    private func groupsWithPendingCommits() async -> [(groupID: MLSGroupID, commitDate: Date)] {
         guard let context else {
             return []
         }
 
-        var result: [(MLSGroupID, Date)] = []
-
-        let conversations = await context.perform { ZMConversation.fetchConversationsWithPendingProposals(in: context) }
-
-        for conversation in conversations {
-            let (groupID, timestamp) = await context.perform {
-                (conversation.mlsGroupID,
-                conversation.commitPendingProposalDate)
-            }
+        return await context.perform {
+            ZMConversation.fetchConversationsWithPendingProposals(in: context).compactMap { conversation -> (groupID: MLSGroupID, commitDate: Date)? in
+                guard
+                    let groupID = conversation.mlsGroupID,
+                    let commitDate = conversation.commitPendingProposalDate
+                else {
+                    return nil
+                }
 
-            guard let groupID, let timestamp else {
-                    continue
+                return (groupID, commitDate)
             }
+        }
+    }
 
-            result.append((groupID, timestamp))
+    private func includingSubconversations(
+        of groups: [(groupID: MLSGroupID, commitDate: Date)]
+    ) async -> [(groupID: MLSGroupID, commitDate: Date)] {
+        var result = groups
 
+        for group in groups {
             // The pending proposal might be for the subconversation,
             // so include it just in case.
             if let subgroupID = await subconversationGroupIDRepository.fetchSubconversationGroupID(
                 forType: .conference,
-                parentGroupID: groupID
+                parentGroupID: group.groupID
             ) {
-                result.append((subgroupID, timestamp))
+                result.append((subgroupID, group.commitDate))
             }
         }
 
-        return result.sorted { lhs, rhs in
-            let (lhsCommitDate, rhsCommitDate) = (lhs.1, rhs.1)
-            return lhsCommitDate <= rhsCommitDate
-        }
+        return result
     }
 
     private func commitPendingProposalsIfNeeded(in groupID: MLSGroupID) async throws {
@@ -1791,26 +1880,28 @@ public final class MLSService: MLSServiceInterface {
             logger.info("committing pending proposals in: \(groupID.safeForLoggingDescription)")
             let events = try await mlsActionExecutor.commitPendingProposals(in: groupID)
             await conversationEventProcessor.processConversationEvents(events)
-            clearPendingProposalCommitDate(for: groupID)
+            await clearPendingProposalCommitDate(for: groupID)
             delegate?.mlsServiceDidCommitPendingProposal(for: groupID)
         } catch CommitError.noPendingProposals {
             logger.info("no proposals to commit in group (\(groupID.safeForLoggingDescription))...")
-            clearPendingProposalCommitDate(for: groupID)
+            await clearPendingProposalCommitDate(for: groupID)
         } catch {
             logger.info("failed to commit pending proposals in \(groupID.safeForLoggingDescription): \(String(describing: error))")
             throw error
         }
     }
 
-    private func clearPendingProposalCommitDate(for groupID: MLSGroupID) {
-        guard let context else {
-            return
+    /// Clears the commit date of a group whose proposals were committed, and drops its
+    /// scheduled commit so that the scheduler doesn't commit the group again.
+    private func clearPendingProposalCommitDate(for groupID: MLSGroupID) async {
+        if let context {
+            context.performAndWait {
+                let conversation = ZMConversation.fetch(with: groupID, in: context)
+                conversation?.commitPendingProposalDate = nil
+            }
         }
 
-        context.performAndWait {
-            let conversation = ZMConversation.fetch(with: groupID, in: context)
-            conversation?.commitPendingProposalDate = nil
-        }
+        await pendingProposalCommitScheduler.cancel(groupID)
     }
 
     // MARK: - Error recovery
@@ -0,0 +1,310 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// The passage of time, as far as the `PendingProposalCommitScheduler` is concerned.
+public protocol PendingProposalCommitClock {
+
+    var now: Date { get }
+
+    /// Suspends until the given date, throws if the task is cancelled.
+    func sleep(until date: Date) async throws
+
+}
+
+public struct SystemPendingProposalCommitClock: PendingProposalCommitClock {
+
+    public init() {}
+
+    public var now: Date {
+        Date()
+    }
+
+    public func sleep(until date: Date) async throws {
+        let interval = date.timeIntervalSinceNow
+
+        if interval > 0 {
+            try await Task.sleep(nanoseconds: UInt64(interval * 1_000_000_000))
+        }
+    }
+
+}
+
+/// Commits pending proposals when they fall due.
+///
+/// Scheduled commits are kept in a priority queue ordered by commit date, and a
+/// single wakeup is armed for the earliest one. When it fires, every commit that is
+/// due within `batchingInterval` is handed to the commit handler at once, then the
+/// wakeup is armed for the next one. Scheduling a commit only touches the queue,
+/// and re-arms the wakeup if the new commit is due earlier.
+actor PendingProposalCommitScheduler {
+
+    typealias CommitHandler = ([MLSGroupID]) async -> Void
+
+    private struct Entry {
+
+        let commitDate: Date
+        let groupID: MLSGroupID
+
+    }
+
+    private let clock: PendingProposalCommitClock
+    private let batchingInterval: TimeInterval
+    private let commit: CommitHandler
+
+    /// A min-heap of scheduled commits. An entry is stale if its group was
+    /// rescheduled or cancelled since, such entries are dropped when they surface.
+    private var queue = [Entry]()
+    private var commitDates = [MLSGroupID: Date]()
+
+    private var wakeup: Task<Void, Never>?
+    private var wakeupDate: Date?
+    private var wakeupGeneration = 0
+    private var batchesInProgress = 0
+    private var idleWaiters = [CheckedContinuation<Void, Never>]()
+    private var caughtUpWaiters = [CheckedContinuation<Void, Never>]()
+
+    /// The number of wakeups that were armed so far.
+    private(set) var wakeupCount = 0
+
+    init(
+        clock: PendingProposalCommitClock = SystemPendingProposalCommitClock(),
+        batchingInterval: TimeInterval = 1,
+        commit: @escaping CommitHandler
+    ) {
+        self.clock = clock
+        self.batchingInterval = batchingInterval
+        self.commit = commit
+    }
+
+    // MARK: - Scheduling
+
+    /// The number of groups with a scheduled commit.
+    var scheduledCount: Int {
+        commitDates.count
+    }
+
+    /// Schedules a commit, replacing any commit already scheduled for the group.
+    func schedule(_ groupID: MLSGroupID, at commitDate: Date) {
+        commitDates[groupID] = commitDate
+        push(Entry(commitDate: commitDate, groupID: groupID))
+        rearm()
+    }
+
+    /// Schedules commits for several groups.
+    func schedule(_ commits: [(groupID: MLSGroupID, commitDate: Date)]) {
+        for commit in commits {
+            commitDates[commit.groupID] = commit.commitDate
+            push(Entry(commitDate: commit.commitDate, groupID: commit.groupID))
+        }
+
+        rearm()
+    }
+
+    /// Returns the commits whose groups aren't scheduled for the same date yet.
+    func unscheduledCommits(
+        in commits: [(groupID: MLSGroupID, commitDate: Date)]
+    ) -> [(groupID: MLSGroupID, commitDate: Date)] {
+        commits.filter { commitDates[$0.groupID] != $0.commitDate }
+    }
+
+    /// Removes the scheduled commit of a group, e.g. because it was committed before sending a message.
+    func cancel(_ groupID: MLSGroupID) {
+        guard commitDates.removeValue(forKey: groupID) != nil else { return }
+        rearm()
+    }
+
+    // MARK: - Waiting
+
+    /// Returns once no commits are scheduled or in progress.
+    func waitUntilIdle() async {
+        guard !isIdle else { return }
+
+        await withCheckedContinuation { continuation in
+            idleWaiters.append(continuation)
+        }
+    }
+
+    /// Returns once every commit due by now was handed to the commit handler and completed.
+    func waitUntilCaughtUp() async {
+        guard !isCaughtUp else { return }
+
+        await withCheckedContinuation { continuation in
+            caughtUpWaiters.append(continuation)
+        }
+    }
+
+    private var isIdle: Bool {
+        commitDates.isEmpty && batchesInProgress == 0
+    }
+
+    private var isCaughtUp: Bool {
+        guard batchesInProgress == 0 else { return false }
+        guard let nextCommitDate = nextCommitDate() else { return true }
+        return nextCommitDate > clock.now
+    }
+
+    private func resumeWaiters() {
+        if isIdle {
+            idleWaiters.forEach { $0.resume() }
+            idleWaiters.removeAll()
+        }
+
+        if isCaughtUp {
+            caughtUpWaiters.forEach { $0.resume() }
+            caughtUpWaiters.removeAll()
+        }
+    }
+
+    // MARK: - Wakeup
+
+    private func rearm() {
+        defer { resumeWaiters() }
+
+        compactQueueIfNeeded()
+
+        guard let nextCommitDate = nextCommitDate() else {
+            cancelWakeup()
+            return
+        }
+
+        if let wakeupDate, wakeupDate <= nextCommitDate {
+            // The armed wakeup fires early enough.
+            return
+        }
+
+        cancelWakeup()
+        wakeupGeneration += 1
+        wakeupCount += 1
+        wakeupDate = nextCommitDate
+
+        let generation = wakeupGeneration
+        let clock = clock
+
+        wakeup = Task { [weak self] in
+            do {
+                try await clock.sleep(until: nextCommitDate)
+            } catch {
+                return
+            }
+
+            await self?.fire(generation: generation)
+        }
+    }
+
+    private func cancelWakeup() {
+        wakeup?.cancel()
+        wakeup = nil
+        wakeupDate = nil
+    }
+
+    private func fire(generation: Int) async {
+        guard generation == wakeupGeneration else { return }
+
+        wakeup = nil
+        wakeupDate = nil
+
+        let deadline = clock.now.addingTimeInterval(batchingInterval)
+        var dueGroups = [MLSGroupID]()
+
+        while let entry = queue.first, entry.commitDate <= deadline {
+            pop()
+
+            guard commitDates[entry.groupID] == entry.commitDate else { continue }
+            commitDates[entry.groupID] = nil
+            dueGroups.append(entry.groupID)
+        }
+
+        guard !dueGroups.isEmpty else {
+            rearm()
+            return
+        }
+
+        batchesInProgress += 1
+        rearm()
+
+        await commit(dueGroups)
+
+        batchesInProgress -= 1
+        resumeWaiters()
+    }
+
+    // MARK: - Priority queue
+
+    /// The earliest commit date, after dropping stale entries.
+    private func nextCommitDate() -> Date? {
+        while let entry = queue.first, commitDates[entry.groupID] != entry.commitDate {
+            pop()
+        }
+
+        return queue.first?.commitDate
+    }
+
+    /// Rebuilds the queue once most of its entries are stale, so rescheduling
+    /// busy groups doesn't grow it without bounds.
+    private func compactQueueIfNeeded() {
+        guard queue.count > 2 * commitDates.count + 64 else { return }
+
+        queue.removeAll(keepingCapacity: true)
+
+        for (groupID, commitDate) in commitDates {
+            push(Entry(commitDate: commitDate, groupID: groupID))
+        }
+    }
+
+    private func push(_ entry: Entry) {
+        queue.append(entry)
+        var child = queue.count - 1
+
+        while child > 0 {
+            let parent = (child - 1) / 2
+            guard queue[child].commitDate < queue[parent].commitDate else { break }
+            queue.swapAt(child, parent)
+            child = parent
+        }
+    }
+
+    private func pop() {
+        guard !queue.isEmpty else { return }
+
+        queue.swapAt(0, queue.count - 1)
+        queue.removeLast()
+
+        var parent = 0
+
+        while true {
+            let left = 2 * parent + 1
+            let right = left + 1
+            var smallest = parent
+
+            if left < queue.count, queue[left].commitDate < queue[smallest].commitDate {
+                smallest = left
+            }
+
+            if right < queue.count, queue[right].commitDate < queue[smallest].commitDate {
+                smallest = right
+            }
+
+            guard smallest != parent else { break }
+            queue.swapAt(parent, smallest)
+            parent = smallest
+        }
+    }
+
+}
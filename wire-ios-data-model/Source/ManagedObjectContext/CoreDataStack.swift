@@ -325,6 +325,46 @@ public class CoreDataStack: NSObject, ContextProvider {
         }
     }
 
+    /// Loads the stores for a process that only decrypts and processes incoming events,
+    /// such as the notification service extension.
+    ///
+    /// Both stores are opened in parallel and the method returns once they are loaded.
+    /// Only the sync and event contexts are fully configured. The view context is linked
+    /// to the sync context, but no default objects are fetched or created in it, and the
+    /// search context is not created.
+    public func loadStoresForEventProcessing() throws {
+        try createStoreDirectory(for: messagesContainer)
+        try createStoreDirectory(for: eventsContainer)
+
+        let eventStoreGroup = DispatchGroup()
+        var eventStoreError: Error?
+        var messagesStoreError: Error?
+
+        eventStoreGroup.enter()
+        DispatchQueue.global(qos: .userInitiated).async {
+            self.eventsContainer.loadPersistentStores { _, error in
+                eventStoreError = eventStoreError ?? error
+            }
+            eventStoreGroup.leave()
+        }
+
+        messagesContainer.loadPersistentStores { _, error in
+            messagesStoreError = messagesStoreError ?? error
+        }
+
+        eventStoreGroup.wait()
+
+        if let error = messagesStoreError ?? eventStoreError {
+            WireLogger.localStorage.error("failed to load stores for event processing: \(error)", attributes: .safePublic)
+            throw error
+        }
+
+        configureContextReferences()
+        configureViewContext(viewContext, createDefaultObjects: false)
+        configureSyncContext(syncContext)
+        configureEventContext(eventContext)
+    }
+
     func loadMessagesStore(completionHandler: @escaping (Error?) -> Void) {
         do {
             try createStoreDirectory(for: messagesContainer)
@@ -389,11 +429,16 @@ public class CoreDataStack: NSObject, ContextProvider {
 
     // MARK: - Configure Contexts
 
-    func configureViewContext(_ context: NSManagedObjectContext) {
+    func configureViewContext(_ context: NSManagedObjectContext, createDefaultObjects: Bool = true) {
         context.markAsUIContext()
         context.createDispatchGroups()
         dispatchGroup.map(context.addGroup(_:))
         context.mergePolicy = NSMergePolicy(merge: .rollbackMergePolicyType)
+
+        guard createDefaultObjects else {
+            return
+        }
+
         ZMUser.selfUser(in: context)
         Label.fetchOrCreateFavoriteLabel(in: context, create: true)
     }
@@ -0,0 +1,377 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// Migrates the instances of an entity toward or away from encryption at rest.
+///
+/// The instances are split into partitions of contiguous primary keys. Partitions
+/// are migrated in parallel, each on its own background context that shares the
+/// persistent store coordinator of the migrating context. Every saved partition is
+/// recorded in the store metadata in the same transaction as its changes, so a
+/// migration that was interrupted continues with the remaining partitions when it
+/// is started again with the same key. Instances in recorded ranges are checked
+/// again, since they may have been inserted or changed after the range was saved.
+///
+/// `migrate(_:)` blocks until all partitions are done and should be called on the
+/// queue of the migrating context.
+final class EncryptionAtRestMigration {
+
+    // MARK: - Types
+
+    enum Direction: String {
+
+        case towardEncryptionAtRest
+        case awayFromEncryptionAtRest
+
+    }
+
+    /// A range of primary keys that was migrated and saved.
+    struct Checkpoint: Equatable {
+
+        let lowerBound: Int64
+        let upperBound: Int64
+
+    }
+
+    static let checkpointMetadataKey = "encryptionAtRestMigrationCheckpoint"
+    private static let directionKey = "direction"
+    private static let checkpointsKey = "checkpoints"
+
+    // MARK: - Properties
+
+    private let context: NSManagedObjectContext
+    private let direction: Direction
+    private let key: VolatileData
+    private let partitionSize: Int
+    private let progressHandler: ((EncryptionAtRestMigrationProgress) -> Void)?
+
+    /// Serializes updating the checkpoints and saving the partitions.
+    private let saveLock = NSLock()
+
+    // MARK: - Life cycle
+
+    init(
+        context: NSManagedObjectContext,
+        direction: Direction,
+        key: VolatileData,
+        partitionSize: Int = 5000,
+        progressHandler: ((EncryptionAtRestMigrationProgress) -> Void)? = nil
+    ) {
+        self.context = context
+        self.direction = direction
+        self.key = key
+        self.partitionSize = partitionSize
+        self.progressHandler = progressHandler
+    }
+
+    // MARK: - Migration
+
+    /// Migrates all instances of the given type that weren't migrated yet.
+    func migrate<T: MigratableEntity>(_ type: T.Type) throws {
+        let entityName = T.entityName()
+        let completedCheckpoints = checkpoints(for: entityName)
+        let objectIDs = try fetchObjectIDs(type: type)
+
+        // Checkpoints are ranges of primary keys, instances inserted or changed
+        // in a range after it was migrated aren't covered by them.
+        var notYetMigratedObjectIDs = Set<NSManagedObjectID>()
+
+        if !completedCheckpoints.isEmpty {
+            notYetMigratedObjectIDs = Set(try fetchObjectIDs(
+                type: type,
+                matching: type.predicateForObjectsNotYetMigrated(direction)
+            ))
+        }
+
+        let checkpointedObjectIDs = Self.objectIDs(objectIDs, coveredBy: completedCheckpoints)
+        let pendingObjectIDs = objectIDs.filter { objectID in
+            notYetMigratedObjectIDs.contains(objectID) || !checkpointedObjectIDs.contains(objectID)
+        }
+
+        let partitions = stride(from: 0, to: pendingObjectIDs.count, by: partitionSize).map {
+            Array(pendingObjectIDs[$0..<min($0 + partitionSize, pendingObjectIDs.count)])
+        }
+
+        WireLogger.ear.info(
+            "migrating \(pendingObjectIDs.count) of \(objectIDs.count) instances of \(entityName) in \(partitions.count) partitions"
+        )
+
+        let encryptionContext = try context.encryptionContext(for: key)
+        let startDate = Date()
+        let alreadyMigrated = objectIDs.count - pendingObjectIDs.count
+        var migratedInThisRun = 0
+        var firstError: Error?
+        let stateLock = NSLock()
+
+        DispatchQueue.concurrentPerform(iterations: partitions.count) { index in
+            stateLock.lock()
+            let shouldSkip = firstError != nil
+            stateLock.unlock()
+
+            guard !shouldSkip else { return }
+
+            do {
+                try migratePartition(
+                    partitions[index],
+                    type: type,
+                    encryptionContext: encryptionContext
+                )
+            } catch {
+                stateLock.lock()
+                firstError = firstError ?? error
+                stateLock.unlock()
+                return
+            }
+
+            stateLock.lock()
+            migratedInThisRun += partitions[index].count
+            let migrated = migratedInThisRun
+            stateLock.unlock()
+
+            let duration = Date().timeIntervalSince(startDate)
+            progressHandler?(EncryptionAtRestMigrationProgress(
+                entityName: entityName,
+                migratedObjects: alreadyMigrated + migrated,
+                totalObjects: objectIDs.count,
+                duration: duration,
+                throughput: duration > 0 ? Double(migrated) / duration : 0
+            ))
+        }
+
+        if let firstError {
+            throw firstError
+        }
+
+        // The partitions were saved behind the back of the migrating context.
+        context.refreshAllObjects()
+    }
+
+    /// Removes all checkpoints once every entity was migrated.
+    func finish() {
+        context.setPersistentStoreMetadata(nil as String?, key: Self.checkpointMetadataKey)
+        context.saveOrRollback()
+    }
+
+    // MARK: - Partitions
+
+    private func migratePartition<T: MigratableEntity>(
+        _ objectIDs: [NSManagedObjectID],
+        type: T.Type,
+        encryptionContext: NSManagedObjectContext.EncryptionContext
+    ) throws {
+        guard let coordinator = context.persistentStoreCoordinator else {
+            return
+        }
+
+        let partitionContext = NSManagedObjectContext(concurrencyType: .privateQueueConcurrencyType)
+        partitionContext.persistentStoreCoordinator = coordinator
+        partitionContext.undoManager = nil
+        partitionContext.setEncryptionContext(encryptionContext)
+
+        try partitionContext.performAndWait {
+            let instances = try objectIDs.compactMap {
+                try partitionContext.existingObject(with: $0) as? T
+            }
+
+            if let instances = instances as? [any EncryptionAtRestValueMigratable] {
+                // Encrypt or decrypt all values of the partition at once.
+                switch direction {
+                case .towardEncryptionAtRest:
+                    try partitionContext.encryptValues(of: instances, key: key)
+                case .awayFromEncryptionAtRest:
+                    try partitionContext.decryptValues(of: instances, key: key)
+                }
+            } else {
+                for instance in instances {
+                    switch direction {
+                    case .towardEncryptionAtRest:
+                        try instance.migrateTowardEncryptionAtRest(in: partitionContext, key: key)
+                    case .awayFromEncryptionAtRest:
+                        try instance.migrateAwayFromEncryptionAtRest(in: partitionContext, key: key)
+                    }
+                }
+            }
+
+            let primaryKeys = objectIDs.map(Self.primaryKey(of:))
+            let checkpoint = Checkpoint(
+                lowerBound: primaryKeys.min() ?? 0,
+                upperBound: primaryKeys.max() ?? 0
+            )
+
+            try save(partitionContext, recording: checkpoint, for: T.entityName())
+            partitionContext.reset()
+        }
+    }
+
+    /// Saves the partition and its checkpoint in one transaction.
+    private func save(
+        _ partitionContext: NSManagedObjectContext,
+        recording checkpoint: Checkpoint,
+        for entityName: String
+    ) throws {
+        guard
+            let coordinator = partitionContext.persistentStoreCoordinator,
+            let store = coordinator.persistentStores.first
+        else {
+            return
+        }
+
+        saveLock.lock()
+        defer { saveLock.unlock() }
+
+        let oldMetadata = coordinator.metadata(for: store)
+        var metadata = oldMetadata
+        var state = metadata[Self.checkpointMetadataKey] as? [String: Any] ?? [:]
+
+        // Checkpoints of an interrupted migration in the other direction don't apply anymore.
+        if state[Self.directionKey] as? String != direction.rawValue {
+            state[Self.checkpointsKey] = nil
+        }
+
+        var checkpoints = state[Self.checkpointsKey] as? [String: [String]] ?? [:]
+        checkpoints[entityName, default: []].append("\(checkpoint.lowerBound)-\(checkpoint.upperBound)")
+        state[Self.directionKey] = direction.rawValue
+        state[Self.checkpointsKey] = checkpoints
+        metadata[Self.checkpointMetadataKey] = state
+        coordinator.setMetadata(metadata, for: store)
+
+        do {
+            try partitionContext.save()
+        } catch {
+            coordinator.setMetadata(oldMetadata, for: store)
+            throw error
+        }
+    }
+
+    // MARK: - Checkpoints
+
+    /// The direction of a migration that was interrupted, if any.
+    static func interruptedMigration(in context: NSManagedObjectContext) -> Direction? {
+        guard
+            let state = context.persistentStoreMetadata(forKey: checkpointMetadataKey) as? [String: Any],
+            let rawDirection = state[directionKey] as? String
+        else {
+            return nil
+        }
+
+        return Direction(rawValue: rawDirection)
+    }
+
+    private func checkpoints(for entityName: String) -> [Checkpoint] {
+        guard let state = context.persistentStoreMetadata(forKey: Self.checkpointMetadataKey) as? [String: Any] else {
+            return []
+        }
+
+        guard state[Self.directionKey] as? String == direction.rawValue else {
+            WireLogger.ear.warn("ignoring checkpoints of an interrupted migration in the other direction")
+            return []
+        }
+
+        let rawCheckpoints = (state[Self.checkpointsKey] as? [String: [String]])?[entityName] ?? []
+
+        return rawCheckpoints.compactMap { rawCheckpoint in
+            let bounds = rawCheckpoint.split(separator: "-").compactMap { Int64($0) }
+
+            guard bounds.count == 2 else {
+                return nil
+            }
+
+            return Checkpoint(lowerBound: bounds[0], upperBound: bounds[1])
+        }
+    }
+
+    /// Returns the object IDs whose primary key is in one of the checkpoints.
+    ///
+    /// The object IDs must be sorted by primary key, like those of `fetchObjectIDs(type:matching:)`,
+    /// so that both they and the checkpoints are walked only once.
+    private static func objectIDs(
+        _ objectIDs: [NSManagedObjectID],
+        coveredBy checkpoints: [Checkpoint]
+    ) -> Set<NSManagedObjectID> {
+        let sortedCheckpoints = checkpoints.sorted { $0.lowerBound < $1.lowerBound }
+        var checkpointIndex = sortedCheckpoints.startIndex
+        var coveredUpperBound = Int64.min
+        var coveredObjectIDs = Set<NSManagedObjectID>()
+
+        for objectID in objectIDs {
+            let primaryKey = Self.primaryKey(of: objectID)
+
+            // Take in every checkpoint starting at or before the primary key.
+            while checkpointIndex < sortedCheckpoints.endIndex, sortedCheckpoints[checkpointIndex].lowerBound <= primaryKey {
+                coveredUpperBound = max(coveredUpperBound, sortedCheckpoints[checkpointIndex].upperBound)
+                checkpointIndex += 1
+            }
+
+            if primaryKey <= coveredUpperBound {
+                coveredObjectIDs.insert(objectID)
+            }
+        }
+
+        return coveredObjectIDs
+    }
+
+    // MARK: - Helpers
+
+    private func fetchObjectIDs<T: MigratableEntity>(
+        type: T.Type,
+        matching predicate: NSPredicate? = nil
+    ) throws -> [NSManagedObjectID] {
+        let request = NSFetchRequest<NSManagedObjectID>(entityName: T.entityName())
+        request.predicate = type.predicateForObjectsNeedingMigration
+
+        if let predicate {
+            request.predicate = request.predicate.map {
+                NSCompoundPredicate(andPredicateWithSubpredicates: [$0, predicate])
+            } ?? predicate
+        }
+        request.resultType = .managedObjectIDResultType
+
+        return try context.fetch(request)
+            .map { (primaryKey: Self.primaryKey(of: $0), objectID: $0) }
+            .sorted { $0.primaryKey < $1.primaryKey }
+            .map(\.objectID)
+    }
+
+    /// The primary key of a permanent object id, as found at the end of its uri, e.g. `p42`.
+    static func primaryKey(of objectID: NSManagedObjectID) -> Int64 {
+        let component = objectID.uriRepresentation().lastPathComponent
+        return Int64(component.dropFirst()) ?? 0
+    }
+
+}
+
+/// Progress of the encryption at rest migration of a single entity.
+public struct EncryptionAtRestMigrationProgress {
+
+    /// The name of the entity being migrated.
+    public let entityName: String
+
+    /// The number of instances migrated so far, including those migrated before an interruption.
+    public let migratedObjects: Int
+
+    /// The number of instances to migrate.
+    public let totalObjects: Int
+
+    /// The time spent migrating this entity in the current run.
+    public let duration: TimeInterval
+
+    /// The number of instances migrated per second in the current run.
+    public let throughput: Double
+
+}
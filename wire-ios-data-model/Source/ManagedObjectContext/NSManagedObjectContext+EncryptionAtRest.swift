@@ -78,23 +78,33 @@ extension NSManagedObjectContext {
 
     }
 
-    public func migrateTowardEncryptionAtRest(databaseKey: VolatileData) throws {
+    /// Encrypts sensitive data in the database with the given key.
+    ///
+    /// The migration is performed in parallel partitions and can be resumed: if it
+    /// was interrupted, invoking this method again with the same key only migrates
+    /// the remaining data.
+    ///
+    /// - Parameters:
+    ///   - databaseKey: The key to encrypt the data with.
+    ///   - progressHandler: Invoked on an arbitrary queue after every partition.
+
+    public func migrateTowardEncryptionAtRest(
+        databaseKey: VolatileData,
+        progressHandler: ((EncryptionAtRestMigrationProgress) -> Void)? = nil
+    ) throws {
         do {
             WireLogger.ear.info("migrating existing data toward EAR")
             saveOrRollback()
-            try migrateInstancesTowardEncryptionAtRest(
-                type: ZMGenericMessageData.self,
-                key: databaseKey
-            )
-            try migrateInstancesTowardEncryptionAtRest(
-                type: ZMClientMessage.self,
-                key: databaseKey
+            let migration = EncryptionAtRestMigration(
+                context: self,
+                direction: .towardEncryptionAtRest,
+                key: databaseKey,
+                progressHandler: progressHandler
             )
-            try migrateInstancesTowardEncryptionAtRest(
-                type: ZMConversation.self,
-                key: databaseKey
-            )
-            saveOrRollback()
+            try migrateInstances(type: ZMGenericMessageData.self, with: migration)
+            try migrateInstances(type: ZMClientMessage.self, with: migration)
+            try migrateInstances(type: ZMConversation.self, with: migration)
+            migration.finish()
         } catch {
             WireLogger.ear.error("failed to migrate existing data toward EAR: \(error)")
             reset()
@@ -102,23 +112,33 @@ extension NSManagedObjectContext {
         }
     }
 
-    public func migrateAwayFromEncryptionAtRest(databaseKey: VolatileData) throws {
+    /// Decrypts sensitive data in the database with the given key.
+    ///
+    /// The migration is performed in parallel partitions and can be resumed: if it
+    /// was interrupted, invoking this method again with the same key only migrates
+    /// the remaining data.
+    ///
+    /// - Parameters:
+    ///   - databaseKey: The key the data was encrypted with.
+    ///   - progressHandler: Invoked on an arbitrary queue after every partition.
+
+    public func migrateAwayFromEncryptionAtRest(
+        databaseKey: VolatileData,
+        progressHandler: ((EncryptionAtRestMigrationProgress) -> Void)? = nil
+    ) throws {
         do {
             WireLogger.ear.info("migrating existing data away from EAR")
             saveOrRollback()
-            try migrateInstancesAwayFromEncryptionAtRest(
-                type: ZMGenericMessageData.self,
-                key: databaseKey
-            )
-            try migrateInstancesAwayFromEncryptionAtRest(
-                type: ZMClientMessage.self,
-                key: databaseKey
+            let migration = EncryptionAtRestMigration(
+                context: self,
+                direction: .awayFromEncryptionAtRest,
+                key: databaseKey,
+                progressHandler: progressHandler
             )
-            try migrateInstancesAwayFromEncryptionAtRest(
-                type: ZMConversation.self,
-                key: databaseKey
-            )
-            saveOrRollback()
+            try migrateInstances(type: ZMGenericMessageData.self, with: migration)
+            try migrateInstances(type: ZMClientMessage.self, with: migration)
+            try migrateInstances(type: ZMConversation.self, with: migration)
+            migration.finish()
         } catch {
             WireLogger.ear.error("failed to migrate existing data away from EAR: \(error)")
             reset()
@@ -126,52 +146,31 @@ extension NSManagedObjectContext {
         }
     }
 
-    private func migrateInstancesTowardEncryptionAtRest<T: MigratableEntity>(
-        type: T.Type,
-        key: VolatileData
-    ) throws {
-        do {
-            try fetchObjects(type: type).modifyAndSaveInBatches { instance in
-                try instance.migrateTowardEncryptionAtRest(
-                    in: self,
-                    key: key
-                )
-            }
-        } catch {
-            throw MigrationError.failedToMigrateInstances(type: type, reason: error.localizedDescription)
-        }
+    /// Whether a migration toward encryption at rest was interrupted and
+    /// should be resumed with the same database key.
+
+    var hasInterruptedMigrationTowardEncryptionAtRest: Bool {
+        EncryptionAtRestMigration.interruptedMigration(in: self) == .towardEncryptionAtRest
+    }
+
+    /// Whether a migration in either direction was interrupted, i.e. some data
+    /// may be encrypted with the existing database key.
+
+    var hasInterruptedEncryptionAtRestMigration: Bool {
+        EncryptionAtRestMigration.interruptedMigration(in: self) != nil
     }
 
-    private func migrateInstancesAwayFromEncryptionAtRest<T: MigratableEntity>(
+    private func migrateInstances<T: MigratableEntity>(
         type: T.Type,
-        key: VolatileData
+        with migration: EncryptionAtRestMigration
     ) throws {
         do {
-            try fetchObjects(type: type).modifyAndSaveInBatches { instance in
-                try instance.migrateAwayFromEncryptionAtRest(
-                    in: self,
-                    key: key
-                )
-            }
+            try migration.migrate(type)
         } catch {
             throw MigrationError.failedToMigrateInstances(type: type, reason: error.localizedDescription)
         }
     }
 
-    private func fetchObjects<T: MigratableEntity>(type: T.Type) throws -> [T] {
-        let request = fetchRequest(forType: type, batchSize: 100)
-        return try fetch(request)
-    }
-
-    private func fetchRequest<T>(forType type: T.Type, batchSize: Int) -> NSFetchRequest<T>
-    where T: MigratableEntity {
-        let fetchRequest = NSFetchRequest<T>(entityName: T.entityName())
-        fetchRequest.predicate = type.predicateForObjectsNeedingMigration
-        fetchRequest.returnsObjectsAsFaults = false
-        fetchRequest.fetchBatchSize = batchSize
-        return fetchRequest
-    }
-
     /// Whether the encryption at rest feature is enabled.
 
     internal(set) public var encryptMessagesAtRest: Bool {
@@ -230,7 +229,7 @@ extension NSManagedObjectContext {
         data: Data,
         key: VolatileData
     ) throws -> (data: Data, nonce: Data) {
-        guard let context = contextData() else {
+        guard let context = contextData(for: key) else {
             throw EncryptionError.missingContextData
         }
 
@@ -262,7 +261,7 @@ extension NSManagedObjectContext {
         nonce: Data,
         key: VolatileData
     ) throws -> Data {
-        guard let context = contextData() else {
+        guard let context = contextData(for: key) else {
             throw EncryptionError.missingContextData
         }
 
@@ -273,6 +272,134 @@ extension NSManagedObjectContext {
         }
     }
 
+    /// Encrypts several values with the current database key.
+    ///
+    /// The associated data and the key are prepared once for all values.
+    ///
+    /// - Parameter values: The plaintext values.
+    /// - Returns: The ciphertexts and nonces, in the order of the values.
+
+    func encryptData(values: [Data]) throws -> [(data: Data, nonce: Data)] {
+        guard let key = databaseKey else {
+            throw EncryptionError.missingDatabaseKey
+        }
+
+        return try encryptData(
+            values: values,
+            key: key
+        )
+    }
+
+    func encryptData(
+        values: [Data],
+        key: VolatileData
+    ) throws -> [(data: Data, nonce: Data)] {
+        guard let context = contextData(for: key) else {
+            throw EncryptionError.missingContextData
+        }
+
+        do {
+            return try ChaCha20Poly1305.AEADEncryption.encrypt(messages: values, context: context, key: key._storage)
+                .map { (data: $0.ciphertext, nonce: $0.nonce) }
+        } catch let error as ChaCha20Poly1305.AEADEncryption.EncryptionError {
+            throw EncryptionError.cryptobox(error: error)
+        }
+    }
+
+    /// Decrypts several values with the current database key.
+    ///
+    /// The associated data and the key are prepared once for all values.
+    ///
+    /// - Parameter values: The ciphertexts and the nonces they were encrypted with.
+    /// - Returns: The plaintext values, in the order of the ciphertexts.
+
+    func decryptData(values: [(data: Data, nonce: Data)]) throws -> [Data] {
+        guard let key = databaseKey else {
+            throw EncryptionError.missingDatabaseKey
+        }
+
+        return try decryptData(
+            values: values,
+            key: key
+        )
+    }
+
+    func decryptData(
+        values: [(data: Data, nonce: Data)],
+        key: VolatileData
+    ) throws -> [Data] {
+        guard let context = contextData(for: key) else {
+            throw EncryptionError.missingContextData
+        }
+
+        do {
+            return try ChaCha20Poly1305.AEADEncryption.decrypt(
+                ciphertexts: values.map { (ciphertext: $0.data, nonce: $0.nonce) },
+                context: context,
+                key: key._storage
+            )
+        } catch let error as ChaCha20Poly1305.AEADEncryption.EncryptionError {
+            throw EncryptionError.cryptobox(error: error)
+        }
+    }
+
+    // MARK: - Context Data
+
+    private static let encryptionContextUserInfoKey = "encryptionContext"
+
+    /// The associated data bound to every ciphertext, computed for a specific database key.
+
+    final class EncryptionContext {
+
+        weak var key: VolatileData?
+        let data: Data
+
+        init(key: VolatileData, data: Data) {
+            self.key = key
+            self.data = data
+        }
+
+    }
+
+    /// Returns the associated data for the given key.
+    ///
+    /// Computing it requires fetching the self user and self client, so it's
+    /// cached until a different key is used.
+
+    private func contextData(for key: VolatileData) -> Data? {
+        if
+            let cached = userInfo[Self.encryptionContextUserInfoKey] as? EncryptionContext,
+            cached.key === key
+        {
+            return cached.data
+        }
+
+        guard let data = contextData() else {
+            return nil
+        }
+
+        userInfo[Self.encryptionContextUserInfoKey] = EncryptionContext(key: key, data: data)
+        return data
+    }
+
+    /// Returns the associated data for the given key, to be shared with other
+    /// contexts of the same store.
+
+    func encryptionContext(for key: VolatileData) throws -> EncryptionContext {
+        guard let data = contextData(for: key) else {
+            throw EncryptionError.missingContextData
+        }
+
+        return EncryptionContext(key: key, data: data)
+    }
+
+    /// Uses associated data computed by another context, e.g. for contexts
+    /// that can't look up the self client.
+
+    func setEncryptionContext(_ encryptionContext: EncryptionContext) {
+        userInfo[Self.encryptionContextUserInfoKey] = encryptionContext
+    }
+
     private func contextData() -> Data? {
         let selfUser = ZMUser.selfUser(in: self)
 
@@ -302,6 +429,7 @@ extension NSManagedObjectContext {
         }
         set {
             userInfo[Self.databaseKeyUserInfoKey] = newValue
+            userInfo[Self.encryptionContextUserInfoKey] = nil
         }
     }
 
@@ -309,7 +437,7 @@ extension NSManagedObjectContext {
 
 // MARK: - Migratable
 
-private typealias MigratableEntity = ZMManagedObject & EncryptionAtRestMigratable
+typealias MigratableEntity = ZMManagedObject & EncryptionAtRestMigratable
 
 /// A type that needs to be migrated when encryption at rest is enabled / disabled.
 
@@ -319,6 +447,13 @@ protocol EncryptionAtRestMigratable {
 
     static var predicateForObjectsNeedingMigration: NSPredicate? { get }
 
+    /// The predicate matching instances that weren't migrated in the given direction yet.
+    ///
+    /// It's used to find instances that were inserted or changed in a range of
+    /// primary keys after the range was migrated.
+
+    static func predicateForObjectsNotYetMigrated(_ direction: EncryptionAtRestMigration.Direction) -> NSPredicate
+
     /// Migrate necessary data to adhere to encryption at rest feature.
     ///
     /// For example, encrypt sensitve data and set a nonce.
@@ -338,3 +473,101 @@ protocol EncryptionAtRestMigratable {
     ) throws
 
 }
+
+/// A migratable type whose sensitive data is a single value with its own nonce.
+///
+/// The values of many instances can be encrypted or decrypted in one bulk
+/// operation, see `NSManagedObjectContext.encryptValues(of:key:)`.
+
+protocol EncryptionAtRestValueMigratable: AnyObject, EncryptionAtRestMigratable {
+
+    /// The sensitive value, encrypted if `encryptionAtRestNonce` is set.
+
+    var encryptionAtRestValue: Data? { get set }
+
+    /// The nonce used to encrypt `encryptionAtRestValue`, if it is encrypted.
+
+    var encryptionAtRestNonce: Data? { get set }
+
+}
+
+extension EncryptionAtRestValueMigratable {
+
+    func migrateTowardEncryptionAtRest(
+        in context: NSManagedObjectContext,
+        key: VolatileData
+    ) throws {
+        try context.encryptValues(of: [self], key: key)
+    }
+
+    func migrateAwayFromEncryptionAtRest(
+        in context: NSManagedObjectContext,
+        key: VolatileData
+    ) throws {
+        try context.decryptValues(of: [self], key: key)
+    }
+
+}
+
+extension NSManagedObjectContext {
+
+    /// Encrypts the values of several instances, preparing the key and the
+    /// associated data once for all of them.
+
+    func encryptValues(
+        of instances: [any EncryptionAtRestValueMigratable],
+        key: VolatileData
+    ) throws {
+        let plaintexts = instances.compactMap { instance -> (instance: any EncryptionAtRestValueMigratable, value: Data)? in
+            // Never encrypt a value twice.
+            guard
+                instance.encryptionAtRestNonce == nil,
+                let value = instance.encryptionAtRestValue
+            else {
+                return nil
+            }
+
+            return (instance, value)
+        }
+
+        let ciphertexts = try encryptData(
+            values: plaintexts.map(\.value),
+            key: key
+        )
+
+        for (plaintext, ciphertext) in zip(plaintexts, ciphertexts) {
+            plaintext.instance.encryptionAtRestValue = ciphertext.data
+            plaintext.instance.encryptionAtRestNonce = ciphertext.nonce
+        }
+    }
+
+    /// Decrypts the values of several instances, preparing the key and the
+    /// associated data once for all of them.
+
+    func decryptValues(
+        of instances: [any EncryptionAtRestValueMigratable],
+        key: VolatileData
+    ) throws {
+        let ciphertexts = instances.compactMap { instance -> (instance: any EncryptionAtRestValueMigratable, data: Data, nonce: Data)? in
+            guard
+                let data = instance.encryptionAtRestValue,
+                let nonce = instance.encryptionAtRestNonce
+            else {
+                return nil
+            }
+
+            return (instance, data, nonce)
+        }
+
+        let plaintexts = try decryptData(
+            values: ciphertexts.map { (data: $0.data, nonce: $0.nonce) },
+            key: key
+        )
+
+        for (ciphertext, plaintext) in zip(ciphertexts, plaintexts) {
+            ciphertext.instance.encryptionAtRestValue = plaintext
+            ciphertext.instance.encryptionAtRestNonce = nil
+        }
+    }
+
+}
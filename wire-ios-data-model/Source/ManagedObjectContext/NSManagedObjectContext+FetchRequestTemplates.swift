@@ -0,0 +1,172 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import CoreData
+import Foundation
+
+/// Timing counters of the fetches made from one template.
+public struct FetchRequestTemplateStatistics: Equatable {
+
+    /// The name of the template.
+    public let name: String
+
+    /// The number of fetches that were made from the template.
+    public var fetchCount = 0
+
+    /// The time spent executing these fetches.
+    public var totalDuration: TimeInterval = 0
+
+    public var averageDuration: TimeInterval {
+        fetchCount > 0 ? totalDuration / Double(fetchCount) : 0
+    }
+
+}
+
+/// The predicate templates of the hot fetches of a context.
+///
+/// Creating a predicate from a format string parses the format on every call,
+/// which adds up for queries that run for every processed event or message.
+/// The cache parses each template once per context, with `$VARIABLE`
+/// placeholders for the values that change between fetches, and only
+/// substitutes the variables when a fetch is made. It also keeps timing
+/// counters per template, so the most expensive queries can be ranked.
+///
+/// Like the context's other user info caches, it must only be used on the
+/// context's queue.
+@objc(ZMFetchRequestTemplateCache)
+public final class FetchRequestTemplateCache: NSObject {
+
+    private var templates: [String: NSPredicate] = [:]
+    private var statisticsByName: [String: FetchRequestTemplateStatistics] = [:]
+
+    /// The number of parsed templates.
+    @objc public var count: Int {
+        templates.count
+    }
+
+    /// Returns the predicate of a template with the variables substituted.
+    ///
+    /// - Parameters:
+    ///   - name: The name of the template, unique per context.
+    ///   - substitutionVariables: The values of the `$VARIABLE` placeholders.
+    ///   - template: Creates the template the first time it is needed.
+    @objc(predicateForTemplateNamed:substitutionVariables:template:)
+    public func predicate(
+        templateNamed name: String,
+        substitutionVariables: [String: Any],
+        template: () -> NSPredicate
+    ) -> NSPredicate {
+        let predicate: NSPredicate
+
+        if let cached = templates[name] {
+            predicate = cached
+        } else {
+            predicate = template()
+            templates[name] = predicate
+        }
+
+        return predicate.withSubstitutionVariables(substitutionVariables)
+    }
+
+    // MARK: - Statistics
+
+    /// Executes a fetch made from a template and records its duration.
+    public func measure<T>(templateNamed name: String, _ fetch: () throws -> T) rethrows -> T {
+        let start = CFAbsoluteTimeGetCurrent()
+        defer {
+            recordFetch(templateNamed: name, duration: CFAbsoluteTimeGetCurrent() - start)
+        }
+        return try fetch()
+    }
+
+    /// Executes a fetch made from a template and records its duration, for callers in Objective-C.
+    @objc(measureFetchForTemplateNamed:fetch:)
+    public func measureFetch(templateNamed name: String, _ fetch: () -> [Any]) -> [Any] {
+        measure(templateNamed: name, fetch)
+    }
+
+    public func recordFetch(templateNamed name: String, duration: TimeInterval) {
+        var statistics = statisticsByName[name] ?? FetchRequestTemplateStatistics(name: name)
+        statistics.fetchCount += 1
+        statistics.totalDuration += duration
+        statisticsByName[name] = statistics
+    }
+
+    /// The counters of all templates, the most expensive first.
+    public var statistics: [FetchRequestTemplateStatistics] {
+        statisticsByName.values.sorted { $0.totalDuration > $1.totalDuration }
+    }
+
+    /// Logs the templates that took the most time so far.
+    @objc(logMostExpensiveFetchesWithLimit:)
+    public func logMostExpensiveFetches(limit: Int = 5) {
+        for statistics in statistics.prefix(limit) {
+            WireLogger.localStorage.info(
+                "fetch template \(statistics.name): \(statistics.fetchCount) fetches, " +
+                    "\(Int(statistics.totalDuration * 1000)) ms total, " +
+                    "\(Int(statistics.averageDuration * 1_000_000)) us average"
+            )
+        }
+    }
+
+    @objc
+    public func resetStatistics() {
+        statisticsByName.removeAll()
+    }
+
+}
+
+extension NSManagedObjectContext {
+
+    private static let fetchRequestTemplateCacheUserInfoKey = "ZMFetchRequestTemplateCache"
+
+    /// The predicate templates of the context, created on first access.
+    @objc(zm_fetchRequestTemplateCache)
+    public var fetchRequestTemplateCache: FetchRequestTemplateCache {
+        if let cache = userInfo[Self.fetchRequestTemplateCacheUserInfoKey] as? FetchRequestTemplateCache {
+            return cache
+        }
+
+        let cache = FetchRequestTemplateCache()
+        userInfo[Self.fetchRequestTemplateCacheUserInfoKey] = cache
+        return cache
+    }
+
+    /// Executes a fetch request whose predicate is made from a template, and
+    /// records the duration of the fetch.
+    public func fetchOrAssert<T>(
+        request: NSFetchRequest<T>,
+        templateNamed name: String
+    ) -> [T] {
+        fetchRequestTemplateCache.measure(templateNamed: name) {
+            fetchOrAssert(request: request)
+        }
+    }
+
+    /// Counts a fetch request whose predicate is made from a template, and
+    /// records the duration of the count.
+    public func countOrAssert<T>(
+        request: NSFetchRequest<T>,
+        templateNamed name: String
+    ) -> Int {
+        fetchRequestTemplateCache.measure(templateNamed: name) {
+            countOrAssert(request: request)
+        }
+    }
+
+}
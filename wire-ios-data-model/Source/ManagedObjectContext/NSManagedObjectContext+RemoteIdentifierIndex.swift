@@ -0,0 +1,101 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+
+import CoreData
+import Foundation
+
+/// An index of the objects registered in a context by their remote identifier.
+///
+/// `ZMManagedObject` adds objects when they are fetched or when their remote
+/// identifier is set, and removes them when they turn into faults. The index
+/// only holds weak references and may contain stale entries, e.g. after the
+/// identifier of an object was changed through KVC, so callers must validate
+/// each candidate before using it.
+@objc(ZMRemoteIdentifierIndex)
+public final class RemoteIdentifierIndex: NSObject {
+
+    private struct WeakObject {
+        weak var object: NSManagedObject?
+    }
+
+    private var objectsByRemoteIdentifier: [Data: [WeakObject]] = [:]
+
+    /// The number of remote identifiers with at least one entry.
+    @objc var count: Int {
+        objectsByRemoteIdentifier.count
+    }
+
+    @objc(addObject:remoteIdentifierData:)
+    public func add(_ object: NSManagedObject, remoteIdentifierData: Data) {
+        var objects = objectsByRemoteIdentifier[remoteIdentifierData] ?? []
+        objects.removeAll { $0.object == nil }
+
+        guard !objects.contains(where: { $0.object === object }) else {
+            objectsByRemoteIdentifier[remoteIdentifierData] = objects
+            return
+        }
+
+        objects.append(WeakObject(object: object))
+        objectsByRemoteIdentifier[remoteIdentifierData] = objects
+    }
+
+    @objc(removeObject:remoteIdentifierData:)
+    public func remove(_ object: NSManagedObject, remoteIdentifierData: Data) {
+        guard var objects = objectsByRemoteIdentifier[remoteIdentifierData] else {
+            return
+        }
+
+        objects.removeAll { $0.object == nil || $0.object === object }
+        objectsByRemoteIdentifier[remoteIdentifierData] = objects.isEmpty ? nil : objects
+    }
+
+    /// Returns the objects that were registered with the given remote identifier.
+    @objc(objectsWithRemoteIdentifierData:)
+    public func objects(remoteIdentifierData: Data) -> [NSManagedObject] {
+        guard let objects = objectsByRemoteIdentifier[remoteIdentifierData] else {
+            return []
+        }
+
+        return objects.compactMap(\.object)
+    }
+
+    @objc
+    func removeAllObjects() {
+        objectsByRemoteIdentifier.removeAll()
+    }
+
+}
+
+extension NSManagedObjectContext {
+
+    private static let remoteIdentifierIndexUserInfoKey = "ZMRemoteIdentifierIndex"
+
+    /// The index of registered objects by remote identifier, created on first access.
+    @objc(zm_remoteIdentifierIndex)
+    public var remoteIdentifierIndex: RemoteIdentifierIndex {
+        if let index = userInfo[Self.remoteIdentifierIndexUserInfoKey] as? RemoteIdentifierIndex {
+            return index
+        }
+
+        let index = RemoteIdentifierIndex()
+        userInfo[Self.remoteIdentifierIndexUserInfoKey] = index
+        return index
+    }
+
+}
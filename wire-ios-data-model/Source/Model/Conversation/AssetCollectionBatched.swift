@@ -151,6 +151,7 @@ public class AssetCollectionBatched: NSObject, ZMCollection {
 
         // Get and categorize next batch
         let messagesToAnalyze = Array(allMessages[offset..<(offset + numberToAnalyze)])
+        GenericMessageBatchDecoder.decodeUnderlyingMessages(of: messagesToAnalyze)
         let newAssets = AssetCollectionBatched.messageMap(messages: messagesToAnalyze, matchingCategories: self.matchingCategories)
         managedObjectContext.enqueueDelayedSave()
 
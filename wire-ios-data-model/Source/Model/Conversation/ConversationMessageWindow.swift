@@ -0,0 +1,209 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import CoreData
+import Foundation
+
+/// The direction in which the history of a conversation is scrolled.
+public enum MessageWindowDirection {
+
+    case older
+    case newer
+
+}
+
+/// A sliding window over the visible messages of a conversation.
+///
+/// Offsets count from the newest message, matching the order of
+/// `ZMConversation.visibleMessagesFetchRequest()`. The window grows by one
+/// page each time it moves, and once it reached `maximumSize` it drops the
+/// page at the far end instead, so the number of loaded messages stays
+/// bounded however long the conversation is.
+public struct MessageWindow: Equatable {
+
+    /// The number of newer messages before the window.
+    public private(set) var offset: Int
+
+    /// The number of messages in the window.
+    public private(set) var limit: Int
+
+    /// The number of messages the window moves by.
+    public let pageSize: Int
+
+    /// The number of messages after which the window drops far away pages.
+    public let maximumSize: Int
+
+    public init(
+        offset: Int = 0,
+        limit: Int,
+        pageSize: Int,
+        maximumSize: Int
+    ) {
+        self.offset = max(0, offset)
+        self.limit = min(limit, maximumSize)
+        self.pageSize = pageSize
+        self.maximumSize = maximumSize
+    }
+
+    /// Moves the window by one page.
+    ///
+    /// - Returns: The range of messages that were dropped from the window.
+    @discardableResult
+    public mutating func slide(_ direction: MessageWindowDirection) -> Range<Int> {
+        let previous = offset..<(offset + limit)
+
+        switch direction {
+        case .older:
+            limit += pageSize
+
+            if limit > maximumSize {
+                offset += limit - maximumSize
+                limit = maximumSize
+            }
+
+        case .newer:
+            let newOffset = max(0, offset - pageSize)
+            limit = min(limit + offset - newOffset, maximumSize)
+            offset = newOffset
+        }
+
+        let current = offset..<(offset + limit)
+
+        if previous.lowerBound < current.lowerBound {
+            return previous.lowerBound..<min(current.lowerBound, previous.upperBound)
+        } else if previous.upperBound > current.upperBound {
+            return max(current.upperBound, previous.lowerBound)..<previous.upperBound
+        } else {
+            return previous.upperBound..<previous.upperBound
+        }
+    }
+
+    /// The page the window will move to next in the given direction, if any.
+    public func nextPage(_ direction: MessageWindowDirection) -> Range<Int>? {
+        switch direction {
+        case .older:
+            return (offset + limit)..<(offset + limit + pageSize)
+
+        case .newer:
+            guard offset > 0 else { return nil }
+            return max(0, offset - pageSize)..<offset
+        }
+    }
+
+}
+
+extension ZMConversation {
+
+    /// A fetch request for the visible messages of the conversation, newest first.
+    ///
+    /// - Parameter window: The window of messages to fetch, or `nil` to fetch all of them.
+    public func visibleMessagesFetchRequest(in window: MessageWindow? = nil) -> NSFetchRequest<ZMMessage> {
+        let fetchRequest = NSFetchRequest<ZMMessage>(entityName: ZMMessage.entityName())
+        fetchRequest.predicate = visibleMessagesPredicate
+        fetchRequest.sortDescriptors = [NSSortDescriptor(key: #keyPath(ZMMessage.serverTimestamp), ascending: false)]
+
+        if let window {
+            fetchRequest.fetchOffset = window.offset
+            fetchRequest.fetchLimit = window.limit
+        }
+
+        return fetchRequest
+    }
+
+    /// Loads a range of visible messages ahead of time, so that a window can
+    /// move over them without waiting for the store.
+    ///
+    /// The messages are fetched with their senders and payloads, and the
+    /// generic messages of client messages are decoded. On SQLite stores the
+    /// fetch runs asynchronously on the persistent store coordinator, otherwise
+    /// it is deferred to the next turn of the context's queue.
+    ///
+    /// - Parameters:
+    ///   - range: The range of messages, counted from the newest message.
+    ///   - completion: Called on the context's queue with the prefetched messages.
+    public func prefetchVisibleMessages(
+        in range: Range<Int>,
+        completion: (([ZMMessage]) -> Void)? = nil
+    ) {
+        guard
+            let managedObjectContext,
+            !range.isEmpty
+        else {
+            completion?([])
+            return
+        }
+
+        let fetchRequest = visibleMessagesFetchRequest()
+        fetchRequest.fetchOffset = range.lowerBound
+        fetchRequest.fetchLimit = range.count
+        fetchRequest.returnsObjectsAsFaults = false
+        fetchRequest.relationshipKeyPathsForPrefetching = [#keyPath(ZMMessage.sender)]
+
+        let decode = { (messages: [ZMMessage]) in
+            let clientMessages = messages.compactMap { $0 as? ZMClientMessage }
+
+            if !clientMessages.isEmpty {
+                // The payloads are only modelled on the client message entity,
+                // so they can't be prefetched with the messages themselves.
+                let payloadRequest = NSFetchRequest<ZMClientMessage>(entityName: ZMClientMessage.entityName())
+                payloadRequest.predicate = NSPredicate(format: "self IN %@", clientMessages)
+                payloadRequest.relationshipKeyPathsForPrefetching = [#keyPath(ZMClientMessage.dataSet)]
+                _ = managedObjectContext.fetchOrAssert(request: payloadRequest)
+            }
+
+            for message in clientMessages {
+                _ = message.underlyingMessage
+            }
+
+            completion?(messages)
+        }
+
+        let isSQLiteStore = managedObjectContext.persistentStoreCoordinator?.persistentStores.first?.type == NSSQLiteStoreType
+
+        guard isSQLiteStore else {
+            managedObjectContext.performGroupedBlock {
+                decode(managedObjectContext.fetchOrAssert(request: fetchRequest))
+            }
+            return
+        }
+
+        let asynchronousFetchRequest = NSAsynchronousFetchRequest(fetchRequest: fetchRequest) { result in
+            decode(result.finalResult ?? [])
+        }
+
+        do {
+            try managedObjectContext.execute(asynchronousFetchRequest)
+        } catch {
+            WireLogger.localStorage.error("failed to prefetch messages: \(error.localizedDescription)")
+            completion?([])
+        }
+    }
+
+}
+
+extension NSManagedObjectContext {
+
+    /// Turns messages that left a message window back into faults, releasing
+    /// their row data and decoded payloads. Messages with unsaved changes are kept.
+    public func evictMessages<S: Sequence>(_ messages: S) where S.Element == ZMMessage {
+        for message in messages where message.managedObjectContext === self && !message.isFault && !message.hasChanges {
+            refresh(message, mergeChanges: false)
+        }
+    }
+
+}
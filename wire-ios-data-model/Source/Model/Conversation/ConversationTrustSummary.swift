@@ -0,0 +1,322 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import CoreData
+import Foundation
+
+/// Counters describing the trust state of the participants of a conversation.
+///
+/// The security level of a conversation changes when all participants become
+/// trusted or when one of them stops being trusted. Instead of walking every
+/// participant and client for each added, removed, verified or ignored
+/// client, the conversation keeps one entry per participant and the number of
+/// untrusted, clientless and unconnected or external participants. Security
+/// changes only update the entries of the users they are about, which makes
+/// the checks for a transition O(1).
+///
+/// A summary is only valid for the `generation` of its context. The
+/// generation is bumped whenever connections, teams or team memberships
+/// change in the context, which no security change accounts for, after which
+/// the summary is rebuilt from scratch. Changes to users, clients and
+/// participant roles, including merges from other contexts, are recorded per
+/// user instead, and only the entries of those users are updated.
+@objc(ZMConversationTrustSummary)
+public final class ConversationTrustSummary: NSObject {
+
+    /// The trust state of a single participant.
+    struct ParticipantState: Equatable {
+
+        /// Whether all clients of the participant are trusted by the self client.
+        var isTrusted: Bool
+
+        /// The number of clients of the participant.
+        var clientCount: Int
+
+        /// Whether the self client is one of the clients of the participant.
+        var hasSelfClient: Bool
+
+        /// Whether the participant is neither connected to the self user,
+        /// nor a wireless user, nor a member of the self user's team.
+        var isUnconnectedOrExternal: Bool
+
+        var isSelfUser: Bool
+
+    }
+
+    /// The context generation the summary was built for.
+    let generation: Int
+
+    /// The change sequence of the context up to which the entries are up to date.
+    var changeSequence: Int
+
+    /// The self client the summary was built for.
+    let selfClient: UserClient?
+
+    /// The team of the self user the summary was built for.
+    let selfTeam: Team?
+
+    private var participants: [ZMUser: ParticipantState] = [:]
+
+    private(set) var untrustedParticipantCount = 0
+    private(set) var clientlessParticipantCount = 0
+    private(set) var unconnectedOrExternalParticipantCount = 0
+    private(set) var clientCount = 0
+    private(set) var selfClientCount = 0
+    private(set) var selfUserCount = 0
+
+    init(generation: Int, changeSequence: Int, selfClient: UserClient?, selfTeam: Team?) {
+        self.generation = generation
+        self.changeSequence = changeSequence
+        self.selfClient = selfClient
+        self.selfTeam = selfTeam
+        super.init()
+    }
+
+    /// The number of participants in the summary.
+    var participantCount: Int {
+        participants.count
+    }
+
+    /// Whether all participants, including the self user, have clients and are trusted,
+    /// and none of them is unconnected or external.
+    var allParticipantsTrusted: Bool {
+        !participants.isEmpty &&
+            selfUserCount > 0 &&
+            untrustedParticipantCount == 0 &&
+            clientlessParticipantCount == 0 &&
+            unconnectedOrExternalParticipantCount == 0
+    }
+
+    var allParticipantsHaveClients: Bool {
+        clientlessParticipantCount == 0
+    }
+
+    /// Whether the participants have other clients than the self client.
+    var hasMoreClientsThanSelfClient: Bool {
+        !(selfClientCount > 0 && clientCount == 1)
+    }
+
+    // MARK: - Updates
+
+    /// Sets the state of a participant, or removes the participant if `state` is `nil`.
+    func setState(_ state: ParticipantState?, for user: ZMUser) {
+        if let previousState = participants[user] {
+            apply(previousState, sign: -1)
+        }
+
+        participants[user] = state
+
+        if let state {
+            apply(state, sign: 1)
+        }
+    }
+
+    func state(for user: ZMUser) -> ParticipantState? {
+        participants[user]
+    }
+
+    private func apply(_ state: ParticipantState, sign: Int) {
+        if !state.isTrusted {
+            untrustedParticipantCount += sign
+        }
+
+        if state.clientCount == 0 {
+            clientlessParticipantCount += sign
+        }
+
+        if state.isUnconnectedOrExternal {
+            unconnectedOrExternalParticipantCount += sign
+        }
+
+        if state.hasSelfClient {
+            selfClientCount += sign
+        }
+
+        if state.isSelfUser {
+            selfUserCount += sign
+        }
+
+        clientCount += sign * state.clientCount
+    }
+
+}
+
+// MARK: - Generation
+
+extension NSManagedObjectContext {
+
+    private static let conversationTrustGenerationUserInfoKey = "ZMConversationTrustGeneration"
+
+    /// A number that changes whenever a change in the context could affect the trust
+    /// state of all conversation participants.
+    var conversationTrustGeneration: Int {
+        conversationTrustGenerationObserver.generation
+    }
+
+    /// A number that changes whenever users, clients or participant roles change in the context.
+    var conversationTrustChangeSequence: Int {
+        conversationTrustGenerationObserver.changeSequence
+    }
+
+    /// Returns the object IDs of the users whose trust state could have changed after the
+    /// change sequence `sequence`, or `nil` if the changes since then are no longer known.
+    func userIDsWithChangedTrust(since sequence: Int) -> Set<NSManagedObjectID>? {
+        conversationTrustGenerationObserver.userIDs(changedSince: sequence)
+    }
+
+    private var conversationTrustGenerationObserver: ConversationTrustGenerationObserver {
+        if let observer = userInfo[Self.conversationTrustGenerationUserInfoKey] as? ConversationTrustGenerationObserver {
+            return observer
+        }
+
+        let observer = ConversationTrustGenerationObserver(context: self)
+        userInfo[Self.conversationTrustGenerationUserInfoKey] = observer
+        return observer
+    }
+
+}
+
+/// Bumps the generation whenever objects affecting the trust of all participants change,
+/// and records which users changed otherwise.
+///
+/// Users are recorded by object ID so the log doesn't keep them alive. Users that
+/// aren't saved yet get their permanent ID first, since a temporary ID changes on save.
+private final class ConversationTrustGenerationObserver: NSObject {
+
+    private static let changeKeys = [
+        NSInsertedObjectsKey,
+        NSUpdatedObjectsKey,
+        NSDeletedObjectsKey,
+        NSRefreshedObjectsKey,
+        NSInvalidatedObjectsKey
+    ]
+
+    /// The number of changes that are remembered. Summaries that are further behind are rebuilt.
+    private static let maximumChangeCount = 256
+
+    private(set) var generation = 0
+    private(set) var changeSequence = 0
+    private var changes: [(sequence: Int, userIDs: Set<NSManagedObjectID>)] = []
+    private var token: NSObjectProtocol?
+    private unowned let context: NSManagedObjectContext
+
+    init(context: NSManagedObjectContext) {
+        self.context = context
+        super.init()
+
+        token = NotificationCenter.default.addObserver(
+            forName: .NSManagedObjectContextObjectsDidChange,
+            object: context,
+            queue: nil
+        ) { [weak self] notification in
+            self?.process(notification)
+        }
+    }
+
+    deinit {
+        if let token {
+            NotificationCenter.default.removeObserver(token)
+        }
+    }
+
+    func userIDs(changedSince sequence: Int) -> Set<NSManagedObjectID>? {
+        guard sequence < changeSequence else {
+            return []
+        }
+
+        guard let oldestChange = changes.first, oldestChange.sequence <= sequence + 1 else {
+            return nil
+        }
+
+        return changes.reduce(into: Set<NSManagedObjectID>()) { userIDs, change in
+            if change.sequence > sequence {
+                userIDs.formUnion(change.userIDs)
+            }
+        }
+    }
+
+    private func process(_ notification: Notification) {
+        guard let userInfo = notification.userInfo else {
+            return
+        }
+
+        if userInfo[NSInvalidatedAllObjectsKey] != nil {
+            generation += 1
+            return
+        }
+
+        var users = Set<ZMUser>()
+
+        for key in Self.changeKeys {
+            guard let objects = userInfo[key] as? Set<NSManagedObject> else {
+                continue
+            }
+
+            for object in objects {
+                switch object {
+                case is ZMConnection, is Team, is Member:
+                    generation += 1
+                    return
+
+                case let user as ZMUser:
+                    users.insert(user)
+
+                // Deleted clients and roles may no longer have a user, but the user
+                // is updated as well since the inverse relationship changes.
+                case let client as UserClient:
+                    if let user = client.user {
+                        users.insert(user)
+                    }
+
+                case let role as ParticipantRole:
+                    if let user = role.user {
+                        users.insert(user)
+                    }
+
+                default:
+                    break
+                }
+            }
+        }
+
+        guard !users.isEmpty else {
+            return
+        }
+
+        let unsavedUsers = users.filter { $0.objectID.isTemporaryID && !$0.isDeleted }
+
+        if !unsavedUsers.isEmpty {
+            do {
+                try context.obtainPermanentIDs(for: Array(unsavedUsers))
+            } catch {
+                WireLogger.localStorage.error("failed to obtain permanent IDs of changed users: \(error)")
+                generation += 1
+                return
+            }
+        }
+
+        let userIDs = Set(users.map(\.objectID))
+        changeSequence += 1
+        changes.append((changeSequence, userIDs))
+
+        if changes.count > Self.maximumChangeCount {
+            changes.removeFirst(changes.count - Self.maximumChangeCount)
+        }
+    }
+
+}
@@ -0,0 +1,218 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// Keeps the unread counters of a conversation up to date from message inserts,
+/// message deletes and changes of the last read timestamp.
+///
+/// The counters cover all unread messages with a server timestamp in
+/// `lastRead...countedUntil`. Messages newer than `countedUntil` are counted
+/// when they are fetched, messages which were inserted inside the counted range
+/// are collected in `pendingMessages` until the next update, and messages
+/// which become read are subtracted. This way catching up on a conversation
+/// with many unread messages doesn't recount all of them for every new message.
+///
+/// Every `consistencyCheckInterval` updates the counters are calculated from
+/// scratch to correct any drift.
+@objc(ZMUnreadMessageCounter)
+public final class UnreadMessageCounter: NSObject {
+
+    /// The counters of a set of unread messages.
+    struct Counts: Equatable {
+
+        var unreadCount: Int64 = 0
+        var unreadSelfMentionCount: Int64 = 0
+        var unreadSelfReplyCount: Int64 = 0
+        var lastKnockDate: Date?
+        var lastMissedCallDate: Date?
+
+        init() {}
+
+        init(messages: [ZMMessage]) {
+            for message in messages {
+                add(message)
+            }
+        }
+
+        mutating func add(_ message: ZMMessage) {
+            if message.isKnock {
+                lastKnockDate = Self.latest(lastKnockDate, message.serverTimestamp)
+            }
+
+            if message.isSystem, let systemMessage = message as? ZMSystemMessage, systemMessage.systemMessageType == .missedCall {
+                lastMissedCallDate = Self.latest(lastMissedCallDate, message.serverTimestamp)
+            }
+
+            if let textMessageData = message.textMessageData {
+                if textMessageData.isMentioningSelf {
+                    unreadSelfMentionCount += 1
+                }
+                if textMessageData.isQuotingSelf {
+                    unreadSelfReplyCount += 1
+                }
+            }
+
+            if message.shouldGenerateUnreadCount() {
+                unreadCount += 1
+            }
+        }
+
+        /// Subtracts the counts of messages which are no longer unread. The dates
+        /// of the last knock and missed call can't be subtracted, they are handled
+        /// by the caller.
+        mutating func subtract(_ counts: Counts) {
+            unreadCount = max(0, unreadCount - counts.unreadCount)
+            unreadSelfMentionCount = max(0, unreadSelfMentionCount - counts.unreadSelfMentionCount)
+            unreadSelfReplyCount = max(0, unreadSelfReplyCount - counts.unreadSelfReplyCount)
+        }
+
+        private static func latest(_ date: Date?, _ other: Date?) -> Date? {
+            guard let date, let other else { return date ?? other }
+            return max(date, other)
+        }
+
+    }
+
+    /// The number of incremental updates after which the counters are calculated from scratch.
+    static var consistencyCheckInterval = 100
+
+    private(set) var counts: Counts
+
+    /// The last read timestamp the counters were calculated for.
+    private(set) var lastRead: Date
+
+    /// All unread messages up to this timestamp are counted.
+    private(set) var countedUntil: Date
+
+    /// Messages inserted at or before `countedUntil` which haven't been counted yet.
+    private(set) var pendingMessages = Set<ZMMessage>()
+
+    /// The number of incremental updates since the counters were calculated from scratch.
+    private(set) var incrementalUpdateCount = 0
+
+    /// Whether the counters were updated for a message that is about to be deleted.
+    var hasAccountedForDeletion = false
+
+    /// Creates a counter from a full count of the unread messages.
+    ///
+    /// - Parameters:
+    ///   - messages: All unread messages after `lastRead`.
+    ///   - lastRead: The last read timestamp of the conversation.
+    init(messages: [ZMMessage], lastRead: Date) {
+        self.counts = Counts(messages: messages)
+        self.lastRead = lastRead
+        self.countedUntil = messages.compactMap(\.serverTimestamp).max().map { max($0, lastRead) } ?? lastRead
+        super.init()
+    }
+
+    // MARK: - Updates
+
+    /// Records an inserted message. Messages newer than `countedUntil` are
+    /// counted by the next fetch, older ones are kept until the next update.
+    func insert(_ message: ZMMessage) {
+        guard let timestamp = message.serverTimestamp, timestamp <= countedUntil else {
+            return
+        }
+
+        pendingMessages.insert(message)
+    }
+
+    /// Removes a message before it is deleted.
+    ///
+    /// - Parameters:
+    ///   - message: The message that is about to be deleted.
+    ///   - isCounted: Whether the message is counted as an unread message.
+    ///
+    /// - Returns: `false` if the counters can't be updated and need to be recalculated.
+    func remove(_ message: ZMMessage, isCounted: Bool) -> Bool {
+        if pendingMessages.remove(message) != nil {
+            return true
+        }
+
+        guard
+            isCounted,
+            let timestamp = message.serverTimestamp,
+            timestamp > lastRead,
+            timestamp <= countedUntil
+        else {
+            return true
+        }
+
+        let removed = Counts(messages: [message])
+
+        // We don't know the previous knock or missed call, so we can't update the dates.
+        if removed.lastKnockDate != nil && removed.lastKnockDate == counts.lastKnockDate ||
+            removed.lastMissedCallDate != nil && removed.lastMissedCallDate == counts.lastMissedCallDate {
+            return false
+        }
+
+        counts.subtract(removed)
+        return true
+    }
+
+    /// Moves the last read timestamp forward.
+    ///
+    /// - Parameters:
+    ///   - timestamp: The new last read timestamp, which must not be older than `lastRead`.
+    ///   - readMessages: The counted messages in `lastRead...timestamp`.
+    func markAsRead(until timestamp: Date, readMessages: [ZMMessage]) {
+        if timestamp >= countedUntil {
+            counts = Counts()
+            countedUntil = timestamp
+        } else {
+            counts.subtract(Counts(messages: readMessages.filter { !pendingMessages.contains($0) }))
+
+            if let lastKnockDate = counts.lastKnockDate, lastKnockDate <= timestamp {
+                counts.lastKnockDate = nil
+            }
+
+            if let lastMissedCallDate = counts.lastMissedCallDate, lastMissedCallDate <= timestamp {
+                counts.lastMissedCallDate = nil
+            }
+        }
+
+        lastRead = timestamp
+    }
+
+    /// Counts the pending messages and the unread messages newer than `countedUntil`.
+    ///
+    /// - Parameters:
+    ///   - pendingMessages: The pending messages which are unread.
+    ///   - newMessages: The unread messages newer than `countedUntil`.
+    func add(pendingMessages: [ZMMessage], newMessages: [ZMMessage]) {
+        for message in pendingMessages {
+            guard let timestamp = message.serverTimestamp, timestamp > lastRead, timestamp <= countedUntil else {
+                continue
+            }
+            counts.add(message)
+        }
+
+        for message in newMessages {
+            counts.add(message)
+
+            if let timestamp = message.serverTimestamp, timestamp > countedUntil {
+                countedUntil = timestamp
+            }
+        }
+
+        self.pendingMessages.removeAll()
+        incrementalUpdateCount += 1
+    }
+
+}
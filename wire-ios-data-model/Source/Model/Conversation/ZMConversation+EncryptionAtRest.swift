@@ -18,47 +18,28 @@
 
 import Foundation
 
-extension ZMConversation: EncryptionAtRestMigratable {
+extension ZMConversation: EncryptionAtRestValueMigratable {
 
     static let predicateForObjectsNeedingMigration: NSPredicate? =
         NSPredicate(format: "%K != nil", #keyPath(ZMConversation.draftMessageData))
 
-    func migrateTowardEncryptionAtRest(
-        in context: NSManagedObjectContext,
-        key: VolatileData
-    ) throws {
-        guard let data = draftMessageData else {
-            return
+    static func predicateForObjectsNotYetMigrated(_ direction: EncryptionAtRestMigration.Direction) -> NSPredicate {
+        switch direction {
+        case .towardEncryptionAtRest:
+            return NSPredicate(format: "%K == nil", #keyPath(ZMConversation.draftMessageNonce))
+        case .awayFromEncryptionAtRest:
+            return NSPredicate(format: "%K != nil", #keyPath(ZMConversation.draftMessageNonce))
         }
-
-        let (ciphertext, nonce) = try context.encryptData(
-            data: data,
-            key: key
-        )
-
-        draftMessageData = ciphertext
-        draftMessageNonce = nonce
     }
 
-    func migrateAwayFromEncryptionAtRest(
-        in context: NSManagedObjectContext,
-        key: VolatileData
-    ) throws {
-        guard
-            let data = draftMessageData,
-            let nonce = draftMessageNonce
-        else {
-            return
-        }
-
-        let plaintext = try context.decryptData(
-            data: data,
-            nonce: nonce,
-            key: key
-        )
+    var encryptionAtRestValue: Data? {
+        get { draftMessageData }
+        set { draftMessageData = newValue }
+    }
 
-        draftMessageData = plaintext
-        draftMessageNonce = nil
+    var encryptionAtRestNonce: Data? {
+        get { draftMessageNonce }
+        set { draftMessageNonce = newValue }
     }
 
 }
@@ -35,6 +35,8 @@
 @class ZMLocationData;
 @class ZMSystemMessage;
 @class Team;
+@class ZMUnreadMessageCounter;
+@class ZMConversationTrustSummary;
 
 NS_ASSUME_NONNULL_BEGIN
 extern NSString *const ZMConversationOneOnOneUserKey;
@@ -115,6 +117,8 @@ NS_ASSUME_NONNULL_END
 @property (nonatomic, copy, nullable) NSString *normalizedUserDefinedName;
 @property (nonatomic) NSTimeInterval lastReadTimestampSaveDelay;
 @property (nonatomic) int64_t lastReadTimestampUpdateCounter;
+@property (nonatomic, nullable) ZMUnreadMessageCounter *unreadMessageCounter;
+@property (nonatomic, nullable) ZMConversationTrustSummary *trustSummary;
 
 /**
     Appends the given message in the conversation.
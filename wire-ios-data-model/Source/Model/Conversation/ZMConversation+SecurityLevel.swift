@@ -157,6 +157,7 @@ extension ZMConversation {
 
     /// Applies the security changes for the set of users.
     private func applySecurityChanges(cause: SecurityChangeCause) {
+        updateTrustSummary(cause: cause)
         updateLegalHoldState(cause: cause)
         updateSecurityLevel(cause: cause)
     }
@@ -201,11 +202,13 @@ extension ZMConversation {
 
     private func increaseSecurityLevelIfNeeded(for cause: SecurityChangeCause) {
         guard
-            securityLevel != .secure &&
-            allUsersTrusted &&
-            allParticipantsHaveClients &&
-            hasMoreClientsThanSelfClient &&
-            conversationType.isOne(of: .group, .oneOnOne, .invalid)
+            securityLevel != .secure,
+            conversationType.isOne(of: .group, .oneOnOne, .invalid),
+            let trustSummary = validTrustSummary(),
+            trustSummary.allParticipantsTrusted,
+            trustSummary.allParticipantsHaveClients,
+            trustSummary.selfClient != nil,
+            trustSummary.hasMoreClientsThanSelfClient
         else {
             return
         }
@@ -216,7 +219,7 @@ extension ZMConversation {
     }
 
     private func degradeSecurityLevelIfNeeded(for cause: SecurityChangeCause) {
-        guard securityLevel == .secure && !allUsersTrusted else {
+        guard securityLevel == .secure, validTrustSummary()?.allParticipantsTrusted != true else {
             return
         }
 
@@ -699,41 +702,126 @@ extension ZMConversation {
 
         let selfUser = ZMUser.selfUser(in: managedObjectContext)
         return localParticipants.first {
-            if $0.isConnected || $0 == selfUser {
-                return false
-            } else if $0.isWirelessUser {
-                return false
-            } else {
-                return selfUser.team == nil || $0.team != selfUser.team
-            }
+            $0.isUnconnectedOrExternal(selfUser: selfUser)
         } != nil
     }
 
-    fileprivate var allParticipantsHaveClients: Bool {
-        return self.localParticipants.first { $0.clients.count == 0 } == nil
+    /// If true the conversation might still be trusted / ignored
+    @objc public var hasUntrustedClients: Bool {
+        return self.localParticipants.contains { !$0.isTrusted }
     }
+}
 
-    fileprivate var hasMoreClientsThanSelfClient: Bool {
+// MARK: - Trust summary
+extension ZMConversation {
+
+    /// Returns the trust summary of the participants, building it if there is
+    /// none or if it is outdated.
+    fileprivate func validTrustSummary() -> ConversationTrustSummary? {
+        guard let managedObjectContext else {
+            return nil
+        }
+
+        let selfUser = ZMUser.selfUser(in: managedObjectContext)
+        let selfClient = selfUser.selfClient()
+        let generation = managedObjectContext.conversationTrustGeneration
+        let changeSequence = managedObjectContext.conversationTrustChangeSequence
+
+        if let trustSummary,
+           trustSummary.generation == generation,
+           trustSummary.selfClient == selfClient,
+           trustSummary.selfTeam == selfUser.team,
+           let changedUserIDs = managedObjectContext.userIDsWithChangedTrust(since: trustSummary.changeSequence) {
+            // The summary keeps its participants, and new participants are reached through their
+            // role, so changed users that aren't registered in the context don't affect it.
+            let changedUsers = changedUserIDs.compactMap { managedObjectContext.registeredObject(for: $0) as? ZMUser }
+            updateTrustSummary(trustSummary, for: Set(changedUsers), selfUser: selfUser)
+            trustSummary.changeSequence = changeSequence
+
+            if trustSummary.participantCount == participantRoles.count {
+                return trustSummary
+            }
+        }
+
+        let summary = ConversationTrustSummary(
+            generation: generation,
+            changeSequence: changeSequence,
+            selfClient: selfClient,
+            selfTeam: selfUser.team
+        )
+
+        for user in localParticipants {
+            summary.setState(trustState(of: user, selfUser: selfUser, selfClient: selfClient), for: user)
+        }
+
+        trustSummary = summary
+        return summary
+    }
+
+    /// Updates the entries of the users affected by a security change. The self user is always
+    /// updated since its clients change without a security change when the self client is registered.
+    /// Changes are recorded by the context only once it processes them, so this keeps the summary
+    /// current for checks that happen in the meantime.
+    fileprivate func updateTrustSummary(cause: SecurityChangeCause) {
         guard
-            let context = managedObjectContext,
-            let selfClient = ZMUser.selfUser(in: context).selfClient()
+            let managedObjectContext,
+            let trustSummary,
+            trustSummary.generation == managedObjectContext.conversationTrustGeneration
         else {
-            return false
+            return
         }
 
-        let clients = localParticipants.flatMap(\.clients)
+        let selfUser = ZMUser.selfUser(in: managedObjectContext)
+        var users: Set<ZMUser> = [selfUser]
 
-        if clients.contains(selfClient) && clients.count == 1 {
-            return false
+        switch cause {
+        case .addedClients(let clients, _), .verifiedClients(let clients), .ignoredClients(let clients):
+            users.formUnion(clients.compactMap(\.user))
+        case .addedUsers(let changedUsers), .removedUsers(let changedUsers):
+            users.formUnion(changedUsers)
+        case .removedClients(let clientsByUser):
+            users.formUnion(clientsByUser.keys)
+        case .verifyLegalHold:
+            break
         }
 
-        return true
+        updateTrustSummary(trustSummary, for: users, selfUser: selfUser)
     }
 
-    /// If true the conversation might still be trusted / ignored
-    @objc public var hasUntrustedClients: Bool {
-        return self.localParticipants.contains { !$0.isTrusted }
+    private func updateTrustSummary(_ trustSummary: ConversationTrustSummary, for users: Set<ZMUser>, selfUser: ZMUser) {
+        for user in users {
+            let isParticipant = user.participantRole(in: self).map { participantRoles.contains($0) } ?? false
+            let state = isParticipant ? trustState(of: user, selfUser: selfUser, selfClient: trustSummary.selfClient) : nil
+            trustSummary.setState(state, for: user)
+        }
     }
+
+    private func trustState(of user: ZMUser, selfUser: ZMUser, selfClient: UserClient?) -> ConversationTrustSummary.ParticipantState {
+        let clients = user.clients
+
+        return ConversationTrustSummary.ParticipantState(
+            isTrusted: user.isTrusted,
+            clientCount: clients.count,
+            hasSelfClient: selfClient.map(clients.contains) ?? false,
+            isUnconnectedOrExternal: user.isUnconnectedOrExternal(selfUser: selfUser),
+            isSelfUser: user == selfUser
+        )
+    }
+
+}
+
+private extension ZMUser {
+
+    func isUnconnectedOrExternal(selfUser: ZMUser) -> Bool {
+        if isConnected || self == selfUser {
+            return false
+        } else if isWirelessUser {
+            return false
+        } else {
+            return selfUser.team == nil || team != selfUser.team
+        }
+    }
+
 }
 
 // MARK: - System messages
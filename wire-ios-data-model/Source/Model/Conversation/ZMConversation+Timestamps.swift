@@ -41,6 +41,16 @@ fileprivate extension ZMMessage {
         }
     }
 
+    /// Whether the message is one of the messages returned by `ZMConversation.unreadMessages()`,
+    /// ignoring the last read timestamp.
+
+    func isCountedAsUnread(in conversation: ZMConversation, selfUser: ZMUser) -> Bool {
+        return self.conversation == conversation &&
+            sender != selfUser &&
+            shouldGenerateUnreadCount() &&
+            ZMMessage.isVisible(self)
+    }
+
 }
 
 extension ZMConversation {
@@ -181,6 +191,9 @@ extension ZMConversation {
         if let sender = message.sender, sender.isSelfUser {
             // if the message was sent by the self user we don't want to send a lastRead event, since we consider this message to be already read
             updateLastRead(timestamp, synchronize: false)
+        } else if let counter = unreadMessageCounter, timestamp <= counter.countedUntil {
+            // The message might already be counted, so the counters can't be updated incrementally.
+            unreadMessageCounter = nil
         }
 
         self.needsToCalculateUnreadMessages = true
@@ -195,14 +208,40 @@ extension ZMConversation {
             updateLastModified(timestamp)
         }
 
-        calculateLastUnreadMessages()
+        unreadMessageCounter?.insert(message)
+        updateUnreadMessageCounters()
+    }
+
+    /// Update the unread counters before a message is deleted, while its content is still available
+    @objc
+    func updateTimestampsBeforeDeletingMessage(_ message: ZMMessage) {
+        guard
+            let managedObjectContext,
+            managedObjectContext.zm_isSyncContext,
+            let counter = unreadMessageCounter
+        else {
+            return
+        }
+
+        let selfUser = ZMUser.selfUser(in: managedObjectContext)
+
+        if counter.remove(message, isCounted: message.isCountedAsUnread(in: self, selfUser: selfUser)) {
+            counter.hasAccountedForDeletion = true
+        } else {
+            unreadMessageCounter = nil
+        }
     }
 
     /// Update timetamps after an message has been deleted
     @objc
     func updateTimestampsAfterDeletingMessage() {
-        // If an unread message is deleted we must re-calculate the unread messages.
-        calculateLastUnreadMessages()
+        if let counter = unreadMessageCounter, counter.hasAccountedForDeletion {
+            counter.hasAccountedForDeletion = false
+            updateUnreadMessageCounters()
+        } else {
+            // If an unread message is deleted we must re-calculate the unread messages.
+            calculateLastUnreadMessages()
+        }
     }
 
     // MARK: - Mark as read
@@ -300,51 +339,69 @@ extension ZMConversation {
         lastReadTimestampUpdateCounter = 0
     }
 
-    /// Calculates the the last unread knock, missed call and total unread unread count. This should be re-calculated
-    /// when the last read timetamp changes or a message is inserted / deleted.
+    /// Calculates the last unread knock, missed call and total unread count from all unread messages.
+    ///
+    /// Prefer `updateUnreadMessageCounters()` when the last read timestamp changes or a message is
+    /// inserted / deleted, which only looks at the messages that changed.
 
     @objc
     func calculateLastUnreadMessages() {
         // We only calculate unread message on the sync MOC
         guard let managedObjectContext, managedObjectContext.zm_isSyncContext else { return }
 
-        let messages = unreadMessages()
-        var lastKnockDate: Date?
-        var lastMissedCallDate: Date?
-        var unreadCount: Int64 = 0
-        var unreadSelfMentionCount: Int64 = 0
-        var unreadSelfReplyCount: Int64 = 0
+        let counter = UnreadMessageCounter(messages: unreadMessages(), lastRead: lastReadServerTimeStamp ?? .distantPast)
+        unreadMessageCounter = counter
+        applyUnreadMessageCounts(counter.counts)
+    }
 
-        for message in messages {
-            if message.isKnock {
-                lastKnockDate = message.serverTimestamp
-            }
+    /// Updates the last unread knock, missed call and total unread count from the messages that were
+    /// inserted, deleted or read since they were last calculated.
+    ///
+    /// Falls back to `calculateLastUnreadMessages()` if the counters haven't been calculated yet or the
+    /// last read timestamp moved backwards, and compares the counters with a full count every
+    /// `UnreadMessageCounter.consistencyCheckInterval` updates.
 
-            if message.isSystem, let systemMessage = message as? ZMSystemMessage, systemMessage.systemMessageType == .missedCall {
-                lastMissedCallDate = message.serverTimestamp
-            }
+    @objc
+    func updateUnreadMessageCounters() {
+        // We only calculate unread message on the sync MOC
+        guard let managedObjectContext, managedObjectContext.zm_isSyncContext else { return }
 
-            if let textMessageData = message.textMessageData {
-                if textMessageData.isMentioningSelf {
-                    unreadSelfMentionCount += 1
-                }
-                if textMessageData.isQuotingSelf {
-                    unreadSelfReplyCount += 1
-                }
-            }
+        let lastRead = lastReadServerTimeStamp ?? .distantPast
+
+        guard let counter = unreadMessageCounter, lastRead >= counter.lastRead else {
+            return calculateLastUnreadMessages()
+        }
+
+        if lastRead > counter.lastRead {
+            let readMessages = lastRead < counter.countedUntil ? unreadMessages(in: counter.lastRead...lastRead) : []
+            counter.markAsRead(until: lastRead, readMessages: readMessages)
+        }
+
+        let selfUser = ZMUser.selfUser(in: managedObjectContext)
+        let pendingMessages = counter.pendingMessages.filter { $0.isCountedAsUnread(in: self, selfUser: selfUser) }
+        let newMessages = unreadMessages(in: counter.countedUntil ... .distantFuture)
+
+        counter.add(pendingMessages: pendingMessages, newMessages: newMessages)
+
+        if counter.incrementalUpdateCount >= UnreadMessageCounter.consistencyCheckInterval {
+            calculateLastUnreadMessages()
 
-            if message.shouldGenerateUnreadCount() {
-                unreadCount += 1
+            if unreadMessageCounter?.counts != counter.counts {
+                WireLogger.badgeCount.warn("incremental unread counters in \(String(describing: remoteIdentifier?.uuidString)) were out of sync")
             }
+        } else {
+            applyUnreadMessageCounts(counter.counts)
         }
+    }
 
-        updateLastUnreadKnock(lastKnockDate)
-        updateLastUnreadMissedCall(lastMissedCallDate)
-        internalEstimatedUnreadCount = unreadCount
+    private func applyUnreadMessageCounts(_ counts: UnreadMessageCounter.Counts) {
+        updateLastUnreadKnock(counts.lastKnockDate)
+        updateLastUnreadMissedCall(counts.lastMissedCallDate)
+        internalEstimatedUnreadCount = counts.unreadCount
         WireLogger.badgeCount.info("update internalEstimatedUnreadCount: \(internalEstimatedUnreadCount) in \(String(describing: remoteIdentifier?.uuidString)) timestamp: \(Date())")
 
-        internalEstimatedUnreadSelfMentionCount = unreadSelfMentionCount
-        internalEstimatedUnreadSelfReplyCount = unreadSelfReplyCount
+        internalEstimatedUnreadSelfMentionCount = counts.unreadSelfMentionCount
+        internalEstimatedUnreadSelfReplyCount = counts.unreadSelfReplyCount
         needsToCalculateUnreadMessages = false
     }
 
@@ -398,16 +455,30 @@ extension ZMConversation {
         guard let managedObjectContext else { return [] }
 
         let selfUser = ZMUser.selfUser(in: managedObjectContext)
+        let templateName = "unreadMessagesIncludingInvisible"
         let fetchRequest = NSFetchRequest<ZMMessage>(entityName: ZMMessage.entityName())
-        fetchRequest.predicate = NSPredicate(format: "(%K == %@ OR %K == %@) AND %K != %@ AND %K > %@ AND %K <= %@",
-                                             ZMMessageConversationKey, self,
-                                             ZMMessageHiddenInConversationKey, self,
-                                             ZMMessageSenderKey, selfUser,
-                                             ZMMessageServerTimestampKey, range.lowerBound as NSDate,
-                                             ZMMessageServerTimestampKey, range.upperBound as NSDate)
+        fetchRequest.predicate = managedObjectContext.fetchRequestTemplateCache.predicate(
+            templateNamed: templateName,
+            substitutionVariables: [
+                "CONVERSATION": self,
+                "SELF_USER": selfUser,
+                "LOWER_BOUND": range.lowerBound as NSDate,
+                "UPPER_BOUND": range.upperBound as NSDate
+            ]
+        ) {
+            NSPredicate(format: "(%K == $CONVERSATION OR %K == $CONVERSATION) AND %K != $SELF_USER AND %K > $LOWER_BOUND AND %K <= $UPPER_BOUND",
+                        ZMMessageConversationKey,
+                        ZMMessageHiddenInConversationKey,
+                        ZMMessageSenderKey,
+                        ZMMessageServerTimestampKey,
+                        ZMMessageServerTimestampKey)
+        }
 
         fetchRequest.sortDescriptors = ZMMessage.defaultSortDescriptors()
 
-        return managedObjectContext.fetchOrAssert(request: fetchRequest).filter { $0.shouldGenerateUnreadCount() }
+        let messages = managedObjectContext.fetchOrAssert(request: fetchRequest, templateNamed: templateName)
+        GenericMessageBatchDecoder.decodeUnderlyingMessages(of: messages)
+
+        return messages.filter { $0.shouldGenerateUnreadCount() }
     }
 }
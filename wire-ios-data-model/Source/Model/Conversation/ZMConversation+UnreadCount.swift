@@ -25,7 +25,7 @@ extension ZMConversation {
         let fetchRequest = sortedFetchRequest(with: predicateForConversationsNeedingToBeCalculatedUnreadMessages())
         let conversations = managedObjectContext.fetchOrAssert(request: fetchRequest) as? [ZMConversation]
 
-        conversations?.forEach { $0.calculateLastUnreadMessages() }
+        conversations?.forEach { $0.updateUnreadMessageCounters() }
     }
 
     /// Fetch all conversations that could potentially have unread messages and recalculate the latest unread messages for them.
@@ -118,6 +118,8 @@ const NSUInteger ZMConversationMaxTextMessageLength = ZMConversationMaxEncodedTe
 
 @property (nonatomic) NSTimeInterval lastReadTimestampSaveDelay;
 @property (nonatomic) int64_t lastReadTimestampUpdateCounter;
+@property (nonatomic) ZMUnreadMessageCounter *unreadMessageCounter;
+@property (nonatomic) ZMConversationTrustSummary *trustSummary;
 @property (nonatomic) BOOL internalIsArchived;
 
 @property (nonatomic) NSDate *pendingLastReadServerTimestamp;
@@ -165,6 +167,8 @@ const NSUInteger ZMConversationMaxTextMessageLength = ZMConversationMaxEncodedTe
 @synthesize previousLastReadServerTimestamp;
 @synthesize lastReadTimestampSaveDelay;
 @synthesize lastReadTimestampUpdateCounter;
+@synthesize unreadMessageCounter;
+@synthesize trustSummary;
 
 - (BOOL)isArchived
 {
@@ -245,6 +249,14 @@ const NSUInteger ZMConversationMaxTextMessageLength = ZMConversationMaxEncodedTe
     }
 }
 
+- (void)didTurnIntoFault
+{
+    [super didTurnIntoFault];
+    // The transient caches might include changes that were discarded
+    self.unreadMessageCounter = nil;
+    self.trustSummary = nil;
+}
+
 - (void)awakeFromInsert;
 {
     [super awakeFromInsert];
@@ -403,7 +415,7 @@ const NSUInteger ZMConversationMaxTextMessageLength = ZMConversationMaxEncodedTe
     [self didChangeValueForKey:ZMConversationLastReadServerTimeStampKey];
     
     if (self.managedObjectContext.zm_isSyncContext) {
-        [self calculateLastUnreadMessages];
+        [self updateUnreadMessageCounters];
     }
 }
 
@@ -48,6 +48,15 @@ protocol Cache {
     /// This will probably cause I/O
     func storeAssetFromURL(_ url: URL, key: String, createdAt: Date)
 
+    /// Stores the asset data written by a block directly to the file of the given key.
+    ///
+    /// - parameter key: unique key used to store & retrieve the asset data
+    /// - parameter createdAt: date when the asset data was created
+    /// - parameter write: block writing the asset data to the given file URL
+    ///
+    /// This will probably cause I/O
+    func storeAssetData(key: String, createdAt: Date, write: (URL) throws -> Void) throws
+
     /// Deletes the data for a key.
     func deleteAssetData(_ key: String)
 
@@ -300,6 +300,20 @@ public final class FileAssetCache: NSObject {
         return cache.assetData(key)
     }
 
+    /// Returns the URL of the encrypted medium image, if it is stored.
+
+    public func encryptedMediumImageURL(for message: ZMConversationMessage) -> URL? {
+        guard let key = Self.cacheKeyForAsset(
+            message,
+            format: .medium,
+            encrypted: true
+        ) else {
+            return nil
+        }
+
+        return cache.assetURL(key)
+    }
+
     public func deleteMediumEncryptedImageData(for message: ZMConversationMessage) {
         guard let key = Self.cacheKeyForAsset(
             message,
@@ -518,6 +532,19 @@ public final class FileAssetCache: NSObject {
         return cache.assetData(key)
     }
 
+    /// Returns the URL of the encrypted file, if it is stored.
+
+    public func encryptedFileURL(for message: ZMConversationMessage) -> URL? {
+        guard let key = Self.cacheKeyForAsset(
+            message,
+            encrypted: true
+        ) else {
+            return nil
+        }
+
+        return cache.assetURL(key)
+    }
+
     public func temporaryURLForDecryptedFile(
         for message: ZMConversationMessage,
         encryptionKey: Data,
@@ -581,6 +608,39 @@ public final class FileAssetCache: NSObject {
         return cache.assetURL(key)
     }
 
+    /// Stores upload request data that is written straight to the cache file, so
+    /// that large request bodies never have to be held in memory as a whole.
+    ///
+    /// - Parameters:
+    ///   - message: The message the request data belongs to.
+    ///   - write: A block writing the request data to the given file URL.
+    ///
+    /// - Returns: The URL of the stored request data.
+
+    public func storeTransportData(
+        for message: ZMConversationMessage,
+        write: (URL) throws -> Void
+    ) -> URL? {
+        guard let key = Self.cacheKeyForAsset(
+            message,
+            identifier: "transport"
+        ) else {
+            return nil
+        }
+
+        do {
+            try cache.storeAssetData(
+                key: key,
+                createdAt: message.serverTimestamp ?? Date(),
+                write: write
+            )
+        } catch {
+            return nil
+        }
+
+        return cache.assetURL(key)
+    }
+
     public func deleteTransportData(for message: ZMConversationMessage) {
         guard let key = Self.cacheKeyForAsset(
             message,
@@ -669,8 +729,7 @@ public final class FileAssetCache: NSObject {
         let encryptionKey = Data.randomEncryptionKey()
 
         do {
-            let encryptedData = try plainData.zmEncryptPrefixingPlainTextIV(key: encryptionKey)
-            let hash = encryptedData.zmSHA256Digest()
+            let (encryptedData, hash) = try plainData.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: encryptionKey)
 
             cache.storeAssetData(
                 encryptedData,
@@ -711,12 +770,14 @@ public final class FileAssetCache: NSObject {
             return nil
         }
 
-        guard encryptedData.zmSHA256Digest() == sha256Digest else {
+        do {
+            return try encryptedData.zmDecryptPrefixedPlainTextIV(key: encryptionKey, sha256Digest: sha256Digest)
+        } catch AESError.digestMismatch {
             cache.deleteAssetData(key)
             return nil
+        } catch {
+            return nil
         }
-
-        return encryptedData.zmDecryptPrefixedPlainTextIV(key: encryptionKey)
     }
 
     // MARK: - Purge
@@ -920,6 +981,30 @@ private struct FileCache: Cache {
         }
     }
 
+    func storeAssetData(key: String, createdAt creationDate: Date = Date(), write: (URL) throws -> Void) throws {
+
+        let url = URLForKey(key)
+        let coordinator = NSFileCoordinator()
+
+        var coordinationError: NSError?
+        var writeError: Error?
+        coordinator.coordinate(writingItemAt: url, options: .forReplacing, error: &coordinationError) { url in
+            do {
+                try write(url)
+                try FileManager.default.setAttributes([.protectionKey: FileProtectionType.completeUntilFirstUserAuthentication,
+                                                       .creationDate: creationDate], ofItemAtPath: url.path)
+            } catch {
+                writeError = error
+                try? FileManager.default.removeItem(at: url)
+            }
+        }
+
+        if let error = coordinationError ?? writeError {
+            WireLogger.assets.error("Failed writing asset data for key = \(key): \(error)")
+            throw error
+        }
+    }
+
     func storeAssetFromURL(_ fromUrl: URL, key: String, createdAt creationDate: Date = Date()) {
 
         guard fromUrl.scheme == NSURLFileScheme else { fatal("Can't save remote URL to cache: \(fromUrl)") }
@@ -39,8 +39,8 @@ extension GenericMessage {
         }
 
         do {
-            let encryptedData = try messageData.zmEncryptPrefixingPlainTextIV(key: aesKey)
-            let keys = ZMEncryptionKeyWithChecksum.key(withAES: aesKey, digest: encryptedData.zmSHA256Digest())
+            let (encryptedData, sha256Digest) = try messageData.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: aesKey)
+            let keys = ZMEncryptionKeyWithChecksum.key(withAES: aesKey, digest: sha256Digest)
             return ZMExternalEncryptedDataWithKeys(data: encryptedData, keys: keys)
         } catch {
             WireLogger.messaging.error("failed to encrypt generic message: \(error.localizedDescription)")
@@ -57,16 +57,23 @@ extension GenericMessage {
     ///   - external: the External containing the otrKey used for the symmetric encryption and the sha256 checksum
     init?(from updateEvent: ZMUpdateEvent, withExternal external: External) {
         guard let externalDataString = updateEvent.payload.optionalString(forKey: "external") else { return nil }
-        let externalData = Data(base64Encoded: externalDataString)
-        let externalSha256 = externalData?.zmSHA256Digest()
+        guard let externalData = Data(base64Encoded: externalDataString) else {
+            zmLog.error("Invalid base64 encoding of external data, updateEvent: \(updateEvent)")
+            return nil
+        }
 
-        guard externalSha256 == external.sha256 else {
-            zmLog.error("Invalid hash for external data: \(externalSha256 ?? Data()) != \(external.sha256), updateEvent: \(updateEvent)")
+        let decryptedData: Data
+        do {
+            decryptedData = try externalData.zmDecryptPrefixedPlainTextIV(key: external.otrKey, sha256Digest: external.sha256)
+        } catch AESError.digestMismatch {
+            zmLog.error("Invalid hash for external data: \(externalData.zmSHA256Digest()) != \(external.sha256), updateEvent: \(updateEvent)")
+            return nil
+        } catch {
+            zmLog.error("Failed to decrypt external data: \(error), updateEvent: \(updateEvent)")
             return nil
         }
 
-        let decryptedData = externalData?.zmDecryptPrefixedPlainTextIV(key: external.otrKey)
-        guard let message = GenericMessage(withBase64String: decryptedData?.base64String()) else {
+        guard let message = GenericMessage(withBase64String: decryptedData.base64String()) else {
             return nil
         }
         self = message
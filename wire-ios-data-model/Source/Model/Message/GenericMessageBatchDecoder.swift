@@ -0,0 +1,181 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import CoreData
+import Foundation
+
+/// Generic messages decoded by `GenericMessageBatchDecoder`, keyed by the
+/// object ID of the message they belong to.
+public struct DecodedGenericMessages {
+
+    private let messagesByObjectID: [NSManagedObjectID: GenericMessage]
+
+    init(_ messagesByObjectID: [NSManagedObjectID: GenericMessage]) {
+        self.messagesByObjectID = messagesByObjectID
+    }
+
+    /// The number of decoded messages.
+    public var count: Int {
+        messagesByObjectID.count
+    }
+
+    public subscript(objectID: NSManagedObjectID) -> GenericMessage? {
+        messagesByObjectID[objectID]
+    }
+
+}
+
+/// Decodes the generic messages of many messages at once.
+///
+/// Decoding a message's generic message lazily on the context's queue is fine
+/// for a single message, but paths that look at thousands of messages, like
+/// search indexing or asset categorization, end up decoding one protobuf after
+/// the other. The batch decoder only collects the raw payloads on the context's
+/// queue, decodes them concurrently off the context, and hands back an
+/// immutable result that is stored in the messages' decoded message caches.
+public enum GenericMessageBatchDecoder {
+
+    /// The serialized parts of the generic message of one message.
+    public struct Payload {
+
+        let objectID: NSManagedObjectID
+        let parts: [Data]
+        let includesPart: (GenericMessage) -> Bool
+
+    }
+
+    /// The number of payloads a worker decodes at a time, so that small
+    /// messages don't drown in scheduling overhead.
+    static let chunkSize = 64
+
+    /// Decodes the given payloads.
+    ///
+    /// - Parameters:
+    ///   - payloads: The payloads to decode. They can be decoded on any queue.
+    ///   - concurrently: Whether to decode on all cores, or one after the other.
+    ///
+    /// - Returns: The decoded messages of all payloads with at least one valid part.
+    public static func decode(_ payloads: [Payload], concurrently: Bool = true) -> DecodedGenericMessages {
+        var results = [GenericMessage?](repeating: nil, count: payloads.count)
+
+        if concurrently, payloads.count > chunkSize {
+            let chunkCount = (payloads.count + chunkSize - 1) / chunkSize
+
+            results.withUnsafeMutableBufferPointer { results in
+                DispatchQueue.concurrentPerform(iterations: chunkCount) { chunk in
+                    let start = chunk * chunkSize
+                    let end = min(start + chunkSize, payloads.count)
+
+                    // Every chunk writes to its own range of the buffer.
+                    for index in start..<end {
+                        results[index] = decode(payloads[index])
+                    }
+                }
+            }
+        } else {
+            for index in payloads.indices {
+                results[index] = decode(payloads[index])
+            }
+        }
+
+        var messagesByObjectID = [NSManagedObjectID: GenericMessage](minimumCapacity: payloads.count)
+
+        for (payload, result) in zip(payloads, results) {
+            messagesByObjectID[payload.objectID] = result
+        }
+
+        return DecodedGenericMessages(messagesByObjectID)
+    }
+
+    /// Decodes the generic messages of the given messages that were not decoded
+    /// yet, and stores them in the messages.
+    ///
+    /// Must be called on the messages' context.
+    ///
+    /// - Parameter messages: Client and asset client messages. Other messages are ignored.
+    /// - Returns: The number of messages that were decoded.
+    @discardableResult
+    public static func decodeUnderlyingMessages(of messages: [ZMMessage]) -> Int {
+        let clientMessages = messages
+            .compactMap { $0 as? ZMClientMessage }
+            .filter { $0.cachedUnderlyingMessage == nil && !$0.isZombieObject }
+        let assetMessages = messages
+            .compactMap { $0 as? ZMAssetClientMessage }
+            .filter { $0.cachedUnderlyingAssetMessage == nil && !$0.isZombieObject }
+
+        let payloads = clientMessages.map {
+            Payload(
+                objectID: $0.objectID,
+                parts: protobufData(of: $0.dataSet),
+                includesPart: ZMClientMessage.includesInUnderlyingMessage
+            )
+        } + assetMessages.map {
+            Payload(
+                objectID: $0.objectID,
+                parts: protobufData(of: $0.dataSet),
+                includesPart: ZMAssetClientMessage.includesInUnderlyingMessage
+            )
+        }
+
+        guard !payloads.isEmpty else {
+            return 0
+        }
+
+        let decoded = decode(payloads)
+
+        for message in clientMessages {
+            message.cachedUnderlyingMessage = decoded[message.objectID]
+        }
+
+        for message in assetMessages {
+            message.cachedUnderlyingAssetMessage = decoded[message.objectID]
+        }
+
+        return decoded.count
+    }
+
+    // MARK: - Helpers
+
+    private static func protobufData(of dataSet: NSOrderedSet) -> [Data] {
+        dataSet.compactMap { try? ($0 as? ZMGenericMessageData)?.getProtobufData() }
+    }
+
+    private static func decode(_ payload: Payload) -> GenericMessage? {
+        let parts = payload.parts
+            .compactMap { try? GenericMessage(serializedData: $0) }
+            .filter(payload.includesPart)
+
+        // Merging a single part into an empty message yields the part itself.
+        if parts.count == 1 {
+            return parts[0]
+        }
+
+        guard !parts.isEmpty else {
+            return nil
+        }
+
+        var message = GenericMessage()
+        for part in parts {
+            if let data = try? part.serializedData() {
+                try? message.merge(serializedData: data)
+            }
+        }
+        return message
+    }
+
+}
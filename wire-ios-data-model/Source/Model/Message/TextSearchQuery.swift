@@ -60,10 +60,15 @@ extension ZMClientMessage {
     /// - parameter queryComponents: The array of the search terms to match the normalized text against.
     static func predicateForMessagesMatching(_ queryComponents: [String]) -> NSPredicate {
         guard queryComponents.count > 0 else { return NSPredicate(value: false) }
-        let predicates = Set(queryComponents).map { NSPredicate(format: "%K CONTAINS[n] %@", #keyPath(ZMMessage.normalizedText), $0) }
+        let predicates = Set(queryComponents).map {
+            normalizedTextContainsTemplate.withSubstitutionVariables(["QUERY": $0])
+        }
         return NSCompoundPredicate(andPredicateWithSubpredicates: predicates)
     }
 
+    /// The template of a single search term, parsed once instead of for every term of every query.
+    private static let normalizedTextContainsTemplate = NSPredicate(format: "%K CONTAINS[n] $QUERY", #keyPath(ZMMessage.normalizedText))
+
     static func predicateForMessages(inConversationWith identifier: UUID) -> NSPredicate {
         return NSPredicate(
             format: "%K.%K == %@",
@@ -272,6 +277,9 @@ public class TextSearchQuery: NSObject {
 
             guard let unwrappedRequest = request,
                   let messagesToIndex = self.syncMOC.fetchOrAssert(request: unwrappedRequest) as? [ZMClientMessage] else { return }
+            if !self.syncMOC.encryptMessagesAtRest {
+                GenericMessageBatchDecoder.decodeUnderlyingMessages(of: messagesToIndex)
+            }
             messagesToIndex.forEach {
                 // We populate the `normalizedText` field, so the search can be 
                 // performed faster on the normalized field the next time.
@@ -46,13 +46,17 @@ extension ZMAssetClientMessage {
         guard !isZombieObject else { return nil }
 
         if cachedUnderlyingAssetMessage == nil {
-            cachedUnderlyingAssetMessage = underlyingMessageMergedFromDataSet(filter: {
-                $0.assetData != nil
-            })
+            cachedUnderlyingAssetMessage = underlyingMessageMergedFromDataSet(filter: ZMAssetClientMessage.includesInUnderlyingMessage)
         }
         return cachedUnderlyingAssetMessage
     }
 
+    /// Whether a part of the data set is merged into the underlying message.
+
+    static let includesInUnderlyingMessage: (GenericMessage) -> Bool = {
+        $0.assetData != nil
+    }
+
     /// Set the underlying protobuf message data.
     ///
     /// - Parameter message: The protobuf message object to be associated with this asset client message.
@@ -387,6 +387,15 @@ struct CacheAsset: AssetType {
         }
     }
 
+    var encryptedURL: URL? {
+        switch type {
+        case .file:
+            return cache.encryptedFileURL(for: owner)
+        case .image, .thumbnail:
+            return cache.encryptedMediumImageURL(for: owner)
+        }
+    }
+
     var isUploaded: Bool {
         guard let genericMessage = owner.underlyingMessage else {
             return false
@@ -589,6 +598,9 @@ public protocol AssetType {
     /// Encrypted data
     var encrypted: Data? { get }
 
+    /// The file the encrypted data is stored in
+    var encryptedURL: URL? { get }
+
     /// True if the encrypted data has been uploaded to the backend
     var isUploaded: Bool { get }
 
@@ -22,6 +22,16 @@ extension ZMClientMessage: EncryptionAtRestMigratable {
 
     static let predicateForObjectsNeedingMigration: NSPredicate? = nil
 
+    static func predicateForObjectsNotYetMigrated(_ direction: EncryptionAtRestMigration.Direction) -> NSPredicate {
+        // The normalized text is cleared while encryption at rest is enabled.
+        switch direction {
+        case .towardEncryptionAtRest:
+            return NSPredicate(format: "%K != nil AND %K != ''", #keyPath(ZMMessage.normalizedText), #keyPath(ZMMessage.normalizedText))
+        case .awayFromEncryptionAtRest:
+            return NSPredicate(format: "%K == nil OR %K == ''", #keyPath(ZMMessage.normalizedText), #keyPath(ZMMessage.normalizedText))
+        }
+    }
+
     func migrateTowardEncryptionAtRest(
         in context: NSManagedObjectContext,
         key: VolatileData
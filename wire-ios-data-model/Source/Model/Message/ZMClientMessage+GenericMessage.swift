@@ -31,10 +31,16 @@ extension ZMClientMessage {
         return cachedUnderlyingMessage
     }
 
+    /// Whether a part of the data set is merged into the underlying message.
+
+    static let includesInUnderlyingMessage: (GenericMessage) -> Bool = {
+        $0.knownMessage && $0.imageAssetData == nil
+    }
+
     private func underlyingMessageMergedFromDataSet() -> GenericMessage? {
         let filteredData = dataSet.lazy
             .compactMap { ($0 as? ZMGenericMessageData)?.underlyingMessage }
-            .filter { $0.knownMessage && $0.imageAssetData == nil }
+            .filter(ZMClientMessage.includesInUnderlyingMessage)
             .compactMap { try? $0.serializedData() }
 
         guard !Array(filteredData).isEmpty else {
@@ -77,7 +77,7 @@ import WireCryptobox
 
     // MARK: - Methods
 
-    private func getProtobufData() throws -> Data {
+    func getProtobufData() throws -> Data {
         guard let moc = managedObjectContext else {
             throw ProcessingError.missingManagedObjectContext
         }
@@ -158,39 +158,27 @@ extension ZMGenericMessageData {
 
 }
 
-extension ZMGenericMessageData: EncryptionAtRestMigratable {
+extension ZMGenericMessageData: EncryptionAtRestValueMigratable {
 
     static let predicateForObjectsNeedingMigration: NSPredicate? = nil
 
-    func migrateTowardEncryptionAtRest(
-        in context: NSManagedObjectContext,
-        key: VolatileData
-    ) throws {
-        let (ciphertext, nonce) = try context.encryptData(
-            data: data,
-            key: key
-        )
-
-        self.data = ciphertext
-        self.nonce = nonce
-    }
-
-    func migrateAwayFromEncryptionAtRest(
-        in context: NSManagedObjectContext,
-        key: VolatileData
-    ) throws {
-        guard let nonce else {
-            return
+    static func predicateForObjectsNotYetMigrated(_ direction: EncryptionAtRestMigration.Direction) -> NSPredicate {
+        switch direction {
+        case .towardEncryptionAtRest:
+            return NSPredicate(format: "%K == nil", nonceKey)
+        case .awayFromEncryptionAtRest:
+            return NSPredicate(format: "%K != nil", nonceKey)
         }
+    }
 
-        let plaintext = try context.decryptData(
-            data: data,
-            nonce: nonce,
-            key: key
-        )
+    var encryptionAtRestValue: Data? {
+        get { data }
+        set { data = newValue ?? Data() }
+    }
 
-        self.data = plaintext
-        self.nonce = nil
+    var encryptionAtRestNonce: Data? {
+        get { nonce }
+        set { nonce = newValue }
     }
 
 }
@@ -91,6 +91,9 @@ extension ZMMessage {
 
         let selfUser = ZMUser.selfUser(in: moc)
 
+        // The unread counters need the content of the message, which is cleared below
+        conversation.updateTimestampsBeforeDeletingMessage(message)
+
         // Only clients other than self should see the system message
         if senderID != selfUser.remoteIdentifier && !message.isEphemeral, let sender = message.sender {
             let timestamp = message.serverTimestamp ?? Date()
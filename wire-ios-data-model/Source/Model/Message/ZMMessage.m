@@ -457,6 +457,17 @@ NSString * const ZMMessageDecryptionErrorCodeKey = @"decryptionErrorCode";
     NSEntityDescription *entity = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[self.entityName];
     NSPredicate *noncePredicate = [NSPredicate predicateWithFormat:@"%K == %@", ZMMessageNonceDataKey, [nonce data]];
     
+    for (ZMMessage *message in [moc.zm_remoteIdentifierIndex objectsWithRemoteIdentifierData:nonce.data]) {
+        if (!message.isFault &&
+            message.managedObjectContext == moc &&
+            [message.entity isKindOfEntity:entity] &&
+            ([message valueForKey:ZMMessageConversationKey] == conversation ||
+             [message valueForKey:ZMMessageHiddenInConversationKey] == conversation) &&
+            [noncePredicate evaluateWithObject:message]) {
+            return (id) message;
+        }
+    }
+    
     BOOL checkedAllHiddenMessages = NO;
     BOOL checkedAllVisibleMessage = NO;
 
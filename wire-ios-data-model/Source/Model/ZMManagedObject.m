@@ -30,9 +30,190 @@ static NSString * const NeedsToBeUpdatedFromBackendKey = @"needsToBeUpdatedFromB
 static NSString * const RemoteIdentifierDataKey = @"remoteIdentifier_data";
 NSString * const ZMManagedObjectLocallyModifiedKeysKey = @"modifiedKeys";
 static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
+static NSString * const LocalModificationKeyIndexesKey = @"ZMLocalModificationKeyIndexes";
+
+
+
+/// The number of 64 bit words in a @c ZMKeyMask. This allows for entities with up to 256 attributes and relationships.
+#define ZMKeyMaskWordCount 4
+
+/// A set of keys of a single entity, with one bit per attribute or relationship.
+typedef struct {
+    uint64_t words[ZMKeyMaskWordCount];
+} ZMKeyMask;
+
+static inline ZMKeyMask ZMKeyMaskUnion(ZMKeyMask a, ZMKeyMask b)
+{
+    for (size_t i = 0; i < ZMKeyMaskWordCount; i++) {
+        a.words[i] |= b.words[i];
+    }
+    return a;
+}
+
+static inline ZMKeyMask ZMKeyMaskIntersection(ZMKeyMask a, ZMKeyMask b)
+{
+    for (size_t i = 0; i < ZMKeyMaskWordCount; i++) {
+        a.words[i] &= b.words[i];
+    }
+    return a;
+}
+
+static inline ZMKeyMask ZMKeyMaskMinus(ZMKeyMask a, ZMKeyMask b)
+{
+    for (size_t i = 0; i < ZMKeyMaskWordCount; i++) {
+        a.words[i] &= ~b.words[i];
+    }
+    return a;
+}
+
+static inline BOOL ZMKeyMaskIsEqual(ZMKeyMask a, ZMKeyMask b)
+{
+    for (size_t i = 0; i < ZMKeyMaskWordCount; i++) {
+        if (a.words[i] != b.words[i]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static inline BOOL ZMKeyMaskIsSubset(ZMKeyMask a, ZMKeyMask b)
+{
+    for (size_t i = 0; i < ZMKeyMaskWordCount; i++) {
+        if ((a.words[i] & ~b.words[i]) != 0) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static inline NSUInteger ZMKeyMaskCount(ZMKeyMask mask)
+{
+    NSUInteger count = 0;
+    for (size_t i = 0; i < ZMKeyMaskWordCount; i++) {
+        count += (NSUInteger) __builtin_popcountll(mask.words[i]);
+    }
+    return count;
+}
+
+
+
+/// Assigns a bit in a @c ZMKeyMask to every attribute and relationship of an entity
+/// and caches the keys that are tracked for local modifications by default.
+///
+/// The bits are only used in memory. The persisted @c modifiedKeys still store the
+/// key names, so they stay valid when a model version adds or removes properties.
+@interface ZMLocalModificationKeyIndex : NSObject
+
+@property (nonatomic, readonly) NSSet<NSString *> *trackedKeys;
+@property (nonatomic, readonly) ZMKeyMask trackedMask;
+
+- (instancetype)initWithEntity:(NSEntityDescription *)entity ignoredKeys:(NSSet *)ignoredKeys;
+
+/// Keys that are not attributes or relationships of the entity are skipped.
+- (ZMKeyMask)maskForKeys:(id<NSFastEnumeration>)keys;
+
+/// Returns @c nil for an empty mask.
+- (NSSet<NSString *> *)keysForMask:(ZMKeyMask)mask;
+
+@end
+
+
+
+@implementation ZMLocalModificationKeyIndex
+{
+    NSArray<NSString *> *_keys;
+    NSDictionary<NSString *, NSNumber *> *_bitsByKey;
+}
+
+- (instancetype)initWithEntity:(NSEntityDescription *)entity ignoredKeys:(NSSet *)ignoredKeys
+{
+    self = [super init];
+    if (self) {
+        NSArray *attributeKeys = [entity.attributesByName.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        NSArray *relationshipKeys = [entity.relationshipsByName.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        _keys = [attributeKeys arrayByAddingObjectsFromArray:relationshipKeys];
+        RequireString(_keys.count <= ZMKeyMaskWordCount * 64,
+                      "Entity %s has too many properties for tracking local modifications",
+                      entity.name.UTF8String);
+
+        NSMutableDictionary *bitsByKey = [NSMutableDictionary dictionaryWithCapacity:_keys.count];
+        NSMutableSet *trackedKeys = [NSMutableSet set];
+        ZMKeyMask trackedMask = {{0}};
+
+        for (NSUInteger bit = 0; bit < _keys.count; bit++) {
+            NSString *key = _keys[bit];
+            bitsByKey[key] = @(bit);
+
+            NSAttributeDescription *attribute = entity.attributesByName[key];
+            BOOL isTracked = ! [ignoredKeys containsObject:key] && (attribute == nil || attribute.attributeType != NSUndefinedAttributeType);
+            if (isTracked) {
+                [trackedKeys addObject:key];
+                trackedMask.words[bit / 64] |= 1ull << (bit % 64);
+            }
+        }
+
+        _bitsByKey = [bitsByKey copy];
+        _trackedKeys = [trackedKeys copy];
+        _trackedMask = trackedMask;
+    }
+    return self;
+}
+
+- (ZMKeyMask)maskForKeys:(id<NSFastEnumeration>)keys
+{
+    ZMKeyMask mask = {{0}};
+    for (NSString *key in keys) {
+        NSNumber *bit = _bitsByKey[key];
+        if (bit != nil) {
+            NSUInteger index = bit.unsignedIntegerValue;
+            mask.words[index / 64] |= 1ull << (index % 64);
+        }
+    }
+    return mask;
+}
+
+- (NSSet<NSString *> *)keysForMask:(ZMKeyMask)mask
+{
+    __unsafe_unretained NSString *keys[ZMKeyMaskWordCount * 64];
+    NSUInteger count = 0;
+
+    for (NSUInteger i = 0; i < ZMKeyMaskWordCount; i++) {
+        uint64_t word = mask.words[i];
+        while (word != 0) {
+            NSUInteger bit = i * 64 + (NSUInteger) __builtin_ctzll(word);
+            keys[count++] = _keys[bit];
+            word &= word - 1;
+        }
+    }
+
+    return (count == 0) ? nil : [NSSet setWithObjects:keys count:count];
+}
+
+@end
+
 
 
 @interface ZMManagedObject ()
+
+@property (nonatomic, readonly) ZMLocalModificationKeyIndex *localModificationKeyIndex;
+@property (nonatomic, readonly) ZMKeyMask trackedKeyMask;
+@property (nonatomic) ZMKeyMask locallyModifiedKeyMask;
+
+@end
+
+
+
+@interface ZMManagedObject (RemoteIdentifierIndex)
+
++ (NSManagedObject *)registeredObjectWithRemoteIdentifierData:(NSData *)data
+                                                       entity:(NSEntityDescription *)entity
+                                                       domain:(NSString *)domain
+                                               matchingDomain:(BOOL)matchingDomain
+                                       inManagedObjectContext:(NSManagedObjectContext *)moc;
+
+- (void)addToRemoteIdentifierIndex;
+- (void)removeFromRemoteIdentifierIndex;
+
 @end
 
 
@@ -99,27 +280,51 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
     }
 }
 
-- (NSDictionary *)filteredChangedValues;
-{
-    NSSet *ignoredKeys = self.ignoredKeys;
-    NSArray *changedKeys = [self.changedValues.allKeys filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSString *k, NSDictionary *bindings) {
-        NOT_USED(bindings);
-        return ! [ignoredKeys containsObject:k];
-    }]];
-    return [self.changedValues dictionaryWithValuesForKeys:changedKeys];
-}
-
 - (void)setKeysThatHaveLocalModifications:(NSSet *)keys;
 {
     if (! [[self class] isTrackingLocalModifications]) {
         return;
     }
-    NSMutableSet *changedTrackedKeys = [keys mutableCopy];
-    [changedTrackedKeys intersectSet:self.keysTrackedForLocalModifications];
-    if ([self.modifiedKeys isEqualToSet:changedTrackedKeys]){
+    ZMKeyMask changedTrackedKeys = ZMKeyMaskIntersection([self.localModificationKeyIndex maskForKeys:keys], self.trackedKeyMask);
+    self.locallyModifiedKeyMask = changedTrackedKeys;
+}
+
+- (ZMLocalModificationKeyIndex *)localModificationKeyIndex
+{
+    NSMutableDictionary *indexes = self.managedObjectContext.userInfo[LocalModificationKeyIndexesKey];
+    ZMLocalModificationKeyIndex *index = indexes[self.entity.name];
+    if (index == nil) {
+        index = [[ZMLocalModificationKeyIndex alloc] initWithEntity:self.entity ignoredKeys:self.ignoredKeys];
+        if (self.managedObjectContext != nil) {
+            if (indexes == nil) {
+                indexes = [NSMutableDictionary dictionary];
+                self.managedObjectContext.userInfo[LocalModificationKeyIndexesKey] = indexes;
+            }
+            indexes[self.entity.name] = index;
+        }
+    }
+    return index;
+}
+
+- (ZMKeyMask)trackedKeyMask
+{
+    ZMLocalModificationKeyIndex *index = self.localModificationKeyIndex;
+    NSSet *trackedKeys = self.keysTrackedForLocalModifications;
+    // Subclasses that override the tracked keys return a different set
+    return (trackedKeys == index.trackedKeys) ? index.trackedMask : [index maskForKeys:trackedKeys];
+}
+
+- (ZMKeyMask)locallyModifiedKeyMask
+{
+    return [self.localModificationKeyIndex maskForKeys:self.keysThatHaveLocalModifications];
+}
+
+- (void)setLocallyModifiedKeyMask:(ZMKeyMask)mask
+{
+    if (ZMKeyMaskIsEqual(self.locallyModifiedKeyMask, mask) && (self.modifiedKeys.count == 0) == (ZMKeyMaskCount(mask) == 0)) {
         return;
     }
-    self.modifiedKeys = (keys.count == 0) ? nil : [changedTrackedKeys copy];
+    self.modifiedKeys = [self.localModificationKeyIndex keysForMask:mask];
 }
 
 - (NSString *)objectIDURLString
@@ -200,12 +405,19 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
     [self setPrimitiveValue:newUUID forKey:key];
     [self didChangeValueForKey:key];
     NSString *dataKey = [key stringByAppendingString:ZMDataPropertySuffix];
+    BOOL const isRemoteIdentifier = [dataKey isEqualToString:[self.class remoteIdentifierDataKey]];
+    if (isRemoteIdentifier) {
+        [self removeFromRemoteIdentifierIndex];
+    }
     if (newUUID != nil) {
         NSData *data = [newUUID data];
         [self setValue:data forKeyPath:dataKey];
     } else {
         [self setValue:nil forKeyPath:dataKey];
     }
+    if (isRemoteIdentifier) {
+        [self addToRemoteIdentifierIndex];
+    }
 }
 
 - (CGSize)transientCGSizeForKey:(NSString *)key
@@ -325,28 +537,47 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
     }
 }
 
+/// Executes a fetch request whose predicate was made from a template of the context's
+/// fetch request template cache, and records how long it took.
++ (NSArray *)executeFetchRequest:(NSFetchRequest *)fetchRequest
+                   templateNamed:(NSString *)templateName
+          inManagedObjectContext:(NSManagedObjectContext *)moc
+{
+    return [moc.zm_fetchRequestTemplateCache measureFetchForTemplateNamed:templateName fetch:^NSArray *{
+        return [moc executeFetchRequestOrAssert:fetchRequest];
+    }];
+}
+
 + (instancetype)internalFetchObjectWithRemoteIdentifier:(NSUUID *)uuid inManagedObjectContext:(NSManagedObjectContext *)moc;
 {
     // Executing a fetch request is quite expensive, because it will _always_ (1) round trip through
     // the persistent store coordinator and the SQLite engine, and (2) touch the file system.
-    // Looping through all objects in the context is way cheaper, because it does not involve (1)
-    // taking any locks, nor (2) touching the file system.
+    // Looking the object up in the context's remote identifier index is way cheaper, because it does
+    // not involve (1) taking any locks, nor (2) touching the file system.
     
     NSEntityDescription *entity = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[self.entityName];
     Require(entity != nil);
     
-    NSString *key = [self remoteIdentifierDataKey];
     NSData *data = uuid.data;
-    for (NSManagedObject *mo in moc.registeredObjects) {
-        if (!mo.isFault && mo.entity == entity && [data isEqual:[mo valueForKey:key]]) {
-            return (id) mo;
-        }
+    NSManagedObject *registeredObject = [self registeredObjectWithRemoteIdentifierData:data
+                                                                                 entity:entity
+                                                                                 domain:nil
+                                                                         matchingDomain:NO
+                                                                 inManagedObjectContext:moc];
+    if (registeredObject != nil) {
+        return (id) registeredObject;
     }
+    NSString *templateName = [self.entityName stringByAppendingString:@".remoteIdentifier"];
     NSFetchRequest *fetchRequest = [[NSFetchRequest alloc] initWithEntityName:self.entityName];
-    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == %@", [self remoteIdentifierDataKey], uuid.data];
+    fetchRequest.predicate = [moc.zm_fetchRequestTemplateCache predicateForTemplateNamed:templateName
+                                                                   substitutionVariables:@{@"REMOTE_IDENTIFIER": data}
+                                                                                template:^NSPredicate *{
+        return [NSPredicate predicateWithFormat:@"%K == $REMOTE_IDENTIFIER", [self remoteIdentifierDataKey]];
+    }];
     fetchRequest.fetchLimit = 2; // We only want 1, but want to check if there are too many.
-    NSArray *fetchResult = [moc executeFetchRequestOrAssert:fetchRequest];
+    NSArray *fetchResult = [self executeFetchRequest:fetchRequest templateNamed:templateName inManagedObjectContext:moc];
     RequireString([fetchResult count] <= 1, "More than one object with the same UUID: %s", uuid.transportString.UTF8String);
+    [fetchResult.firstObject addToRemoteIdentifierIndex];
     return fetchResult.firstObject;
 }
 
@@ -357,43 +588,69 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 {
     // Executing a fetch request is quite expensive, because it will _always_ (1) round trip through
     // the persistent store coordinator and the SQLite engine, and (2) touch the file system.
-    // Looping through all objects in the context is way cheaper, because it does not involve (1)
-    // taking any locks, nor (2) touching the file system.
+    // Looking the object up in the context's remote identifier index is way cheaper, because it does
+    // not involve (1) taking any locks, nor (2) touching the file system.
 
     NSEntityDescription *entity = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[self.entityName];
     Require(entity != nil);
 
-    NSString *key = [self remoteIdentifierDataKey];
-    NSString *domainKey = [self domainKey];
     NSData *data = uuid.data;
-    for (NSManagedObject *mo in moc.registeredObjects) {
-        if (!mo.isFault && mo.entity == entity &&
-            [data isEqual:[mo valueForKey:key]] &&
-            [domain isEqual:[mo valueForKey:domainKey]]) {
-            return (id) mo;
-        }
+    NSManagedObject *registeredObject = [self registeredObjectWithRemoteIdentifierData:data
+                                                                                 entity:entity
+                                                                                 domain:domain
+                                                                         matchingDomain:YES
+                                                                 inManagedObjectContext:moc];
+    if (registeredObject != nil) {
+        return (id) registeredObject;
     }
-    NSFetchRequest *fetchRequest = [[NSFetchRequest alloc] initWithEntityName:self.entityName];
+    NSString *templateName;
+    NSPredicate *(^template)(void);
 
     if (searchingLocalDomain) {
         if (domain != nil) {
-            fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == %@ AND (%K == %@ OR %K == NULL)",
-                                      [self remoteIdentifierDataKey], uuid.data,
-                                      [self domainKey], domain,
-                                      [self domainKey]];
+            templateName = [self.entityName stringByAppendingString:@".remoteIdentifierInLocalDomain"];
+            template = ^NSPredicate *{
+                return [NSPredicate predicateWithFormat:@"%K == $REMOTE_IDENTIFIER AND (%K == $DOMAIN OR %K == NULL)",
+                        [self remoteIdentifierDataKey],
+                        [self domainKey],
+                        [self domainKey]];
+            };
         } else {
-            fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == %@",
-                                      [self remoteIdentifierDataKey], uuid.data];
+            templateName = [self.entityName stringByAppendingString:@".remoteIdentifier"];
+            template = ^NSPredicate *{
+                return [NSPredicate predicateWithFormat:@"%K == $REMOTE_IDENTIFIER", [self remoteIdentifierDataKey]];
+            };
         }
+    } else if (domain != nil) {
+        templateName = [self.entityName stringByAppendingString:@".remoteIdentifierInDomain"];
+        template = ^NSPredicate *{
+            return [NSPredicate predicateWithFormat:@"%K == $REMOTE_IDENTIFIER AND %K == $DOMAIN",
+                    [self remoteIdentifierDataKey],
+                    [self domainKey]];
+        };
     } else {
-        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == %@ AND %K == %@",
-                                  [self remoteIdentifierDataKey], uuid.data,
-                                  [self domainKey], domain];
+        // A nil domain has to be matched with NULL, which a substitution variable can't express.
+        templateName = [self.entityName stringByAppendingString:@".remoteIdentifierWithoutDomain"];
+        template = ^NSPredicate *{
+            return [NSPredicate predicateWithFormat:@"%K == $REMOTE_IDENTIFIER AND %K == NULL",
+                    [self remoteIdentifierDataKey],
+                    [self domainKey]];
+        };
+    }
+
+    NSMutableDictionary *variables = [NSMutableDictionary dictionaryWithObject:data forKey:@"REMOTE_IDENTIFIER"];
+    if (domain != nil) {
+        variables[@"DOMAIN"] = domain;
     }
 
+    NSFetchRequest *fetchRequest = [[NSFetchRequest alloc] initWithEntityName:self.entityName];
+    fetchRequest.predicate = [moc.zm_fetchRequestTemplateCache predicateForTemplateNamed:templateName
+                                                                   substitutionVariables:variables
+                                                                                template:template];
     fetchRequest.fetchLimit = 2; // We only want 1, but want to check if there are too many.
-    NSArray *fetchResult = [moc executeFetchRequestOrAssert:fetchRequest];
+    NSArray *fetchResult = [self executeFetchRequest:fetchRequest templateNamed:templateName inManagedObjectContext:moc];
     RequireString([fetchResult count] <= 1, "More than one object with the same UUID: %s and domain: %s", uuid.transportString.UTF8String, domain.UTF8String);
+    [fetchResult.firstObject addToRemoteIdentifierIndex];
     return fetchResult.firstObject;
 }
 
@@ -401,23 +658,27 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 {
     // Executing a fetch request is quite expensive, because it will _always_ (1) round trip through
     // (1) the persistent store coordinator and the SQLite engine, and (2) touch the file system.
-    // Looping through all objects in the context is way cheaper, because it does not involve (1)
-    // taking any locks, nor (2) touching the file system.
+    // Looking the objects up in the context's remote identifier index is way cheaper, because it does
+    // not involve (1) taking any locks, nor (2) touching the file system. The remaining identifiers
+    // are fetched with a single request.
     
     NSEntityDescription *entity = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[self.entityName];
     Require(entity != nil);
     
     NSMutableSet *objects = [[NSMutableSet alloc] init];
+    NSMutableSet <NSData *> *uuidDataArray = [[NSMutableSet alloc] init];
     
-    NSString *key = [self remoteIdentifierDataKey];
-    NSMutableSet <NSData *> *uuidDataArray = [[uuids mapWithBlock:^NSData *(NSUUID *uuid) {
-        return uuid.data;
-    }] mutableCopy];
-    
-    for (NSManagedObject *mo in moc.registeredObjects) {
-        if ((mo.entity == entity) && [uuidDataArray containsObject:[mo valueForKey:key]]) {
-            [objects addObject:mo];
-            [uuidDataArray removeObject:[mo valueForKey:key]];
+    for (NSUUID *uuid in uuids) {
+        NSData *data = uuid.data;
+        NSManagedObject *registeredObject = [self registeredObjectWithRemoteIdentifierData:data
+                                                                                     entity:entity
+                                                                                     domain:nil
+                                                                             matchingDomain:NO
+                                                                     inManagedObjectContext:moc];
+        if (registeredObject != nil) {
+            [objects addObject:registeredObject];
+        } else {
+            [uuidDataArray addObject:data];
         }
     }
     
@@ -425,11 +686,19 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
         return objects;
     }
     
+    NSString *templateName = [self.entityName stringByAppendingString:@".remoteIdentifiers"];
     NSFetchRequest *fetchRequest = [[NSFetchRequest alloc] initWithEntityName:self.entityName];
-    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K IN %@", [self remoteIdentifierDataKey], uuidDataArray];
+    fetchRequest.predicate = [moc.zm_fetchRequestTemplateCache predicateForTemplateNamed:templateName
+                                                                   substitutionVariables:@{@"REMOTE_IDENTIFIERS": uuidDataArray}
+                                                                                template:^NSPredicate *{
+        return [NSPredicate predicateWithFormat:@"%K IN $REMOTE_IDENTIFIERS", [self remoteIdentifierDataKey]];
+    }];
     fetchRequest.fetchLimit = uuidDataArray.count + 1; // We only want 1 object for each uuid, but want to check if there are too many.
-    NSArray *fetchResult = [moc executeFetchRequestOrAssert:fetchRequest];
+    NSArray *fetchResult = [self executeFetchRequest:fetchRequest templateNamed:templateName inManagedObjectContext:moc];
     RequireString([fetchResult count] <= uuidDataArray.count, "More than one object with the same UUID");
+    for (ZMManagedObject *mo in fetchResult) {
+        [mo addToRemoteIdentifierIndex];
+    }
     [objects addObjectsFromArray:fetchResult];
     return objects;
 }
@@ -439,6 +708,66 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 
 
 
+@implementation ZMManagedObject (RemoteIdentifierIndex)
+
+/// Returns a registered object of the given entity from the context's remote identifier index.
+/// Faults are skipped, just like they were when scanning the registered objects, so that
+/// looking up an object never fires a fault for a row that might no longer exist.
++ (NSManagedObject *)registeredObjectWithRemoteIdentifierData:(NSData *)data
+                                                       entity:(NSEntityDescription *)entity
+                                                       domain:(NSString *)domain
+                                               matchingDomain:(BOOL)matchingDomain
+                                       inManagedObjectContext:(NSManagedObjectContext *)moc
+{
+    ZMRemoteIdentifierIndex *index = moc.zm_remoteIdentifierIndex;
+    NSString *key = [self remoteIdentifierDataKey];
+    
+    for (NSManagedObject *mo in [index objectsWithRemoteIdentifierData:data]) {
+        if (mo.isFault || mo.managedObjectContext != moc || mo.entity != entity) {
+            continue;
+        }
+        if (! [data isEqual:[mo valueForKey:key]]) {
+            // The identifier was changed without going through -setTransientUUID:forKey:
+            [index removeObject:mo remoteIdentifierData:data];
+            continue;
+        }
+        if (matchingDomain && ! [domain isEqual:[mo valueForKey:[self domainKey]]]) {
+            continue;
+        }
+        return mo;
+    }
+    return nil;
+}
+
+- (NSData *)remoteIdentifierDataForIndex
+{
+    NSString *key = [self.class remoteIdentifierDataKey];
+    if (self.isFault || self.entity.attributesByName[key] == nil) {
+        return nil;
+    }
+    return [self primitiveValueForKey:key];
+}
+
+- (void)addToRemoteIdentifierIndex
+{
+    NSData *data = self.remoteIdentifierDataForIndex;
+    if (data != nil && self.managedObjectContext != nil) {
+        [self.managedObjectContext.zm_remoteIdentifierIndex addObject:self remoteIdentifierData:data];
+    }
+}
+
+- (void)removeFromRemoteIdentifierIndex
+{
+    NSData *data = self.remoteIdentifierDataForIndex;
+    if (data != nil && self.managedObjectContext != nil) {
+        [self.managedObjectContext.zm_remoteIdentifierIndex removeObject:self remoteIdentifierData:data];
+    }
+}
+
+@end
+
+
+
 @implementation ZMManagedObject (PersistentChangeTracking)
 
 + (NSPredicate *)predicateForNeedingToBeUpdatedFromBackend;
@@ -480,20 +809,19 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 
 - (void)resetLocallyModifiedKeys:(NSSet *)keys;
 {
-    NSMutableSet *newKeys = [self.keysThatHaveLocalModifications mutableCopy];
-    [newKeys minusSet:keys];
-    self.modifiedKeys = (newKeys.count == 0) ? nil : [newKeys copy];
+    ZMKeyMask keysToReset = [self.localModificationKeyIndex maskForKeys:keys];
+    self.locallyModifiedKeyMask = ZMKeyMaskMinus(self.locallyModifiedKeyMask, keysToReset);
 }
 
 - (void)setLocallyModifiedKeys:(NSSet *)keys;
 {
     VerifyReturn(keys != nil);
-    RequireString([keys isSubsetOfSet:self.keysTrackedForLocalModifications],
+    ZMKeyMask newKeys = [self.localModificationKeyIndex maskForKeys:keys];
+    RequireString(ZMKeyMaskCount(newKeys) == keys.count && ZMKeyMaskIsSubset(newKeys, self.trackedKeyMask),
                   "Trying to set keys that are not being tracked: %s",
                   [keys.allObjects componentsJoinedByString:@", "].UTF8String);
     
-    NSSet *newKeys = [self.keysThatHaveLocalModifications setByAddingObjectsFromSet:keys];
-    self.modifiedKeys = (newKeys.count == 0) ? nil : newKeys;
+    self.locallyModifiedKeyMask = ZMKeyMaskUnion(self.locallyModifiedKeyMask, newKeys);
 }
 
 - (BOOL)hasLocalModificationsForKeys:(NSSet *)keys;
@@ -514,24 +842,7 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 
 - (NSSet *)keysTrackedForLocalModifications;
 {
-    NSMutableSet *keys = [NSMutableSet set];
-    NSSet *ignoredKeys = self.ignoredKeys;
-    
-    [self.entity.attributesByName enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSAttributeDescription *attribute, BOOL *stop) {
-        NOT_USED(stop);
-        if (attribute.attributeType != NSUndefinedAttributeType && ! [ignoredKeys containsObject:key]) {
-            [keys addObject:key];
-        }
-    }];
-    
-    [self.entity.relationshipsByName enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSRelationshipDescription *relationship, BOOL *stop) {
-        NOT_USED(relationship);
-        NOT_USED(stop);
-        if (! [ignoredKeys containsObject:key]) {
-            [keys addObject:key];
-        }
-    }];
-    return keys;
+    return self.localModificationKeyIndex.trackedKeys;
 }
 
 
@@ -577,20 +888,26 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
 {
     [super awakeFromFetch];
     [self removeObsoleteKeys];
+    [self addToRemoteIdentifierIndex];
+}
+
+- (void)willTurnIntoFault
+{
+    [self removeFromRemoteIdentifierIndex];
+    [super willTurnIntoFault];
 }
 
 /// Removes keys that were previously tracked but are not tracked anymore from the modifiedKeys
 - (void)removeObsoleteKeys
 {
-    if (![self.class isTrackingLocalModifications]) {
+    if (![self.class isTrackingLocalModifications] || self.modifiedKeys == nil) {
         return;
     }
-    if (self.modifiedKeys == nil || [self.modifiedKeys isSubsetOfSet:self.keysTrackedForLocalModifications]) {
+    ZMKeyMask remainingKeys = ZMKeyMaskIntersection(self.locallyModifiedKeyMask, self.trackedKeyMask);
+    if (ZMKeyMaskCount(remainingKeys) == self.modifiedKeys.count) {
         return;
     }
-    NSMutableSet *remainingKeys = [self.modifiedKeys mutableCopy];
-    [remainingKeys intersectSet:self.keysTrackedForLocalModifications];
-    self.modifiedKeys = (remainingKeys.count == 0) ? nil : remainingKeys;
+    self.modifiedKeys = [self.localModificationKeyIndex keysForMask:remainingKeys];
 }
 
 - (void)updateKeysThatHaveLocalModifications;
@@ -598,13 +915,16 @@ static NSString * const KeysForCachedValuesKey = @"ZMKeysForCachedValues";
     if (![self.class isTrackingLocalModifications]) {
         return;
     }
-    NSSet *oldKeys = self.keysThatHaveLocalModifications;
-    NSMutableSet *newKeys = [oldKeys mutableCopy];
-    [newKeys addObjectsFromArray:self.filteredChangedValues.allKeys ?: @[]];
-    NSSet *filteredKeys = [self filterUpdatedLocallyModifiedKeys:newKeys];
-    if (! [oldKeys isEqualToSet:filteredKeys]) {
-        [self setKeysThatHaveLocalModifications:filteredKeys];
+    ZMLocalModificationKeyIndex *index = self.localModificationKeyIndex;
+    ZMKeyMask oldKeys = self.locallyModifiedKeyMask;
+    ZMKeyMask changedKeys = ZMKeyMaskIntersection([index maskForKeys:self.changedValues], self.trackedKeyMask);
+    ZMKeyMask newKeys = ZMKeyMaskUnion(oldKeys, changedKeys);
+    if (ZMKeyMaskIsEqual(oldKeys, newKeys)) {
+        return;
     }
+    // Only build a set for subclasses to filter when there are new keys
+    NSSet *filteredKeys = [self filterUpdatedLocallyModifiedKeys:[index keysForMask:newKeys]];
+    [self setKeysThatHaveLocalModifications:filteredKeys];
 }
 
 // Subclasses should override to conditionally exclude modified keys.
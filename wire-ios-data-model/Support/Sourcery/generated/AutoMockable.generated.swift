@@ -4563,6 +4563,21 @@ public class MockMLSServiceInterface: MLSServiceInterface {
         mock()
     }
 
+    // MARK: - scheduleCommitPendingProposals
+
+    public var scheduleCommitPendingProposalsInAt_Invocations: [(groupID: MLSGroupID, commitDate: Date)] = []
+    public var scheduleCommitPendingProposalsInAt_MockMethod: ((MLSGroupID, Date) async -> Void)?
+
+    public func scheduleCommitPendingProposals(in groupID: MLSGroupID, at commitDate: Date) async {
+        scheduleCommitPendingProposalsInAt_Invocations.append((groupID: groupID, commitDate: commitDate))
+
+        guard let mock = scheduleCommitPendingProposalsInAt_MockMethod else {
+            fatalError("no mock for `scheduleCommitPendingProposalsInAt`")
+        }
+
+        await mock(groupID, commitDate)
+    }
+
     // MARK: - commitPendingProposals
 
     public var commitPendingProposalsIn_Invocations: [MLSGroupID] = []
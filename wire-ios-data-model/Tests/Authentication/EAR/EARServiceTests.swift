@@ -291,6 +291,34 @@ final class EARServiceTests: ZMBaseManagedObjectTest, EARServiceDelegate {
         }
     }
 
+    func test_EnableEncryptionAtRest_KeepsKeysOfAnInterruptedMigration_IfTheyCantBeLoaded() throws {
+        // Given a migration was interrupted
+        uiMOC.encryptMessagesAtRest = false
+        let coordinator = try XCTUnwrap(uiMOC.persistentStoreCoordinator)
+        let store = try XCTUnwrap(coordinator.persistentStores.first)
+        var metadata = coordinator.metadata(for: store)
+        metadata[EncryptionAtRestMigration.checkpointMetadataKey] = [
+            "direction": EncryptionAtRestMigration.Direction.towardEncryptionAtRest.rawValue,
+            "checkpoints": [String: [String]]()
+        ]
+        coordinator.setMetadata(metadata, for: store)
+
+        // Mock
+        mockKeyGeneration()
+        keyRepository.fetchDatabaseKeyDescription_MockError = EARKeyRepositoryFailure.keyNotFound
+
+        // When
+        XCTAssertThrowsError(try sut.enableEncryptionAtRest(context: uiMOC, skipMigration: true))
+
+        // Then EAR is still disabled
+        XCTAssertFalse(uiMOC.encryptMessagesAtRest)
+        XCTAssertNil(uiMOC.databaseKey)
+
+        // Then no key was deleted or generated
+        XCTAssertTrue(keyRepository.deleteDatabaseKeyDescription_Invocations.isEmpty)
+        XCTAssertTrue(keyRepository.storeDatabaseKeyDescriptionKey_Invocations.isEmpty)
+    }
+
     // @SF.Storage @TSFI.FS-IOS @TSFI.Enclave-IOS @S0.1 @S0.2
     // Make sure that message content is encrypted when EAR is enabled
     func test_ExistingMessageContentIsEncrypted_WhenEarIsEnabled() throws {
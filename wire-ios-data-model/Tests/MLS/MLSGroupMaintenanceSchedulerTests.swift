@@ -0,0 +1,220 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+
+@testable import WireDataModel
+
+final class MLSGroupMaintenanceSchedulerTests: XCTestCase {
+
+    private var currentDate: Date!
+    private var sut: MLSGroupMaintenanceScheduler!
+
+    override func setUp() {
+        super.setUp()
+        currentDate = Date(timeIntervalSinceReferenceDate: 0)
+        sut = makeSUT(maximumConcurrentOperations: 8)
+    }
+
+    override func tearDown() {
+        sut = nil
+        currentDate = nil
+        super.tearDown()
+    }
+
+    private func makeSUT(maximumConcurrentOperations: Int) -> MLSGroupMaintenanceScheduler {
+        MLSGroupMaintenanceScheduler(
+            configuration: .init(
+                maximumConcurrentOperations: maximumConcurrentOperations,
+                initialBackoff: 30,
+                maximumBackoff: 120
+            ),
+            currentDate: { [unowned self] in currentDate }
+        )
+    }
+
+    /// Stands in for core crypto and the backend: every operation takes a little
+    /// while, and the number of operations running at the same time is tracked.
+    private actor MockGroupOperation {
+
+        private(set) var maintainedGroups = Set<MLSGroupID>()
+        private(set) var maximumConcurrentOperations = 0
+        private var concurrentOperations = 0
+        private let failingGroups: Set<MLSGroupID>
+
+        init(failingGroups: Set<MLSGroupID> = []) {
+            self.failingGroups = failingGroups
+        }
+
+        func perform(_ groupID: MLSGroupID) async throws {
+            concurrentOperations += 1
+            maximumConcurrentOperations = max(maximumConcurrentOperations, concurrentOperations)
+            defer { concurrentOperations -= 1 }
+
+            try await Task.sleep(nanoseconds: 1_000_000)
+
+            if failingGroups.contains(groupID) {
+                throw CommitError.failedToGenerateCommit
+            }
+
+            maintainedGroups.insert(groupID)
+        }
+
+    }
+
+    /// Records the groups in the order their operations finished.
+    private actor MaintenanceRecorder {
+
+        private(set) var maintainedGroups = [MLSGroupID]()
+
+        func record(_ groupID: MLSGroupID) {
+            maintainedGroups.append(groupID)
+        }
+
+    }
+
+    // MARK: - Concurrency
+
+    func testThatItMaintainsAThousandGroupsWithBoundedConcurrency() async {
+        // Given
+        let groups = (0..<1000).map { _ in MLSGroupID.random() }
+        let operation = MockGroupOperation()
+
+        // When
+        let start = Date()
+        let progress = await sut.run(groups: groups) { try await operation.perform($0) }
+        let duration = Date().timeIntervalSince(start)
+
+        // Then
+        let maintainedGroups = await operation.maintainedGroups
+        let maximumConcurrentOperations = await operation.maximumConcurrentOperations
+        XCTAssertEqual(maintainedGroups, Set(groups))
+        XCTAssertEqual(progress, MLSGroupMaintenanceProgress(total: 1000, succeeded: 1000))
+        XCTAssertTrue(progress.isFinished)
+        XCTAssertLessThanOrEqual(maximumConcurrentOperations, 8)
+        XCTAssertGreaterThan(maximumConcurrentOperations, 1)
+        print("maintained 1000 groups in \(duration)s, at most \(maximumConcurrentOperations) at a time")
+    }
+
+    func testThatItMaintainsEveryGroupExactlyOnceWhenOperationsFinishOutOfOrder() async {
+        // Given
+        let groups = (0..<200).map { _ in MLSGroupID.random() }
+        let recorder = MaintenanceRecorder()
+
+        // When every group takes a different time, so that later groups finish first
+        let progress = await sut.run(groups: groups) { groupID in
+            let index = groups.firstIndex(of: groupID) ?? 0
+            try await Task.sleep(nanoseconds: UInt64(8 - index % 8) * 200_000)
+            await recorder.record(groupID)
+        }
+
+        // Then
+        let maintainedGroups = await recorder.maintainedGroups
+        XCTAssertEqual(maintainedGroups.count, groups.count)
+        XCTAssertEqual(Set(maintainedGroups), Set(groups))
+        XCTAssertEqual(progress, MLSGroupMaintenanceProgress(total: 200, succeeded: 200))
+    }
+
+    func testThatItMaintainsGroupsInOrderWithAConcurrencyOfOne() async {
+        // Given
+        sut = makeSUT(maximumConcurrentOperations: 1)
+        let groups = (0..<20).map { _ in MLSGroupID.random() }
+        let recorder = MaintenanceRecorder()
+
+        // When
+        await sut.run(groups: groups) { await recorder.record($0) }
+
+        // Then
+        let maintainedGroups = await recorder.maintainedGroups
+        XCTAssertEqual(maintainedGroups, groups)
+    }
+
+    func testThatItMaintainsGroupsOneAtATimeWithAConcurrencyOfOne() async {
+        // Given
+        sut = makeSUT(maximumConcurrentOperations: 1)
+        let groups = (0..<20).map { _ in MLSGroupID.random() }
+        let operation = MockGroupOperation()
+
+        // When
+        await sut.run(groups: groups) { try await operation.perform($0) }
+
+        // Then
+        let maximumConcurrentOperations = await operation.maximumConcurrentOperations
+        XCTAssertEqual(maximumConcurrentOperations, 1)
+    }
+
+    func testThatItReportsProgress() async {
+        // Given
+        let failingGroup = MLSGroupID.random()
+        let groups = [MLSGroupID.random(), failingGroup, MLSGroupID.random()]
+        let operation = MockGroupOperation(failingGroups: [failingGroup])
+
+        // When
+        await sut.run(groups: groups) { try await operation.perform($0) }
+
+        // Then
+        let progress = await sut.progress
+        XCTAssertEqual(progress, MLSGroupMaintenanceProgress(total: 3, succeeded: 2, failed: 1))
+    }
+
+    // MARK: - Backoff
+
+    func testThatAFailedGroupIsDeferredUntilItsBackoffExpires() async {
+        // Given
+        let failingGroup = MLSGroupID.random()
+        let otherGroup = MLSGroupID.random()
+        await sut.run(groups: [failingGroup, otherGroup]) { try await MockGroupOperation(failingGroups: [failingGroup]).perform($0) }
+
+        // When
+        currentDate.addTimeInterval(29)
+        let deferredProgress = await sut.run(groups: [failingGroup, otherGroup]) { _ in }
+
+        // Then
+        XCTAssertEqual(deferredProgress, MLSGroupMaintenanceProgress(total: 2, succeeded: 1, deferred: 1))
+
+        // When
+        currentDate.addTimeInterval(1)
+        let retriedProgress = await sut.run(groups: [failingGroup, otherGroup]) { _ in }
+
+        // Then
+        XCTAssertEqual(retriedProgress, MLSGroupMaintenanceProgress(total: 2, succeeded: 2))
+        let isBackingOff = await sut.isBackingOff(failingGroup)
+        XCTAssertFalse(isBackingOff)
+    }
+
+    func testThatTheBackoffDoublesUpToTheMaximum() async {
+        // Given
+        let group = MLSGroupID.random()
+        let failingOperation = MockGroupOperation(failingGroups: [group])
+
+        for expectedBackoff: TimeInterval in [30, 60, 120, 120] {
+            // When
+            await sut.run(groups: [group]) { try await failingOperation.perform($0) }
+
+            // Then
+            currentDate.addTimeInterval(expectedBackoff - 1)
+            var isBackingOff = await sut.isBackingOff(group)
+            XCTAssertTrue(isBackingOff)
+
+            currentDate.addTimeInterval(1)
+            isBackingOff = await sut.isBackingOff(group)
+            XCTAssertFalse(isBackingOff)
+        }
+    }
+
+}
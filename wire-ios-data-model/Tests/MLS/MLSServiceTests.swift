@@ -105,7 +105,9 @@ final class MLSServiceTests: ZMConversationTestsBase, MLSServiceDelegate {
             syncStatus: mockSyncStatus,
             userID: userIdentifier,
             featureRepository: mockFeatureRepository,
-            subconversationGroupIDRepository: mockSubconversationGroupIDRepository
+            subconversationGroupIDRepository: mockSubconversationGroupIDRepository,
+            // The generated mocks aren't thread safe, so maintain one group at a time.
+            groupMaintenanceConfiguration: .init(maximumConcurrentOperations: 1)
         )
     }
 
@@ -737,6 +739,46 @@ final class MLSServiceTests: ZMConversationTestsBase, MLSServiceDelegate {
         XCTAssertEqual(processConversationEventsCalls, [[updateEvent1], [updateEvent2]])
     }
 
+    func test_CommitPendingProposals_BeforeAddingMembersToConversation_CancelsTheScheduledCommit() async throws {
+        // Given
+        let groupID = MLSGroupID.random()
+        let futureCommitDate = Date().addingTimeInterval(1)
+
+        await uiMOC.perform { [self] in
+            // A group with pending proposal in the future
+            let conversation = createConversation(in: uiMOC)
+            conversation.mlsGroupID = groupID
+            conversation.commitPendingProposalDate = futureCommitDate
+        }
+
+        // Mock no subconversations
+        mockSubconversationGroupIDRepository.fetchSubconversationGroupIDForTypeParentGroupID_MockValue = .some(nil)
+
+        await sut.scheduleCommitPendingProposals(in: groupID, at: futureCommitDate)
+
+        // Mock commiting a pending proposal
+        var mockCommitPendingProposalsArgument = [MLSGroupID]()
+        mockMLSActionExecutor.mockCommitPendingProposals = {
+            mockCommitPendingProposalsArgument.append($0)
+            return []
+        }
+
+        // Mock claiming a key package and adding members.
+        let domain = "example.com"
+        let mlsUser = [MLSUser(id: .create(), domain: domain)]
+        mockActionsProvider.claimKeyPackagesUserIDDomainCiphersuiteExcludedSelfClientIDIn_MockMethod = { userID, _, _, _, _ in
+            [self.createKeyPackage(userID: userID, domain: domain)]
+        }
+        mockMLSActionExecutor.mockAddMembers = { _, _ in [] }
+
+        // When
+        try await sut.addMembersToConversation(with: mlsUser, for: groupID)
+        await sut.commitPendingProposals()
+
+        // Then the proposals were only committed before adding the members.
+        XCTAssertEqual(mockCommitPendingProposalsArgument, [groupID])
+    }
+
     func test_AddingMembersToConversation_ThrowsNoParticipantsToAdd() async {
         // Given
         let mlsGroupID = MLSGroupID(Data([1, 2, 3]))
@@ -1445,6 +1487,57 @@ final class MLSServiceTests: ZMConversationTestsBase, MLSServiceDelegate {
         await fulfillment(of: Array(expectations.values), timeout: 1.5)
     }
 
+    func test_RepairOutOfSyncConversations_RejoinsAllOutOfSyncConversationsInOrder() async throws {
+        // GIVEN thirty conversations, every third of which is in sync
+        let conversationAndOutOfSyncTuples = await uiMOC.perform { [self] in
+            (0..<30).map { createConversation(outOfSync: $0 % 3 != 0) }
+        }
+
+        let (localEpochs, expectedGroupIDs) = await uiMOC.perform { [self] () -> ([Data: UInt64], [MLSGroupID]) in
+            uiMOC.saveOrRollback()
+
+            let localEpochs = conversationAndOutOfSyncTuples.reduce(into: [Data: UInt64]()) { localEpochs, tuple in
+                guard let groupID = tuple.conversation.mlsGroupID else { return }
+                localEpochs[groupID.data] = tuple.isOutOfSync ? tuple.conversation.epoch - 1 : tuple.conversation.epoch
+            }
+
+            let outOfSyncGroupIDs = Set(conversationAndOutOfSyncTuples.filter(\.isOutOfSync).compactMap(\.conversation.mlsGroupID))
+            let expectedGroupIDs = ZMConversation.fetchMLSConversations(in: uiMOC)
+                .compactMap(\.mlsGroupID)
+                .filter(outOfSyncGroupIDs.contains)
+
+            return (localEpochs, expectedGroupIDs)
+        }
+
+        // mock the local epochs
+        mockCoreCrypto.conversationEpochConversationId_MockMethod = { localEpochs[$0] ?? 0 }
+
+        // mock fetching group info
+        mockActionsProvider.fetchConversationGroupInfoConversationIdDomainSubgroupTypeContext_MockValue = Data()
+
+        // mock joining group
+        var joinedGroupIDs = [MLSGroupID]()
+        mockMLSActionExecutor.mockJoinGroup = { groupID, _ in
+            joinedGroupIDs.append(groupID)
+            return []
+        }
+
+        // WHEN
+        try await sut.repairOutOfSyncConversations()
+
+        // THEN every out of sync conversation was rejoined once, in the order it was fetched
+        XCTAssertEqual(expectedGroupIDs.count, 20)
+        XCTAssertEqual(joinedGroupIDs, expectedGroupIDs)
+
+        // Every local epoch was read once
+        let epochInvocations = mockCoreCrypto.conversationEpochConversationId_Invocations
+        XCTAssertEqual(epochInvocations.count, Set(epochInvocations).count)
+        XCTAssertTrue(Set(localEpochs.keys).isSubset(of: epochInvocations))
+
+        let progress = await sut.outOfSyncRepairProgress
+        XCTAssertEqual(progress, MLSGroupMaintenanceProgress(total: 20, succeeded: 20))
+    }
+
     func test_FetchAndRepairConversation_RejoinsOutOfSyncConversation() async throws {
         // GIVEN
         let conversation = await uiMOC.perform({ self.createConversation(outOfSync: true).conversation })
@@ -1919,6 +2012,64 @@ final class MLSServiceTests: ZMConversationTestsBase, MLSServiceDelegate {
         )
     }
 
+    func test_UpdateKeyMaterial_ForAThousandGroups() async throws {
+        // Given a thousand stale groups, one of which fails.
+        let groups = (0..<1000).map { _ in MLSGroupID.random() }
+        let failingGroup = try XCTUnwrap(groups.first)
+
+        mockMLSActionExecutor.mockCommitPendingProposals = { _ in
+            throw CommitError.noPendingProposals
+        }
+
+        let staleKeyMaterialDetector = ThreadSafeStaleMLSKeyDetector(groupsWithStaleKeyingMaterial: Set(groups))
+        sut = MLSService(
+            context: uiMOC,
+            notificationContext: uiMOC.notificationContext,
+            coreCryptoProvider: mockCoreCryptoProvider,
+            encryptionService: mockEncryptionService,
+            decryptionService: mockDecryptionService,
+            mlsActionExecutor: mockMLSActionExecutor,
+            conversationEventProcessor: NoOpConversationEventProcessor(),
+            staleKeyMaterialDetector: staleKeyMaterialDetector,
+            userDefaults: userDefaultsTestSuite,
+            actionsProvider: mockActionsProvider,
+            delegate: self,
+            syncStatus: mockSyncStatus,
+            userID: userIdentifier,
+            featureRepository: mockFeatureRepository,
+            subconversationGroupIDRepository: mockSubconversationGroupIDRepository,
+            groupMaintenanceConfiguration: .init(maximumConcurrentOperations: 8)
+        )
+
+        let lock = NSLock()
+        var updatedGroups = Set<MLSGroupID>()
+        mockMLSActionExecutor.mockUpdateKeyMaterial = { groupID in
+            try await Task.sleep(nanoseconds: 1_000_000)
+
+            guard groupID != failingGroup else {
+                throw CommitError.failedToSendCommit(recovery: .giveUp, cause: .mlsStaleMessage)
+            }
+
+            lock.lock()
+            defer { lock.unlock() }
+            updatedGroups.insert(groupID)
+            return []
+        }
+
+        keyMaterialUpdatedExpectation = customExpectation(description: "did update key material")
+
+        // When
+        await sut.updateKeyMaterialForAllStaleGroupsIfNeeded()
+
+        // Then
+        XCTAssertTrue(waitForCustomExpectations(withTimeout: 5))
+        XCTAssertEqual(updatedGroups, Set(groups).subtracting([failingGroup]))
+        XCTAssertEqual(staleKeyMaterialDetector.updatedGroups, updatedGroups)
+
+        let progress = await sut.keyMaterialUpdateProgress
+        XCTAssertEqual(progress, MLSGroupMaintenanceProgress(total: 1000, succeeded: 999, failed: 1))
+    }
+
     // Note: these tests are asserting the behavior of the retry mechanism only, which
     // is used in various operations, such as adding members or removing clients. For
     // these tests, we will just pick one operation.
@@ -2989,3 +3140,40 @@ final class MLSServiceTests: ZMConversationTestsBase, MLSServiceDelegate {
         )
     }
 }
+
+// MARK: - Thread safe stand-ins
+
+/// Groups are maintained concurrently, which the generated mocks don't support.
+private final class ThreadSafeStaleMLSKeyDetector: StaleMLSKeyDetectorProtocol {
+
+    private let lock = NSLock()
+    private var _updatedGroups = Set<MLSGroupID>()
+
+    var refreshIntervalInDays: UInt = 90
+    let groupsWithStaleKeyingMaterial: Set<MLSGroupID>
+
+    var updatedGroups: Set<MLSGroupID> {
+        lock.lock()
+        defer { lock.unlock() }
+        return _updatedGroups
+    }
+
+    init(groupsWithStaleKeyingMaterial: Set<MLSGroupID>) {
+        self.groupsWithStaleKeyingMaterial = groupsWithStaleKeyingMaterial
+    }
+
+    func keyingMaterialUpdated(for groupID: MLSGroupID) {
+        lock.lock()
+        defer { lock.unlock() }
+        _updatedGroups.insert(groupID)
+    }
+
+}
+
+private final class NoOpConversationEventProcessor: ConversationEventProcessorProtocol {
+
+    func processConversationEvents(_ events: [ZMUpdateEvent]) async {}
+
+    func processAndSaveConversationEvents(_ events: [ZMUpdateEvent]) async {}
+
+}
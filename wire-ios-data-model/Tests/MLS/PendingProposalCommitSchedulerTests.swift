@@ -0,0 +1,384 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+
+@testable import WireDataModel
+
+final class PendingProposalCommitSchedulerTests: XCTestCase {
+
+    private let startDate = Date(timeIntervalSinceReferenceDate: 0)
+    private let batchingInterval: TimeInterval = 1
+
+    private var clock: VirtualClock!
+    private var recorder: CommitRecorder!
+    private var sut: PendingProposalCommitScheduler!
+
+    override func setUp() {
+        super.setUp()
+        let clock = VirtualClock(now: startDate)
+        let recorder = CommitRecorder()
+        self.clock = clock
+        self.recorder = recorder
+        sut = PendingProposalCommitScheduler(
+            clock: clock,
+            batchingInterval: batchingInterval
+        ) { groupIDs in
+            await recorder.record(groupIDs, at: clock.now)
+        }
+    }
+
+    override func tearDown() {
+        sut = nil
+        recorder = nil
+        clock = nil
+        super.tearDown()
+    }
+
+    // MARK: - Helpers
+
+    private func groupID(_ index: Int) -> MLSGroupID {
+        MLSGroupID(withUnsafeBytes(of: UInt32(index).bigEndian) { Data($0) })
+    }
+
+    private func advance(by interval: TimeInterval) async {
+        clock.advance(to: clock.now.addingTimeInterval(interval))
+        await sut.waitUntilCaughtUp()
+    }
+
+    // MARK: - Scheduling
+
+    func test_ItCommitsWhenTheCommitIsDue() async {
+        // Given
+        await sut.schedule(groupID(1), at: startDate.addingTimeInterval(10))
+
+        // When
+        await advance(by: 9)
+
+        // Then
+        var batches = await recorder.batches
+        XCTAssertTrue(batches.isEmpty)
+
+        // When
+        await advance(by: 1)
+
+        // Then
+        batches = await recorder.batches
+        XCTAssertEqual(batches, [[groupID(1)]])
+        let scheduledCount = await sut.scheduledCount
+        XCTAssertEqual(scheduledCount, 0)
+    }
+
+    func test_ItBatchesCommitsThatFallDueTogether() async {
+        // Given
+        await sut.schedule([
+            (groupID(1), startDate.addingTimeInterval(10)),
+            (groupID(2), startDate.addingTimeInterval(10.5)),
+            (groupID(3), startDate.addingTimeInterval(20))
+        ])
+
+        // When
+        await advance(by: 10)
+
+        // Then
+        var batches = await recorder.batches
+        XCTAssertEqual(batches.map(Set.init), [[groupID(1), groupID(2)]])
+
+        // When
+        await advance(by: 10)
+
+        // Then
+        batches = await recorder.batches
+        XCTAssertEqual(batches.count, 2)
+        XCTAssertEqual(batches.last, [groupID(3)])
+    }
+
+    func test_SchedulingAnEarlierCommit_RearmsTheWakeup() async {
+        // Given
+        await sut.schedule(groupID(1), at: startDate.addingTimeInterval(60))
+
+        // When
+        await sut.schedule(groupID(2), at: startDate.addingTimeInterval(10))
+        await advance(by: 10)
+
+        // Then
+        let batches = await recorder.batches
+        XCTAssertEqual(batches, [[groupID(2)]])
+        let wakeupCount = await sut.wakeupCount
+        XCTAssertEqual(wakeupCount, 3)
+    }
+
+    func test_SchedulingALaterCommit_KeepsTheWakeup() async {
+        // Given
+        await sut.schedule(groupID(1), at: startDate.addingTimeInterval(10))
+
+        // When
+        await sut.schedule(groupID(2), at: startDate.addingTimeInterval(60))
+
+        // Then
+        let wakeupCount = await sut.wakeupCount
+        XCTAssertEqual(wakeupCount, 1)
+    }
+
+    func test_ReschedulingAGroup_ReplacesItsCommit() async {
+        // Given
+        await sut.schedule(groupID(1), at: startDate.addingTimeInterval(10))
+
+        // When
+        await sut.schedule(groupID(1), at: startDate.addingTimeInterval(30))
+        await advance(by: 10)
+
+        // Then
+        var batches = await recorder.batches
+        XCTAssertTrue(batches.isEmpty)
+
+        // When
+        await advance(by: 20)
+
+        // Then
+        batches = await recorder.batches
+        XCTAssertEqual(batches, [[groupID(1)]])
+    }
+
+    func test_CancelledCommits_AreNotCommitted() async {
+        // Given
+        await sut.schedule(groupID(1), at: startDate.addingTimeInterval(10))
+        await sut.schedule(groupID(2), at: startDate.addingTimeInterval(20))
+
+        // When
+        await sut.cancel(groupID(1))
+        await advance(by: 20)
+
+        // Then
+        let batches = await recorder.batches
+        XCTAssertEqual(batches, [[groupID(2)]])
+    }
+
+    func test_UnscheduledCommits_SkipsGroupsScheduledForTheSameDate() async {
+        // Given
+        await sut.schedule([
+            (groupID(1), startDate.addingTimeInterval(10)),
+            (groupID(2), startDate.addingTimeInterval(10))
+        ])
+
+        // When
+        let commits = await sut.unscheduledCommits(in: [
+            (groupID(1), startDate.addingTimeInterval(10)),
+            (groupID(2), startDate.addingTimeInterval(20)),
+            (groupID(3), startDate.addingTimeInterval(10))
+        ])
+
+        // Then
+        XCTAssertEqual(commits.map(\.groupID), [groupID(2), groupID(3)])
+    }
+
+    func test_WaitUntilIdle_ReturnsOnceEveryCommitIsDone() async {
+        // Given
+        await sut.schedule(groupID(1), at: startDate.addingTimeInterval(10))
+
+        let idle = XCTestExpectation(description: "idle")
+        Task { [sut] in
+            await sut!.waitUntilIdle()
+            idle.fulfill()
+        }
+
+        // When
+        clock.advance(to: startDate.addingTimeInterval(10))
+
+        // Then
+        await fulfillment(of: [idle], timeout: 5)
+        let batches = await recorder.batches
+        XCTAssertEqual(batches, [[groupID(1)]])
+    }
+
+    // MARK: - Simulation
+
+    func test_ItCommitsThousandsOfPendingProposalsOnTime() async {
+        // Given proposals arriving over an hour, each with a commit delay of up to a minute.
+        let groupCount = 5000
+        let step: TimeInterval = 0.25
+        var generator = SeededRandomNumberGenerator(seed: 42)
+
+        var dueDates = [MLSGroupID: Date]()
+        var arrivals = [(arrivalDate: Date, groupID: MLSGroupID, commitDate: Date)]()
+
+        for index in 0 ..< groupCount {
+            let arrivalDate = startDate.addingTimeInterval(.random(in: 0 ..< 3600, using: &generator))
+            let commitDate = arrivalDate.addingTimeInterval(.random(in: 0 ..< 60, using: &generator))
+            dueDates[groupID(index)] = commitDate
+            arrivals.append((arrivalDate, groupID(index), commitDate))
+        }
+
+        arrivals.sort { $0.arrivalDate < $1.arrivalDate }
+
+        // When the clock ticks, scheduling commits as the proposals arrive.
+        var nextArrival = 0
+
+        while clock.now < startDate.addingTimeInterval(3600 + 60 + step) {
+            var commits = [(groupID: MLSGroupID, commitDate: Date)]()
+
+            while nextArrival < arrivals.count, arrivals[nextArrival].arrivalDate <= clock.now {
+                commits.append((arrivals[nextArrival].groupID, arrivals[nextArrival].commitDate))
+                nextArrival += 1
+            }
+
+            await sut.schedule(commits)
+            await sut.waitUntilCaughtUp()
+            await advance(by: step)
+        }
+
+        // Then every group was committed once, on time.
+        let commitDates = await recorder.commitDates
+        XCTAssertEqual(commitDates.count, groupCount)
+
+        for (groupID, dates) in commitDates {
+            guard let dueDate = dueDates[groupID], let commitDate = dates.first else {
+                XCTFail("unexpected commit")
+                continue
+            }
+
+            XCTAssertEqual(dates.count, 1)
+            XCTAssertGreaterThanOrEqual(commitDate, dueDate.addingTimeInterval(-batchingInterval))
+            XCTAssertLessThanOrEqual(commitDate, dueDate.addingTimeInterval(step))
+        }
+
+        // Then commits were batched, with about one wakeup per batch.
+        let batches = await recorder.batches
+        let wakeupCount = await sut.wakeupCount
+        XCTAssertLessThan(batches.count, groupCount * 3 / 4)
+        XCTAssertLessThanOrEqual(wakeupCount, 2 * batches.count)
+        XCTAssertLessThanOrEqual(clock.sleepCount, wakeupCount)
+
+        let scheduledCount = await sut.scheduledCount
+        XCTAssertEqual(scheduledCount, 0)
+    }
+
+}
+
+// MARK: - Virtual clock
+
+/// A clock that only moves when told to. Sleepers are resumed once the clock
+/// is advanced past the date they wait for.
+private final class VirtualClock: PendingProposalCommitClock, @unchecked Sendable {
+
+    private struct Sleeper {
+
+        let id: UUID
+        let date: Date
+        let continuation: CheckedContinuation<Void, Error>
+
+    }
+
+    private let lock = NSLock()
+    private var currentDate: Date
+    private var sleepers = [Sleeper]()
+    private var _sleepCount = 0
+
+    init(now: Date) {
+        currentDate = now
+    }
+
+    var now: Date {
+        lock.lock()
+        defer { lock.unlock() }
+        return currentDate
+    }
+
+    /// The number of sleeps that actually had to wait.
+    var sleepCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return _sleepCount
+    }
+
+    func sleep(until date: Date) async throws {
+        let id = UUID()
+
+        try await withTaskCancellationHandler {
+            try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+                lock.lock()
+
+                if Task.isCancelled {
+                    lock.unlock()
+                    continuation.resume(throwing: CancellationError())
+                } else if date <= currentDate {
+                    lock.unlock()
+                    continuation.resume()
+                } else {
+                    sleepers.append(Sleeper(id: id, date: date, continuation: continuation))
+                    _sleepCount += 1
+                    lock.unlock()
+                }
+            }
+        } onCancel: {
+            lock.lock()
+            let index = sleepers.firstIndex { $0.id == id }
+            let sleeper = index.map { sleepers.remove(at: $0) }
+            lock.unlock()
+
+            sleeper?.continuation.resume(throwing: CancellationError())
+        }
+    }
+
+    func advance(to date: Date) {
+        lock.lock()
+        currentDate = max(currentDate, date)
+        let dueSleepers = sleepers.filter { $0.date <= currentDate }
+        sleepers.removeAll { $0.date <= currentDate }
+        lock.unlock()
+
+        dueSleepers.forEach { $0.continuation.resume() }
+    }
+
+}
+
+// MARK: - Helpers
+
+private actor CommitRecorder {
+
+    private(set) var batches = [[MLSGroupID]]()
+    private(set) var commitDates = [MLSGroupID: [Date]]()
+
+    func record(_ groupIDs: [MLSGroupID], at date: Date) {
+        batches.append(groupIDs)
+
+        for groupID in groupIDs {
+            commitDates[groupID, default: []].append(date)
+        }
+    }
+
+}
+
+/// A SplitMix64 generator, so the simulation is the same on every run.
+private struct SeededRandomNumberGenerator: RandomNumberGenerator {
+
+    private var state: UInt64
+
+    init(seed: UInt64) {
+        state = seed
+    }
+
+    mutating func next() -> UInt64 {
+        state &+= 0x9E37_79B9_7F4A_7C15
+        var z = state
+        z = (z ^ (z >> 30)) &* 0xBF58_476D_1CE4_E5B9
+        z = (z ^ (z >> 27)) &* 0x94D0_49BB_1331_11EB
+        return z ^ (z >> 31)
+    }
+
+}
@@ -0,0 +1,69 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+@testable import WireDataModel
+
+class CoreDataStackTests_EventProcessing: ZMTBaseTest {
+
+    let account: Account = Account(userName: "", userIdentifier: UUID())
+
+    var applicationContainer: URL {
+        return FileManager.default
+            .urls(for: .applicationSupportDirectory, in: .userDomainMask)
+            .first!
+            .appendingPathComponent("CoreDataStackTests")
+    }
+
+    func testThatItLoadsBothStoresForEventProcessing() throws {
+        // given
+        let sut = CoreDataStack(account: account,
+                                applicationContainer: applicationContainer,
+                                inMemoryStore: true,
+                                dispatchGroup: dispatchGroup)
+
+        // when
+        try sut.loadStoresForEventProcessing()
+
+        // then
+        XCTAssertFalse(sut.messagesContainer.persistentStoreCoordinator.persistentStores.isEmpty)
+        XCTAssertFalse(sut.eventsContainer.persistentStoreCoordinator.persistentStores.isEmpty)
+        XCTAssertTrue(sut.syncContext.zm_isSyncContext)
+        XCTAssertTrue(sut.viewContext.zm_isUserInterfaceContext)
+        XCTAssertTrue(sut.viewContext.registeredObjects.isEmpty)
+    }
+
+    func testThatTheSyncContextCanBeUsedAfterLoadingStoresForEventProcessing() throws {
+        // given
+        let sut = CoreDataStack(account: account,
+                                applicationContainer: applicationContainer,
+                                inMemoryStore: true,
+                                dispatchGroup: dispatchGroup)
+        try sut.loadStoresForEventProcessing()
+
+        // when
+        var selfUser: ZMUser?
+        sut.syncContext.performAndWait {
+            selfUser = ZMUser.selfUser(in: sut.syncContext)
+        }
+
+        // then
+        XCTAssertNotNil(selfUser)
+    }
+
+}
@@ -0,0 +1,273 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+
+@testable import WireDataModel
+
+final class EncryptionAtRestMigrationTests: ZMBaseManagedObjectTest {
+
+    private var databaseKey: VolatileData!
+
+    override func setUp() {
+        super.setUp()
+
+        createSelfClient(onMOC: uiMOC)
+        uiMOC.encryptMessagesAtRest = false
+        databaseKey = validDatabaseKey
+    }
+
+    override func tearDown() {
+        uiMOC.databaseKey = nil
+        databaseKey = nil
+        super.tearDown()
+    }
+
+    // MARK: - Migration
+
+    func testThatItMigratesAllInstancesInPartitions() throws {
+        // Given
+        let messages = try createMessageData(count: 25)
+        let sut = makeSUT(partitionSize: 10)
+
+        // When
+        try sut.migrate(ZMGenericMessageData.self)
+
+        // Then
+        enableEncryptionAtRest()
+
+        for (index, message) in messages.enumerated() {
+            XCTAssertTrue(message.isEncrypted)
+            XCTAssertEqual(message.underlyingMessage?.text.content, "Message \(index)")
+        }
+    }
+
+    func testThatItMigratesAwayFromEncryptionAtRest() throws {
+        // Given
+        let messages = try createMessageData(count: 25)
+        try makeSUT(partitionSize: 10).migrate(ZMGenericMessageData.self)
+        let sut = makeSUT(direction: .awayFromEncryptionAtRest, partitionSize: 10)
+
+        // When
+        try sut.migrate(ZMGenericMessageData.self)
+
+        // Then
+        for (index, message) in messages.enumerated() {
+            XCTAssertFalse(message.isEncrypted)
+            XCTAssertEqual(message.underlyingMessage?.text.content, "Message \(index)")
+        }
+    }
+
+    func testThatItReportsProgress() throws {
+        // Given
+        try createMessageData(count: 25)
+        var progress: [EncryptionAtRestMigrationProgress] = []
+        let lock = NSLock()
+
+        let sut = makeSUT(partitionSize: 10) {
+            lock.lock()
+            progress.append($0)
+            lock.unlock()
+        }
+
+        // When
+        try sut.migrate(ZMGenericMessageData.self)
+
+        // Then
+        XCTAssertEqual(progress.count, 3)
+        XCTAssertEqual(progress.map(\.migratedObjects).max(), 25)
+        XCTAssertTrue(progress.allSatisfy { $0.totalObjects == 25 })
+    }
+
+    // MARK: - Resuming
+
+    func testThatItResumesAnInterruptedMigration() throws {
+        // Given some instances were migrated and checkpointed before an interruption
+        let messages = try createMessageData(count: 25)
+        let migratedMessages = messages.prefix(10)
+
+        for message in migratedMessages {
+            try message.migrateTowardEncryptionAtRest(in: uiMOC, key: databaseKey)
+        }
+
+        let primaryKeys = migratedMessages.map { EncryptionAtRestMigration.primaryKey(of: $0.objectID) }
+        try writeCheckpoint(
+            "\(primaryKeys.min()!)-\(primaryKeys.max()!)",
+            entityName: ZMGenericMessageData.entityName()
+        )
+        uiMOC.saveOrRollback()
+
+        XCTAssertTrue(uiMOC.hasInterruptedMigrationTowardEncryptionAtRest)
+
+        // When
+        try uiMOC.migrateTowardEncryptionAtRest(databaseKey: databaseKey)
+
+        // Then nothing was encrypted twice
+        enableEncryptionAtRest()
+
+        for (index, message) in messages.enumerated() {
+            XCTAssertEqual(message.underlyingMessage?.text.content, "Message \(index)")
+        }
+
+        XCTAssertFalse(uiMOC.hasInterruptedMigrationTowardEncryptionAtRest)
+    }
+
+    func testThatItMigratesInstancesChangedInACheckpointedRange() throws {
+        // Given a checkpointed range in which one instance wasn't migrated,
+        // e.g. because it was inserted after the range was saved
+        let messages = try createMessageData(count: 5)
+
+        for message in messages.dropLast() {
+            try message.migrateTowardEncryptionAtRest(in: uiMOC, key: databaseKey)
+        }
+
+        let primaryKeys = messages.map { EncryptionAtRestMigration.primaryKey(of: $0.objectID) }
+        try writeCheckpoint(
+            "\(primaryKeys.min()!)-\(primaryKeys.max()!)",
+            entityName: ZMGenericMessageData.entityName()
+        )
+        uiMOC.saveOrRollback()
+
+        // When
+        try makeSUT(partitionSize: 10).migrate(ZMGenericMessageData.self)
+
+        // Then every instance is encrypted exactly once
+        XCTAssertTrue(messages.allSatisfy(\.isEncrypted))
+        enableEncryptionAtRest()
+
+        for (index, message) in messages.enumerated() {
+            XCTAssertEqual(message.underlyingMessage?.text.content, "Message \(index)")
+        }
+    }
+
+    func testThatItOnlyMigratesInstancesOutsideOfSeveralCheckpoints() throws {
+        // Given two checkpointed ranges with a gap between them, recorded out of order
+        let messages = try createMessageData(count: 10).sorted {
+            EncryptionAtRestMigration.primaryKey(of: $0.objectID) < EncryptionAtRestMigration.primaryKey(of: $1.objectID)
+        }
+        let firstRange = messages[0..<3]
+        let secondRange = messages[6..<10]
+
+        for message in firstRange + secondRange {
+            try message.migrateTowardEncryptionAtRest(in: uiMOC, key: databaseKey)
+        }
+
+        let checkpoints = [secondRange, firstRange].map { range in
+            let primaryKeys = range.map { EncryptionAtRestMigration.primaryKey(of: $0.objectID) }
+            return "\(primaryKeys.min()!)-\(primaryKeys.max()!)"
+        }
+        try writeCheckpoint(checkpoints[0], checkpoints[1], entityName: ZMGenericMessageData.entityName())
+        uiMOC.saveOrRollback()
+
+        // When
+        try makeSUT(partitionSize: 2).migrate(ZMGenericMessageData.self)
+
+        // Then the gap was migrated and nothing was encrypted twice
+        XCTAssertTrue(messages.allSatisfy(\.isEncrypted))
+        enableEncryptionAtRest()
+
+        for message in messages {
+            XCTAssertTrue(message.underlyingMessage?.text.content.hasPrefix("Message ") ?? false)
+        }
+    }
+
+    func testThatItIgnoresCheckpointsOfTheOtherDirection() throws {
+        // Given
+        let messages = try createMessageData(count: 5)
+        let primaryKeys = messages.map { EncryptionAtRestMigration.primaryKey(of: $0.objectID) }
+        try writeCheckpoint(
+            "\(primaryKeys.min()!)-\(primaryKeys.max()!)",
+            entityName: ZMGenericMessageData.entityName(),
+            direction: .awayFromEncryptionAtRest
+        )
+
+        // When
+        try makeSUT(partitionSize: 10).migrate(ZMGenericMessageData.self)
+
+        // Then
+        XCTAssertTrue(messages.allSatisfy(\.isEncrypted))
+    }
+
+    // MARK: - Performance
+
+    /// Accounts can have millions of messages, raise the count locally to
+    /// benchmark such stores.
+    func testPerformanceOfMigratingMessages() throws {
+        // Given
+        try createMessageData(count: 10000)
+
+        measureMetrics([.wallClockTime], automaticallyStartMeasuring: false) {
+            uiMOC.encryptMessagesAtRest = false
+            try? uiMOC.migrateAwayFromEncryptionAtRest(databaseKey: databaseKey)
+
+            // When
+            startMeasuring()
+            XCTAssertNoThrow(try uiMOC.migrateTowardEncryptionAtRest(databaseKey: databaseKey))
+            stopMeasuring()
+        }
+    }
+
+    // MARK: - Helpers
+
+    private func makeSUT(
+        direction: EncryptionAtRestMigration.Direction = .towardEncryptionAtRest,
+        partitionSize: Int,
+        progressHandler: ((EncryptionAtRestMigrationProgress) -> Void)? = nil
+    ) -> EncryptionAtRestMigration {
+        EncryptionAtRestMigration(
+            context: uiMOC,
+            direction: direction,
+            key: databaseKey,
+            partitionSize: partitionSize,
+            progressHandler: progressHandler
+        )
+    }
+
+    @discardableResult
+    private func createMessageData(count: Int) throws -> [ZMGenericMessageData] {
+        let messages = try (0..<count).map { index in
+            let messageData = ZMGenericMessageData.insertNewObject(in: uiMOC)
+            try messageData.setGenericMessage(GenericMessage(content: Text(content: "Message \(index)")))
+            return messageData
+        }
+
+        uiMOC.saveOrRollback()
+        return messages
+    }
+
+    private func enableEncryptionAtRest() {
+        uiMOC.encryptMessagesAtRest = true
+        uiMOC.databaseKey = databaseKey
+    }
+
+    private func writeCheckpoint(
+        _ checkpoints: String...,
+        entityName: String,
+        direction: EncryptionAtRestMigration.Direction = .towardEncryptionAtRest
+    ) throws {
+        let coordinator = try XCTUnwrap(uiMOC.persistentStoreCoordinator)
+        let store = try XCTUnwrap(coordinator.persistentStores.first)
+        var metadata = coordinator.metadata(for: store)
+        metadata[EncryptionAtRestMigration.checkpointMetadataKey] = [
+            "direction": direction.rawValue,
+            "checkpoints": [entityName: checkpoints]
+        ]
+        coordinator.setMetadata(metadata, for: store)
+    }
+
+}
@@ -0,0 +1,119 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+
+@testable import WireDataModel
+
+final class FetchRequestTemplateCacheTests: ZMBaseManagedObjectTest {
+
+    func testThatItParsesATemplateOnlyOnce() {
+        // given
+        let sut = FetchRequestTemplateCache()
+        var templateCount = 0
+        let template = { () -> NSPredicate in
+            templateCount += 1
+            return NSPredicate(format: "name == $NAME")
+        }
+
+        // when
+        let first = sut.predicate(templateNamed: "name", substitutionVariables: ["NAME": "Alice"], template: template)
+        let second = sut.predicate(templateNamed: "name", substitutionVariables: ["NAME": "Bob"], template: template)
+
+        // then
+        XCTAssertEqual(templateCount, 1)
+        XCTAssertEqual(sut.count, 1)
+        XCTAssertEqual(first, NSPredicate(format: "name == %@", "Alice"))
+        XCTAssertEqual(second, NSPredicate(format: "name == %@", "Bob"))
+    }
+
+    func testThatItRanksTheTemplatesByTotalDuration() {
+        // given
+        let sut = FetchRequestTemplateCache()
+
+        // when
+        sut.recordFetch(templateNamed: "cheap", duration: 0.001)
+        sut.recordFetch(templateNamed: "cheap", duration: 0.001)
+        sut.recordFetch(templateNamed: "expensive", duration: 0.01)
+
+        // then
+        XCTAssertEqual(sut.statistics.map(\.name), ["expensive", "cheap"])
+        XCTAssertEqual(sut.statistics.last?.fetchCount, 2)
+        XCTAssertEqual(sut.statistics.last?.averageDuration ?? 0, 0.001, accuracy: 0.0001)
+
+        // when
+        sut.resetStatistics()
+
+        // then
+        XCTAssertTrue(sut.statistics.isEmpty)
+    }
+
+    func testThatItRecordsTheFetchesByRemoteIdentifier() {
+        // given
+        let uuid = UUID.create()
+        let conversation = ZMConversation.insertNewObject(in: uiMOC)
+        conversation.remoteIdentifier = uuid
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        uiMOC.refresh(conversation, mergeChanges: false)
+
+        // when
+        let fetched = ZMConversation.fetch(with: uuid, in: uiMOC)
+
+        // then
+        XCTAssertEqual(fetched, conversation)
+        let statistics = uiMOC.fetchRequestTemplateCache.statistics
+        XCTAssertEqual(statistics.map(\.name), ["\(ZMConversation.entityName()).remoteIdentifier"])
+        XCTAssertEqual(statistics.first?.fetchCount, 1)
+    }
+
+    func testThatTheCacheIsKeptPerContext() {
+        XCTAssertTrue(uiMOC.fetchRequestTemplateCache === uiMOC.fetchRequestTemplateCache)
+        XCTAssertFalse(uiMOC.fetchRequestTemplateCache === syncMOC.fetchRequestTemplateCache)
+    }
+
+    // MARK: - Performance
+
+    func testPerformanceOfParsingAPredicateForEveryFetch() {
+        measure {
+            for index in 0..<10000 {
+                _ = NSPredicate(
+                    format: "%K = %@ AND (%K = %lld OR %K = 0)",
+                    "uuidString", "\(index)",
+                    "eventHash", Int64(index),
+                    "eventHash"
+                )
+            }
+        }
+    }
+
+    func testPerformanceOfSubstitutingATemplateForEveryFetch() {
+        let sut = FetchRequestTemplateCache()
+
+        measure {
+            for index in 0..<10000 {
+                _ = sut.predicate(
+                    templateNamed: "storedEventExists",
+                    substitutionVariables: ["EVENT_ID": "\(index)", "EVENT_HASH": NSNumber(value: Int64(index))]
+                ) {
+                    NSPredicate(format: "%K = $EVENT_ID AND (%K = $EVENT_HASH OR %K = 0)", "uuidString", "eventHash", "eventHash")
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,99 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+
+@testable import WireDataModel
+
+final class NSManagedObjectContextTests_EncryptionAtRest: ZMBaseManagedObjectTest {
+
+    override func setUp() {
+        super.setUp()
+
+        createSelfClient(onMOC: uiMOC)
+        uiMOC.encryptMessagesAtRest = true
+        uiMOC.databaseKey = validDatabaseKey
+    }
+
+    override func tearDown() {
+        uiMOC.encryptMessagesAtRest = false
+        uiMOC.databaseKey = nil
+        super.tearDown()
+    }
+
+    // MARK: - Bulk
+
+    func testThatItEncryptsAndDecryptsValuesInBulk() throws {
+        // Given
+        let values = (0..<10).map { Data("Message \($0)".utf8) }
+
+        // When
+        let encrypted = try uiMOC.encryptData(values: values)
+
+        // Then
+        XCTAssertEqual(encrypted.count, values.count)
+
+        // When
+        let decrypted = try uiMOC.decryptData(values: encrypted)
+
+        // Then
+        XCTAssertEqual(decrypted, values)
+    }
+
+    func testThatValuesEncryptedInBulkCanBeDecryptedOneByOne() throws {
+        // Given
+        let value = Data("Hello, world".utf8)
+        let encrypted = try XCTUnwrap(uiMOC.encryptData(values: [value]).first)
+
+        // When
+        let decrypted = try uiMOC.decryptData(data: encrypted.data, nonce: encrypted.nonce)
+
+        // Then
+        XCTAssertEqual(decrypted, value)
+    }
+
+    func testThatItDoesNotEncryptInBulk_IfDatabaseKeyIsMissing() {
+        // Given
+        uiMOC.databaseKey = nil
+
+        // Then
+        XCTAssertThrowsError(try uiMOC.encryptData(values: [Data("Hello, world".utf8)]))
+    }
+
+    // MARK: - Context data
+
+    func testThatItKeepsTheContextDataUntilTheDatabaseKeyChanges() throws {
+        // Given
+        let value = Data("Hello, world".utf8)
+        let encrypted = try uiMOC.encryptData(data: value)
+        let databaseKey = try XCTUnwrap(uiMOC.databaseKey)
+
+        // When the self client changes, the cached context data is still used.
+        ZMUser.selfUser(in: uiMOC).selfClient()?.remoteIdentifier = "changed"
+
+        // Then
+        XCTAssertEqual(try uiMOC.decryptData(data: encrypted.data, nonce: encrypted.nonce), value)
+
+        // When the key is set again, the context data is computed again.
+        uiMOC.databaseKey = databaseKey
+
+        // Then
+        XCTAssertThrowsError(try uiMOC.decryptData(data: encrypted.data, nonce: encrypted.nonce))
+    }
+
+}
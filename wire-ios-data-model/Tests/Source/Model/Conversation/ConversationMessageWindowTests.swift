@@ -0,0 +1,209 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+@testable import WireDataModel
+import XCTest
+
+final class ConversationMessageWindowTests: ZMConversationTestsBase {
+
+    // MARK: - Window
+
+    func testThatTheWindowGrowsUntilItsMaximumSize() {
+        // given
+        var sut = MessageWindow(limit: 30, pageSize: 30, maximumSize: 90)
+
+        // when
+        let dropped = sut.slide(.older)
+
+        // then
+        XCTAssertEqual(sut.offset, 0)
+        XCTAssertEqual(sut.limit, 60)
+        XCTAssertTrue(dropped.isEmpty)
+    }
+
+    func testThatTheWindowDropsTheNewestPageOnceItIsFull() {
+        // given
+        var sut = MessageWindow(limit: 90, pageSize: 30, maximumSize: 90)
+
+        // when
+        let dropped = sut.slide(.older)
+
+        // then
+        XCTAssertEqual(sut.offset, 30)
+        XCTAssertEqual(sut.limit, 90)
+        XCTAssertEqual(dropped, 0..<30)
+    }
+
+    func testThatTheWindowDropsTheOldestPageWhenMovingTowardsNewerMessages() {
+        // given
+        var sut = MessageWindow(offset: 60, limit: 90, pageSize: 30, maximumSize: 90)
+
+        // when
+        let dropped = sut.slide(.newer)
+
+        // then
+        XCTAssertEqual(sut.offset, 30)
+        XCTAssertEqual(sut.limit, 90)
+        XCTAssertEqual(dropped, 120..<150)
+    }
+
+    func testThatTheWindowStopsAtTheNewestMessage() {
+        // given
+        var sut = MessageWindow(offset: 10, limit: 30, pageSize: 30, maximumSize: 90)
+
+        // when
+        sut.slide(.newer)
+
+        // then
+        XCTAssertEqual(sut.offset, 0)
+        XCTAssertEqual(sut.limit, 40)
+        XCTAssertNil(sut.nextPage(.newer))
+    }
+
+    func testThatItReturnsTheNextPageInTheScrollDirection() {
+        // given
+        let sut = MessageWindow(offset: 45, limit: 60, pageSize: 30, maximumSize: 90)
+
+        // then
+        XCTAssertEqual(sut.nextPage(.older), 105..<135)
+        XCTAssertEqual(sut.nextPage(.newer), 15..<45)
+    }
+
+    // MARK: - Fetching
+
+    func testThatItFetchesTheMessagesOfAWindowNewestFirst() {
+        // given
+        let conversation = createConversation(in: uiMOC)
+        let timestamps = insertTextMessages(count: 10, in: conversation)
+        let window = MessageWindow(offset: 2, limit: 3, pageSize: 3, maximumSize: 9)
+
+        // when
+        let messages = uiMOC.fetchOrAssert(request: conversation.visibleMessagesFetchRequest(in: window))
+
+        // then
+        XCTAssertEqual(messages.compactMap(\.serverTimestamp), Array(timestamps.reversed()[2..<5]))
+    }
+
+    func testThatItPrefetchesAndDecodesMessages() {
+        // given
+        let conversation = createConversation(in: uiMOC)
+        let timestamps = insertTextMessages(count: 10, in: conversation)
+        let expectation = customExpectation(description: "Prefetched")
+        var prefetched: [ZMMessage] = []
+
+        // when
+        conversation.prefetchVisibleMessages(in: 0..<4) { messages in
+            prefetched = messages
+            expectation.fulfill()
+        }
+        XCTAssertTrue(waitForCustomExpectations(withTimeout: 0.5))
+
+        // then
+        XCTAssertEqual(prefetched.compactMap(\.serverTimestamp), Array(timestamps.reversed()[0..<4]))
+        for message in prefetched {
+            XCTAssertFalse(message.isFault)
+            XCTAssertNotNil((message as? ZMClientMessage)?.cachedUnderlyingMessage)
+        }
+    }
+
+    func testThatItEvictsMessagesWithoutChanges() {
+        // given
+        let conversation = createConversation(in: uiMOC)
+        insertTextMessages(count: 2, in: conversation)
+        let messages = uiMOC.fetchOrAssert(request: conversation.visibleMessagesFetchRequest())
+        messages.forEach { _ = $0.textMessageData?.messageText }
+        messages[1].serverTimestamp = Date()
+
+        // when
+        uiMOC.evictMessages(messages)
+
+        // then
+        XCTAssertTrue(messages[0].isFault)
+        XCTAssertFalse(messages[1].isFault)
+    }
+
+    // MARK: - Performance
+
+    func testPerformanceOfTheFirstRenderOfAConversationWithManyMessages() {
+        // given
+        let conversation = createConversation(in: uiMOC)
+        insertTextMessages(count: 100_000, in: conversation)
+        let window = MessageWindow(limit: 60, pageSize: 30, maximumSize: 300)
+
+        measure {
+            // when
+            let messages = uiMOC.fetchOrAssert(request: conversation.visibleMessagesFetchRequest(in: window))
+            messages.forEach { _ = $0.textMessageData?.messageText }
+
+            // then
+            XCTAssertEqual(messages.count, 60)
+            uiMOC.evictMessages(messages)
+        }
+    }
+
+    func testPerformanceOfScrollingThroughAConversationWithManyMessages() {
+        // given
+        let conversation = createConversation(in: uiMOC)
+        insertTextMessages(count: 100_000, in: conversation)
+
+        measure(metrics: [XCTClockMetric(), XCTMemoryMetric()]) {
+            // when
+            var window = MessageWindow(limit: 60, pageSize: 30, maximumSize: 300)
+            var loaded = uiMOC.fetchOrAssert(request: conversation.visibleMessagesFetchRequest(in: window))
+
+            for _ in 0..<100 {
+                window.slide(.older)
+                let messages = uiMOC.fetchOrAssert(request: conversation.visibleMessagesFetchRequest(in: window))
+                messages.forEach { _ = $0.textMessageData?.messageText }
+                uiMOC.evictMessages(Set(loaded).subtracting(messages))
+                loaded = messages
+            }
+
+            // then
+            XCTAssertEqual(loaded.count, window.maximumSize)
+            uiMOC.evictMessages(loaded)
+        }
+    }
+
+    // MARK: - Helpers
+
+    /// Inserts text messages with increasing server timestamps and returns the timestamps, oldest first.
+    @discardableResult
+    private func insertTextMessages(count: Int, in conversation: ZMConversation) -> [Date] {
+        let start = Date(timeIntervalSince1970: 1_000_000)
+        var timestamps: [Date] = []
+
+        for index in 0..<count {
+            let message = ZMClientMessage(nonce: UUID(), managedObjectContext: uiMOC)
+            try? message.setUnderlyingMessage(GenericMessage(content: Text(content: "Message \(index)")))
+            message.serverTimestamp = start.addingTimeInterval(TimeInterval(index))
+            message.visibleInConversation = conversation
+            timestamps.append(message.serverTimestamp!)
+
+            if index % 1000 == 999 {
+                XCTAssertTrue(uiMOC.saveOrRollback())
+                uiMOC.refreshAllObjects()
+            }
+        }
+
+        XCTAssertTrue(uiMOC.saveOrRollback())
+        uiMOC.refreshAllObjects()
+        return timestamps
+    }
+
+}
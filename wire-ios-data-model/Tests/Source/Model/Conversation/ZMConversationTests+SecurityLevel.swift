@@ -1050,4 +1050,189 @@ final class ZMConversationTests_SecurityLevel: ZMConversationTestsBase {
         XCTAssertEqual(conversation.securityLevel, .secure)
     }
 
+
+    // MARK: - Trust summary
+
+    func testThatItOnlyUpdatesTheTrustSummaryOfAffectedUsers() {
+        context.performGroupedAndWait {
+            // given
+            let users = self.createUsersWithClientsOnSyncMOC(count: 3)
+            let selfClient = self.createSelfClient(onMOC: context)
+            selfClient.trustClients(Set(users.flatMap(\.clients)))
+            let conversation = ZMConversation.insertGroupConversation(moc: context, participants: users)!
+            XCTAssertEqual(conversation.securityLevel, .secure)
+            context.processPendingChanges()
+
+            let firstClient = UserClient.insertNewObject(in: context)
+            firstClient.user = users[0]
+            selfClient.updateSecurityLevelAfterDiscovering([firstClient])
+            XCTAssertEqual(conversation.securityLevel, .secureWithIgnored)
+            let summary = conversation.trustSummary
+
+            // when
+            let secondClient = UserClient.insertNewObject(in: context)
+            secondClient.user = users[1]
+            selfClient.updateSecurityLevelAfterDiscovering([secondClient])
+
+            // then
+            XCTAssertTrue(conversation.trustSummary === summary)
+            XCTAssertEqual(summary?.participantCount, 4)
+            XCTAssertEqual(summary?.untrustedParticipantCount, 2)
+            XCTAssertEqual(summary?.clientlessParticipantCount, 0)
+            XCTAssertEqual(summary?.clientCount, 6)
+        }
+    }
+
+    func testThatItUpdatesTheTrustSummaryWhenAnUntrustedParticipantIsRemoved() {
+        context.performGroupedAndWait {
+            // given
+            let users = self.createUsersWithClientsOnSyncMOC(count: 3)
+            let selfClient = self.createSelfClient(onMOC: context)
+            let conversation = ZMConversation.insertGroupConversation(moc: context, participants: users)!
+            selfClient.trustClients(users[0].clients.union(users[1].clients))
+            XCTAssertEqual(conversation.securityLevel, .notSecure)
+            let summary = conversation.trustSummary
+            XCTAssertEqual(summary?.untrustedParticipantCount, 1)
+
+            // when
+            conversation.removeParticipantAndUpdateConversationState(user: users[2], initiatingUser: self.selfUser)
+
+            // then
+            XCTAssertTrue(conversation.trustSummary === summary)
+            XCTAssertEqual(summary?.participantCount, 3)
+            XCTAssertEqual(summary?.untrustedParticipantCount, 0)
+            XCTAssertEqual(conversation.securityLevel, .secure)
+        }
+    }
+
+    func testThatItRebuildsTheTrustSummaryAfterChangesInTheContext() {
+        context.performGroupedAndWait {
+            // given
+            let users = self.createUsersWithClientsOnSyncMOC(count: 2)
+            let selfClient = self.createSelfClient(onMOC: context)
+            let conversation = ZMConversation.insertGroupConversation(moc: context, participants: users)!
+            selfClient.trustClients(users[0].clients)
+            let summary = conversation.trustSummary
+            XCTAssertNotNil(summary)
+
+            // when the connection changes without a security change
+            users[1].connection?.status = .sent
+            context.processPendingChanges()
+            selfClient.trustClients(users[1].clients)
+
+            // then
+            XCTAssertFalse(conversation.trustSummary === summary)
+            XCTAssertEqual(conversation.trustSummary?.unconnectedOrExternalParticipantCount, 1)
+            XCTAssertEqual(conversation.securityLevel, .notSecure)
+        }
+    }
+
+    func testThatItUpdatesTheTrustSummaryOfUsersChangedInTheContextWithoutRebuildingIt() {
+        context.performGroupedAndWait {
+            // given
+            let users = self.createUsersWithClientsOnSyncMOC(count: 3)
+            let selfClient = self.createSelfClient(onMOC: context)
+            let conversation = ZMConversation.insertGroupConversation(moc: context, participants: users)!
+            selfClient.trustClients(users[0].clients.union(users[1].clients))
+            XCTAssertEqual(conversation.securityLevel, .notSecure)
+            let summary = conversation.trustSummary
+            XCTAssertNotNil(summary)
+
+            // when a client is added without a security change
+            let client = UserClient.insertNewObject(in: context)
+            client.user = users[0]
+            context.processPendingChanges()
+            selfClient.trustClients(users[2].clients)
+
+            // then
+            XCTAssertTrue(conversation.trustSummary === summary)
+            XCTAssertEqual(summary?.untrustedParticipantCount, 1)
+            XCTAssertEqual(conversation.securityLevel, .notSecure)
+        }
+    }
+
+    func testThatItUpdatesTheTrustSummaryOfUsersChangedBeforeTheyWereSaved() {
+        context.performGroupedAndWait {
+            // given
+            let users = self.createUsersWithClientsOnSyncMOC(count: 3)
+            let selfClient = self.createSelfClient(onMOC: context)
+            let conversation = ZMConversation.insertGroupConversation(moc: context, participants: users)!
+            selfClient.trustClients(users[0].clients.union(users[1].clients))
+            XCTAssertEqual(conversation.securityLevel, .notSecure)
+            let summary = conversation.trustSummary
+            XCTAssertNotNil(summary)
+
+            // when a client is added to an unsaved user, which is then saved
+            let client = UserClient.insertNewObject(in: context)
+            client.user = users[0]
+            context.processPendingChanges()
+            XCTAssertTrue(context.saveOrRollback())
+            selfClient.trustClients(users[2].clients)
+
+            // then
+            XCTAssertTrue(conversation.trustSummary === summary)
+            XCTAssertEqual(summary?.untrustedParticipantCount, 1)
+            XCTAssertEqual(conversation.securityLevel, .notSecure)
+        }
+    }
+
+    func testPerformanceOfSecurityChangesInAConversationWithManyParticipants() {
+        let participantCount = 1000
+        let changeCount = 50
+
+        context.performGroupedAndWait {
+            // given
+            let users = self.createUsersWithClientsOnSyncMOC(count: participantCount)
+            let selfClient = self.createSelfClient(onMOC: context)
+            selfClient.trustClients(Set(users.flatMap(\.clients)))
+            let conversation = ZMConversation.insertGroupConversation(moc: context, participants: users)!
+            XCTAssertEqual(conversation.securityLevel, .secure)
+
+            // when
+            self.measure {
+                for user in users.prefix(changeCount) {
+                    let client = UserClient.insertNewObject(in: context)
+                    client.user = user
+                    selfClient.updateSecurityLevelAfterDiscovering([client])
+                    selfClient.trustClient(client)
+                }
+            }
+
+            // then
+            XCTAssertEqual(conversation.securityLevel, .secure)
+        }
+    }
+
+    func testPerformanceOfProcessedSecurityChangesInAConversationWithManyParticipants() {
+        let participantCount = 1000
+        let changeCount = 50
+
+        context.performGroupedAndWait {
+            // given
+            let users = self.createUsersWithClientsOnSyncMOC(count: participantCount)
+            let selfClient = self.createSelfClient(onMOC: context)
+            selfClient.trustClients(Set(users.flatMap(\.clients)))
+            let conversation = ZMConversation.insertGroupConversation(moc: context, participants: users)!
+            XCTAssertEqual(conversation.securityLevel, .secure)
+            context.processPendingChanges()
+            let summary = conversation.trustSummary
+
+            // when the context processes the changes in between, as it does at the end of each run loop
+            self.measure {
+                for user in users.prefix(changeCount) {
+                    let client = UserClient.insertNewObject(in: context)
+                    client.user = user
+                    context.processPendingChanges()
+                    selfClient.updateSecurityLevelAfterDiscovering([client])
+                    selfClient.trustClient(client)
+                    context.processPendingChanges()
+                }
+            }
+
+            // then
+            XCTAssertTrue(conversation.trustSummary === summary)
+            XCTAssertEqual(conversation.securityLevel, .secure)
+        }
+    }
+
 }
@@ -53,4 +53,239 @@ final class ZMConversationTests_UnreadMessages: ZMConversationTestsBase {
         }
     }
 
+    // MARK: - Incremental counters
+
+    func testThatItCountsNewMessagesIncrementally() {
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 3)
+            conversation.calculateLastUnreadMessages()
+            XCTAssertEqual(conversation.estimatedUnreadCount, 3)
+
+            // when
+            let message = self.insertMessage(in: conversation, at: Date(timeIntervalSince1970: 100), mentioningSelf: true)
+            conversation.updateTimestampsAfterUpdatingMessage(message)
+            ZMConversation.calculateLastUnreadMessages(in: self.syncMOC)
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 4)
+            XCTAssertEqual(conversation.estimatedUnreadSelfMentionCount, 1)
+            XCTAssertEqual(conversation.unreadMessageCounter?.incrementalUpdateCount, 1)
+        }
+    }
+
+    func testThatItSubtractsMessagesThatBecomeRead() {
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 4)
+            let mention = self.insertMessage(in: conversation, at: Date(timeIntervalSince1970: 5), mentioningSelf: true)
+            conversation.calculateLastUnreadMessages()
+            XCTAssertEqual(conversation.estimatedUnreadCount, 5)
+            XCTAssertEqual(conversation.estimatedUnreadSelfMentionCount, 1)
+
+            // when
+            conversation.lastReadServerTimeStamp = Date(timeIntervalSince1970: 2)
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 3)
+            XCTAssertEqual(conversation.estimatedUnreadSelfMentionCount, 1)
+
+            // when
+            conversation.lastReadServerTimeStamp = mention.serverTimestamp
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 0)
+            XCTAssertEqual(conversation.estimatedUnreadSelfMentionCount, 0)
+            XCTAssertEqual(conversation.unreadMessageCounter?.incrementalUpdateCount, 2)
+        }
+    }
+
+    func testThatItRecalculatesWhenLastReadMovesBackwards() {
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 4)
+            conversation.lastReadServerTimeStamp = Date(timeIntervalSince1970: 4)
+            XCTAssertEqual(conversation.estimatedUnreadCount, 0)
+
+            // when
+            conversation.lastReadServerTimeStamp = Date(timeIntervalSince1970: 1)
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 3)
+            XCTAssertEqual(conversation.unreadMessageCounter?.incrementalUpdateCount, 0)
+        }
+    }
+
+    func testThatItRemovesDeletedMessagesIncrementally() {
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 2)
+            let mention = self.insertMessage(in: conversation, at: Date(timeIntervalSince1970: 3), mentioningSelf: true)
+            conversation.calculateLastUnreadMessages()
+            XCTAssertEqual(conversation.estimatedUnreadCount, 3)
+
+            // when
+            conversation.updateTimestampsBeforeDeletingMessage(mention)
+            mention.visibleInConversation = nil
+            conversation.updateTimestampsAfterDeletingMessage()
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 2)
+            XCTAssertEqual(conversation.estimatedUnreadSelfMentionCount, 0)
+            XCTAssertEqual(conversation.unreadMessageCounter?.incrementalUpdateCount, 1)
+        }
+    }
+
+    func testThatItCountsMessagesInsertedInsideTheCountedRange() {
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 3)
+            conversation.calculateLastUnreadMessages()
+
+            // when
+            let message = ZMSystemMessage(nonce: UUID(), managedObjectContext: self.syncMOC)
+            message.systemMessageType = .missedCall
+            message.serverTimestamp = Date(timeIntervalSince1970: 2)
+            conversation.append(message)
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 4)
+            XCTAssertEqual(conversation.lastUnreadMissedCallDate, message.serverTimestamp)
+            XCTAssertEqual(conversation.unreadMessageCounter?.incrementalUpdateCount, 1)
+        }
+    }
+
+    func testThatItFallsBackToAFullCountWhenAnOlderMessageIsUpdated() {
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 3)
+            conversation.calculateLastUnreadMessages()
+
+            // when
+            let message = self.insertMessage(in: conversation, at: Date(timeIntervalSince1970: 2), mentioningSelf: false)
+            conversation.updateTimestampsAfterUpdatingMessage(message)
+            ZMConversation.calculateLastUnreadMessages(in: self.syncMOC)
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 4)
+            XCTAssertEqual(conversation.unreadMessageCounter?.incrementalUpdateCount, 0)
+        }
+    }
+
+    func testThatItCorrectsTheCountersInTheConsistencyCheck() {
+        let consistencyCheckInterval = UnreadMessageCounter.consistencyCheckInterval
+        UnreadMessageCounter.consistencyCheckInterval = 2
+        defer { UnreadMessageCounter.consistencyCheckInterval = consistencyCheckInterval }
+
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 3)
+            conversation.calculateLastUnreadMessages()
+
+            // a message the counters are not told about
+            self.insertMessage(in: conversation, at: Date(timeIntervalSince1970: 2), mentioningSelf: false)
+
+            // when
+            conversation.updateUnreadMessageCounters()
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 3)
+
+            // when
+            conversation.updateUnreadMessageCounters()
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, 4)
+            XCTAssertEqual(conversation.unreadMessageCounter?.incrementalUpdateCount, 0)
+        }
+    }
+
+    func testThatIncrementalCountersMatchAFullCount() {
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: 10)
+            conversation.calculateLastUnreadMessages()
+
+            // when
+            for index in 11...20 {
+                let message = self.insertMessage(in: conversation, at: Date(timeIntervalSince1970: TimeInterval(index)), mentioningSelf: index.isMultiple(of: 3))
+                conversation.updateTimestampsAfterUpdatingMessage(message)
+                ZMConversation.calculateLastUnreadMessages(in: self.syncMOC)
+
+                if index.isMultiple(of: 4) {
+                    conversation.lastReadServerTimeStamp = Date(timeIntervalSince1970: TimeInterval(index - 2))
+                }
+            }
+
+            let counts = conversation.unreadMessageCounter?.counts
+            conversation.calculateLastUnreadMessages()
+
+            // then
+            XCTAssertEqual(conversation.unreadMessageCounter?.counts, counts)
+            XCTAssertEqual(conversation.estimatedUnreadCount, 2)
+        }
+    }
+
+    // MARK: - Performance
+
+    func testPerformanceOfCatchingUpInAConversationWithManyUnreadMessages() {
+        let unreadMessageCount = 10000
+        let newMessageCount = 200
+
+        syncMOC.performGroupedAndWait {
+            // given
+            let conversation = self.createConversationWithUnreadMessages(count: unreadMessageCount)
+            conversation.calculateLastUnreadMessages()
+            XCTAssertTrue(self.syncMOC.saveOrRollback())
+
+            var timestamp = TimeInterval(unreadMessageCount)
+
+            // when
+            self.measure {
+                for _ in 0..<newMessageCount {
+                    timestamp += 1
+                    let message = self.insertMessage(in: conversation, at: Date(timeIntervalSince1970: timestamp), mentioningSelf: false)
+                    conversation.updateTimestampsAfterUpdatingMessage(message)
+                    ZMConversation.calculateLastUnreadMessages(in: self.syncMOC)
+                }
+            }
+
+            // then
+            XCTAssertEqual(conversation.estimatedUnreadCount, Int64(unreadMessageCount + 10 * newMessageCount))
+        }
+    }
+
+    // MARK: - Helpers
+
+    private func createConversationWithUnreadMessages(count: Int) -> ZMConversation {
+        let conversation = ZMConversation.insertNewObject(in: syncMOC)
+        conversation.conversationType = .group
+        conversation.remoteIdentifier = UUID.create()
+        conversation.lastReadServerTimeStamp = Date(timeIntervalSince1970: 0)
+
+        for index in 1...count {
+            insertMessage(in: conversation, at: Date(timeIntervalSince1970: TimeInterval(index)), mentioningSelf: false)
+        }
+
+        return conversation
+    }
+
+    @discardableResult
+    private func insertMessage(in conversation: ZMConversation, at timestamp: Date, mentioningSelf: Bool) -> ZMClientMessage {
+        let nonce = UUID()
+        let mentions = mentioningSelf ? [Mention(range: NSRange(location: 0, length: 4), user: selfUser)] : []
+        let text = GenericMessage(content: Text(content: "@joe hello", mentions: mentions, linkPreviews: [], replyingTo: nil), nonce: nonce)
+        let message = ZMClientMessage(nonce: nonce, managedObjectContext: syncMOC)
+
+        do {
+            try message.setUnderlyingMessage(text)
+        } catch {
+            XCTFail()
+        }
+
+        message.serverTimestamp = timestamp
+        message.visibleInConversation = conversation
+        return message
+    }
+
 }
@@ -449,6 +449,32 @@ class FileAssetCacheTests: XCTestCase {
         XCTAssertTrue(requestData == data)
     }
 
+    func testThatItStoresTheRequestDataWrittenToTheFileURL() {
+        let message = createMessageForCaching()
+        let requestData = Data.secureRandomData(ofLength: 500)
+
+        // when
+        let assetURL = sut.storeTransportData(for: message) { url in
+            try requestData.write(to: url)
+        }
+
+        // then
+        guard let url = assetURL else { return XCTFail() }
+        XCTAssertEqual(try? Data(contentsOf: url), requestData)
+    }
+
+    func testThatItDoesNotReturnAFileURLWhenWritingTheRequestDataFails() {
+        let message = createMessageForCaching()
+
+        // when
+        let assetURL = sut.storeTransportData(for: message) { _ in
+            throw NSError(domain: NSCocoaErrorDomain, code: NSFileWriteUnknownError)
+        }
+
+        // then
+        XCTAssertNil(assetURL)
+    }
+
     func testThatItDeletesTheRequestData() {
         let message = createMessageForCaching()
         let requestData = Data.secureRandomData(ofLength: 500)
@@ -0,0 +1,145 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+@testable import WireDataModel
+import XCTest
+
+final class GenericMessageBatchDecoderTests: ModelObjectsTests {
+
+    func testThatItDecodesTheSameMessagesAsTheLazyDecoding() throws {
+        // given
+        let messages = try createTextMessages(count: 200)
+        let expected = messages.map(\.underlyingMessage)
+        messages.forEach { $0.cachedUnderlyingMessage = nil }
+
+        // when
+        let decodedCount = GenericMessageBatchDecoder.decodeUnderlyingMessages(of: messages)
+
+        // then
+        XCTAssertEqual(decodedCount, messages.count)
+        XCTAssertEqual(messages.map(\.cachedUnderlyingMessage), expected)
+    }
+
+    func testThatItDecodesAssetMessages() throws {
+        // given
+        let message = ZMAssetClientMessage(nonce: UUID.create(), managedObjectContext: uiMOC)
+        let original = WireProtos.Asset.Original(withSize: 234, mimeType: "foo/bar", name: "boo.bar")
+        try message.setUnderlyingMessage(GenericMessage(content: WireProtos.Asset(original: original, preview: nil), nonce: message.nonce!))
+        let expected = message.underlyingMessage
+        message.cachedUnderlyingAssetMessage = nil
+
+        // when
+        GenericMessageBatchDecoder.decodeUnderlyingMessages(of: [message])
+
+        // then
+        XCTAssertNotNil(message.cachedUnderlyingAssetMessage)
+        XCTAssertEqual(message.cachedUnderlyingAssetMessage, expected)
+    }
+
+    func testThatItSkipsMessagesThatWereAlreadyDecoded() throws {
+        // given
+        let messages = try createTextMessages(count: 2)
+        _ = messages[0].underlyingMessage
+        messages[1].cachedUnderlyingMessage = nil
+
+        // when
+        let decodedCount = GenericMessageBatchDecoder.decodeUnderlyingMessages(of: messages)
+
+        // then
+        XCTAssertEqual(decodedCount, 1)
+        XCTAssertNotNil(messages[1].cachedUnderlyingMessage)
+    }
+
+    func testThatConcurrentAndSerialDecodingReturnTheSameMessages() throws {
+        // given
+        let payloads = try createPayloads(count: 1000)
+
+        // when
+        let serial = GenericMessageBatchDecoder.decode(payloads, concurrently: false)
+        let concurrent = GenericMessageBatchDecoder.decode(payloads, concurrently: true)
+
+        // then
+        XCTAssertEqual(serial.count, payloads.count)
+        XCTAssertEqual(concurrent.count, payloads.count)
+        for payload in payloads {
+            XCTAssertEqual(serial[payload.objectID], concurrent[payload.objectID])
+        }
+    }
+
+    func testThatItIgnoresPartsThatAreNotPartOfTheMessage() throws {
+        // given
+        let messageData = ZMGenericMessageData.insertNewObject(in: uiMOC)
+        let payload = GenericMessageBatchDecoder.Payload(
+            objectID: messageData.objectID,
+            parts: [Data("not a protobuf".utf8)],
+            includesPart: ZMClientMessage.includesInUnderlyingMessage
+        )
+
+        // when
+        let decoded = GenericMessageBatchDecoder.decode([payload])
+
+        // then
+        XCTAssertEqual(decoded.count, 0)
+    }
+
+    // MARK: - Performance
+
+    func testPerformanceOfSerialDecoding() throws {
+        let payloads = try createPayloads(count: 10000)
+
+        measure {
+            _ = GenericMessageBatchDecoder.decode(payloads, concurrently: false)
+        }
+    }
+
+    func testPerformanceOfConcurrentDecoding() throws {
+        let payloads = try createPayloads(count: 10000)
+
+        measure {
+            _ = GenericMessageBatchDecoder.decode(payloads, concurrently: true)
+        }
+    }
+
+    // MARK: - Helpers
+
+    private func createTextMessages(count: Int) throws -> [ZMClientMessage] {
+        try (0..<count).map { index in
+            let message = ZMClientMessage(nonce: UUID.create(), managedObjectContext: uiMOC)
+            try message.setUnderlyingMessage(GenericMessage(content: Text(content: "Message \(index)"), nonce: message.nonce!))
+            return message
+        }
+    }
+
+    /// Payloads of text messages the size of a short paragraph, keyed by the IDs of
+    /// otherwise unused objects.
+    private func createPayloads(count: Int) throws -> [GenericMessageBatchDecoder.Payload] {
+        let text = String(repeating: "Lorem ipsum dolor sit amet. ", count: 10)
+
+        return try (0..<count).map { index in
+            let messageData = ZMGenericMessageData.insertNewObject(in: uiMOC)
+            let data = try GenericMessage(content: Text(content: "\(index) \(text)")).serializedData()
+
+            return GenericMessageBatchDecoder.Payload(
+                objectID: messageData.objectID,
+                parts: [data],
+                includesPart: ZMClientMessage.includesInUnderlyingMessage
+            )
+        }
+    }
+
+}
@@ -0,0 +1,73 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+@testable import WireDataModel
+import XCTest
+
+class ZMGenericMessageDataPerformanceTests: ModelObjectsTests {
+
+    override func setUp() {
+        super.setUp()
+
+        createSelfClient(onMOC: uiMOC)
+    }
+
+    override func tearDown() {
+        uiMOC.encryptMessagesAtRest = false
+        uiMOC.databaseKey = nil
+        super.tearDown()
+    }
+
+    /// Reading a message decrypts its protobuf data when encryption at rest is
+    /// enabled. Compare with the test below to see the per message overhead.
+    func testPerformanceOfReadingMessages_EncryptionAtRestEnabled() throws {
+        // Given
+        uiMOC.encryptMessagesAtRest = true
+        uiMOC.databaseKey = validDatabaseKey
+        let messages = try createMessageData(count: 1000)
+
+        measure {
+            // When
+            for message in messages {
+                _ = message.underlyingMessage
+            }
+        }
+    }
+
+    func testPerformanceOfReadingMessages_EncryptionAtRestDisabled() throws {
+        // Given
+        uiMOC.encryptMessagesAtRest = false
+        let messages = try createMessageData(count: 1000)
+
+        measure {
+            // When
+            for message in messages {
+                _ = message.underlyingMessage
+            }
+        }
+    }
+
+    private func createMessageData(count: Int) throws -> [ZMGenericMessageData] {
+        try (0..<count).map { index in
+            let messageData = ZMGenericMessageData.insertNewObject(in: uiMOC)
+            try messageData.setGenericMessage(GenericMessage(content: Text(content: "Message \(index)")))
+            return messageData
+        }
+    }
+
+}
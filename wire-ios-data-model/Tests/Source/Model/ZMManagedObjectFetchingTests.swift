@@ -215,6 +215,129 @@ class ZMManagedObjectFetchingTests: DatabaseBaseTest {
                                  fetched: false)
     }
 
+    // MARK: - Remote identifier index
+
+    func testItFetchesEntityByRemoteIdentifier_WhenRemoteIdentifierChanged() throws {
+        // given
+        let oldUUID = UUID()
+        let newUUID = UUID()
+        let user = ZMUser.insertNewObject(in: mocs.viewContext)
+        user.remoteIdentifier = oldUUID
+
+        // when
+        user.remoteIdentifier = newUUID
+
+        // then
+        XCTAssertEqual(ZMUser.fetch(with: newUUID, in: mocs.viewContext), user)
+        XCTAssertNil(ZMUser.fetch(with: oldUUID, in: mocs.viewContext))
+    }
+
+    func testItFetchesEntityByRemoteIdentifier_WhenRemoteIdentifierDataWasSetDirectly() throws {
+        // given
+        let oldUUID = UUID()
+        let newUUID = UUID()
+        let user = ZMUser.insertNewObject(in: mocs.viewContext)
+        user.remoteIdentifier = oldUUID
+
+        // when
+        user.setValue(newUUID.uuidData, forKey: ZMUser.remoteIdentifierDataKey())
+
+        // then
+        XCTAssertNil(ZMUser.fetch(with: oldUUID, in: mocs.viewContext))
+        XCTAssertEqual(ZMUser.fetch(with: newUUID, in: mocs.viewContext), user)
+    }
+
+    func testItFetchesEntityByRemoteIdentifier_AfterItWasTurnedIntoAFaultAndFetchedAgain() throws {
+        // given
+        let uuid = UUID()
+        let user = ZMUser.insertNewObject(in: mocs.viewContext)
+        user.remoteIdentifier = uuid
+        try mocs.viewContext.save()
+        mocs.viewContext.refresh(user, mergeChanges: false)
+
+        // when
+        let fetched = ZMUser.fetch(with: uuid, in: mocs.viewContext)
+        _ = fetched?.name
+        let fetchedAgain = ZMUser.fetch(with: uuid, in: mocs.viewContext)
+
+        // then
+        XCTAssertEqual(fetched, fetchedAgain)
+        XCTAssertEqual(fetchedAgain?.remoteIdentifier, uuid)
+    }
+
+    func testItDoesntFetchDeletedEntityByRemoteIdentifier_AfterSaving() throws {
+        // given
+        let uuid = UUID()
+        let user = ZMUser.insertNewObject(in: mocs.viewContext)
+        user.remoteIdentifier = uuid
+        try mocs.viewContext.save()
+
+        // when
+        mocs.viewContext.delete(user)
+        try mocs.viewContext.save()
+
+        // then
+        XCTAssertNil(ZMUser.fetch(with: uuid, in: mocs.viewContext))
+    }
+
+    func testItFetchesAPageOfEntitiesByRemoteIdentifier_WhenSomeAreNotRegisteredInContext() throws {
+        // given
+        let users = (0..<10).map { _ in
+            let user = ZMUser.insertNewObject(in: mocs.viewContext)
+            user.remoteIdentifier = UUID()
+            return user
+        }
+        try mocs.viewContext.save()
+        users.prefix(5).forEach { mocs.viewContext.refresh($0, mergeChanges: false) }
+
+        // when
+        let uuids = Set(users.compactMap(\.remoteIdentifier))
+        let fetched = ZMUser.fetchObjects(withRemoteIdentifiers: uuids, in: mocs.viewContext) as? Set<ZMUser>
+
+        // then
+        XCTAssertEqual(fetched?.compactMap(\.remoteIdentifier).count, 10)
+        XCTAssertEqual(Set(fetched?.map(\.objectID) ?? []), Set(users.map(\.objectID)))
+    }
+
+    func testEventProcessingLookupPerformance_1000RegisteredObjects() {
+        assertEventProcessingLookupPerformance(registeredObjectCount: 1000)
+    }
+
+    func testEventProcessingLookupPerformance_50000RegisteredObjects() {
+        assertEventProcessingLookupPerformance(registeredObjectCount: 50000)
+    }
+
+    /// Looks up a user and a conversation per simulated event, with the given
+    /// number of users and conversations registered in the context.
+    func assertEventProcessingLookupPerformance(registeredObjectCount: Int) {
+        // given
+        let context = mocs.viewContext
+        var userIDs: [UUID] = []
+        var conversationIDs: [UUID] = []
+
+        for _ in 0..<(registeredObjectCount / 2) {
+            let user = ZMUser.insertNewObject(in: context)
+            user.remoteIdentifier = UUID()
+            userIDs.append(user.remoteIdentifier)
+
+            let conversation = ZMConversation.insertNewObject(in: context)
+            conversation.remoteIdentifier = UUID()
+            conversationIDs.append(conversation.remoteIdentifier!)
+        }
+
+        let eventCount = 1000
+
+        // when
+        measure {
+            for index in 0..<eventCount {
+                let user = ZMUser.fetch(with: userIDs[index % userIDs.count], in: context)
+                let conversation = ZMConversation.fetch(with: conversationIDs[index % conversationIDs.count], in: context)
+                XCTAssertNotNil(user)
+                XCTAssertNotNil(conversation)
+            }
+        }
+    }
+
     func assertEntityFetchingWhen(selfUserDomain: String?,
                                   entityDomain: String?,
                                   searchDomain: String?,
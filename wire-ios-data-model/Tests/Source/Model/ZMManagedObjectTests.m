@@ -361,6 +361,43 @@
     XCTAssertEqualObjects(expectedKeys, keysWithLocalModifications);
 }
 
+- (void)testThatItRemovesKeysThatAreNotTrackedWhenFetchingAnObject
+{
+    // given
+    NSUUID *entityUUID = [NSUUID createUUID];
+    [self.testMOC performGroupedBlockThenWaitForReasonableTimeout:^{
+        MockEntity *mockEntity = [MockEntity insertNewObjectInManagedObjectContext:self.testMOC];
+        mockEntity.testUUID = entityUUID;
+        [self.testMOC save:nil];
+        [mockEntity resetLocallyModifiedKeys:mockEntity.keysThatHaveLocalModifications];
+        mockEntity.modifiedKeys = [NSSet setWithObjects:@"field", @"removedInAnOlderModelVersion", nil];
+        [self.testMOC save:nil];
+    }];
+
+    // when
+    __block NSSet *keysWithLocalModifications;
+    [self.alternativeTestMOC performGroupedBlockThenWaitForReasonableTimeout:^{
+        MockEntity *fetchedEntity = [self mockEntityWithUUID:entityUUID inMoc:self.alternativeTestMOC];
+        keysWithLocalModifications = fetchedEntity.keysThatHaveLocalModifications;
+    }];
+
+    // then
+    NSSet *expectedKeys = [NSSet setWithObject:@"field"];
+    XCTAssertEqualObjects(expectedKeys, keysWithLocalModifications);
+}
+
+- (void)testThatItReturnsTheSameTrackedKeysForObjectsOfTheSameEntity
+{
+    // given
+    MockEntity *mockEntity1 = [MockEntity insertNewObjectInManagedObjectContext:self.testMOC];
+    MockEntity *mockEntity2 = [MockEntity insertNewObjectInManagedObjectContext:self.testMOC];
+
+    // then
+    XCTAssertEqual(mockEntity1.keysTrackedForLocalModifications, mockEntity2.keysTrackedForLocalModifications);
+    XCTAssertTrue([mockEntity1.keysTrackedForLocalModifications containsObject:@"field2"]);
+    XCTAssertFalse([mockEntity1.keysTrackedForLocalModifications containsObject:ZMManagedObjectLocallyModifiedKeysKey]);
+}
+
 - (void)testObjectIDForURIRepresentation
 {
     // given
@@ -546,4 +583,41 @@
     }];
 }
 
+- (void)testPerformanceOfLocalModificationBookkeepingPerSave
+{
+    NSMutableArray<MockEntity *> *entities = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 1000; i++) {
+        [entities addObject:[MockEntity insertNewObjectInManagedObjectContext:self.testMOC]];
+    }
+    [self.testMOC saveOrRollback];
+
+    __block int count = 1;
+    [self measureMetrics:@[XCTPerformanceMetric_WallClockTime] automaticallyStartMeasuring:NO forBlock:^{
+        // given
+        for (MockEntity *entity in entities) {
+            entity.field = count;
+            entity.field2 = (count % 2 == 0) ? @"foo" : @"bar";
+        }
+        count++;
+
+        // when
+        [self startMeasuring];
+        [self.testMOC saveOrRollback];
+        for (MockEntity *entity in entities) {
+            [entity resetLocallyModifiedKeys:[NSSet setWithObject:@"field2"]];
+            [entity setLocallyModifiedKeys:[NSSet setWithObject:@"field3"]];
+        }
+        [self stopMeasuring];
+
+        // then
+        XCTAssertEqualObjects(entities.firstObject.keysThatHaveLocalModifications, ([NSSet setWithObjects:@"field", @"field3", nil]));
+
+        // reset
+        for (MockEntity *entity in entities) {
+            [entity resetLocallyModifiedKeys:entity.keysThatHaveLocalModifications];
+        }
+        [self.testMOC saveOrRollback];
+    }];
+}
+
 @end
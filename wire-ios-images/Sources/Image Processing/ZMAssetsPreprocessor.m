@@ -22,6 +22,7 @@
 #import "ZMImageLoadOperation.h"
 #import "ZMImageOwner.h"
 #import "ZMImageDownsampleOperation.h"
+#import "ZMImagePreprocessor.h"
 
 
 @implementation ZMAssetsPreprocessor
@@ -45,6 +46,7 @@
     if (load == nil) {
         return nil;
     }
+    load.maximumPixelSize = [self decodedPixelSizeForImageOwner:imageOwner];
     [allOperations addObject:load];
     
     NSArray *downsampleOPs = [self downsampleOperationsForImageOwner:imageOwner loadOperation:load];
@@ -61,6 +63,27 @@
     return allOperations;
 }
 
+/// The size the source needs to be decoded at so that the largest required format can be
+/// scaled from it. All smaller formats are then produced from that same decoded image.
+/// Returns 0 if any format needs the full-size image.
+- (CGFloat)decodedPixelSizeForImageOwner:(id<ZMImageOwner>)imageOwner
+{
+    CGSize const imageSize = [ZMImagePreprocessor sizeOfPrerotatedImageWithData:imageOwner.originalImageData];
+    CGFloat pixelSize = 0;
+    
+    for (NSNumber *boxedImageFormat in imageOwner.requiredImageFormats) {
+        ZMImageFormat format = (ZMImageFormat) boxedImageFormat.integerValue;
+        ZMImageDownsampleType downsampleType = [ZMImageDownsampleOperation downsampleTypeForImageFormat:format];
+        CGFloat const formatPixelSize = [ZMImageDownsampleOperation decodedPixelSizeForImageSize:imageSize downsampleType:downsampleType];
+        if (formatPixelSize == 0) {
+            return 0;
+        }
+        pixelSize = MAX(pixelSize, formatPixelSize);
+    }
+    
+    return pixelSize;
+}
+
 - (NSArray *)downsampleOperationsForImageOwner:(id<ZMImageOwner>)imageOwner loadOperation:(ZMImageLoadOperation *)load
 {
     NSMutableArray *operations = [NSMutableArray array];
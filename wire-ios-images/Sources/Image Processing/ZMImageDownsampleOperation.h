@@ -47,8 +47,15 @@ typedef NS_ENUM (int16_t, ZMImageDownsampleType) {
 
 + (ZMImageDownsampleType)downsampleTypeForImageFormat:(ZMImageFormat)format;
 
+/// The longest side, in pixels, an image of the given (oriented) size needs to be decoded at
+/// to produce the given downsample type. Returns 0 if the full image is needed.
++ (CGFloat)decodedPixelSizeForImageSize:(CGSize)imageSize downsampleType:(ZMImageDownsampleType)downsampleType;
+
 @property (nonatomic, readonly, copy) NSData *downsampleImageData;
 @property (nonatomic, readonly) ZMImageFormat format;
 @property (nonatomic, readonly) ZMIImageProperties *properties;
 
+/// The number of times an image was encoded at its final size, including the quality search.
+@property (nonatomic, readonly) NSUInteger encodePassCount;
+
 @end
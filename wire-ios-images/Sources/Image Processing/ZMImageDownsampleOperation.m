@@ -34,12 +34,22 @@ static const double DownsampleResizeThreshold = 1.2;
 static const int TiffOrientationCorrect = 1;
 static const int TiffOrientationNotSet = 0;
 static const double ScaleFudgeFactor = 1.3; ///< We will not require scaling if the image is within 30% of the target size
+static const double MinimumCompressionQuality = 0.15; ///< The lowest JPEG quality the size search will go down to
+static const double CompressionQualityTolerance = 0.03; ///< The size search stops once the quality is known within this range
+static const double ProbeCompressionQualityStep = 0.05;
+static const NSUInteger MaximumSizeSearchEncodePasses = 3; ///< Full size encodes the size search may do after the first one
+static const double ProbePixelSize = 256; ///< Longest side of the image used to estimate the encoded size
 
 static BOOL isFormatKindOfFormat(NSString *format1, UTType *format2) {
     return (BOOL) [[UTType typeWithIdentifier:format1] conformsToType:format2];
 }
 static CGContextRef createBitmapContext(size_t width, size_t height);
 static void bitmapContextReleaseData(void *releaseInfo, void *data);
+static NSData *encodeImage(CGImageRef image, NSString *format, NSDictionary *properties, NSUInteger capacity);
+static NSUInteger targetDimensionForDownsampleType(ZMImageDownsampleType downsampleType);
+static BOOL shouldScaleImageOfSize(CGSize size, double targetDimension);
+static CGSize finalSizeForOriginalSize(CGSize originalSize, double targetDimension);
+static CGSize orientedSizeForSize(CGSize size, int orientation);
 
 
 
@@ -52,6 +62,13 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
 @property (nonatomic) NSString *imageFormat;
 @property (nonatomic) ZMImageFormat format;
 @property (nonatomic) ZMIImageProperties *properties;
+@property (nonatomic) NSUInteger encodePassCount;
+
+/// Encoded byte counts of a small copy of the image being searched, by quality.
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSNumber *> *probeByteCounts;
+@property (nonatomic) CGImageRef probeSourceImage;
+/// The small copy of @c probeSourceImage that is encoded, scaled once per source image.
+@property (nonatomic) CGImageRef probeImage;
 
 @end
 
@@ -108,6 +125,28 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
     return ZMImageFormatInvalid;
 }
 
++ (CGFloat)decodedPixelSizeForImageSize:(CGSize)imageSize downsampleType:(ZMImageDownsampleType)downsampleType
+{
+    double const targetDimension = targetDimensionForDownsampleType(downsampleType);
+    VerifyReturnValue(targetDimension > 0 && imageSize.width > 0 && imageSize.height > 0, 0);
+    
+    if (downsampleType == ZMImageDownsampleTypeSmallProfile) {
+        // The square crop scales the shortest side down to the target dimension.
+        double const shortestSide = fmin(imageSize.width, imageSize.height);
+        if (shortestSide <= targetDimension) {
+            return 0;
+        }
+        // One extra pixel so that rounding in the decoder never leaves the shortest side too short.
+        return (CGFloat) (ceil(fmax(imageSize.width, imageSize.height) * targetDimension / shortestSide) + 1);
+    }
+    
+    if (! shouldScaleImageOfSize(imageSize, targetDimension)) {
+        return 0;
+    }
+    CGSize const finalSize = finalSizeForOriginalSize(imageSize, targetDimension);
+    return (CGFloat) fmax(finalSize.width, finalSize.height);
+}
+
 - (instancetype)initWithLoadOperation:(ZMImageLoadOperation *)loadOperation downsampleType:(ZMImageDownsampleType)downsampleType;
 {
     self = [super init];
@@ -132,6 +171,12 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
     return self;
 }
 
+- (void)dealloc
+{
+    CGImageRelease(_probeSourceImage);
+    CGImageRelease(_probeImage);
+}
+
 - (NSString *)description
 {
     NSString *typeName = @"Invalid";
@@ -162,10 +207,20 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
         return;
     }
 
+    NSString *mimeType = self.loadOperation.computedImageProperties.mimeType;
+    CGSize const orientedImageSize = self.loadOperation.orientedImageSize;
+    
+    // The decision to scale is based on the size of the source, not on the decoded image,
+    // which may already have been subsampled for the largest format.
+    if (! self.forceSquare && shouldScaleImageOfSize(orientedImageSize, self.targetDimension)) {
+        CGSize const imageSize = [self scaleImageFromOrientedSize:orientedImageSize];
+        self.properties = [self createImagePropertiesWithUti:mimeType imageSize:imageSize];
+        return;
+    }
+
     const CGImageRef image = self.forceSquare ? [self squareImage] : [self rotatedImage];
     CGSize imageSize = CGSizeMake(CGImageGetWidth(image), CGImageGetHeight(image));
 
-    NSString *mimeType = self.loadOperation.computedImageProperties.mimeType;
     if ([self shouldScale:image]) {
         imageSize = [self scaleImage:image];
     }
@@ -174,7 +229,7 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
         mimeType = [self recompressImage:image];
     }
     if (self.downsampleImageData == nil) {
-        if(image == self.loadOperation.CGImage) {
+        if(image == self.loadOperation.CGImage && ! self.loadOperation.isDecodedAtReducedSize) {
             self.downsampleImageData = self.loadOperation.originalImageData;
         }
         else {
@@ -187,6 +242,21 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
     CGImageRelease(image);
 }
 
+/// Rotates and scales the decoded image to the final size in a single draw.
+- (CGSize)scaleImageFromOrientedSize:(CGSize)orientedImageSize
+{
+    const CGSize finalSize = [self finalSizeForOriginalSize:orientedImageSize];
+    const int orientation = self.loadOperation.isDecodedAtReducedSize ? TiffOrientationCorrect : self.loadOperation.tiffOrientation;
+    CGImageRef scaledImage = [self drawImage:self.loadOperation.CGImage orientation:orientation size:finalSize];
+    
+    NSString *format = self.forceLossy ? UTTypeJPEG.identifier : self.formatForScaling;
+    
+    self.downsampleImageData = [self createCompressImageDataFromImage:scaledImage format:format];
+    self.imageFormat = format;
+    CGImageRelease(scaledImage);
+    return finalSize;
+}
+
 - (CGSize)scaleImage:(CGImageRef)image
 {
     const CGSize originalSize = CGSizeMake(CGImageGetWidth(image), CGImageGetHeight(image));
@@ -240,10 +310,7 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
 - (BOOL)shouldScale:(CGImageRef)image
 {
     const CGSize size = CGSizeMake(CGImageGetWidth(image), CGImageGetHeight(image));
-    BOOL const oneSideIsToLong = ((size.width > ScaleFudgeFactor * self.targetDimension) || (size.height > ScaleFudgeFactor * self.targetDimension));
-    double const MaxPixelCount = ScaleFudgeFactor * self.targetDimension * self.targetDimension;
-    BOOL const pixelCountIsTooBig = (size.width * size.height > MaxPixelCount);
-    return (oneSideIsToLong && pixelCountIsTooBig);
+    return shouldScaleImageOfSize(size, self.targetDimension);
 }
 
 - (NSUInteger)targetByteCount
@@ -264,17 +331,7 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
 
 - (NSUInteger)targetDimension
 {
-    switch (self.downsampleType) {
-        case ZMImageDownsampleTypeMedium:
-            return 1448;
-        case ZMImageDownsampleTypePreview:
-            return 30;
-        case ZMImageDownsampleTypeSmallProfile:
-            return 280;
-        case ZMImageDownsampleTypeInvalid:
-            break;
-    }
-    VerifyActionString(NO, return 0, "Invalid downsample type");
+    return targetDimensionForDownsampleType(self.downsampleType);
 }
 
 - (double)compressionQuality;
@@ -334,19 +391,111 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
 
 - (NSData *)createCompressImageDataFromImage:(CGImageRef)image format:(NSString *)format
 {
-    NSData *result = nil;
-    NSMutableData *data = [NSMutableData dataWithCapacity:(NSUInteger) llround(self.targetByteCount * 1.5)];
-    CGImageDestinationRef dest = CGImageDestinationCreateWithData((__bridge CFMutableDataRef) data, (__bridge CFStringRef) format, 1, NULL);
-    if (dest != NULL) {
-        CGImageDestinationAddImage(dest, image, (__bridge CFDictionaryRef) self.outputProperties);
-        if (CGImageDestinationFinalize(dest)) {
-            result = data;
-        }
-        CFRelease(dest);
+    NSData *result = [self encodeImage:image format:format quality:self.compressionQuality];
+    if (result.length > self.targetByteCount && isFormatKindOfFormat(format, UTTypeJPEG)) {
+        result = [self sizeTargetedJPEGDataFromImage:image initialData:result];
     }
     return result;
 }
 
+- (NSData *)encodeImage:(CGImageRef)image format:(NSString *)format quality:(double)quality
+{
+    NSMutableDictionary *properties = [self.outputProperties mutableCopy];
+    properties[(__bridge id) kCGImageDestinationLossyCompressionQuality] = @(quality);
+    self.encodePassCount += 1;
+    return encodeImage(image, format, properties, (NSUInteger) llround(self.targetByteCount * 1.5));
+}
+
+/// Searches for the highest JPEG quality that fits into the target byte count.
+///
+/// The search starts at a quality estimated from encodes of a small copy of the image and then
+/// bisects between the minimum and the default quality, with at most
+/// @c MaximumSizeSearchEncodePasses full size encodes. If nothing fits, the smallest encoding is used.
+- (NSData *)sizeTargetedJPEGDataFromImage:(CGImageRef)image initialData:(NSData *)initialData
+{
+    double low = MinimumCompressionQuality;
+    double high = self.compressionQuality;
+    if (high <= low) {
+        return initialData;
+    }
+    
+    NSData *bestFit = nil;
+    NSData *smallest = initialData;
+    double quality = [self estimatedQualityForImage:image initialData:initialData];
+    
+    for (NSUInteger pass = 0; pass < MaximumSizeSearchEncodePasses; ++pass) {
+        NSData *data = [self encodeImage:image format:UTTypeJPEG.identifier quality:quality];
+        if (data == nil) {
+            break;
+        }
+        if (data.length <= self.targetByteCount) {
+            bestFit = data;
+            low = quality;
+        } else {
+            high = quality;
+        }
+        if (data.length < smallest.length) {
+            smallest = data;
+        }
+        if (((high - low) < CompressionQualityTolerance) || (bestFit == nil && quality <= MinimumCompressionQuality)) {
+            break;
+        }
+        // Make sure the last pass tries the minimum quality if nothing fitted so far.
+        BOOL const isLastPass = (pass + 2 == MaximumSizeSearchEncodePasses);
+        quality = (bestFit == nil && isLastPass) ? low : 0.5 * (low + high);
+    }
+    
+    return bestFit ?: smallest;
+}
+
+/// Estimates the quality that hits the target byte count from encodes of a small copy of the image,
+/// scaled by the ratio between the full size and the probe encode at the default quality.
+- (double)estimatedQualityForImage:(CGImageRef)image initialData:(NSData *)initialData
+{
+    double const defaultQuality = self.compressionQuality;
+    NSUInteger const defaultProbeByteCount = [self probeByteCountForImage:image quality:defaultQuality];
+    if (defaultProbeByteCount == 0) {
+        return 0.5 * (MinimumCompressionQuality + defaultQuality);
+    }
+    double const bytesPerProbeByte = initialData.length / (double) defaultProbeByteCount;
+    
+    for (double quality = defaultQuality - ProbeCompressionQualityStep; quality > MinimumCompressionQuality; quality -= ProbeCompressionQualityStep) {
+        if ([self probeByteCountForImage:image quality:quality] * bytesPerProbeByte <= self.targetByteCount) {
+            return quality;
+        }
+    }
+    return MinimumCompressionQuality;
+}
+
+- (NSUInteger)probeByteCountForImage:(CGImageRef)image quality:(double)quality
+{
+    if (self.probeSourceImage != image) {
+        CGImageRelease(self.probeSourceImage);
+        self.probeSourceImage = CGImageRetain(image);
+        CGImageRelease(self.probeImage);
+        self.probeImage = [self createProbeImageFromImage:image];
+        self.probeByteCounts = [NSMutableDictionary dictionary];
+    }
+    
+    NSNumber *key = @(llround(quality * 1000));
+    NSNumber *byteCount = self.probeByteCounts[key];
+    if (byteCount == nil) {
+        NSDictionary *properties = @{(__bridge id) kCGImageDestinationLossyCompressionQuality: @(quality)};
+        byteCount = @(encodeImage(self.probeImage, UTTypeJPEG.identifier, properties, 0).length);
+        self.probeByteCounts[key] = byteCount;
+    }
+    return byteCount.unsignedIntegerValue;
+}
+
+- (CGImageRef)createProbeImageFromImage:(CGImageRef)image CF_RETURNS_RETAINED
+{
+    CGSize const size = CGSizeMake(CGImageGetWidth(image), CGImageGetHeight(image));
+    double const scale = fmin(1, ProbePixelSize / fmax(size.width, size.height));
+    CGSize const probeSize = CGSizeMake((CGFloat) fmax(1, round(size.width * scale)),
+                                        (CGFloat) fmax(1, round(size.height * scale)));
+    return [self scaleImage:image toSize:probeSize];
+}
+
 - (NSString *)formatForScaling
 {
     return (NSString *)UTTypeJPEG.identifier;
@@ -417,7 +566,8 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
     CGImageRef image = [self.loadOperation CGImage];
     int orientation = [self.loadOperation tiffOrientation];
     
-    if ((orientation == TiffOrientationCorrect) ||
+    if (self.loadOperation.isDecodedAtReducedSize ||
+        (orientation == TiffOrientationCorrect) ||
         (orientation == TiffOrientationNotSet))
     {
         return CGImageRetain(image);
@@ -429,16 +579,7 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
 
 - (CGSize)finalSizeForOriginalSize:(CGSize)originalSize
 {
-    VerifyReturnValue(originalSize.width > 0 && originalSize.height > 0, CGSizeMake(1, 1));
-    
-    double const scale1 = fmax(self.targetDimension / (double) originalSize.width,
-                                   self.targetDimension / (double) originalSize.height);
-    double const scale2 = self.targetDimension / sqrt(originalSize.width * originalSize.height);
-    double const scale =  (isfinite(scale2) && (scale2 < scale1)) ? 0.5 * (scale2 + scale1) : scale1;
-    CGSize result = CGSizeZero;
-    result.width = (CGFloat) ceil(scale * originalSize.width);
-    result.height = (CGFloat) round(result.width / originalSize.width * originalSize.height);
-    return result;
+    return finalSizeForOriginalSize(originalSize, self.targetDimension);
 }
 
 
@@ -455,51 +596,67 @@ static void bitmapContextReleaseData(void *releaseInfo, void *data);
 }
 
 - (CGImageRef)rotateImageWithEXIF:(CGImageRef)source orientation:(int) orientation CF_RETURNS_RETAINED
+{
+    if (orientation < 2 || orientation > 8) {
+        return NULL;
+    }
+    CGSize const size = orientedSizeForSize(CGSizeMake(CGImageGetWidth(source), CGImageGetHeight(source)), orientation);
+    return [self drawImage:source orientation:orientation size:size];
+}
+
+/// Draws the image with the given EXIF orientation applied, scaled to the given size.
+- (CGImageRef)drawImage:(CGImageRef)source orientation:(int)orientation size:(CGSize)finalSize CF_RETURNS_RETAINED
+{
+    CGSize const sourceSize = CGSizeMake(CGImageGetWidth(source), CGImageGetHeight(source));
+    CGSize const orientedSize = orientedSizeForSize(sourceSize, orientation);
+    
+    CGContextRef context = createBitmapContext((size_t) finalSize.width, (size_t) finalSize.height);
+    CGContextScaleCTM(context, finalSize.width / orientedSize.width, finalSize.height / orientedSize.height);
+    CGContextConcatCTM(context, [self transformForOrientation:orientation sourceSize:sourceSize]);
+    CGContextDrawImage(context, CGRectMake(0, 0, sourceSize.width, sourceSize.height), source);
+    CGContextFlush(context);
+    CGImageRef result = CGBitmapContextCreateImage(context);
+    
+    CFRelease(context);
+    
+    return result;
+}
+
+- (CGAffineTransform)transformForOrientation:(int)orientation sourceSize:(CGSize)size
 {
     switch (orientation)
     {
         case 2:
-            return [self rotateImageWithFlip:source angle:0 flipX:YES flipY:NO];
-            break;
+            return [self transformWithAngle:0 flipX:YES flipY:NO sourceSize:size];
         case 3:
-            return [self rotateImageWithFlip:source angle:0 flipX:YES flipY:YES];
-            break;
+            return [self transformWithAngle:0 flipX:YES flipY:YES sourceSize:size];
         case 4:
-            return [self rotateImageWithFlip:source angle:0 flipX:NO flipY:YES];
-            break;
+            return [self transformWithAngle:0 flipX:NO flipY:YES sourceSize:size];
             
         case 5:
-            return [self rotateImageWithFlip:source angle:90 flipX:NO flipY:YES];
-            break;
+            return [self transformWithAngle:90 flipX:NO flipY:YES sourceSize:size];
         case 6:
-            return [self rotateImageWithFlip:source angle:-90 flipX:NO flipY:NO];
-            break;
+            return [self transformWithAngle:-90 flipX:NO flipY:NO sourceSize:size];
             
         case 7:
-            return [self rotateImageWithFlip:source angle:90 flipX:YES flipY:NO];
-            break;
+            return [self transformWithAngle:90 flipX:YES flipY:NO sourceSize:size];
         case 8:
-            return [self rotateImageWithFlip:source angle:-90 flipX:YES flipY:YES];
-            break;
+            return [self transformWithAngle:-90 flipX:YES flipY:YES sourceSize:size];
             
         default:
             break;
     }
     
-    return NULL;
+    return CGAffineTransformIdentity;
 }
 
 static inline double radians (double degrees) { return degrees * M_PI/180; }
 
-- (CGImageRef)rotateImageWithFlip:(CGImageRef)source angle:(float)angle flipX:(BOOL)flipX flipY:(BOOL)flipY CF_RETURNS_RETAINED
+- (CGAffineTransform)transformWithAngle:(float)angle flipX:(BOOL)flipX flipY:(BOOL)flipY sourceSize:(CGSize)size
 {
-    double fX    =  fabs ( cos ( radians ( angle ) ) );
-    double fY    =  fabs ( sin ( radians ( angle ) ) );
-    
-    double dW    =  CGImageGetWidth(source) * fX + CGImageGetHeight(source) * fY;
-    double dH    =  CGImageGetWidth(source) * fY + CGImageGetHeight(source) * fX;
-    
-    CGContextRef context = createBitmapContext((size_t)dW, (size_t)dH);
+    BOOL const swapsSides = (angle != 0);
+    double const dW = swapsSides ? size.height : size.width;
+    double const dH = swapsSides ? size.width : size.height;
     
     CGAffineTransform transform = CGAffineTransformMakeTranslation(flipX?(CGFloat)dW:0.0f,flipY?(CGFloat)dH:0.0f);
     transform = CGAffineTransformScale(transform, flipX?-1.0:1.0f,flipY?-1.0: 1.0f);
@@ -511,16 +668,7 @@ static inline double radians (double degrees) { return degrees * M_PI/180; }
         transform             = CGAffineTransformConcat(rot, transform);
     }
     
-    CGContextConcatCTM(context, transform);
-    CGRect r = CGRectMake(0, 0,
-                          CGImageGetWidth(source), CGImageGetHeight(source));
-    CGContextDrawImage(context, r, source);
-    CGContextFlush(context);
-    CGImageRef rotated = CGBitmapContextCreateImage(context);
-    
-    CFRelease(context);
-    
-    return rotated;
+    return transform;
 }
 
 @end
@@ -552,3 +700,68 @@ static void bitmapContextReleaseData(void *releaseInfo, void * __unused data)
 		CFRelease(o);
 	}
 }
+
+static NSUInteger targetDimensionForDownsampleType(ZMImageDownsampleType downsampleType)
+{
+    switch (downsampleType) {
+        case ZMImageDownsampleTypeMedium:
+            return 1448;
+        case ZMImageDownsampleTypePreview:
+            return 30;
+        case ZMImageDownsampleTypeSmallProfile:
+            return 280;
+        case ZMImageDownsampleTypeInvalid:
+            break;
+    }
+    VerifyActionString(NO, return 0, "Invalid downsample type");
+}
+
+static BOOL shouldScaleImageOfSize(CGSize size, double targetDimension)
+{
+    BOOL const oneSideIsToLong = ((size.width > ScaleFudgeFactor * targetDimension) || (size.height > ScaleFudgeFactor * targetDimension));
+    double const MaxPixelCount = ScaleFudgeFactor * targetDimension * targetDimension;
+    BOOL const pixelCountIsTooBig = (size.width * size.height > MaxPixelCount);
+    return (oneSideIsToLong && pixelCountIsTooBig);
+}
+
+static CGSize finalSizeForOriginalSize(CGSize originalSize, double targetDimension)
+{
+    VerifyReturnValue(originalSize.width > 0 && originalSize.height > 0, CGSizeMake(1, 1));
+    
+    double const scale1 = fmax(targetDimension / (double) originalSize.width,
+                               targetDimension / (double) originalSize.height);
+    double const scale2 = targetDimension / sqrt(originalSize.width * originalSize.height);
+    double const scale =  (isfinite(scale2) && (scale2 < scale1)) ? 0.5 * (scale2 + scale1) : scale1;
+    CGSize result = CGSizeZero;
+    result.width = (CGFloat) ceil(scale * originalSize.width);
+    result.height = (CGFloat) round(result.width / originalSize.width * originalSize.height);
+    return result;
+}
+
+static CGSize orientedSizeForSize(CGSize size, int orientation)
+{
+    switch (orientation) {
+        case 5:
+        case 6:
+        case 7:
+        case 8:
+            return CGSizeMake(size.height, size.width);
+        default:
+            return size;
+    }
+}
+
+static NSData *encodeImage(CGImageRef image, NSString *format, NSDictionary *properties, NSUInteger capacity)
+{
+    NSData *result = nil;
+    NSMutableData *data = [NSMutableData dataWithCapacity:capacity];
+    CGImageDestinationRef dest = CGImageDestinationCreateWithData((__bridge CFMutableDataRef) data, (__bridge CFStringRef) format, 1, NULL);
+    if (dest != NULL) {
+        CGImageDestinationAddImage(dest, image, (__bridge CFDictionaryRef) properties);
+        if (CGImageDestinationFinalize(dest)) {
+            result = data;
+        }
+        CFRelease(dest);
+    }
+    return result;
+}
@@ -26,10 +26,19 @@
 - (instancetype)initWithImageData:(NSData *)imageData;
 - (instancetype)initWithImageFileURL:(NSURL *)fileURL;
 
+/// When set, images that are larger than this many pixels on their longest
+/// side are decoded subsampled to that size, with the EXIF orientation
+/// already applied. Defaults to 0, which decodes the full image.
+@property (nonatomic) CGFloat maximumPixelSize;
+
 @property (nonatomic, readonly) CGImageRef CGImage;
+/// YES when `CGImage` was decoded at a reduced size and with the orientation applied.
+@property (nonatomic, readonly) BOOL isDecodedAtReducedSize;
 @property (nonatomic, readonly, copy) NSDictionary *sourceImageProperties;
 
 @property (nonatomic, readonly) int tiffOrientation;
+/// The pixel size of the source image once its orientation is applied.
+@property (nonatomic, readonly) CGSize orientedImageSize;
 @property (nonatomic, readonly) ZMIImageProperties *computedImageProperties;
 @property (nonatomic, readonly, copy) NSData *originalImageData;
 
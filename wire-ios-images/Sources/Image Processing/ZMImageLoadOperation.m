@@ -32,6 +32,7 @@
 @property (nonatomic, copy) NSDictionary *sourceImageProperties;
 @property (nonatomic, copy) NSData *originalImageData;
 @property (nonatomic) ZMIImageProperties *computedImageProperties;
+@property (nonatomic) BOOL isDecodedAtReducedSize;
 
 @end
 
@@ -101,11 +102,27 @@
     NSDictionary *imageOptions = nil;
     size_t const imageIndex = 0;
     
-    _CGImage = CGImageSourceCreateImageAtIndex(_source, imageIndex, (__bridge CFDictionaryRef) imageOptions);
-    
     self.sourceImageProperties = CFBridgingRelease(CGImageSourceCopyPropertiesAtIndex(_source, imageIndex, (__bridge CFDictionaryRef) imageOptions));
     
     CGSize size = [self imageSizeFromSourceImage];
+    
+    if (self.maximumPixelSize > 0 && self.maximumPixelSize < fmax(size.width, size.height)) {
+        // Let ImageIO subsample while decoding and apply the orientation in the same pass,
+        // so the full-size bitmap is never allocated.
+        NSDictionary *thumbnailOptions = @{
+            (__bridge id) kCGImageSourceCreateThumbnailFromImageAlways: @YES,
+            (__bridge id) kCGImageSourceCreateThumbnailWithTransform: @YES,
+            (__bridge id) kCGImageSourceShouldCacheImmediately: @YES,
+            (__bridge id) kCGImageSourceThumbnailMaxPixelSize: @(ceil(self.maximumPixelSize)),
+        };
+        _CGImage = CGImageSourceCreateThumbnailAtIndex(_source, imageIndex, (__bridge CFDictionaryRef) thumbnailOptions);
+        self.isDecodedAtReducedSize = (_CGImage != NULL);
+    }
+    
+    if (_CGImage == NULL) {
+        _CGImage = CGImageSourceCreateImageAtIndex(_source, imageIndex, (__bridge CFDictionaryRef) imageOptions);
+    }
+    
     NSUInteger length = (NSUInteger) [(NSNumber *)self.sourceImageProperties[(__bridge id) kCGImagePropertyFileSize] intValue];
     NSString *mimeType = (__bridge id) CGImageSourceGetType(_source);
     self.computedImageProperties = [ZMIImageProperties
@@ -121,6 +138,20 @@
     return o.intValue;
 }
 
+- (CGSize)orientedImageSize;
+{
+    CGSize const size = [self imageSizeFromSourceImage];
+    switch (self.tiffOrientation) {
+        case 5:
+        case 6:
+        case 7:
+        case 8:
+            return CGSizeMake(size.height, size.width);
+        default:
+            return size;
+    }
+}
+
 - (CGSize)imageSizeFromSourceImage;
 {
     NSNumber *w = self.sourceImageProperties[(__bridge id) kCGImagePropertyPixelWidth];
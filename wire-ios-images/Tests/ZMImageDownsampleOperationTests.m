@@ -18,6 +18,8 @@
 
 @import WireImages;
 @import WireTesting;
+@import ImageIO;
+@import UniformTypeIdentifiers;
 
 #import "NSOperationQueue+Helpers.h"
 
@@ -657,3 +659,269 @@ static NSString const * TypeJPEG = @"image/jpeg";
 }
 
 @end
+
+
+
+@interface ZMPipelineTestImageOwner : NSObject <ZMImageOwner, ZMAssetsPreprocessorDelegate>
+
+@property (nonatomic, copy) NSData *originalImageData;
+@property (nonatomic) NSOrderedSet *requiredImageFormats;
+@property (nonatomic) NSMutableDictionary<NSNumber *, id<ZMImageDownsampleOperationProtocol>> *completedOperations;
+
+@end
+
+@implementation ZMPipelineTestImageOwner
+
+- (void)completedDownsampleOperation:(id<ZMImageDownsampleOperationProtocol>)operation imageOwner:(id<ZMImageOwner>)imageOwner
+{
+    (void) imageOwner;
+    @synchronized (self) {
+        self.completedOperations[@(operation.format)] = operation;
+    }
+}
+
+- (void)failedPreprocessingImageOwner:(id<ZMImageOwner>)imageOwner
+{
+    (void) imageOwner;
+}
+
+- (NSOperation *)preprocessingCompleteOperationForImageOwner:(id<ZMImageOwner>)imageOwner
+{
+    (void) imageOwner;
+    return nil;
+}
+
+@end
+
+
+
+@implementation ZMImageDownsampleOperationTests (Pipeline)
+
+/// Creates a JPEG with the given pixel size and EXIF orientation, filled with a gradient.
+- (NSData *)jpegDataWithSize:(CGSize)size orientation:(int)orientation
+{
+    CGColorSpaceRef space = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, (size_t) size.width, (size_t) size.height, 8, 0, space, (CGBitmapInfo) kCGImageAlphaNoneSkipLast);
+    CGFloat const components[] = {0.9, 0.2, 0.1, 1, 0.1, 0.3, 0.9, 1};
+    CGGradientRef gradient = CGGradientCreateWithColorComponents(space, components, NULL, 2);
+    CGContextDrawLinearGradient(context, gradient, CGPointZero, CGPointMake(size.width, size.height), 0);
+    CGImageRef image = CGBitmapContextCreateImage(context);
+    
+    NSMutableData *data = [NSMutableData data];
+    CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef) data, (__bridge CFStringRef) UTTypeJPEG.identifier, 1, NULL);
+    NSDictionary *properties = @{(__bridge id) kCGImagePropertyOrientation: @(orientation),
+                                 (__bridge id) kCGImageDestinationLossyCompressionQuality: @0.8};
+    CGImageDestinationAddImage(destination, image, (__bridge CFDictionaryRef) properties);
+    XCTAssertTrue(CGImageDestinationFinalize(destination));
+    
+    CFRelease(destination);
+    CGImageRelease(image);
+    CGGradientRelease(gradient);
+    CGContextRelease(context);
+    CGColorSpaceRelease(space);
+    return data;
+}
+
+- (ZMPipelineTestImageOwner *)processImageData:(NSData *)imageData formats:(NSArray<NSNumber *> *)formats
+{
+    ZMPipelineTestImageOwner *imageOwner = [[ZMPipelineTestImageOwner alloc] init];
+    imageOwner.originalImageData = imageData;
+    imageOwner.requiredImageFormats = [NSOrderedSet orderedSetWithArray:formats];
+    imageOwner.completedOperations = [NSMutableDictionary dictionary];
+    
+    ZMAssetsPreprocessor *preprocessor = [[ZMAssetsPreprocessor alloc] initWithDelegate:imageOwner];
+    NSOperationQueue *queue = [ZMImagePreprocessor createSuitableImagePreprocessingQueue];
+    [queue addOperations:[preprocessor operationsForPreprocessingImageOwner:imageOwner] waitUntilFinished:YES];
+    return imageOwner;
+}
+
+- (void)testThatThePipelineProducesAllFormatsFromASingleReducedDecode
+{
+    // given
+    NSData *imageData = [self jpegDataWithSize:CGSizeMake(4000, 3000) orientation:6];
+    
+    // when
+    ZMPipelineTestImageOwner *imageOwner = [self processImageData:imageData formats:@[@(ZMImageFormatPreview), @(ZMImageFormatMedium)]];
+    
+    // then
+    id<ZMImageDownsampleOperationProtocol> medium = imageOwner.completedOperations[@(ZMImageFormatMedium)];
+    id<ZMImageDownsampleOperationProtocol> preview = imageOwner.completedOperations[@(ZMImageFormatPreview)];
+    XCTAssertNotNil(medium.downsampleImageData);
+    XCTAssertNotNil(preview.downsampleImageData);
+    XCTAssertLessThan(medium.properties.size.width, medium.properties.size.height);
+    XCTAssertLessThan(preview.properties.size.width, preview.properties.size.height);
+    XCTAssertTrue(CGSizeEqualToSize(medium.properties.size, [UIImage imageWithData:medium.downsampleImageData].size));
+    XCTAssertTrue(CGSizeEqualToSize(preview.properties.size, [UIImage imageWithData:preview.downsampleImageData].size));
+}
+
+- (void)testThatItComputesTheDecodedPixelSizeOfTheLargestFormat
+{
+    // given
+    CGSize const imageSize = CGSizeMake(3000, 4000);
+    
+    // then
+    XCTAssertEqualWithAccuracy([ZMImageDownsampleOperation decodedPixelSizeForImageSize:imageSize downsampleType:ZMImageDownsampleTypeMedium], 1800, 100);
+    XCTAssertLessThan([ZMImageDownsampleOperation decodedPixelSizeForImageSize:imageSize downsampleType:ZMImageDownsampleTypePreview], 50);
+    XCTAssertEqualWithAccuracy([ZMImageDownsampleOperation decodedPixelSizeForImageSize:imageSize downsampleType:ZMImageDownsampleTypeSmallProfile], 375, 2);
+    XCTAssertEqual([ZMImageDownsampleOperation decodedPixelSizeForImageSize:CGSizeMake(1000, 800) downsampleType:ZMImageDownsampleTypeMedium], 0);
+}
+
+- (void)assertPipelinePerformanceForImageOfSize:(CGSize)size
+{
+    NSData *imageData = [self jpegDataWithSize:size orientation:6];
+    NSArray *formats = @[@(ZMImageFormatPreview), @(ZMImageFormatMedium)];
+    XCTMeasureOptions *options = [XCTMeasureOptions defaultOptions];
+    options.iterationCount = 3;
+    
+    [self measureWithMetrics:@[[[XCTCPUMetric alloc] init], [[XCTMemoryMetric alloc] init], [[XCTClockMetric alloc] init]] options:options block:^{
+        @autoreleasepool {
+            ZMPipelineTestImageOwner *imageOwner = [self processImageData:imageData formats:formats];
+            XCTAssertEqual(imageOwner.completedOperations.count, formats.count);
+        }
+    }];
+}
+
+- (void)testPipelinePerformance_12MP
+{
+    [self assertPipelinePerformanceForImageOfSize:CGSizeMake(4032, 3024)];
+}
+
+- (void)testPipelinePerformance_48MP
+{
+    [self assertPipelinePerformanceForImageOfSize:CGSizeMake(8064, 6048)];
+}
+
+@end
+
+
+
+@implementation ZMImageDownsampleOperationTests (SizeTargeting)
+
+/// Creates a PNG filled with random pixels, which JPEG compresses badly, or with a flat color.
+- (NSData *)pngDataWithSize:(CGSize)size noise:(BOOL)noise
+{
+    CGColorSpaceRef space = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, (size_t) size.width, (size_t) size.height, 8, 0, space, (CGBitmapInfo) kCGImageAlphaNoneSkipLast);
+    if (noise) {
+        arc4random_buf(CGBitmapContextGetData(context), CGBitmapContextGetBytesPerRow(context) * (size_t) size.height);
+    } else {
+        CGContextSetRGBFillColor(context, 0.2, 0.4, 0.8, 1);
+        CGContextFillRect(context, CGRectMake(0, 0, size.width, size.height));
+    }
+    CGImageRef image = CGBitmapContextCreateImage(context);
+    NSData *data = [self pngDataWithImage:image];
+    
+    CGImageRelease(image);
+    CGContextRelease(context);
+    CGColorSpaceRelease(space);
+    return data;
+}
+
+/// Creates a PNG of a gradient with faint noise, which only fits the medium target byte count at a reduced JPEG quality.
+- (NSData *)pngDataWithGrainyGradientOfSize:(CGSize)size
+{
+    CGColorSpaceRef space = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, (size_t) size.width, (size_t) size.height, 8, 0, space, (CGBitmapInfo) kCGImageAlphaNoneSkipLast);
+    uint8_t *pixels = CGBitmapContextGetData(context);
+    size_t const bytesPerRow = CGBitmapContextGetBytesPerRow(context);
+    for (size_t y = 0; y < (size_t) size.height; ++y) {
+        for (size_t x = 0; x < (size_t) size.width; ++x) {
+            uint8_t *pixel = pixels + y * bytesPerRow + x * 4;
+            int const base = (int) (200 * x / size.width);
+            for (size_t channel = 0; channel < 3; ++channel) {
+                pixel[channel] = (uint8_t) (base + (int) channel * 16 + (int) arc4random_uniform(24));
+            }
+        }
+    }
+    CGImageRef image = CGBitmapContextCreateImage(context);
+    NSData *data = [self pngDataWithImage:image];
+    
+    CGImageRelease(image);
+    CGContextRelease(context);
+    CGColorSpaceRelease(space);
+    return data;
+}
+
+- (NSData *)pngDataWithImage:(CGImageRef)image
+{
+    NSMutableData *data = [NSMutableData data];
+    CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef) data, (__bridge CFStringRef) UTTypePNG.identifier, 1, NULL);
+    CGImageDestinationAddImage(destination, image, NULL);
+    XCTAssertTrue(CGImageDestinationFinalize(destination));
+    
+    CFRelease(destination);
+    return data;
+}
+
+- (void)testThatItSearchesForAQualityThatFitsTheTargetByteCount
+{
+    // given
+    NSData *inputData = [self pngDataWithSize:CGSizeMake(2000, 1500) noise:YES];
+    
+    // when
+    ZMImageDownsampleOperation *outputData = [self mediumImageDataForInputData:inputData];
+    
+    // then
+    XCTAssertNotNil(outputData.downsampleImageData);
+    XCTAssertEqualObjects(outputData.properties.mimeType, TypeJPEG);
+    XCTAssertGreaterThan(outputData.encodePassCount, 1u);
+    XCTAssertLessThanOrEqual(outputData.encodePassCount, 4u);
+    XCTAssert(CGSizeEqualToSize(outputData.properties.size, [UIImage imageWithData:outputData.downsampleImageData].size));
+}
+
+- (void)testThatItReducesTheQualityUntilTheImageFitsTheTargetByteCount
+{
+    // given
+    NSData *inputData = [self pngDataWithGrainyGradientOfSize:CGSizeMake(2000, 1500)];
+    
+    // when
+    ZMImageDownsampleOperation *outputData = [self mediumImageDataForInputData:inputData];
+    
+    // then
+    XCTAssertNotNil(outputData.downsampleImageData);
+    XCTAssertEqualObjects(outputData.properties.mimeType, TypeJPEG);
+    XCTAssertGreaterThan(outputData.encodePassCount, 1u);
+    XCTAssertLessThanOrEqual(outputData.encodePassCount, 4u);
+    XCTAssertLessThanOrEqual(outputData.downsampleImageData.length, 310u * 1024u);
+}
+
+- (void)testThatItEncodesOnceWhenTheImageFitsTheTargetByteCount
+{
+    // given
+    NSData *inputData = [self pngDataWithSize:CGSizeMake(2000, 1500) noise:NO];
+    
+    // when
+    ZMImageDownsampleOperation *outputData = [self mediumImageDataForInputData:inputData];
+    
+    // then
+    XCTAssertNotNil(outputData.downsampleImageData);
+    XCTAssertLessThanOrEqual(outputData.downsampleImageData.length, 310u * 1024u);
+    XCTAssertEqual(outputData.encodePassCount, 1u);
+}
+
+- (void)testMediumEncodePassesPerformance
+{
+    NSArray<NSData *> *corpus = @[
+        [self dataForResource:@"unsplash_720_KB" extension:@"jpg"],
+        [self dataForResource:@"unsplash_720_KB_rotated" extension:@"jpg"],
+        [self dataForResource:@"unsplash_owl_1_MB" extension:@"png"],
+        [self dataForResource:@"unsplash_portrait" extension:@"jpg"],
+        [self dataForResource:@"ceiling_rotated_1" extension:@"jpg"],
+        [self dataForResource:@"ceiling_rotated_2" extension:@"png"],
+        [self pngDataWithSize:CGSizeMake(2000, 1500) noise:YES],
+    ];
+    
+    __block NSUInteger encodePassCount = 0;
+    [self measureWithMetrics:@[[[XCTCPUMetric alloc] init], [[XCTClockMetric alloc] init]] block:^{
+        encodePassCount = 0;
+        for (NSData *inputData in corpus) {
+            @autoreleasepool {
+                encodePassCount += [self mediumImageDataForInputData:inputData].encodePassCount;
+            }
+        }
+    }];
+    
+    XCTAssertLessThanOrEqual(encodePassCount, corpus.count * 4);
+}
+
+@end
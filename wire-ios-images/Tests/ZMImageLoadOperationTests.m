@@ -59,6 +59,48 @@
     AssertEqualSizes(sut.computedImageProperties.size, CGSizeMake(531, 346));
 }
 
+- (void)testThatItDecodesAtAReducedSizeWithTheOrientationApplied;
+{
+    // given
+    NSData *imageData = [self dataForResource:@"unsplash_medium_exif_6" extension:@"jpg"];
+    ZMImageLoadOperation *sut = [[ZMImageLoadOperation alloc] initWithImageData:imageData];
+    sut.maximumPixelSize = 100;
+    
+    // when
+    [sut start];
+    XCTAssert([self waitOnMainLoopUntilBlock:^BOOL{
+        return [sut isFinished];
+    } timeout:1]);
+    
+    // then
+    XCTAssertNotEqual(sut.CGImage, NULL);
+    XCTAssertTrue(sut.isDecodedAtReducedSize);
+    XCTAssertEqual(sut.tiffOrientation, 6);
+    CGSize const orientedSize = sut.orientedImageSize;
+    XCTAssertLessThan(orientedSize.width, orientedSize.height);
+    XCTAssertLessThan(CGImageGetWidth(sut.CGImage), CGImageGetHeight(sut.CGImage));
+    XCTAssertEqual(CGImageGetHeight(sut.CGImage), 100u);
+}
+
+- (void)testThatItDecodesTheFullImageWhenItIsSmallerThanTheMaximumPixelSize;
+{
+    // given
+    NSData *imageData = [self dataForResource:@"unsplash_medium_exif_2" extension:@"jpg"];
+    ZMImageLoadOperation *sut = [[ZMImageLoadOperation alloc] initWithImageData:imageData];
+    sut.maximumPixelSize = 1000;
+    
+    // when
+    [sut start];
+    XCTAssert([self waitOnMainLoopUntilBlock:^BOOL{
+        return [sut isFinished];
+    } timeout:1]);
+    
+    // then
+    XCTAssertFalse(sut.isDecodedAtReducedSize);
+    XCTAssertEqual(CGImageGetWidth(sut.CGImage), 531u);
+    XCTAssertEqual(CGImageGetHeight(sut.CGImage), 346u);
+}
+
 - (void)testThatItDoesNotLoadWhenCancelled
 {
     // given
@@ -0,0 +1,89 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// A preview downloader that answers from an `OpenGraphDataCache` when it can,
+/// and merges concurrent requests for the same link into a single download.
+final class CachingPreviewDownloader: PreviewDownloaderType {
+
+    typealias DownloadCompletion = (OpenGraphData?) -> Void
+
+    let cache: OpenGraphDataCache
+
+    private let downloader: PreviewDownloaderType
+    private let resultsQueue: OperationQueue
+    private let lock = NSLock()
+    private var completionsByKey = [String: [DownloadCompletion]]()
+
+    /// - parameter resultsQueue: The queue cached results are delivered on, it should be
+    ///   the results queue of `downloader`.
+    init(downloader: PreviewDownloaderType, cache: OpenGraphDataCache, resultsQueue: OperationQueue) {
+        self.downloader = downloader
+        self.cache = cache
+        self.resultsQueue = resultsQueue
+    }
+
+    func requestOpenGraphData(fromURL url: URL, completion: @escaping DownloadCompletion) {
+        let key = OpenGraphDataCache.key(for: url)
+
+        if let entry = cache.entry(forKey: key) {
+            resultsQueue.addOperation {
+                completion(entry.data)
+            }
+            return
+        }
+
+        if PreviewBlacklist.isBlacklisted(url) {
+            // The blacklist may change with the next version of the app.
+            cache.store(nil, forKey: key)
+
+            resultsQueue.addOperation {
+                completion(nil)
+            }
+            return
+        }
+
+        lock.lock()
+        let isInFlight = completionsByKey[key] != nil
+        completionsByKey[key, default: []].append(completion)
+        lock.unlock()
+
+        if isInFlight {
+            cache.recordJoinedRequest()
+            return
+        }
+
+        downloader.requestOpenGraphData(fromURL: url) { [weak self] data in
+            guard let self else { return }
+
+            cache.store(data, forKey: key)
+
+            lock.lock()
+            let completions = completionsByKey.removeValue(forKey: key) ?? []
+            lock.unlock()
+
+            completions.forEach { $0(data) }
+        }
+    }
+
+    func tearDown() {
+        downloader.tearDown()
+    }
+
+}
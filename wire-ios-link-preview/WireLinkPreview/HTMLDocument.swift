@@ -30,20 +30,6 @@ typealias HTMLElement = xmlNodePtr
 
 extension UnsafeMutablePointer where Pointee == xmlDoc {
 
-    /// Tries to create a new HTML document.
-    init?(xmlString: String) {
-        let options = Int32(HTML_PARSE_NOWARNING.rawValue) | Int32(HTML_PARSE_NOERROR.rawValue) | Int32(HTML_PARSE_RECOVER.rawValue)
-        let data = Data(xmlString.utf8)
-
-        let decodedDocument = data.withUnsafeBytes { (pointer: UnsafeRawBufferPointer) -> xmlDocPtr? in
-            guard let cString = pointer.baseAddress?.assumingMemoryBound(to: Int8.self) else { return nil }
-            return htmlReadMemory(cString, Int32(data.count), "", nil, options)
-        }
-
-        guard let rawPtr = decodedDocument else { return nil }
-        self = rawPtr
-    }
-
     /// Returns the root element of the document.
     var rootElement: xmlNodePtr? {
         return xmlDocGetRootElement(self)
@@ -56,6 +42,75 @@ extension UnsafeMutablePointer where Pointee == xmlDoc {
 
 }
 
+/// Parses an HTML document from chunks of bytes, as they are downloaded.
+///
+/// The bytes are handed to libxml2's push parser, so the tree is built while
+/// the download is still running and no string has to be decoded first. The
+/// bytes are decoded with the charset of the response if there is one, else
+/// libxml2 detects it from a byte order mark or a `<meta charset>` tag.
+final class HTMLPushParser {
+
+    private var context: htmlParserCtxtPtr?
+    private var document: HTMLDocument?
+
+    /// Creates a parser.
+    /// - parameter encodingName: The IANA name of the charset declared by the response, if any.
+    init(encodingName: String? = nil) {
+        let options = Int32(HTML_PARSE_NOWARNING.rawValue) | Int32(HTML_PARSE_NOERROR.rawValue) | Int32(HTML_PARSE_RECOVER.rawValue)
+        context = htmlCreatePushParserCtxt(nil, nil, nil, 0, "", XML_CHAR_ENCODING_NONE)
+
+        guard let context else { return }
+
+        htmlCtxtUseOptions(context, options)
+
+        if let encodingName, let handler = xmlFindCharEncodingHandler(encodingName) {
+            xmlSwitchToEncoding(context, handler)
+        }
+    }
+
+    deinit {
+        if let context {
+            // The document is only handed over by `finish()`.
+            if let unfinishedDocument = context.pointee.myDoc {
+                xmlFreeDoc(unfinishedDocument)
+                context.pointee.myDoc = nil
+            }
+
+            htmlFreeParserCtxt(context)
+        }
+
+        if let document {
+            HTMLDocument.free(document)
+        }
+    }
+
+    /// Feeds the next chunk of the document to the parser.
+    func parse(_ data: Data) {
+        guard let context, !data.isEmpty else { return }
+
+        data.withUnsafeBytes { (pointer: UnsafeRawBufferPointer) in
+            guard let chunk = pointer.baseAddress?.assumingMemoryBound(to: CChar.self) else { return }
+            htmlParseChunk(context, chunk, Int32(pointer.count), 0)
+        }
+    }
+
+    /// Ends parsing and returns the document made of the chunks fed so far.
+    ///
+    /// The document is owned by the parser and released with it.
+    func finish() -> HTMLDocument? {
+        guard let context else { return document }
+
+        htmlParseChunk(context, nil, 0, 1)
+        document = context.pointee.myDoc
+        context.pointee.myDoc = nil
+        htmlFreeParserCtxt(context)
+        self.context = nil
+
+        return document
+    }
+
+}
+
 extension UnsafeMutablePointer where Pointee == xmlNode {
 
     /// The name of the HTML tag.
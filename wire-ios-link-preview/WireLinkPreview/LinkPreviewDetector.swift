@@ -30,22 +30,42 @@ public final class LinkPreviewDetector: NSObject, LinkPreviewDetectorType {
     private let previewDownloader: PreviewDownloaderType
     private let imageDownloader: ImageDownloaderType
     private let workerQueue: OperationQueue
+    private let cache: OpenGraphDataCache?
 
     public typealias DetectCompletion = ([LinkMetadata]) -> Void
 
+    /// How often previews were answered from the cache of this detector.
+    public var cacheMetrics: OpenGraphDataCacheMetrics? {
+        return cache?.metrics
+    }
+
     public convenience override init() {
         let workerQueue = OperationQueue()
+        let cache = OpenGraphDataCache()
+        let previewDownloader = CachingPreviewDownloader(
+            downloader: PreviewDownloader(resultsQueue: workerQueue),
+            cache: cache,
+            resultsQueue: workerQueue
+        )
+
         self.init(
-            previewDownloader: PreviewDownloader(resultsQueue: workerQueue),
+            previewDownloader: previewDownloader,
             imageDownloader: ImageDownloader(resultsQueue: workerQueue),
-            workerQueue: workerQueue
+            workerQueue: workerQueue,
+            cache: cache
         )
     }
 
-    init(previewDownloader: PreviewDownloaderType, imageDownloader: ImageDownloaderType, workerQueue: OperationQueue) {
+    init(
+        previewDownloader: PreviewDownloaderType,
+        imageDownloader: ImageDownloaderType,
+        workerQueue: OperationQueue,
+        cache: OpenGraphDataCache? = nil
+    ) {
         self.workerQueue = workerQueue
         self.previewDownloader = previewDownloader
         self.imageDownloader = imageDownloader
+        self.cache = cache
         super.init()
     }
 
@@ -18,46 +18,188 @@
 
 import Foundation
 
+/// Collects the bytes of a page while it is downloaded, until the end of its head.
+///
+/// Every chunk is scanned for the end of the head as raw bytes, without decoding
+/// it. Tags are matched ASCII case insensitively and may be split across chunks. A `<body>` tag ends the head as well, for pages that leave out
+/// `</head>`, and markers inside scripts are skipped. The bytes up to the end of
+/// the head are fed to `parser` as they arrive.
 final class MetaStreamContainer {
 
-    var bytes = Data()
+    private(set) var bytes = Data()
 
-    var stringContent: String? {
-        return parseString(from: bytes)
+    /// The parser the head is fed to, ready to be finished once `reachedEndOfHead`.
+    let parser: HTMLPushParser
+
+    var reachedEndOfHead: Bool {
+        return headEndOffset != nil
     }
 
-    var head: String? {
-        guard let content = stringContent else { return nil }
-        var startBound = content.range(of: OpenGraphXMLNode.headStart.rawValue)?.lowerBound ??
-                           content.range(of: OpenGraphXMLNode.headStartNoAttributes.rawValue)?.lowerBound ??
-                           content.startIndex
+    private var headEndOffset: Int?
+    private var isInsideScript = false
 
-        let upperBound = content.range(of: OpenGraphXMLNode.headEnd.rawValue)?.upperBound ?? content.endIndex
+    /// The offset from which the bytes still have to be scanned.
+    private var scanOffset = 0
 
-        if startBound >= upperBound {
-            startBound = content.startIndex
-        }
+    /// The number of bytes that were fed to the parser.
+    private(set) var parsedCount = 0
 
-        let result = content[startBound..<upperBound]
-        return String(result)
+    /// Creates a container.
+    /// - parameter encodingName: The IANA name of the charset declared by the response, if any.
+    init(encodingName: String? = nil) {
+        parser = HTMLPushParser(encodingName: encodingName)
     }
 
-    var reachedEndOfHead = false
-
     @discardableResult func addData(_ data: Data) -> Data {
-        updateReachedEndOfHead(withData: data)
         bytes.append(data)
-        return bytes as Data
+
+        if !reachedEndOfHead {
+            scanForMarkers()
+            feedParser()
+        }
+
+        return bytes
+    }
+
+    // MARK: - Scanning
+
+    private enum Marker: CaseIterable {
+        case headEnd
+        case bodyStart
+        case scriptStart
+        case scriptEnd
+
+        var tag: [UInt8] {
+            switch self {
+            case .headEnd: return Array("</head>".utf8)
+            case .bodyStart: return Array("<body".utf8)
+            case .scriptStart: return Array("<script".utf8)
+            case .scriptEnd: return Array("</script".utf8)
+            }
+        }
+
+        /// Whether the tag name must be followed by whitespace or `>`,
+        /// so that e.g. `<bodyguard>` isn't taken for `<body>`.
+        var needsDelimiter: Bool {
+            return self != .headEnd
+        }
+    }
+
+    private enum Match {
+        case marker(Marker, upperBound: Int)
+        case incomplete
+        case none
+    }
+
+    private static let markers = Marker.allCases.map { (marker: $0, tag: $0.tag) }
+
+    private func scanForMarkers() {
+        bytes.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) in
+            guard let baseAddress = buffer.baseAddress else { return }
+
+            while scanOffset < buffer.count {
+                guard let found = memchr(baseAddress + scanOffset, Int32(UInt8(ascii: "<")), buffer.count - scanOffset) else {
+                    scanOffset = buffer.count
+                    return
+                }
+
+                let offset = baseAddress.distance(to: UnsafeRawPointer(found))
+
+                switch match(at: offset, in: buffer) {
+                case .incomplete:
+                    // Wait for the next chunk to tell.
+                    scanOffset = offset
+                    return
+
+                case .none:
+                    scanOffset = offset + 1
+
+                case let .marker(marker, upperBound):
+                    scanOffset = upperBound
+
+                    switch marker {
+                    case .scriptStart:
+                        isInsideScript = true
+                    case .scriptEnd:
+                        isInsideScript = false
+                    case .headEnd:
+                        headEndOffset = upperBound
+                        return
+                    case .bodyStart:
+                        headEndOffset = offset
+                        return
+                    }
+                }
+            }
+        }
+    }
+
+    private func match(at offset: Int, in buffer: UnsafeRawBufferPointer) -> Match {
+        var isIncomplete = false
+
+        for (marker, tag) in Self.markers where isInsideScript == (marker == .scriptEnd) {
+            var upperBound = offset
+            var isMatching = true
+
+            for byte in tag {
+                guard upperBound < buffer.count else { break }
+
+                if lowercased(buffer[upperBound]) != byte {
+                    isMatching = false
+                    break
+                }
+
+                upperBound += 1
+            }
+
+            guard isMatching else { continue }
+
+            if upperBound - offset < tag.count {
+                isIncomplete = true
+                continue
+            }
+
+            if marker.needsDelimiter {
+                guard upperBound < buffer.count else {
+                    isIncomplete = true
+                    continue
+                }
+
+                guard isDelimiter(buffer[upperBound]) else { continue }
+            }
+
+            return .marker(marker, upperBound: upperBound)
+        }
+
+        return isIncomplete ? .incomplete : .none
     }
 
-    private func updateReachedEndOfHead(withData data: Data) {
-        guard let string = parseString(from: data)?.lowercased() else { return }
-        if string.contains(OpenGraphXMLNode.headEnd.rawValue) {
-            reachedEndOfHead = true
+    private func lowercased(_ byte: UInt8) -> UInt8 {
+        switch byte {
+        case UInt8(ascii: "A")...UInt8(ascii: "Z"):
+            return byte + 32
+        default:
+            return byte
         }
     }
 
-    private func parseString(from data: Data) -> String? {
-        String(decoding: data, as: UTF8.self)
+    private func isDelimiter(_ byte: UInt8) -> Bool {
+        switch byte {
+        case UInt8(ascii: ">"), UInt8(ascii: " "), UInt8(ascii: "\t"), UInt8(ascii: "\n"), UInt8(ascii: "\r"), UInt8(ascii: "/"):
+            return true
+        default:
+            return false
+        }
+    }
+
+    // MARK: - Parsing
+
+    private func feedParser() {
+        let upperBound = headEndOffset ?? bytes.count
+
+        guard parsedCount < upperBound else { return }
+
+        parser.parse(bytes[parsedCount..<upperBound])
+        parsedCount = upperBound
     }
 }
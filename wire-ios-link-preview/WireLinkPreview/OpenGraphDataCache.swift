@@ -0,0 +1,196 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+
+/// Counters describing how often the `OpenGraphDataCache` saved a download.
+public struct OpenGraphDataCacheMetrics: Equatable {
+
+    /// Lookups answered with cached data.
+    public internal(set) var hits = 0
+
+    /// Lookups answered with a cached failure or blacklisted URL.
+    public internal(set) var negativeHits = 0
+
+    /// Lookups that found nothing, or only an expired entry.
+    public internal(set) var misses = 0
+
+    /// Requests that joined a download already in flight for the same URL.
+    public internal(set) var joinedRequests = 0
+
+    /// The share of requests that didn't start a download.
+    public var hitRate: Double {
+        let lookups = hits + negativeHits + misses
+        return lookups > 0 ? Double(lookups - misses + joinedRequests) / Double(lookups) : 0
+    }
+
+}
+
+/// Caches the open graph data of links, so a link pasted in many messages is only downloaded once.
+///
+/// Entries are kept in memory only, least recently used first out, and live as long as the
+/// link preview detector that owns the cache, i.e. as long as the session of one account.
+/// URLs are normalized before they are used as keys: the scheme and host are lowercased,
+/// and the fragment and `utm_` tracking parameters are dropped.
+///
+/// A link that failed to download is remembered as well (negative caching), for a shorter
+/// time, since the failure may be caused by the connection.
+final class OpenGraphDataCache {
+
+    struct Configuration {
+        /// The number of entries kept.
+        var capacity = 256
+        /// How long downloaded open graph data is used.
+        var timeToLive: TimeInterval = 24 * 60 * 60
+        /// How long a failed download or a blacklisted URL is remembered.
+        var negativeTimeToLive: TimeInterval = 10 * 60
+    }
+
+    /// A cached lookup result, `data` is `nil` for negative entries.
+    struct Entry {
+        let data: OpenGraphData?
+        let expirationDate: Date
+    }
+
+    private let configuration: Configuration
+    private let currentDate: () -> Date
+    private let lock = NSLock()
+
+    private var entries = [String: Entry]()
+    private var lastAccess = [String: UInt64]()
+    private var accessCounter: UInt64 = 0
+    private var _metrics = OpenGraphDataCacheMetrics()
+
+    init(
+        configuration: Configuration = Configuration(),
+        currentDate: @escaping () -> Date = Date.init
+    ) {
+        self.configuration = configuration
+        self.currentDate = currentDate
+    }
+
+    var metrics: OpenGraphDataCacheMetrics {
+        lock.lock()
+        defer { lock.unlock() }
+        return _metrics
+    }
+
+    // MARK: - Lookup
+
+    /// Returns the unexpired entry for a key.
+    func entry(forKey key: String) -> Entry? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard let entry = entries[key] else {
+            _metrics.misses += 1
+            return nil
+        }
+
+        guard entry.expirationDate > currentDate() else {
+            entries[key] = nil
+            lastAccess[key] = nil
+            _metrics.misses += 1
+            return nil
+        }
+
+        touch(key)
+
+        if entry.data == nil {
+            _metrics.negativeHits += 1
+        } else {
+            _metrics.hits += 1
+        }
+
+        return entry
+    }
+
+    /// Stores the result of a download, `nil` if it failed.
+    func store(_ data: OpenGraphData?, forKey key: String) {
+        let timeToLive = data == nil ? configuration.negativeTimeToLive : configuration.timeToLive
+        let entry = Entry(data: data, expirationDate: currentDate().addingTimeInterval(timeToLive))
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        insert(entry, forKey: key)
+    }
+
+    func recordJoinedRequest() {
+        lock.lock()
+        defer { lock.unlock() }
+        _metrics.joinedRequests += 1
+    }
+
+    /// Removes all entries.
+    func removeAll() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        entries.removeAll()
+        lastAccess.removeAll()
+    }
+
+    // MARK: - Keys
+
+    /// The key for a URL: links that only differ in case, fragment or tracking parameters share a key.
+    static func key(for url: URL) -> String {
+        guard var components = URLComponents(url: url, resolvingAgainstBaseURL: true) else {
+            return url.absoluteString
+        }
+
+        components.scheme = components.scheme?.lowercased()
+        components.host = components.host?.lowercased()
+        components.fragment = nil
+
+        if components.port == 80 && components.scheme == "http" || components.port == 443 && components.scheme == "https" {
+            components.port = nil
+        }
+
+        if components.path.isEmpty {
+            components.path = "/"
+        }
+
+        let queryItems = components.queryItems?.filter { !$0.name.lowercased().hasPrefix("utm_") }
+        components.queryItems = queryItems?.isEmpty == true ? nil : queryItems
+
+        return components.string ?? url.absoluteString
+    }
+
+    // MARK: - Eviction
+
+    private func insert(_ entry: Entry, forKey key: String) {
+        entries[key] = entry
+        touch(key)
+
+        guard entries.count > configuration.capacity,
+              let leastRecentlyUsed = lastAccess.min(by: { $0.value < $1.value })?.key
+        else {
+            return
+        }
+
+        entries[leastRecentlyUsed] = nil
+        lastAccess[leastRecentlyUsed] = nil
+    }
+
+    private func touch(_ key: String) {
+        accessCounter += 1
+        lastAccess[key] = accessCounter
+    }
+
+}
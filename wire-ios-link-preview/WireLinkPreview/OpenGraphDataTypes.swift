@@ -23,12 +23,6 @@ enum OpenGraphAttribute {
     static let content = "content"
 }
 
-enum OpenGraphXMLNode: String {
-    case headStart = "<head "
-    case headStartNoAttributes = "<head>"
-    case headEnd = "</head>"
-}
-
 enum OpenGraphPropertyType: String {
     case title = "og:title"
     case type = "og:type"
@@ -22,24 +22,30 @@ final class OpenGraphScanner: NSObject {
 
     typealias ParserCompletion = (OpenGraphData?) -> Void
 
-    let xmlString: String
+    let parser: HTMLPushParser
     var contentsByProperty = [OpenGraphPropertyType: String]()
     var images = [String]()
     var pageTitle: String?
     var completion: ParserCompletion
     var originalURL: URL
 
-    init(_ xmlString: String, url: URL, completion: @escaping ParserCompletion) {
-        self.xmlString = xmlString
+    /// Creates a scanner for a document that was fed to `parser`, e.g. while it was downloaded.
+    init(_ parser: HTMLPushParser, url: URL, completion: @escaping ParserCompletion) {
+        self.parser = parser
         self.completion = completion
         originalURL = url
         super.init()
     }
 
+    convenience init(_ xmlString: String, url: URL, completion: @escaping ParserCompletion) {
+        let parser = HTMLPushParser()
+        parser.parse(Data(xmlString.utf8))
+        self.init(parser, url: url, completion: completion)
+    }
+
     func parse() {
         // 1. Parse the document
-        guard let document = HTMLDocument(xmlString: xmlString) else { return completion(nil) }
-        defer { HTMLDocument.free(document) }
+        guard let document = parser.finish() else { return completion(nil) }
 
         // 2. Find the head
         guard let headElement = findHead(in: document) else { return completion(nil) }
@@ -129,8 +129,7 @@ final class PreviewDownloader: NSObject, URLSessionDataDelegate, PreviewDownload
     }
 
     func parseMetaHeader(_ container: MetaStreamContainer, url: URL, completion: @escaping DownloadCompletion) {
-        guard let xmlString = container.head else { return completion(nil) }
-        let scanner = OpenGraphScanner(xmlString, url: url) { [weak self] result in
+        let scanner = OpenGraphScanner(container.parser, url: url) { [weak self] result in
             self?.resultsQueue.addOperation {
                 completion(result)
             }
@@ -158,6 +157,8 @@ extension PreviewDownloader {
             return completionHandler(.cancel)
         }
 
+        // Decode the page with the charset the server declared.
+        containerByTaskID[dataTask.taskIdentifier] = MetaStreamContainer(encodingName: response.textEncodingName)
         return completionHandler(.allow)
     }
 
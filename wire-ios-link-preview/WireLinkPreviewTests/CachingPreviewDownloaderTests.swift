@@ -0,0 +1,151 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+@testable import WireLinkPreview
+import XCTest
+
+class CachingPreviewDownloaderTests: XCTestCase {
+
+    var cache: OpenGraphDataCache!
+    var downloader: DeferredPreviewDownloader!
+    var sut: CachingPreviewDownloader!
+
+    override func setUp() {
+        super.setUp()
+        cache = OpenGraphDataCache()
+        downloader = DeferredPreviewDownloader()
+        sut = CachingPreviewDownloader(downloader: downloader, cache: cache, resultsQueue: .main)
+    }
+
+    override func tearDown() {
+        sut = nil
+        downloader = nil
+        cache = nil
+        super.tearDown()
+    }
+
+    func testThatConcurrentRequestsForTheSameLinkJoinASingleDownload() {
+        // given
+        let data = OpenGraphMockDataProvider.nytimesData().expected!
+        var results = [OpenGraphData?]()
+
+        // when
+        sut.requestOpenGraphData(fromURL: URL(string: "https://example.com/a")!) { results.append($0) }
+        sut.requestOpenGraphData(fromURL: URL(string: "https://example.com/a#top")!) { results.append($0) }
+        sut.requestOpenGraphData(fromURL: URL(string: "https://EXAMPLE.com/a")!) { results.append($0) }
+
+        // then
+        XCTAssertEqual(downloader.completionsByURL.count, 1)
+
+        // when
+        downloader.complete(URL(string: "https://example.com/a")!, with: data)
+
+        // then
+        XCTAssertEqual(results, [data, data, data])
+        XCTAssertEqual(cache.metrics.joinedRequests, 2)
+    }
+
+    func testThatItAnswersLaterRequestsFromTheCache() {
+        // given
+        let url = URL(string: "https://example.com/a")!
+        let data = OpenGraphMockDataProvider.nytimesData().expected!
+        sut.requestOpenGraphData(fromURL: url) { _ in }
+        downloader.complete(url, with: data)
+
+        // when
+        let completionExpectation = expectation(description: "It calls the completion closure")
+        var result: OpenGraphData?
+        sut.requestOpenGraphData(fromURL: url) {
+            result = $0
+            completionExpectation.fulfill()
+        }
+
+        // then
+        waitForExpectations(timeout: 0.5, handler: nil)
+        XCTAssertEqual(result, data)
+        XCTAssertEqual(downloader.requestCount, 1)
+        XCTAssertEqual(cache.metrics.hits, 1)
+    }
+
+    func testThatItRemembersFailedDownloads() {
+        // given
+        let url = URL(string: "https://example.com/a")!
+        sut.requestOpenGraphData(fromURL: url) { _ in }
+        downloader.complete(url, with: nil)
+
+        // when
+        let completionExpectation = expectation(description: "It calls the completion closure")
+        sut.requestOpenGraphData(fromURL: url) {
+            XCTAssertNil($0)
+            completionExpectation.fulfill()
+        }
+
+        // then
+        waitForExpectations(timeout: 0.5, handler: nil)
+        XCTAssertEqual(downloader.requestCount, 1)
+        XCTAssertEqual(cache.metrics.negativeHits, 1)
+    }
+
+    func testThatItDoesNotDownloadBlacklistedLinks() {
+        // given
+        let url = URL(string: "https://www.youtube.com/watch?v=1")!
+
+        // when
+        let completionExpectation = expectation(description: "It calls the completion closure")
+        sut.requestOpenGraphData(fromURL: url) {
+            XCTAssertNil($0)
+            completionExpectation.fulfill()
+        }
+
+        // then
+        waitForExpectations(timeout: 0.5, handler: nil)
+        XCTAssertEqual(downloader.requestCount, 0)
+        XCTAssertNotNil(cache.entry(forKey: OpenGraphDataCache.key(for: url)))
+    }
+
+    func testThatItTearsDownTheDownloader() {
+        // when
+        sut.tearDown()
+
+        // then
+        XCTAssertTrue(downloader.tornDown)
+    }
+
+}
+
+/// A preview downloader that only completes when told to.
+final class DeferredPreviewDownloader: PreviewDownloaderType {
+
+    private(set) var completionsByURL = [URL: (OpenGraphData?) -> Void]()
+    private(set) var requestCount = 0
+    private(set) var tornDown = false
+
+    func requestOpenGraphData(fromURL url: URL, completion: @escaping (OpenGraphData?) -> Void) {
+        requestCount += 1
+        completionsByURL[url] = completion
+    }
+
+    func complete(_ url: URL, with data: OpenGraphData?) {
+        completionsByURL.removeValue(forKey: url)?(data)
+    }
+
+    func tearDown() {
+        tornDown = true
+    }
+
+}
@@ -88,87 +88,149 @@ class MetaStreamContainerTests: XCTestCase {
         assertThatItUpdatesReachedEndOfHeadWhenItReceivedHead("</head >", shouldUpdate: false, encoding: .ascii)
     }
 
-    func testThatItExtractsTheHead_whenAllInOneLine() {
+    func testThatItParsesUpToTheEndOfTheHead_whenAllInOneLine() {
         let head = "<head>header</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html)
     }
 
-    func testThatItExtractsTheHead_whenHeadStartIsMissing() {
+    func testThatItParsesUpToTheEndOfTheHead_whenHeadStartIsMissing() {
         let html = "<!DOCTYPE html><html lang=\"en\">header</head>"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: html)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html)
     }
 
-    func testThatItExtractsTheHead_whenHeadStartIsMissingButContainsHeader() {
+    func testThatItParsesUpToTheEndOfTheHead_whenHeadStartIsMissingButContainsHeader() {
         let html = "<!DOCTYPE html><html lang=\"en\"><header>some</header>header</head>"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: html)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html)
     }
 
-    func testThatItExtractsTheHead_whenHeadStartIsAfterEnd() {
+    func testThatItParsesUpToTheEndOfTheHead_whenHeadStartIsAfterEnd() {
         let head = "<head>"
         let body = "<!DOCTYPE html><html lang=\"en\">header</head>"
         let html = body + head
-        assertThatItExtractsTheCorrectHead(html, expectedHead: body)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: body)
     }
 
-    func testThatItExtractsTheHead_whenOneASeparateLine() {
+    func testThatItParsesUpToTheEndOfTheHead_whenOneASeparateLine() {
         let head = "<head>\nheader\n</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\n\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html)
     }
 
-    func testThatItExtractsTheHead_whenItHasAttributes() {
+    func testThatItParsesUpToTheEndOfTheHead_whenItHasAttributes() {
         let head = "<head data-network=\"123\">\nheader\n</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\n\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html)
     }
 
-    func testThatItExtractsTheHead_whenAllInOneLine_Latin1() {
+    func testThatItParsesUpToTheEndOfTheHead_whenAllInOneLine_Latin1() {
         let head = "<head>header</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head, encoding: .isoLatin1)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html, encoding: .isoLatin1)
     }
 
-    func testThatItExtractsTheHead_whenOneASeparateLine_Latin1() {
+    func testThatItParsesUpToTheEndOfTheHead_whenOneASeparateLine_Latin1() {
         let head = "<head>\nheader\n</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\n\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head, encoding: .isoLatin1)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html, encoding: .isoLatin1)
     }
 
-    func testThatItExtractsTheHead_whenItHasAttributes_Latin1() {
+    func testThatItParsesUpToTheEndOfTheHead_whenItHasAttributes_Latin1() {
         let head = "<head data-network=\"123\">\nheader\n</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\n\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head, encoding: .isoLatin1)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html, encoding: .isoLatin1)
     }
 
-    func testThatItExtractsTheHead_whenAllInOneLine_ASCII() {
+    func testThatItParsesUpToTheEndOfTheHead_whenAllInOneLine_ASCII() {
         let head = "<head>header</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head, encoding: .ascii)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html, encoding: .ascii)
     }
 
-    func testThatItExtractsTheHead_whenOneASeparateLine_ASCII() {
+    func testThatItParsesUpToTheEndOfTheHead_whenOneASeparateLine_ASCII() {
         let head = "<head>\nheader\n</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\n\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head, encoding: .ascii)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html, encoding: .ascii)
     }
 
-    func testThatItExtractsTheHead_whenItHasAttributes_ASCII() {
+    func testThatItParsesUpToTheEndOfTheHead_whenItHasAttributes_ASCII() {
         let head = "<head data-network=\"123\">\nheader\n</head>"
         let html = "<!DOCTYPE html><html lang=\"en\">\n\(head)"
-        assertThatItExtractsTheCorrectHead(html, expectedHead: head, encoding: .ascii)
+        assertThatItParsesUpToTheEndOfTheHead(html, expectedContent: html, encoding: .ascii)
+    }
+
+    func testThatItSets_reachedEndOfHead_WhenHeadEndIsSplitAcrossChunks() {
+        // when
+        sut.addData(Data("<head><title>Title</title></he".utf8))
+
+        // then
+        XCTAssertFalse(sut.reachedEndOfHead)
+
+        // when
+        sut.addData(Data("AD><body>".utf8))
+
+        // then
+        XCTAssertTrue(sut.reachedEndOfHead)
+        XCTAssertEqual(parsedContent, "<head><title>Title</title></heAD>")
+    }
+
+    func testThatItParsesUpToTheEndOfTheHead_whenHeadStartIsSplitAcrossChunks() {
+        // when
+        sut.addData(Data("<!DOCTYPE html><html><he".utf8))
+        sut.addData(Data("ad".utf8))
+        sut.addData(Data(">header</head>".utf8))
+
+        // then
+        XCTAssertTrue(sut.reachedEndOfHead)
+        XCTAssertEqual(parsedContent, "<!DOCTYPE html><html><head>header</head>")
+    }
+
+    func testThatItSets_reachedEndOfHead_WhenBodyStartsWithoutHeadEnd() {
+        // when
+        sut.addData(Data("<html><head><title>Title</title>\n<body class=\"page\"><p>Text</p>".utf8))
+
+        // then
+        XCTAssertTrue(sut.reachedEndOfHead)
+        XCTAssertEqual(parsedContent, "<html><head><title>Title</title>\n")
+    }
+
+    func testThatItDoesNotSet_reachedEndOfHead_WhenHeadEndIsInsideAScript() {
+        // when
+        sut.addData(Data("<head><script>document.write('</head><body>');</scr".utf8))
+
+        // then
+        XCTAssertFalse(sut.reachedEndOfHead)
+
+        // when
+        sut.addData(Data("ipt></head>".utf8))
+
+        // then
+        XCTAssertTrue(sut.reachedEndOfHead)
+        XCTAssertEqual(parsedContent, "<head><script>document.write('</head><body>');</script></head>")
+    }
+
+    func testThatItDoesNotTakeOtherTagsForTheBody() {
+        // when
+        sut.addData(Data("<head><meta name=\"bodyclass\"><bodyguard>".utf8))
+
+        // then
+        XCTAssertFalse(sut.reachedEndOfHead)
     }
 
     // MARK: - Helper
 
-    func assertThatItExtractsTheCorrectHead(_ html: String, expectedHead: String, encoding: String.Encoding = .utf8, file: StaticString = #file, line: UInt = #line) {
+    /// The bytes that were fed to the parser so far.
+    private var parsedContent: String {
+        String(decoding: sut.bytes.prefix(sut.parsedCount), as: UTF8.self)
+    }
+
+    func assertThatItParsesUpToTheEndOfTheHead(_ html: String, expectedContent: String, encoding: String.Encoding = .utf8, file: StaticString = #file, line: UInt = #line) {
         // when
         sut.addData(html.data(using: encoding)!)
 
         // then
         XCTAssertTrue(sut.reachedEndOfHead, "Should reach end of head", file: file, line: line)
-        guard let head = sut.head else { return XCTFail("Head was nil", file: file, line: line) }
-        XCTAssertEqual(head, expectedHead, "Should have expected head", file: file, line: line)
+        XCTAssertEqual(parsedContent, expectedContent, "Should parse up to the end of the head", file: file, line: line)
     }
 
     func assertThatItUpdatesReachedEndOfHeadWhenItReceivedHead(_ head: String, shouldUpdate: Bool = true, encoding: String.Encoding = .utf8, line: UInt = #line) {
@@ -204,7 +266,6 @@ class MetaStreamContainerTests: XCTestCase {
 
         // then
         XCTAssertEqual(sut.bytes, first)
-        XCTAssertEqual(sut.stringContent, "First")
 
         // when
         sut.addData(second)
@@ -212,7 +273,6 @@ class MetaStreamContainerTests: XCTestCase {
         // then
         let expected = "FirstSecond".data(using: encoding)!
         XCTAssertEqual(sut.bytes, expected)
-        XCTAssertEqual(sut.stringContent, "FirstSecond")
     }
 
 }
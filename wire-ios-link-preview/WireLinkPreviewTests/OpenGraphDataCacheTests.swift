@@ -0,0 +1,159 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+@testable import WireLinkPreview
+import XCTest
+
+class OpenGraphDataCacheTests: XCTestCase {
+
+    var currentDate: Date!
+    var sut: OpenGraphDataCache!
+
+    override func setUp() {
+        super.setUp()
+        currentDate = Date(timeIntervalSinceReferenceDate: 0)
+        sut = makeSUT()
+    }
+
+    override func tearDown() {
+        sut = nil
+        currentDate = nil
+        super.tearDown()
+    }
+
+    func makeSUT(capacity: Int = 256) -> OpenGraphDataCache {
+        OpenGraphDataCache(
+            configuration: .init(capacity: capacity, timeToLive: 100, negativeTimeToLive: 10),
+            currentDate: { [unowned self] in currentDate }
+        )
+    }
+
+    // MARK: - Keys
+
+    func testThatLinksThatOnlyDifferInCaseFragmentOrTrackingShareAKey() {
+        let key = OpenGraphDataCache.key(for: URL(string: "https://www.example.com/article?id=1")!)
+
+        XCTAssertEqual(OpenGraphDataCache.key(for: URL(string: "HTTPS://WWW.Example.com/article?id=1")!), key)
+        XCTAssertEqual(OpenGraphDataCache.key(for: URL(string: "https://www.example.com/article?id=1#comments")!), key)
+        XCTAssertEqual(OpenGraphDataCache.key(for: URL(string: "https://www.example.com/article?id=1&utm_source=wire")!), key)
+        XCTAssertEqual(OpenGraphDataCache.key(for: URL(string: "https://www.example.com:443/article?id=1")!), key)
+    }
+
+    func testThatDifferentLinksHaveDifferentKeys() {
+        let key = OpenGraphDataCache.key(for: URL(string: "https://www.example.com/article?id=1")!)
+
+        XCTAssertNotEqual(OpenGraphDataCache.key(for: URL(string: "https://www.example.com/article?id=2")!), key)
+        XCTAssertNotEqual(OpenGraphDataCache.key(for: URL(string: "https://www.example.com/Article?id=1")!), key)
+    }
+
+    // MARK: - Lookup
+
+    func testThatItReturnsStoredData() {
+        // given
+        let data = OpenGraphMockDataProvider.nytimesData().expected!
+
+        // when
+        sut.store(data, forKey: "key")
+
+        // then
+        XCTAssertEqual(sut.entry(forKey: "key")?.data, data)
+        XCTAssertEqual(sut.metrics.hits, 1)
+    }
+
+    func testThatItDoesNotShareEntriesBetweenInstances() {
+        // given
+        sut.store(OpenGraphMockDataProvider.foursquareData().expected!, forKey: "key")
+
+        // when
+        sut = makeSUT()
+
+        // then
+        XCTAssertNil(sut.entry(forKey: "key"))
+    }
+
+    func testThatItRemovesAllEntries() {
+        // given
+        sut.store(OpenGraphMockDataProvider.nytimesData().expected!, forKey: "key")
+
+        // when
+        sut.removeAll()
+
+        // then
+        XCTAssertNil(sut.entry(forKey: "key"))
+    }
+
+    func testThatItExpiresEntries() {
+        // given
+        sut.store(OpenGraphMockDataProvider.nytimesData().expected!, forKey: "key")
+
+        // when
+        currentDate.addTimeInterval(100)
+
+        // then
+        XCTAssertNil(sut.entry(forKey: "key"))
+    }
+
+    func testThatItRemembersFailuresForTheNegativeTimeToLive() {
+        // given
+        sut.store(nil, forKey: "key")
+
+        // when & then
+        let entry = sut.entry(forKey: "key")
+        XCTAssertNotNil(entry)
+        XCTAssertNil(entry?.data)
+        XCTAssertEqual(sut.metrics.negativeHits, 1)
+
+        // when & then
+        currentDate.addTimeInterval(10)
+        XCTAssertNil(sut.entry(forKey: "key"))
+    }
+
+    func testThatItEvictsTheLeastRecentlyUsedEntry() {
+        // given
+        sut = makeSUT(capacity: 2)
+        let data = OpenGraphMockDataProvider.nytimesData().expected!
+        sut.store(data, forKey: "a")
+        sut.store(data, forKey: "b")
+        _ = sut.entry(forKey: "a")
+
+        // when
+        sut.store(data, forKey: "c")
+
+        // then
+        XCTAssertNotNil(sut.entry(forKey: "a"))
+        XCTAssertNil(sut.entry(forKey: "b"))
+        XCTAssertNotNil(sut.entry(forKey: "c"))
+    }
+
+    func testThatItComputesTheHitRate() {
+        // given
+        sut.store(OpenGraphMockDataProvider.nytimesData().expected!, forKey: "a")
+
+        // when
+        _ = sut.entry(forKey: "a")
+        _ = sut.entry(forKey: "a")
+        _ = sut.entry(forKey: "b")
+        _ = sut.entry(forKey: "c")
+        sut.recordJoinedRequest()
+
+        // then
+        XCTAssertEqual(sut.metrics.misses, 2)
+        XCTAssertEqual(sut.metrics.hitRate, 0.75, accuracy: 0.001)
+    }
+
+}
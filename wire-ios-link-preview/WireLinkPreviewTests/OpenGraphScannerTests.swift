@@ -110,4 +110,123 @@ class OpenGraphScannerTests: XCTestCase {
         XCTAssertEqual(mockData.expected, receivedData, line: line)
     }
 
+    // MARK: - Streaming
+
+    func testThatItParsesSampleDataStreamedInChunks() {
+        for mockData in sampleData {
+            assertThatItParsesStreamedSampleDataCorrectly(mockData, chunkSize: 1024)
+        }
+    }
+
+    func testThatItParsesSampleDataStreamedByteByByte() {
+        assertThatItParsesStreamedSampleDataCorrectly(OpenGraphMockDataProvider.wireData(), chunkSize: 1)
+        assertThatItParsesStreamedSampleDataCorrectly(OpenGraphMockDataProvider.crashingDataEmoji(), chunkSize: 1)
+    }
+
+    func testThatItDecodesThePageWithTheCharsetOfTheResponse() throws {
+        // given
+        var receivedData: OpenGraphData?
+        let head = "<head><meta property=\"og:title\" content=\"Caf\u{E9} cr\u{E8}me\"><meta property=\"og:type\" content=\"website\"></head>"
+        let page = try XCTUnwrap(("<html>" + head + "<body></body></html>").data(using: .isoLatin1))
+        let container = MetaStreamContainer(encodingName: "iso-8859-1")
+
+        // when
+        container.addData(page)
+        OpenGraphScanner(container.parser, url: URL(string: "https://example.com")!) { receivedData = $0 }.parse()
+
+        // then
+        XCTAssertEqual(receivedData?.title, "Caf\u{E9} cr\u{E8}me")
+    }
+
+    func testThatItDecodesThePageWithTheCharsetOfTheMetaTag() throws {
+        // given
+        var receivedData: OpenGraphData?
+        let head = "<head><meta charset=\"iso-8859-1\"><meta property=\"og:title\" content=\"Caf\u{E9} cr\u{E8}me\"><meta property=\"og:type\" content=\"website\"></head>"
+        let page = try XCTUnwrap(("<html>" + head + "<body></body></html>").data(using: .isoLatin1))
+        let container = MetaStreamContainer()
+
+        // when
+        container.addData(page)
+        OpenGraphScanner(container.parser, url: URL(string: "https://example.com")!) { receivedData = $0 }.parse()
+
+        // then
+        XCTAssertEqual(receivedData?.title, "Caf\u{E9} cr\u{E8}me")
+    }
+
+    func testPerformanceOfStreamingSampleData() {
+        // given
+        let pages = sampleData.map { (page: makePage(withHead: $0.head), url: URL(string: $0.urlString)!) }
+
+        // when & then
+        measure {
+            for (page, url) in pages {
+                let container = stream(page, chunkSize: 16 * 1024)
+                OpenGraphScanner(container.parser, url: url) { XCTAssertNotNil($0) }.parse()
+            }
+        }
+    }
+
+    // MARK: - Helper
+
+    private var sampleData: [OpenGraphMockData] {
+        [
+            OpenGraphMockDataProvider.twitterData(),
+            OpenGraphMockDataProvider.twitterDataWithImages(),
+            OpenGraphMockDataProvider.vergeData(),
+            OpenGraphMockDataProvider.foursquareData(),
+            OpenGraphMockDataProvider.youtubeData(),
+            OpenGraphMockDataProvider.guardianData(),
+            OpenGraphMockDataProvider.instagramData(),
+            OpenGraphMockDataProvider.vimeoData(),
+            OpenGraphMockDataProvider.nytimesData(),
+            OpenGraphMockDataProvider.washingtonPostData(),
+            OpenGraphMockDataProvider.wireData(),
+            OpenGraphMockDataProvider.polygonData(),
+            OpenGraphMockDataProvider.iTunesData(),
+            OpenGraphMockDataProvider.iTunesDataWithoutTitle(),
+            OpenGraphMockDataProvider.yahooSports(),
+            OpenGraphMockDataProvider.crashingDataEmoji()
+        ]
+    }
+
+    /// Turns a saved head into a whole page, with a long body after it.
+    private func makePage(withHead head: String) -> Data {
+        let prefix = head.contains("<html") ? "" : "<!DOCTYPE html>\n<html lang=\"en\">\n"
+        let body = "\n<body>" + String(repeating: "<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</p>\n", count: 10_000) + "</body></html>"
+        return Data((prefix + head + body).utf8)
+    }
+
+    /// Feeds a page to a container in chunks, until the container reached the end of the head.
+    private func stream(_ page: Data, chunkSize: Int) -> MetaStreamContainer {
+        let container = MetaStreamContainer()
+        var offset = 0
+
+        while !container.reachedEndOfHead, offset < page.count {
+            let upperBound = min(offset + chunkSize, page.count)
+            container.addData(page[offset..<upperBound])
+            offset = upperBound
+        }
+
+        return container
+    }
+
+    func assertThatItParsesStreamedSampleDataCorrectly(_ mockData: OpenGraphMockData, chunkSize: Int, line: UInt = #line) {
+        // given
+        var receivedData: OpenGraphData?
+        let page = makePage(withHead: mockData.head)
+
+        // when
+        let container = stream(page, chunkSize: chunkSize)
+        let sut = OpenGraphScanner(container.parser, url: URL(string: mockData.urlString)!) { receivedData = $0 }
+        sut.parse()
+
+        // then it stopped before downloading the body.
+        XCTAssertTrue(container.reachedEndOfHead, line: line)
+        XCTAssertLessThan(container.bytes.count, page.count / 2, line: line)
+
+        // then
+        XCTAssertNotNil(receivedData, line: line)
+        XCTAssertEqual(mockData.expected, receivedData, line: line)
+    }
+
 }
@@ -86,6 +86,11 @@ public final class NotificationSession {
 
     // MARK: - Properties
 
+    /// The maximum number of events that are decrypted and turned into notifications
+    /// at once, so the memory used while processing a push stays bounded.
+
+    static let eventBatchSize = 25
+
     /// Directory of all application statuses.
 
     private let applicationStatusDirectory: ApplicationStatusDirectory
@@ -106,6 +111,10 @@ public final class NotificationSession {
     private var callEvent: CallEventPayload?
     private var localNotifications = [ZMLocalNotification]()
 
+    private var creationDate = Date()
+    private var pushProcessingStartDate: Date?
+    private var processedEventCount = 0
+
     private var context: NSManagedObjectContext { coreDataStack.syncContext }
 
     public weak var delegate: NotificationSessionDelegate?
@@ -125,6 +134,7 @@ public final class NotificationSession {
         sharedUserDefaults: UserDefaults,
         minTLSVersion: String?
     ) throws {
+        let creationDate = Date()
         let sharedContainerURL = FileManager.sharedContainerDirectory(for: applicationGroupIdentifier)
         let accountManager = AccountManager(sharedDirectory: sharedContainerURL)
 
@@ -145,14 +155,14 @@ public final class NotificationSession {
             throw InitializationError.coreDataMigrationRequired
         }
 
-        coreDataStack.loadStores { error in
+        do {
+            // Only the contexts needed to decrypt and process events are configured.
+            try coreDataStack.loadStoresForEventProcessing()
+        } catch {
             // ⚠️ errors are not handled and `NotificationSession` will be created.
             // Currently it is the given behavior, but should be refactored
             // into a "setup" or "load" func that can be async and handle errors.
-
-            if let error {
-                WireLogger.notifications.error("Loading coreDataStack with error: \(error.localizedDescription)")
-            }
+            WireLogger.notifications.error("Loading coreDataStack with error: \(error.localizedDescription)")
         }
 
         // Don't cache the cookie because if the user logs out and back in again in the main app
@@ -185,6 +195,11 @@ public final class NotificationSession {
             accountIdentifier: accountIdentifier,
             sharedUserDefaults: sharedUserDefaults
         )
+
+        self.creationDate = creationDate
+        WireLogger.notifications.info(
+            "notification session created in \(Date().timeIntervalSince(creationDate))s, peak memory: \(Self.peakResidentMemoryDescription)"
+        )
     }
 
     convenience init(
@@ -236,16 +251,6 @@ public final class NotificationSession {
             cryptoboxMigrationManager: cryptoboxMigrationManager,
             allowCreation: false
         )
-        let commitSender = CommitSender(
-            coreCryptoProvider: coreCryptoProvider,
-            notificationContext: coreDataStack.syncContext.notificationContext
-        )
-        let featureRepository = FeatureRepository(context: coreDataStack.syncContext)
-        let mlsActionExecutor = MLSActionExecutor(
-            coreCryptoProvider: coreCryptoProvider,
-            commitSender: commitSender,
-            featureRepository: featureRepository
-        )
 
         let saveNotificationPersistence = ContextDidSaveNotificationPersistence(accountContainer: accountContainer)
 
@@ -267,11 +272,32 @@ public final class NotificationSession {
             cryptoboxMigrationManager: cryptoboxMigrationManager,
             earService: earService,
             proteusService: ProteusService(coreCryptoProvider: coreCryptoProvider),
-            mlsDecryptionService: MLSDecryptionService(context: coreDataStack.syncContext, mlsActionExecutor: mlsActionExecutor),
+            mlsDecryptionService: Self.makeMLSDecryptionService(
+                coreCryptoProvider: coreCryptoProvider,
+                syncContext: coreDataStack.syncContext
+            ),
             lastEventIDRepository: lastEventIDRepository
         )
     }
 
+    private static func makeMLSDecryptionService(
+        coreCryptoProvider: CoreCryptoProvider,
+        syncContext: NSManagedObjectContext
+    ) -> MLSDecryptionServiceInterface {
+        let commitSender = CommitSender(
+            coreCryptoProvider: coreCryptoProvider,
+            notificationContext: syncContext.notificationContext
+        )
+        let featureRepository = FeatureRepository(context: syncContext)
+        let mlsActionExecutor = MLSActionExecutor(
+            coreCryptoProvider: coreCryptoProvider,
+            commitSender: commitSender,
+            featureRepository: featureRepository
+        )
+
+        return MLSDecryptionService(context: syncContext, mlsActionExecutor: mlsActionExecutor)
+    }
+
     init(
         coreDataStack: CoreDataStack,
         transportSession: ZMTransportSession,
@@ -283,8 +309,8 @@ public final class NotificationSession {
         pushNotificationStrategy: PushNotificationStrategy,
         cryptoboxMigrationManager: CryptoboxMigrationManagerInterface,
         earService: EARServiceInterface,
-        proteusService: ProteusServiceInterface,
-        mlsDecryptionService: MLSDecryptionServiceInterface,
+        proteusService: @autoclosure () -> ProteusServiceInterface,
+        mlsDecryptionService: @autoclosure () -> MLSDecryptionServiceInterface,
         lastEventIDRepository: LastEventIDRepositoryInterface
 
     ) throws {
@@ -308,16 +334,16 @@ public final class NotificationSession {
         guard !cryptoboxMigrationManager.isMigrationNeeded(accountDirectory: accountDirectory) else {
             throw InitializationError.pendingCryptoboxMigration
         }
+        // The services are only created when they are used.
         coreDataStack.syncContext.performAndWait {
             if DeveloperFlag.proteusViaCoreCrypto.isOn, coreDataStack.syncContext.proteusService == nil {
-                coreDataStack.syncContext.proteusService = proteusService
+                coreDataStack.syncContext.proteusService = proteusService()
             }
 
             if DeveloperFlag.enableMLSSupport.isOn, coreDataStack.syncContext.mlsDecryptionService == nil {
-                coreDataStack.syncContext.mlsDecryptionService = mlsDecryptionService
+                coreDataStack.syncContext.mlsDecryptionService = mlsDecryptionService()
             }
         }
-
     }
 
     deinit {
@@ -336,6 +362,9 @@ public final class NotificationSession {
         WireLogger.notifications.info("processing notification with payload: \(payload)")
 
         coreDataStack.syncContext.performGroupedBlock {
+            self.pushProcessingStartDate = Date()
+            self.processedEventCount = 0
+
             if self.applicationStatusDirectory.authenticationStatus.state == .unauthenticated {
                 WireLogger.notifications.error("Not displaying notification because app is not authenticated")
                 self.delegate?.notificationSessionDidFailWithError(error: .accountNotAuthenticated)
@@ -399,22 +428,41 @@ extension NotificationSession: PushNotificationStrategyDelegate {
         _ strategy: PushNotificationStrategy,
         didFetchEvents events: [ZMUpdateEvent]
     ) async throws {
-        let decodedEvents = try await self.eventDecoder.decryptAndStoreEvents(
-            events,
-            publicKeys: try? self.earService.fetchPublicKeys()
-        )
+        let publicKeys = try? self.earService.fetchPublicKeys()
+
+        // Dictionary to filter notifications fetched in same batch with same messageOnce
+        // i.e: textMessage and linkPreview
+        var tempNotifications = [Int: ZMLocalNotification]()
+
+        // Events are decrypted and processed in small batches, so that only one batch of
+        // decrypted events and the objects they refer to are kept in memory at a time.
+        for batch in events.chunked(into: Self.eventBatchSize) {
+            let decodedEvents = try await self.eventDecoder.decryptAndStoreEvents(
+                batch,
+                publicKeys: publicKeys
+            )
+
+            let notifications = await self.context.perform { [self] in
+                processDecodedEvents(decodedEvents)
+            }
+
+            for notification in notifications {
+                tempNotifications[notification.contentHashValue] = notification
+            }
+        }
 
+        let notifications = Array(tempNotifications.values)
         await self.context.perform { [self] in
-            processDecodedEvents(decodedEvents)
+            localNotifications = notifications
         }
     }
 
-    private func processDecodedEvents(_ events: [ZMUpdateEvent]) {
+    private func processDecodedEvents(_ events: [ZMUpdateEvent]) -> [ZMLocalNotification] {
         WireLogger.notifications.info("processing \(events.count) decoded events...")
 
-        // Dictionary to filter notifications fetched in same batch with same messageOnce
-        // i.e: textMessage and linkPreview
-        var tempNotifications = [Int: ZMLocalNotification]()
+        prefetchConversationsAndSenders(of: events)
+
+        var notifications = [ZMLocalNotification]()
 
         for event in events {
             if let callEventPayload = callEventPayloadForCallKit(from: event) {
@@ -423,14 +471,35 @@ extension NotificationSession: PushNotificationStrategyDelegate {
                 callEvent = callEventPayload
             } else if let notification = notification(from: event, in: context) {
                 WireLogger.notifications.info("generated a notification from an event", attributes: event.logAttributes)
-                tempNotifications[notification.contentHashValue] = notification
+                notifications.append(notification)
             } else {
                 WireLogger.notifications.info("ignoring event", attributes: event.logAttributes)
             }
         }
 
-        localNotifications = Array(tempNotifications.values)
+        processedEventCount += events.count
         context.saveOrRollback()
+
+        // The changes are saved, so the objects of this batch can be turned into faults.
+        context.refreshAllObjects()
+
+        return notifications
+    }
+
+    /// Registers the conversations and senders of the events in the context with one fetch
+    /// each, so resolving them for every single event is a lookup in the remote identifier index.
+
+    private func prefetchConversationsAndSenders(of events: [ZMUpdateEvent]) {
+        let conversationIDs = Set(events.compactMap(\.conversationUUID))
+        let senderIDs = Set(events.compactMap(\.senderUUID))
+
+        if !conversationIDs.isEmpty {
+            _ = ZMConversation.fetchObjects(withRemoteIdentifiers: conversationIDs, in: context)
+        }
+
+        if !senderIDs.isEmpty {
+            _ = ZMUser.fetchObjects(withRemoteIdentifiers: senderIDs, in: context)
+        }
     }
 
     private func callEventPayloadForCallKit(from event: ZMUpdateEvent) -> CallEventPayload? {
@@ -538,6 +607,16 @@ extension NotificationSession: PushNotificationStrategyDelegate {
         WireLogger.notifications.info("did finish processing events")
         processCallEvent()
         processLocalNotifications()
+        logProcessingMetrics()
+    }
+
+    private func logProcessingMetrics() {
+        let coldStartDuration = Date().timeIntervalSince(creationDate)
+        let processingDuration = pushProcessingStartDate.map { Date().timeIntervalSince($0) } ?? 0
+
+        WireLogger.notifications.info(
+            "processed \(processedEventCount) events in \(processingDuration)s, \(coldStartDuration)s after the session was created, peak memory: \(Self.peakResidentMemoryDescription)"
+        )
     }
 
     private func processCallEvent() {
@@ -568,6 +647,31 @@ extension NotificationSession: PushNotificationStrategyDelegate {
 
 }
 
+// MARK: - Memory
+
+extension NotificationSession {
+
+    /// The highest resident memory of the process so far.
+
+    static var peakResidentMemoryDescription: String {
+        var info = mach_task_basic_info()
+        var count = mach_msg_type_number_t(MemoryLayout<mach_task_basic_info>.size / MemoryLayout<natural_t>.size)
+
+        let result = withUnsafeMutablePointer(to: &info) { pointer in
+            pointer.withMemoryRebound(to: integer_t.self, capacity: Int(count)) {
+                task_info(mach_task_self_, task_flavor_t(MACH_TASK_BASIC_INFO), $0, &count)
+            }
+        }
+
+        guard result == KERN_SUCCESS else {
+            return "unknown"
+        }
+
+        return ByteCountFormatter.string(fromByteCount: Int64(info.resident_size_max), countStyle: .memory)
+    }
+
+}
+
 // MARK: - Converting events to localNotifications
 
 extension NotificationSession {
@@ -643,3 +747,13 @@ public struct CallEventPayload {
     }
 
 }
+
+private extension Array {
+
+    func chunked(into size: Int) -> [[Element]] {
+        return stride(from: 0, to: count, by: size).map {
+            Array(self[$0 ..< Swift.min($0 + size, count)])
+        }
+    }
+
+}
@@ -23,7 +23,7 @@ class ActionHandler<T: EntityAction>: NSObject, EntityActionHandler, ZMRequestGe
 
     let context: NSManagedObjectContext
 
-    private(set) var pendingActions: [Action] = []
+    var pendingActions: [Action] = []
     private var token: NSObjectProtocol?
 
     init(context: NSManagedObjectContext) {
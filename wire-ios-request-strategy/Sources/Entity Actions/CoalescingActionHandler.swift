@@ -0,0 +1,192 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+import WireDataModel
+
+/// An action about a set of entities that can be merged with other
+/// actions of the same type into a single bulk request.
+
+protocol CoalescableEntityAction: EntityAction {
+
+    associatedtype CoalescingID: Hashable
+
+    /// The ids of the entities the action is about.
+
+    var coalescingIDs: Set<CoalescingID> { get }
+
+    /// Creates an action about all the given ids.
+
+    static func coalesced(ids: Set<CoalescingID>) -> Self
+
+    /// Extracts the part of the result of a coalesced action that
+    /// this action asked for.
+
+    func result(from coalescedResult: Result) -> Result
+
+}
+
+/// Counters describing how many requests a `CoalescingActionHandler` saved.
+
+struct CoalescingMetrics: Equatable {
+
+    /// The number of actions that were performed.
+
+    var actions = 0
+
+    /// The number of requests that were sent for these actions.
+
+    var requests = 0
+
+    /// The number of actions that were answered by another action's request.
+
+    var requestsSaved: Int {
+        actions - requests
+    }
+
+}
+
+/// An action handler that folds pending actions into bulk requests.
+///
+/// All actions that were performed since the operation loop last asked for a
+/// request are merged into as few requests as `maximumBatchSize` allows, and
+/// an action whose ids are all covered by a request that is already in flight
+/// waits for that request instead of sending its own. Results are fanned out
+/// to every action once the response arrives.
+
+class CoalescingActionHandler<T: CoalescableEntityAction>: ActionHandler<T> {
+
+    /// A request that was sent on behalf of several actions.
+
+    private final class Batch {
+
+        let ids: Set<T.CoalescingID>
+        var actions: [T]
+
+        init(ids: Set<T.CoalescingID>, actions: [T]) {
+            self.ids = ids
+            self.actions = actions
+        }
+
+    }
+
+    /// The maximum number of ids in a single request. The bulk user and
+    /// client endpoints accept up to 500.
+
+    let maximumBatchSize: Int
+
+    private(set) var metrics = CoalescingMetrics()
+    private var batchesInFlight: [Batch] = []
+
+    init(
+        context: NSManagedObjectContext,
+        maximumBatchSize: Int = 500
+    ) {
+        self.maximumBatchSize = maximumBatchSize
+        super.init(context: context)
+    }
+
+    override func performAction(_ action: Action) {
+        context.performGroupedBlock {
+            self.metrics.actions += 1
+        }
+        super.performAction(action)
+    }
+
+    override func nextRequest(for apiVersion: APIVersion) -> ZMTransportRequest? {
+        joinBatchesInFlight()
+
+        guard !pendingActions.isEmpty else {
+            return nil
+        }
+
+        let batch = makeBatch()
+        var coalescedAction = Action.coalesced(ids: batch.ids)
+        coalescedAction.onResult { result in
+            for var action in batch.actions {
+                action.notifyResult(result.map { action.result(from: $0) })
+            }
+        }
+
+        guard let request = request(for: coalescedAction, apiVersion: apiVersion) else {
+            return nil
+        }
+
+        metrics.requests += 1
+        batchesInFlight.append(batch)
+
+        request.add(ZMCompletionHandler(on: context) { [weak self] response in
+            guard let self else { return }
+
+            batchesInFlight.removeAll { $0 === batch }
+
+            if response.httpStatus.isOne(of: TooManyRequestsStatusCode, EnhanceYourCalmStatusCode) {
+                // We're being rate limited, put the actions back so we can try again
+                // next time the operation loop polls.
+                metrics.requests -= 1
+                pendingActions.append(contentsOf: batch.actions)
+            } else {
+                handleResponse(response, action: coalescedAction)
+            }
+        })
+
+        return request
+    }
+
+    // MARK: - Helpers
+
+    /// Attaches pending actions to requests in flight that cover all of their ids.
+
+    private func joinBatchesInFlight() {
+        guard !batchesInFlight.isEmpty else {
+            return
+        }
+
+        pendingActions.removeAll { action in
+            guard let batch = batchesInFlight.first(where: { action.coalescingIDs.isSubset(of: $0.ids) }) else {
+                return false
+            }
+
+            batch.actions.append(action)
+            return true
+        }
+    }
+
+    /// Takes as many pending actions as fit into one request, in order.
+
+    private func makeBatch() -> Batch {
+        var ids = Set<T.CoalescingID>()
+        var actions: [T] = []
+        var remainingActions: [T] = []
+
+        for action in pendingActions {
+            let mergedIDs = ids.union(action.coalescingIDs)
+
+            if actions.isEmpty || mergedIDs.count <= maximumBatchSize {
+                ids = mergedIDs
+                actions.append(action)
+            } else {
+                remainingActions.append(action)
+            }
+        }
+
+        pendingActions = remainingActions
+        return Batch(ids: ids, actions: actions)
+    }
+
+}
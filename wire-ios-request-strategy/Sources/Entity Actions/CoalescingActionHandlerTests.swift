@@ -0,0 +1,190 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+@testable import WireRequestStrategy
+import XCTest
+
+private final class MockCoalescableAction: CoalescableEntityAction, Equatable {
+    let uuid = UUID()
+    let ids: Set<Int>
+    var resultHandler: ResultHandler?
+
+    typealias Result = Set<Int>
+    typealias Failure = Error
+
+    init(ids: Set<Int>, resultHandler: ResultHandler? = nil) {
+        self.ids = ids
+        self.resultHandler = resultHandler
+    }
+
+    var coalescingIDs: Set<Int> {
+        ids
+    }
+
+    static func coalesced(ids: Set<Int>) -> MockCoalescableAction {
+        MockCoalescableAction(ids: ids)
+    }
+
+    func result(from coalescedResult: Set<Int>) -> Set<Int> {
+        coalescedResult.intersection(ids)
+    }
+
+    static func == (lhs: MockCoalescableAction, rhs: MockCoalescableAction) -> Bool {
+        return lhs.uuid == rhs.uuid
+    }
+}
+
+private class TestCoalescingActionHandler: CoalescingActionHandler<MockCoalescableAction> {
+
+    var requestedIDs: [Set<Int>] = []
+    override func request(for action: MockCoalescableAction, apiVersion: APIVersion) -> ZMTransportRequest? {
+        requestedIDs.append(action.ids)
+        return ZMTransportRequest(getFromPath: "/mock/request", apiVersion: APIVersion.v0.rawValue)
+    }
+
+    override func handleResponse(_ response: ZMTransportResponse, action: MockCoalescableAction) {
+        var action = action
+        action.succeed(with: action.ids)
+    }
+
+}
+
+class CoalescingActionHandlerTests: MessagingTestBase {
+
+    private var sut: TestCoalescingActionHandler!
+
+    override func setUp() {
+        super.setUp()
+        self.sut = TestCoalescingActionHandler(context: uiMOC, maximumBatchSize: 4)
+    }
+
+    override func tearDown() {
+        self.sut = nil
+        super.tearDown()
+    }
+
+    func testThatItFoldsPendingActionsIntoOneRequest() throws {
+        // given
+        MockCoalescableAction(ids: [1, 2]).send(in: uiMOC.notificationContext)
+        MockCoalescableAction(ids: [2, 3]).send(in: uiMOC.notificationContext)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // when
+        let request = self.sut.nextRequest(for: .v0)
+
+        // then
+        XCTAssertNotNil(request)
+        XCTAssertEqual(sut.requestedIDs, [[1, 2, 3]])
+        XCTAssertTrue(sut.pendingActions.isEmpty)
+        XCTAssertNil(self.sut.nextRequest(for: .v0))
+    }
+
+    func testThatItSplitsBatchesAtTheMaximumBatchSize() throws {
+        // given
+        MockCoalescableAction(ids: [1, 2, 3]).send(in: uiMOC.notificationContext)
+        MockCoalescableAction(ids: [4, 5]).send(in: uiMOC.notificationContext)
+        MockCoalescableAction(ids: [3]).send(in: uiMOC.notificationContext)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // when
+        _ = self.sut.nextRequest(for: .v0)
+        _ = self.sut.nextRequest(for: .v0)
+
+        // then
+        XCTAssertEqual(sut.requestedIDs, [[1, 2, 3], [4, 5]])
+    }
+
+    func testThatItHandsEachActionItsPartOfTheResult() throws {
+        // given
+        let firstResult = customExpectation(description: "first result")
+        let secondResult = customExpectation(description: "second result")
+
+        MockCoalescableAction(ids: [1, 2]) { result in
+            XCTAssertEqual(try? result.get(), [1, 2])
+            firstResult.fulfill()
+        }.send(in: uiMOC.notificationContext)
+
+        MockCoalescableAction(ids: [3]) { result in
+            XCTAssertEqual(try? result.get(), [3])
+            secondResult.fulfill()
+        }.send(in: uiMOC.notificationContext)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        let request = try XCTUnwrap(self.sut.nextRequest(for: .v0))
+
+        // when
+        request.complete(with: response(httpStatus: 200, apiVersion: .v0))
+
+        // then
+        XCTAssertTrue(waitForCustomExpectations(withTimeout: 0.5))
+    }
+
+    func testThatItAttachesActionsToACoveringRequestInFlight() throws {
+        // given
+        let lateResult = customExpectation(description: "late result")
+
+        MockCoalescableAction(ids: [1, 2]).send(in: uiMOC.notificationContext)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+        let request = try XCTUnwrap(self.sut.nextRequest(for: .v0))
+
+        MockCoalescableAction(ids: [2]) { result in
+            XCTAssertEqual(try? result.get(), [2])
+            lateResult.fulfill()
+        }.send(in: uiMOC.notificationContext)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // when
+        XCTAssertNil(self.sut.nextRequest(for: .v0))
+        request.complete(with: response(httpStatus: 200, apiVersion: .v0))
+
+        // then
+        XCTAssertTrue(waitForCustomExpectations(withTimeout: 0.5))
+        XCTAssertEqual(sut.requestedIDs, [[1, 2]])
+        XCTAssertEqual(sut.metrics, CoalescingMetrics(actions: 2, requests: 1))
+        XCTAssertEqual(sut.metrics.requestsSaved, 1)
+    }
+
+    func testThatItReturnsAllActionsToPendingIfRateLimited() throws {
+        // given
+        let first = MockCoalescableAction(ids: [1])
+        let second = MockCoalescableAction(ids: [2])
+        first.send(in: uiMOC.notificationContext)
+        second.send(in: uiMOC.notificationContext)
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        let request = try XCTUnwrap(self.sut.nextRequest(for: .v0))
+
+        // when
+        request.complete(with: response(httpStatus: 429, apiVersion: .v0))
+        XCTAssertTrue(waitForAllGroupsToBeEmpty(withTimeout: 0.5))
+
+        // then
+        XCTAssertEqual(sut.pendingActions, [first, second])
+        XCTAssertEqual(sut.metrics.requests, 0)
+    }
+
+    private func response(httpStatus: Int, apiVersion: APIVersion) -> ZMTransportResponse {
+        return ZMTransportResponse(
+            payload: nil,
+            httpStatus: httpStatus,
+            transportSessionError: nil,
+            apiVersion: apiVersion.rawValue
+        )
+    }
+
+}
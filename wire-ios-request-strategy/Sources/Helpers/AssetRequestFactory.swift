@@ -52,9 +52,11 @@ public final class AssetRequestFactory: NSObject {
         }
     }
 
+    /// Creates a request uploading the encrypted asset stored at `fileURL` in a background session.
+    /// The asset is copied from the file into the request body in chunks and never loaded into memory.
     public func backgroundUpstreamRequestForAsset(
         message: ZMAssetClientMessage,
-        withData data: Data,
+        withFileURL fileURL: URL,
         shareable: Bool = true,
         retention: Retention,
         apiVersion: APIVersion
@@ -64,7 +66,7 @@ public final class AssetRequestFactory: NSObject {
             in: message.managedObjectContext!,
             shareable: shareable,
             retention: retention,
-            data: data
+            fileURL: fileURL
         ) else {
             return nil
         }
@@ -104,7 +106,28 @@ public final class AssetRequestFactory: NSObject {
     }
 
     func dataForMultipartAssetUploadRequest(_ data: Data, shareable: Bool, retention: Retention) throws -> Data {
+        try multipartBodyForAssetUploadRequest(data, shareable: shareable, retention: retention).encodedData()
+    }
+
+    func multipartBodyForAssetUploadRequest(_ data: Data, shareable: Bool, retention: Retention) throws -> ZMMultipartBody {
         let fileDataHeader = [Constant.md5: data.zmMD5Digest().base64String()]
+        let fileItem = ZMMultipartBodyItem(data: data, contentType: Constant.ContentType.octetStream, headers: fileDataHeader)
+
+        return try multipartBodyForAssetUploadRequest(fileItem, shareable: shareable, retention: retention)
+    }
+
+    func multipartBodyForAssetUploadRequest(fileURL: URL, shareable: Bool, retention: Retention) throws -> ZMMultipartBody {
+        let md5Digest = try Data.zmMD5Digest(ofContentsOf: fileURL)
+        let fileDataHeader = [Constant.md5: md5Digest.base64String()]
+
+        guard let fileItem = ZMMultipartBodyItem(fileURL: fileURL, contentType: Constant.ContentType.octetStream, headers: fileDataHeader) else {
+            throw CocoaError(.fileReadNoSuchFile, userInfo: [NSURLErrorKey: fileURL])
+        }
+
+        return try multipartBodyForAssetUploadRequest(fileItem, shareable: shareable, retention: retention)
+    }
+
+    private func multipartBodyForAssetUploadRequest(_ fileItem: ZMMultipartBodyItem, shareable: Bool, retention: Retention) throws -> ZMMultipartBody {
         let jsonObject: [String: Any] = [
             Constant.accessLevel: shareable,
             Constant.retention: retention.rawValue
@@ -112,9 +135,9 @@ public final class AssetRequestFactory: NSObject {
 
         let metaData = try JSONSerialization.data(withJSONObject: jsonObject, options: [])
 
-        return NSData.multipartData(withItems: [
+        return ZMMultipartBody(items: [
             ZMMultipartBodyItem(data: metaData, contentType: Constant.ContentType.json, headers: nil),
-            ZMMultipartBodyItem(data: data, contentType: Constant.ContentType.octetStream, headers: fileDataHeader)
+            fileItem
         ], boundary: Constant.boundary)
     }
 
@@ -123,20 +146,20 @@ public final class AssetRequestFactory: NSObject {
         in moc: NSManagedObjectContext,
         shareable: Bool,
         retention: Retention,
-        data: Data
+        fileURL: URL
     ) -> URL? {
-        guard let multipartData = try? dataForMultipartAssetUploadRequest(
-            data,
+        guard let multipartBody = try? multipartBodyForAssetUploadRequest(
+            fileURL: fileURL,
             shareable: shareable,
             retention: retention
         ) else {
             return nil
         }
 
-        return moc.zm_fileAssetCache.storeTransportData(
-            multipartData,
-            for: message
-        )
+        // The body is written straight to the upload file, copying the asset from its file in chunks.
+        return moc.zm_fileAssetCache.storeTransportData(for: message) { url in
+            try multipartBody.write(to: url)
+        }
     }
 
 }
@@ -85,6 +85,35 @@ class AssetRequestFactoryTests: MessagingTestBase {
 
     // MARK: - Upstream requests
 
+    private func createEncryptedFile(_ data: Data) throws -> URL {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try data.write(to: url)
+        addTeardownBlock {
+            try? FileManager.default.removeItem(at: url)
+        }
+        return url
+    }
+
+    func testThatTheBodyOfAFileIsStreamedFromTheFile() throws {
+        // Given
+        let sut = AssetRequestFactory()
+        let data = Data(repeating: 7, count: 200 * 1024)
+        let fileURL = try createEncryptedFile(data)
+
+        // When
+        let body = try sut.multipartBodyForAssetUploadRequest(fileURL: fileURL, shareable: false, retention: .eternal)
+
+        // Then
+        let fileItem = try XCTUnwrap(body.items.last)
+        XCTAssertEqual(fileItem.fileURL, fileURL)
+        XCTAssertEqual(fileItem.length, UInt64(data.count))
+        XCTAssertEqual(fileItem.headers?["Content-MD5"] as? String, data.zmMD5Digest().base64String())
+        XCTAssertEqual(
+            try body.encodedData(),
+            try sut.dataForMultipartAssetUploadRequest(data, shareable: false, retention: .eternal)
+        )
+    }
+
     func test_UpstreamRequest_V0() throws {
         // Given
         let sut = AssetRequestFactory()
@@ -145,13 +174,13 @@ class AssetRequestFactoryTests: MessagingTestBase {
             message.sender = sender
             message.visibleInConversation = createGroupConversation(with: sender)
 
-            let data = Data([1, 2, 3])
+            let fileURL = try createEncryptedFile(Data([1, 2, 3]))
             let apiVersion = APIVersion.v0
 
             // When
             let request = try XCTUnwrap(sut.backgroundUpstreamRequestForAsset(
                 message: message,
-                withData: data,
+                withFileURL: fileURL,
                 retention: .eternal,
                 apiVersion: apiVersion
             ))
@@ -170,13 +199,13 @@ class AssetRequestFactoryTests: MessagingTestBase {
             message.sender = sender
             message.visibleInConversation = createGroupConversation(with: sender)
 
-            let data = Data([1, 2, 3])
+            let fileURL = try createEncryptedFile(Data([1, 2, 3]))
             let apiVersion = APIVersion.v1
 
             // When
             let request = try XCTUnwrap(sut.backgroundUpstreamRequestForAsset(
                 message: message,
-                withData: data,
+                withFileURL: fileURL,
                 retention: .eternal,
                 apiVersion: apiVersion
             ))
@@ -195,13 +224,13 @@ class AssetRequestFactoryTests: MessagingTestBase {
             message.sender = sender
             message.visibleInConversation = createGroupConversation(with: sender)
 
-            let data = Data([1, 2, 3])
+            let fileURL = try createEncryptedFile(Data([1, 2, 3]))
             let apiVersion = APIVersion.v2
 
             // When
             let request = try XCTUnwrap(sut.backgroundUpstreamRequestForAsset(
                 message: message,
-                withData: data,
+                withFileURL: fileURL,
                 retention: .eternal,
                 apiVersion: apiVersion
             ))
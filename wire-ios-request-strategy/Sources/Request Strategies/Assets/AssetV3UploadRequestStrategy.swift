@@ -117,21 +117,22 @@ extension AssetV3UploadRequestStrategy: ZMUpstreamTranscoder {
     }
 
     private func requestForUploadingAsset(_ asset: AssetType, for message: ZMAssetClientMessage, apiVersion: APIVersion) -> ZMUpstreamRequest {
-        guard let data = asset.encrypted else { fatal("Encrypted data not available") }
         guard let retention = message.conversation.map(AssetRequestFactory.Retention.init) else { fatal("Trying to send message that doesn't have a conversation") }
 
         WireLogger.assets.debug("sending request for asset", attributes: [.nonce: message.nonce?.safeForLoggingDescription ?? "<nil>"])
         var request: ZMTransportRequest?
 
         if shouldUseBackgroundSession {
+            guard let fileURL = asset.encryptedURL else { fatal("Encrypted data not available") }
             request = requestFactory.backgroundUpstreamRequestForAsset(
                 message: message,
-                withData: data,
+                withFileURL: fileURL,
                 shareable: false,
                 retention: retention,
                 apiVersion: apiVersion
             )
         } else {
+            guard let data = asset.encrypted else { fatal("Encrypted data not available") }
             request = requestFactory.upstreamRequestForAsset(
                 withData: data,
                 shareable: false,
@@ -74,10 +74,12 @@ public final class LinkPreviewAssetUploadRequestStrategy: AbstractRequestStrateg
     }
 
     public init(managedObjectContext: NSManagedObjectContext, applicationStatus: ApplicationStatus, linkPreviewPreprocessor: LinkPreviewPreprocessor?, previewImagePreprocessor: ZMImagePreprocessingTracker?) {
-        if LinkPreviewDetectorHelper.test_debug_linkPreviewDetector() == nil {
-            LinkPreviewDetectorHelper.setTest_debug_linkPreviewDetector(LinkPreviewDetector())
-        }
-        self.linkPreviewPreprocessor = linkPreviewPreprocessor ?? LinkPreviewPreprocessor(linkPreviewDetector: LinkPreviewDetectorHelper.test_debug_linkPreviewDetector()!, managedObjectContext: managedObjectContext)
+        // Each session gets its own detector, so previews cached for one account are
+        // released with its session and never served to another account.
+        self.linkPreviewPreprocessor = linkPreviewPreprocessor ?? LinkPreviewPreprocessor(
+            linkPreviewDetector: LinkPreviewDetectorHelper.test_debug_linkPreviewDetector() ?? LinkPreviewDetector(),
+            managedObjectContext: managedObjectContext
+        )
         self.previewImagePreprocessor = previewImagePreprocessor ?? ZMImagePreprocessingTracker.createPreviewImagePreprocessingTracker(managedObjectContext: managedObjectContext)
 
         super.init(withManagedObjectContext: managedObjectContext, applicationStatus: applicationStatus)
@@ -19,7 +19,7 @@
 import Foundation
 import WireDataModel
 
-class SyncUsersActionHandler: ActionHandler<SyncUsersAction> {
+class SyncUsersActionHandler: CoalescingActionHandler<SyncUsersAction> {
 
     private let payloadProcessor: UserProfilePayloadProcessing
 
@@ -125,3 +125,19 @@ class SyncUsersActionHandler: ActionHandler<SyncUsersAction> {
     }
 
 }
+
+// MARK: - Coalescing
+
+extension SyncUsersAction: CoalescableEntityAction {
+
+    var coalescingIDs: Set<QualifiedID> {
+        Set(qualifiedIDs)
+    }
+
+    static func coalesced(ids: Set<QualifiedID>) -> SyncUsersAction {
+        SyncUsersAction(qualifiedIDs: Array(ids))
+    }
+
+    func result(from coalescedResult: Void) {}
+
+}
@@ -19,7 +19,7 @@
 import Foundation
 import WireDataModel
 
-final class FetchUserClientsActionHandler: ActionHandler<FetchUserClientsAction> {
+final class FetchUserClientsActionHandler: CoalescingActionHandler<FetchUserClientsAction> {
 
     // MARK: - Request
 
@@ -125,3 +125,23 @@ final class FetchUserClientsActionHandler: ActionHandler<FetchUserClientsAction>
     }
 
 }
+
+// MARK: - Coalescing
+
+extension FetchUserClientsAction: CoalescableEntityAction {
+
+    var coalescingIDs: Set<QualifiedID> {
+        userIDs
+    }
+
+    static func coalesced(ids: Set<QualifiedID>) -> FetchUserClientsAction {
+        FetchUserClientsAction(userIDs: ids)
+    }
+
+    func result(from coalescedResult: Set<QualifiedClientID>) -> Set<QualifiedClientID> {
+        coalescedResult.filter {
+            userIDs.contains(QualifiedID(uuid: $0.userID, domain: $0.domain))
+        }
+    }
+
+}
@@ -116,7 +116,7 @@ extension EventDecoder {
                     }
 
                     if let mlsService, updateEvent.source == .webSocket {
-                        mlsService.commitPendingProposalsIfNeeded()
+                        await mlsService.scheduleCommitPendingProposals(in: groupID, at: scheduledDate)
                     }
                 }
             }
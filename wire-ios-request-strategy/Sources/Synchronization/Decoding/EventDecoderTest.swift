@@ -43,6 +43,7 @@ class EventDecoderTest: MessagingTestBase {
 
         syncMOC.performGroupedAndWait {
             self.mockMLSService.commitPendingProposalsIfNeeded_MockMethod = {}
+            self.mockMLSService.scheduleCommitPendingProposalsInAt_MockMethod = { _, _ in }
             self.syncMOC.mlsService = self.mockMLSService
             let selfUser = ZMUser.selfUser(in: self.syncMOC)
             selfUser.remoteIdentifier = self.accountIdentifier
@@ -582,13 +583,14 @@ extension EventDecoderTest {
         }
     }
 
-    func test_DecryptMLSMessage_CommitsPendingsProposals_WhenReceivingProposalOnWebsocket() async {
+    func test_DecryptMLSMessage_SchedulesPendingProposalsCommit_WhenReceivingProposalOnWebsocket() async throws {
         // Given
         let commitDelay: UInt64 = 5
+        let mlsGroupID = MLSGroupID.random()
         let event: ZMUpdateEvent = await syncMOC.perform { [self] in
             self.mlsMessageAddEvent(
                 data: Data.random().base64EncodedString(),
-                groupID: .random()
+                groupID: mlsGroupID
             )
         }
         event.source = .webSocket
@@ -601,11 +603,18 @@ extension EventDecoderTest {
 
         // Then
         XCTAssertTrue(decryptedEvents.isEmpty)
-        wait(forConditionToBeTrue: !self.mockMLSService.commitPendingProposalsIfNeeded_Invocations.isEmpty, timeout: 3)
-        XCTAssertEqual(1, mockMLSService.commitPendingProposalsIfNeeded_Invocations.count)
+        XCTAssertEqual(1, mockMLSService.scheduleCommitPendingProposalsInAt_Invocations.count)
+
+        let invocation = try XCTUnwrap(mockMLSService.scheduleCommitPendingProposalsInAt_Invocations.first)
+        let expectedCommitDate = try XCTUnwrap(event.timestamp) + TimeInterval(commitDelay)
+        XCTAssertEqual(invocation.groupID, mlsGroupID)
+        XCTAssertEqual(invocation.commitDate, expectedCommitDate)
+
+        // Then it doesn't rescan all groups with pending proposals.
+        XCTAssertTrue(mockMLSService.commitPendingProposalsIfNeeded_Invocations.isEmpty)
     }
 
-    func test_DecryptMLSMessage_CommitsPendingsProposalsIsNotCalled_WhenReceivingProposalViaDownload() async {
+    func test_DecryptMLSMessage_PendingProposalsCommitIsNotScheduled_WhenReceivingProposalViaDownload() async {
         // Given
         let commitDelay: UInt64 = 5
         let mlsGroupID = MLSGroupID.random()
@@ -626,6 +635,7 @@ extension EventDecoderTest {
         // Then
         XCTAssertTrue(decryptedEvents.isEmpty)
         spinMainQueue(withTimeout: 1)
+        XCTAssertTrue(mockMLSService.scheduleCommitPendingProposalsInAt_Invocations.isEmpty)
         XCTAssertTrue(mockMLSService.commitPendingProposalsIfNeeded_Invocations.isEmpty)
     }
 
@@ -126,16 +126,22 @@ public final class StoredUpdateEvent: NSManagedObject {
     }
 
     static private func storedEventExists(for eventId: String, eventHash: Int, in context: NSManagedObjectContext) -> Bool {
+        let templateName = "storedEventExists"
         let fetchRequest = NSFetchRequest<StoredUpdateEvent>(entityName: self.entityName)
-        let eventIdPredicate = NSPredicate(format: "%K = %@", #keyPath(StoredUpdateEvent.uuidString), eventId)
-
-        let eventHash = NSPredicate(format: "%K = %lld", #keyPath(StoredUpdateEvent.eventHash), Int64(eventHash))
-        let defaultEventHash = NSPredicate(format: "%K = 0", #keyPath(StoredUpdateEvent.eventHash))
-
-        let eventHashOrPredicate = NSCompoundPredicate(orPredicateWithSubpredicates: [eventHash, defaultEventHash])
-
-        fetchRequest.predicate = NSCompoundPredicate(andPredicateWithSubpredicates: [eventIdPredicate, eventHashOrPredicate])
+        fetchRequest.predicate = context.fetchRequestTemplateCache.predicate(
+            templateNamed: templateName,
+            substitutionVariables: [
+                "EVENT_ID": eventId,
+                "EVENT_HASH": NSNumber(value: Int64(eventHash))
+            ]
+        ) {
+            NSPredicate(format: "%K = $EVENT_ID AND (%K = $EVENT_HASH OR %K = 0)",
+                        #keyPath(StoredUpdateEvent.uuidString),
+                        #keyPath(StoredUpdateEvent.eventHash),
+                        #keyPath(StoredUpdateEvent.eventHash))
+        }
 
+        // Only the predicate is reused: the statistics of the event context are never logged.
         let result = context.countOrAssert(request: fetchRequest)
         return result > 0
     }
@@ -184,6 +184,7 @@ extension SyncStatus {
                 WireLogger.sync.debug("restarting quick sync since push channel was closed or open after request to fetch notifiations")
             } else {
                 WireLogger.sync.debug("sync complete")
+                logMostExpensiveFetches()
                 notifyQuickSyncDidFinish()
                 isForceQuickSync = false
             }
@@ -191,6 +192,13 @@ extension SyncStatus {
         RequestAvailableNotification.notifyNewRequestsAvailable(self)
     }
 
+    /// Logs the fetches that took the most time since the last sync completed.
+    private func logMostExpensiveFetches() {
+        let fetchRequestTemplateCache = managedObjectContext.fetchRequestTemplateCache
+        fetchRequestTemplateCache.logMostExpensiveFetches()
+        fetchRequestTemplateCache.resetStatistics()
+    }
+
     public func failCurrentSyncPhase(phase: SyncPhase) {
         precondition(phase == currentSyncPhase, "Failed syncPhase does not match currentPhase")
 
@@ -16,6 +16,7 @@
 // along with this program. If not, see http://www.gnu.org/licenses/.
 //
 
+import WireDataModel
 @testable import WireSyncEngine
 import XCTest
 
@@ -240,6 +241,21 @@ final class SyncStatusTests: MessagingTest {
         XCTAssertTrue(mockSyncDelegate.didCallFinishQuickSync)
     }
 
+    func testThatItResetsTheFetchStatisticsWhenFinishingSync() {
+        // given
+        lastEventIDRepository.storeLastEventID(UUID.timeBasedUUID() as UUID)
+        sut.determineInitialSyncPhase()
+        uiMOC.fetchRequestTemplateCache.recordFetch(templateNamed: "template", duration: 0.01)
+        XCTAssertFalse(uiMOC.fetchRequestTemplateCache.statistics.isEmpty)
+
+        // when
+        sut.finishCurrentSyncPhase(phase: .fetchingMissedEvents)
+
+        // then
+        XCTAssertEqual(sut.currentSyncPhase, .done)
+        XCTAssertTrue(uiMOC.fetchRequestTemplateCache.statistics.isEmpty)
+    }
+
     func testThatItNotifiesTheStateDelegateWhenStartingSlowSync() {
         // when
         sut.determineInitialSyncPhase()
@@ -22,20 +22,86 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface ZMMultipartBodyItem : NSObject
 
+/// The payload of the item. For items backed by a file this maps the file on first access.
 @property (nonatomic, readonly, copy) NSData *data;
 @property (nonatomic, readonly, copy, nullable) NSString *contentType;
 @property (nonatomic, readonly, copy, nullable) NSDictionary *headers;
 
+/// The file the payload is streamed from, if the item was created with a file URL.
+@property (nonatomic, readonly, copy, nullable) NSURL *fileURL;
+
+/// The length of the payload in bytes, known without reading a file backed payload.
+@property (nonatomic, readonly) unsigned long long length;
+
 - (instancetype)initWithData:(NSData *)data contentType:(NSString *)contentType headers:(nullable NSDictionary *)headers;
+
+/// Creates an item whose payload is read from @c fileURL only while the body is encoded.
+/// Returns @c nil if the size of the file can't be determined.
+- (nullable instancetype)initWithFileURL:(NSURL *)fileURL contentType:(NSString *)contentType headers:(nullable NSDictionary *)headers;
+
 - (instancetype)initWithMultipartData:(NSData *)data;
 
 - (BOOL)isEqualToItem:(ZMMultipartBodyItem *)object;
 
 @end
 
+/// A multipart body that is encoded on demand.
+///
+/// The encoded length is known upfront, so the body can be written into a single
+/// preallocated buffer or written to a file, without ever concatenating
+/// copies of the payloads. Payloads of file backed items are copied in chunks and
+/// never held in memory as a whole.
+@interface ZMMultipartBody : NSObject
+
+@property (nonatomic, readonly, copy) NSArray<ZMMultipartBodyItem *> *items;
+@property (nonatomic, readonly, copy) NSString *boundary;
+
+/// The number of bytes of the encoded body.
+@property (nonatomic, readonly) unsigned long long contentLength;
+
+- (instancetype)initWithItems:(NSArray<ZMMultipartBodyItem *> *)items boundary:(NSString *)boundary NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Encodes the body into a buffer of exactly @c contentLength bytes.
+/// Returns @c nil if the payload of a file backed item can't be read completely.
+- (nullable NSData *)encodedDataWithError:(NSError **)error;
+
+/// Writes the encoded body to a file, replacing any existing file at @c url.
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error;
+
+@end
+
+/// A part found by @c ZMMultipartParser. The payload is described by its range in the
+/// parsed data and only copied when asked for.
+@interface ZMMultipartPart : NSObject
+
+@property (nonatomic, readonly, copy, nullable) NSString *contentType;
+@property (nonatomic, readonly, copy) NSDictionary<NSString *, NSString *> *headers;
+@property (nonatomic, readonly) NSRange payloadRange;
+
+@end
+
+/// Parses a multipart body part by part, without splitting the whole body upfront.
+///
+/// The declared @c Content-Length of a part is used to skip over its payload, so
+/// payloads are never scanned for the boundary unless the length is missing or wrong.
+@interface ZMMultipartParser : NSObject
+
+- (instancetype)initWithData:(NSData *)data boundary:(NSString *)boundary NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Returns the next part, or @c nil once the closing delimiter or the end of the data is reached.
+- (nullable ZMMultipartPart *)nextPart;
+
+/// Returns a copy of the payload of a part returned by this parser.
+- (NSData *)payloadOfPart:(ZMMultipartPart *)part;
+
+@end
+
 @interface NSData (Multipart)
 
-+ (NSData *)multipartDataWithItems:(NSArray *)items boundary:(NSString *)boundary;
+/// Returns @c nil if the payload of a file backed item can't be read completely.
++ (nullable NSData *)multipartDataWithItems:(NSArray *)items boundary:(NSString *)boundary;
 
 - (NSArray *)multipartDataItemsSeparatedWithBoundary:(NSString *)boundary;
 
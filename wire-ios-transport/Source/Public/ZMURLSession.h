@@ -89,6 +89,11 @@ didReceiveResponse:(NSURLResponse *)response
 
 - (void)URLSessionDidFinishEventsForBackgroundURLSession:(ZMURLSession *)URLSession;
 
+@optional
+
+/// Called before the task completes with the timing of its transactions.
+- (void)URLSession:(ZMURLSession *)URLSession task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,223 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import Foundation
+import WireUtilities
+
+/// Adjusts the number of concurrent requests from the responses the backend sends.
+///
+/// The limit grows additively while responses come back quickly and shrinks
+/// multiplicatively when we are rate limited or see server errors (AIMD). Like
+/// TCP Vegas, a round trip time well above the smallest one observed is taken
+/// as a sign of queueing and shrinks the limit a little before the backend
+/// starts rejecting requests.
+///
+/// `limit` is read lock-free, it is consulted for every request the transport
+/// session considers starting.
+@objc(ZMAdaptiveConcurrencyLimit) @objcMembers
+public final class AdaptiveConcurrencyLimit: NSObject {
+
+    /// Outcome of a single request, as far as the limit is concerned
+    enum Outcome: Equatable {
+        case success(roundTripTime: TimeInterval)
+        case rateLimited
+        case failure
+    }
+
+    struct Configuration {
+        var minimumLimit = 1
+        /// Factor applied to the limit on rate limiting or server errors
+        var backoffFactor = 0.5
+        /// Factor applied to the limit when the round trip time indicates queueing
+        var queueingBackoffFactor = 0.9
+        /// A round trip time above `minimumRoundTripTime * queueingTolerance` counts as queueing
+        var queueingTolerance = 2.0
+        /// The smallest round trip time is forgotten after this interval, so that
+        /// we adapt when switching networks
+        var minimumRoundTripTimeLifetime: TimeInterval = 60
+    }
+
+    /// The current number of requests that may run concurrently
+    public var limit: Int {
+        currentLimit.rawValue
+    }
+
+    /// The limit never grows beyond this value. Setting it starts over from the new maximum.
+    public var maximumLimit: Int {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return _maximumLimit
+        }
+        set {
+            lock.lock()
+            defer { lock.unlock() }
+            _maximumLimit = max(newValue, configuration.minimumLimit)
+            resetEstimate()
+        }
+    }
+
+    private let configuration: Configuration
+    private let currentLimit: ZMAtomicInteger
+    private let currentDate: () -> Date
+    private let lock = NSLock()
+
+    private var _maximumLimit: Int
+    /// The fractional limit, the integer part is published through `currentLimit`
+    private var estimatedLimit: Double
+    private var minimumRoundTripTime: TimeInterval?
+    private var minimumRoundTripTimeDate: Date?
+    private var lastDecreaseDate: Date?
+
+    /// Starts at `maximumLimit` and only shrinks once the backend shows signs of congestion
+    public convenience init(maximumLimit: Int) {
+        self.init(
+            maximumLimit: maximumLimit,
+            configuration: Configuration(),
+            currentDate: Date.init
+        )
+    }
+
+    init(
+        maximumLimit: Int,
+        configuration: Configuration,
+        currentDate: @escaping () -> Date
+    ) {
+        let maximumLimit = max(maximumLimit, configuration.minimumLimit)
+        self.configuration = configuration
+        self.currentDate = currentDate
+        self._maximumLimit = maximumLimit
+        self.estimatedLimit = Double(maximumLimit)
+        self.currentLimit = ZMAtomicInteger(integer: maximumLimit)
+    }
+
+    // MARK: - Recording responses
+
+    /// Records the response of a request that was sent through the transport session
+    /// - parameter statusCode: the HTTP status code, 0 if there was no response
+    /// - parameter error: the `NSURLErrorDomain` error the task completed with, if any
+    /// - parameter roundTripTime: the time between sending the request and receiving the first
+    ///   byte of the response, see `responseLatency(from:)`. 0 if unknown.
+    @objc(recordResponseWithStatusCode:error:roundTripTime:)
+    public func recordResponse(statusCode: Int, error: NSError?, roundTripTime: TimeInterval) {
+        switch statusCode {
+        case TooManyRequestsStatusCode, EnhanceYourCalmStatusCode:
+            record(.rateLimited)
+        case 500...599:
+            record(.failure)
+        case _ where error?.code == NSURLErrorTimedOut:
+            record(.failure)
+        case 100...499:
+            record(.success(roundTripTime: roundTripTime))
+        default:
+            // e.g. lost connectivity, reachability takes care of this
+            break
+        }
+    }
+
+    /// The time between the end of sending the request and the start of the response of the
+    /// last transaction of a task. Unlike the duration of the task, this does not grow with
+    /// the size of uploaded or downloaded bodies.
+    /// - returns: the latency, or 0 if the task didn't receive a response
+    @objc(responseLatencyFromMetrics:)
+    public static func responseLatency(from metrics: URLSessionTaskMetrics) -> TimeInterval {
+        guard
+            let transaction = metrics.transactionMetrics.last,
+            let requestEndDate = transaction.requestEndDate,
+            let responseStartDate = transaction.responseStartDate
+        else {
+            return 0
+        }
+
+        return max(responseStartDate.timeIntervalSince(requestEndDate), 0)
+    }
+
+    func record(_ outcome: Outcome) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let now = currentDate()
+
+        switch outcome {
+        case let .success(roundTripTime):
+            updateMinimumRoundTripTime(roundTripTime, now: now)
+            if roundTripTime > 0, let minimumRoundTripTime, roundTripTime > minimumRoundTripTime * configuration.queueingTolerance {
+                decrease(by: configuration.queueingBackoffFactor, now: now)
+            } else {
+                // grows by roughly one per window of `limit` successful requests
+                estimatedLimit += 1 / estimatedLimit
+            }
+
+        case .rateLimited, .failure:
+            decrease(by: configuration.backoffFactor, now: now)
+        }
+
+        estimatedLimit = min(max(estimatedLimit, Double(configuration.minimumLimit)), Double(_maximumLimit))
+        publish()
+    }
+
+    /// Forgets everything that was learnt about the network, e.g. after a reachability change
+    public func reset() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        resetEstimate()
+    }
+
+    // MARK: - Helpers
+
+    private func resetEstimate() {
+        estimatedLimit = Double(_maximumLimit)
+        minimumRoundTripTime = nil
+        minimumRoundTripTimeDate = nil
+        lastDecreaseDate = nil
+        publish()
+    }
+
+    private func decrease(by factor: Double, now: Date) {
+        // Responses to requests sent before the last decrease still reflect the
+        // old limit, only react once per round trip.
+        let window = minimumRoundTripTime ?? 0
+        if let lastDecreaseDate, now.timeIntervalSince(lastDecreaseDate) < window {
+            return
+        }
+        estimatedLimit *= factor
+        lastDecreaseDate = now
+    }
+
+    private func updateMinimumRoundTripTime(_ roundTripTime: TimeInterval, now: Date) {
+        guard roundTripTime > 0 else { return }
+
+        let isExpired = minimumRoundTripTimeDate.map {
+            now.timeIntervalSince($0) > configuration.minimumRoundTripTimeLifetime
+        } ?? true
+
+        if isExpired || roundTripTime < (minimumRoundTripTime ?? .infinity) {
+            minimumRoundTripTime = roundTripTime
+            minimumRoundTripTimeDate = now
+        }
+    }
+
+    private func publish() {
+        let newLimit = Int(estimatedLimit.rounded(.down))
+        let oldLimit = currentLimit.rawValue
+        if newLimit != oldLimit {
+            _ = currentLimit.setValueWithEqualityCondition(oldLimit, newValue: newLimit)
+        }
+    }
+}
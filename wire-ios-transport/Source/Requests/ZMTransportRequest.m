@@ -795,6 +795,7 @@ typedef NS_ENUM(NSUInteger, ZMTransportRequestSessionType) {
                                          metaDataContentType:metaDataContentType
                                                    mediaType:mediaContentType
                                                     boundary:boundary];
+    VerifyReturnNil(multipartData != nil);
     
     ZMTransportRequest *result = [[self alloc] initWithPath:path
                                                      method:ZMTransportRequestMethodPost
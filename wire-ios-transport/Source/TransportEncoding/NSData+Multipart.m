@@ -16,9 +16,21 @@
 // along with this program. If not, see http://www.gnu.org/licenses/.
 //
 
+@import WireSystem;
 @import WireUtilities;
 
 #import "NSData+Multipart.h"
+#import "ZMTLogging.h"
+
+static NSString* ZMLogTag ZM_UNUSED = ZMT_LOG_TAG_NETWORK;
+
+/// Size of the chunks file backed payloads are copied in.
+static NSUInteger const ZMMultipartChunkSize = 64 * 1024;
+
+static NSString *const ContentTypePrefix = @"Content-Type: ";
+static NSString *const ContentLengthPrefix = @"Content-Length: ";
+
+typedef BOOL (^ZMMultipartChunkBlock)(const uint8_t *bytes, NSUInteger length);
 
 
 static NSRange ZMSubstractRange(NSRange fromRange, NSRange substractRange) {
@@ -37,48 +49,99 @@ static NSRange ZMRangeInterval(NSRange fromRange, NSRange toRange) {
     }
 }
 
-@interface NSMutableData (Multipart)
-
-- (void)appendNewLine;
-- (void)appendString:(NSString *)string;
-- (void)appendStringLine:(NSString *)string;
-- (void)appendMultipartBodyItem:(ZMMultipartBodyItem *)item boundary:(NSString *)boundary;
-
-@end
-
-@implementation NSMutableData (Multipart)
-
-- (void)appendNewLine
+static NSUInteger ZMFindBytes(const uint8_t *bytes, NSUInteger length, NSUInteger from, const void *needle, NSUInteger needleLength)
 {
-    [self appendData:[@"\r\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    if (needleLength == 0 || from > length || length - from < needleLength) {
+        return NSNotFound;
+    }
+    const uint8_t *match = memmem(bytes + from, length - from, needle, needleLength);
+    return match == NULL ? NSNotFound : (NSUInteger)(match - bytes);
 }
 
-- (void)appendString:(NSString *)string
+static BOOL ZMHasNewLineAt(const uint8_t *bytes, NSUInteger length, NSUInteger location)
 {
-    [self appendData:[string dataUsingEncoding:NSUTF8StringEncoding]];
+    return location <= length && length - location >= 2 && bytes[location] == '\r' && bytes[location + 1] == '\n';
 }
 
-- (void)appendStringLine:(NSString *)string
+static BOOL ZMWriteAll(NSOutputStream *stream, const uint8_t *bytes, NSUInteger length)
 {
-    [self appendData:[string dataUsingEncoding:NSUTF8StringEncoding]];
-    [self appendNewLine];
+    while (length > 0) {
+        NSInteger written = [stream write:bytes maxLength:length];
+        if (written <= 0) {
+            return NO;
+        }
+        bytes += written;
+        length -= (NSUInteger)written;
+    }
+    return YES;
 }
 
-- (void)appendMultipartBodyItem:(ZMMultipartBodyItem *)item boundary:(NSString *)boundary
+
+
+@interface ZMMultipartPart ()
+
+@property (nonatomic, readwrite) NSRange payloadRange;
+
+- (instancetype)initWithContentType:(NSString *)contentType headers:(NSDictionary *)headers payloadRange:(NSRange)payloadRange;
+
+@end
+
+
+
+@interface ZMMultipartBodyItem ()
+
+- (instancetype)initWithPayload:(NSData *)payload part:(ZMMultipartPart *)part;
+
+@end
+
+
+
+/// Parses the header lines of a part starting at @c start, which is right after its delimiter.
+/// Returns the part with an empty payload range located at the start of the payload, or @c nil
+/// if the headers are not terminated. @c contentLength is set to -1 if no length is declared.
+static ZMMultipartPart *ZMMultipartPartWithHeaders(const uint8_t *bytes, NSUInteger length, NSUInteger start, NSInteger *contentLength)
 {
-    [self appendStringLine:[NSString stringWithFormat:@"--%@", boundary]];
-    [self appendStringLine:[NSString stringWithFormat:@"Content-Type: %@", item.contentType]];
-    [self appendStringLine:[NSString stringWithFormat:@"Content-Length: %lu", (unsigned long)item.data.length]];
-    for (NSString *key in item.headers) {
-        [self appendStringLine:[NSString stringWithFormat:@"%@: %@", key, item.headers[key]]];
+    NSUInteger headersEnd = ZMFindBytes(bytes, length, start, "\r\n\r\n", 4);
+    if (headersEnd == NSNotFound) {
+        return nil;
+    }
+
+    NSString *contentType;
+    NSMutableDictionary *headers = [NSMutableDictionary new];
+    *contentLength = -1;
+
+    NSUInteger lineStart = start;
+    while (lineStart < headersEnd) {
+        NSUInteger lineEnd = ZMFindBytes(bytes, headersEnd, lineStart, "\r\n", 2);
+        if (lineEnd == NSNotFound) {
+            lineEnd = headersEnd;
+        }
+
+        NSString *line = [[NSString alloc] initWithBytes:bytes + lineStart length:lineEnd - lineStart encoding:NSUTF8StringEncoding];
+        if ([line hasPrefix:ContentTypePrefix]) {
+            contentType = [line substringFromIndex:ContentTypePrefix.length];
+        }
+        else if ([line hasPrefix:ContentLengthPrefix]) {
+            NSScanner *scanner = [NSScanner scannerWithString:[line substringFromIndex:ContentLengthPrefix.length]];
+            NSInteger value = 0;
+            if ([scanner scanInteger:&value] && value >= 0) {
+                *contentLength = value;
+            }
+        }
+        else if (line != nil) {
+            NSRange colonRange = [line rangeOfString:@": "];
+            if (colonRange.location != NSNotFound) {
+                headers[[line substringToIndex:colonRange.location]] = [line substringFromIndex:NSMaxRange(colonRange)];
+            }
+        }
+
+        lineStart = lineEnd + 2;
     }
-    [self appendNewLine];
-    [self appendData:item.data];
-    [self appendNewLine];
+
+    return [[ZMMultipartPart alloc] initWithContentType:contentType headers:headers payloadRange:NSMakeRange(headersEnd + 4, 0)];
 }
 
 
-@end
 
 @implementation NSData (Multipart)
 
@@ -132,119 +195,328 @@ static NSRange ZMRangeInterval(NSRange fromRange, NSRange toRange) {
 
 + (NSData *)multipartDataWithItems:(NSArray *)items boundary:(NSString *)boundary
 {
-    NSMutableData *multipartData = [NSMutableData new];
-    
-    for (ZMMultipartBodyItem *item in items) {
-        [multipartData appendMultipartBodyItem:item boundary:boundary];
+    NSError *error;
+    NSData *data = [[[ZMMultipartBody alloc] initWithItems:items boundary:boundary] encodedDataWithError:&error];
+    if (data == nil) {
+        ZMLogError(@"Failed to encode multipart body: %@", error);
     }
-    [multipartData appendStringLine:[NSString stringWithFormat:@"--%@--", boundary]];
-    
-    return [multipartData copy];
+    return data;
 }
 
 - (NSArray *)multipartDataItemsSeparatedWithBoundary:(NSString *)boundary;
 {
-    NSData *boundaryData = [[NSString stringWithFormat:@"--%@", boundary] dataUsingEncoding:NSUTF8StringEncoding];
-    return [[self componentsSeparatedByData:boundaryData] mapWithBlock:^id(NSData *obj) {
-        if (![obj isEqual:[@"--\r\n" dataUsingEncoding:NSUTF8StringEncoding]]) {
-            //last component is trailing "--\r\n"
-            return [[ZMMultipartBodyItem alloc] initWithMultipartData:obj];
+    ZMMultipartParser *parser = [[ZMMultipartParser alloc] initWithData:self boundary:boundary];
+    NSMutableArray *items = [NSMutableArray new];
+    for (ZMMultipartPart *part = [parser nextPart]; part != nil; part = [parser nextPart]) {
+        [items addObject:[[ZMMultipartBodyItem alloc] initWithPayload:[parser payloadOfPart:part] part:part]];
+    }
+    return items;
+}
+
+@end
+
+
+
+@implementation ZMMultipartBody
+{
+    NSArray<NSData *> *_itemHeaders;
+    NSData *_closingDelimiter;
+}
+
+- (instancetype)initWithItems:(NSArray<ZMMultipartBodyItem *> *)items boundary:(NSString *)boundary
+{
+    self = [super init];
+    if (self) {
+        _items = [items copy];
+        _boundary = [boundary copy];
+        _closingDelimiter = [[NSString stringWithFormat:@"--%@--\r\n", boundary] dataUsingEncoding:NSUTF8StringEncoding];
+
+        NSMutableArray *itemHeaders = [NSMutableArray arrayWithCapacity:items.count];
+        unsigned long long contentLength = _closingDelimiter.length;
+        for (ZMMultipartBodyItem *item in items) {
+            NSData *header = [self headerDataForItem:item];
+            [itemHeaders addObject:header];
+            contentLength += header.length + item.length + 2;
         }
-        return nil;
-    }];
+        _itemHeaders = itemHeaders;
+        _contentLength = contentLength;
+    }
+    return self;
+}
+
+- (NSData *)headerDataForItem:(ZMMultipartBodyItem *)item
+{
+    NSMutableString *header = [NSMutableString stringWithFormat:@"--%@\r\n", self.boundary];
+    [header appendFormat:@"%@%@\r\n", ContentTypePrefix, item.contentType];
+    [header appendFormat:@"%@%llu\r\n", ContentLengthPrefix, item.length];
+    for (NSString *key in item.headers) {
+        [header appendFormat:@"%@: %@\r\n", key, item.headers[key]];
+    }
+    [header appendString:@"\r\n"];
+    return [header dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (NSData *)encodedDataWithError:(NSError **)error
+{
+    NSMutableData *data = [NSMutableData dataWithCapacity:(NSUInteger)self.contentLength];
+    BOOL success = [self enumerateChunksWithBlock:^BOOL(const uint8_t *bytes, NSUInteger length) {
+        [data appendBytes:bytes length:length];
+        return YES;
+    } error:error];
+
+    return success ? data : nil;
+}
+
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error
+{
+    NSOutputStream *stream = [NSOutputStream outputStreamWithURL:url append:NO];
+    [stream open];
+
+    __block BOOL writeFailed = NO;
+    BOOL success = [self enumerateChunksWithBlock:^BOOL(const uint8_t *bytes, NSUInteger length) {
+        writeFailed = !ZMWriteAll(stream, bytes, length);
+        return !writeFailed;
+    } error:error];
+
+    if (writeFailed && error != NULL) {
+        *error = stream.streamError ?: [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSURLErrorKey: url}];
+    }
+    [stream close];
+    return success;
+}
+
+- (BOOL)enumerateChunksWithBlock:(ZMMultipartChunkBlock)block error:(NSError **)error
+{
+    static uint8_t const newLine[] = {'\r', '\n'};
+
+    for (NSUInteger index = 0; index < self.items.count; index++) {
+        NSData *header = _itemHeaders[index];
+        if (!block(header.bytes, header.length) ||
+            ![self enumeratePayloadOfItem:self.items[index] withBlock:block error:error] ||
+            !block(newLine, sizeof(newLine))) {
+            return NO;
+        }
+    }
+
+    return block(_closingDelimiter.bytes, _closingDelimiter.length);
+}
+
+- (BOOL)enumeratePayloadOfItem:(ZMMultipartBodyItem *)item withBlock:(ZMMultipartChunkBlock)block error:(NSError **)error
+{
+    if (item.fileURL == nil) {
+        __block BOOL shouldContinue = YES;
+        [item.data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+            shouldContinue = block(bytes, byteRange.length);
+            *stop = !shouldContinue;
+        }];
+        return shouldContinue;
+    }
+
+    NSInputStream *stream = [NSInputStream inputStreamWithURL:item.fileURL];
+    [stream open];
+
+    uint8_t *buffer = malloc(ZMMultipartChunkSize);
+    unsigned long long copiedLength = 0;
+    BOOL success = YES;
+    NSError *readError;
+
+    while (success) {
+        NSInteger readLength = [stream read:buffer maxLength:ZMMultipartChunkSize];
+        if (readLength < 0) {
+            readError = stream.streamError;
+            success = NO;
+        }
+        else if (readLength == 0) {
+            break;
+        }
+        else {
+            copiedLength += (unsigned long long)readLength;
+            success = copiedLength <= item.length && block(buffer, (NSUInteger)readLength);
+        }
+    }
+
+    free(buffer);
+    [stream close];
+
+    // The declared Content-Length was computed upfront, a file that changed in between would corrupt the body.
+    if (readError != nil || copiedLength != item.length) {
+        if (error != NULL) {
+            *error = readError ?: [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSURLErrorKey: item.fileURL}];
+        }
+        return NO;
+    }
+    return success;
 }
 
 @end
 
-@implementation ZMMultipartBodyItem
 
-- (instancetype)initWithData:(NSData *)data contentType:(NSString *)contentType headers:(NSDictionary *)headers;
+
+@implementation ZMMultipartPart
+
+- (instancetype)initWithContentType:(NSString *)contentType headers:(NSDictionary *)headers payloadRange:(NSRange)payloadRange
 {
     self = [super init];
     if (self) {
-        _data = [data copy];
         _contentType = [contentType copy];
         _headers = [headers copy];
+        _payloadRange = payloadRange;
     }
     return self;
 }
 
-- (instancetype)initWithMultipartData:(NSData *)data 
+@end
+
+
+
+@implementation ZMMultipartParser
+{
+    NSData *_data;
+    NSData *_delimiter;
+    NSUInteger _offset;
+    BOOL _finished;
+}
+
+- (instancetype)initWithData:(NSData *)data boundary:(NSString *)boundary
 {
     self = [super init];
     if (self) {
-        NSArray *dataLines = [self multipartDataLines:data];
-        
-        NSMutableDictionary *headers = [NSMutableDictionary new];
-        NSInteger contentLength = 0;
-        NSString *contentType;
-        
-        for (NSData *lineData in dataLines) {
-            NSString *line = [[NSString alloc] initWithData:lineData encoding:NSUTF8StringEncoding];
-            if ([self contentTypeFromLine:line contentType:&contentType] ||
-                [self contentLengthFromLine:line contentLength:&contentLength] ||
-                [self headersFromLine:line headers:&headers]) {
-                continue;
-            }
-        }
-        _contentType = contentType;
-        _headers = [headers copy];
-        _data = [self contentDataFromData:data contentLength:contentLength];
+        _data = data;
+        _delimiter = [[NSString stringWithFormat:@"--%@", boundary] dataUsingEncoding:NSUTF8StringEncoding];
     }
     return self;
 }
 
-static NSString *const ContentTypePrefix = @"Content-Type: ";
-
-- (BOOL)contentTypeFromLine:(NSString *)line contentType:(NSString **)contentType
+- (ZMMultipartPart *)nextPart
 {
-    if ([line hasPrefix:ContentTypePrefix]) {
-        *contentType = [line stringByReplacingCharactersInRange:NSMakeRange(0, ContentTypePrefix.length) withString:@""];
-        return YES;
+    if (_finished) {
+        return nil;
+    }
+
+    const uint8_t *bytes = _data.bytes;
+    NSUInteger length = _data.length;
+
+    NSUInteger delimiterLocation = ZMFindBytes(bytes, length, _offset, _delimiter.bytes, _delimiter.length);
+    NSUInteger partStart = delimiterLocation + _delimiter.length;
+    NSInteger contentLength = -1;
+    ZMMultipartPart *part;
+
+    if (delimiterLocation == NSNotFound ||
+        (partStart + 2 <= length && bytes[partStart] == '-' && bytes[partStart + 1] == '-') ||
+        (part = ZMMultipartPartWithHeaders(bytes, length, partStart, &contentLength)) == nil) {
+        _finished = YES;
+        return nil;
     }
-    return NO;
+
+    NSUInteger payloadStart = part.payloadRange.location;
+    NSUInteger declaredEnd = payloadStart + (NSUInteger)contentLength;
+
+    // Trust the declared length only if the next delimiter is exactly where it should be.
+    if (contentLength >= 0 &&
+        ZMHasNewLineAt(bytes, length, declaredEnd) &&
+        declaredEnd + 2 + _delimiter.length <= length &&
+        memcmp(bytes + declaredEnd + 2, _delimiter.bytes, _delimiter.length) == 0) {
+        part.payloadRange = NSMakeRange(payloadStart, (NSUInteger)contentLength);
+        _offset = declaredEnd + 2;
+        return part;
+    }
+
+    NSUInteger payloadEnd = ZMFindBytes(bytes, length, payloadStart, _delimiter.bytes, _delimiter.length);
+    if (payloadEnd == NSNotFound) {
+        payloadEnd = length;
+        _finished = YES;
+    }
+    _offset = payloadEnd;
+
+    if (payloadEnd >= payloadStart + 2 && ZMHasNewLineAt(bytes, length, payloadEnd - 2)) {
+        payloadEnd -= 2;
+    }
+    part.payloadRange = NSMakeRange(payloadStart, payloadEnd - payloadStart);
+    return part;
 }
 
-static NSString *const ContentLengthPrefix = @"Content-Length: ";
+- (NSData *)payloadOfPart:(ZMMultipartPart *)part
+{
+    return [_data subdataWithRange:part.payloadRange];
+}
+
+@end
 
-- (BOOL)contentLengthFromLine:(NSString *)line contentLength:(NSInteger *)contentLength
+
+
+@implementation ZMMultipartBodyItem
+
+@synthesize data = _data;
+
+- (instancetype)initWithData:(NSData *)data contentType:(NSString *)contentType headers:(NSDictionary *)headers;
 {
-    if ([line hasPrefix:ContentLengthPrefix]) {
-        NSScanner *scanner = [NSScanner scannerWithString:[line substringFromIndex:ContentLengthPrefix.length]];
-        [scanner scanInteger:contentLength];
-        return YES;
+    self = [super init];
+    if (self) {
+        _data = [data copy];
+        _contentType = [contentType copy];
+        _headers = [headers copy];
+        _length = data.length;
     }
-    return NO;
+    return self;
 }
 
-- (BOOL)headersFromLine:(NSString *)line headers:(NSMutableDictionary **)headers
+- (instancetype)initWithFileURL:(NSURL *)fileURL contentType:(NSString *)contentType headers:(NSDictionary *)headers
 {
-    if (line != nil) {
-        NSRange colonRange = [line rangeOfString:@": "];
-        if (colonRange.location != NSNotFound) {
-            NSString *key = [line substringToIndex:colonRange.location];
-            NSString *value = [line substringFromIndex:NSMaxRange(colonRange)];
-            if (key != nil && value != nil) {
-                [*headers setValue:value forKey:key];
-            }
-            return YES;
-        }
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:fileURL.path error:nil];
+    if (attributes == nil) {
+        return nil;
     }
-    return NO;
+
+    self = [super init];
+    if (self) {
+        _fileURL = [fileURL copy];
+        _contentType = [contentType copy];
+        _headers = [headers copy];
+        _length = attributes.fileSize;
+    }
+    return self;
 }
 
-- (NSData *)contentDataFromData:(NSData *)data contentLength:(NSInteger)contentLength
+- (instancetype)initWithPayload:(NSData *)payload part:(ZMMultipartPart *)part
 {
-    NSData *carriageReturn = [@"\r\n" dataUsingEncoding:NSUTF8StringEncoding];
-    NSData *contentData = [data subdataWithRange:NSMakeRange(data.length - carriageReturn.length - (NSUInteger)contentLength, (NSUInteger)contentLength)];
-    return contentData;
+    self = [super init];
+    if (self) {
+        _data = payload;
+        _contentType = part.contentType;
+        _headers = part.headers;
+        _length = payload.length;
+    }
+    return self;
 }
 
-- (NSArray *)multipartDataLines:(NSData *)data
+- (instancetype)initWithMultipartData:(NSData *)data
 {
-    NSMutableArray *dataLines = [[data lines] mutableCopy];
-    [dataLines removeLastObject]; //last line is redundant
-    return dataLines;
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSInteger contentLength = -1;
+    ZMMultipartPart *part = ZMMultipartPartWithHeaders(bytes, length, 0, &contentLength);
+
+    if (part == nil) {
+        return [self initWithPayload:[NSData data] part:[[ZMMultipartPart alloc] initWithContentType:nil headers:@{} payloadRange:NSMakeRange(0, 0)]];
+    }
+
+    // The payload is followed by a new line and nothing else.
+    NSUInteger payloadStart = part.payloadRange.location;
+    NSUInteger payloadEnd = (length >= 2 && ZMHasNewLineAt(bytes, length, length - 2)) ? length - 2 : length;
+    if (contentLength >= 0 && payloadStart + (NSUInteger)contentLength <= payloadEnd) {
+        payloadStart = payloadEnd - (NSUInteger)contentLength;
+    }
+    part.payloadRange = NSMakeRange(payloadStart, MAX(payloadEnd, payloadStart) - payloadStart);
+
+    return [self initWithPayload:[data subdataWithRange:part.payloadRange] part:part];
+}
+
+- (NSData *)data
+{
+    if (_fileURL != nil) {
+        return [NSData dataWithContentsOfURL:_fileURL options:NSDataReadingMappedIfSafe error:nil] ?: [NSData data];
+    }
+    return _data;
 }
 
 - (BOOL)isEqual:(id)object
@@ -278,9 +550,16 @@ static NSString *const ContentLengthPrefix = @"Content-Length: ";
     [description appendString:self.contentType];
     [description appendString:@"\n"];
     [description appendString:ContentLengthPrefix];
-    [description appendString:[NSString stringWithFormat:@"%lu", (unsigned long)self.data.length]];
+    [description appendString:[NSString stringWithFormat:@"%llu", self.length]];
     [description appendString:@"\n"];
-    
+
+    if (self.fileURL != nil) {
+        [description appendString:@"File: "];
+        [description appendString:self.fileURL.path];
+        [description appendString:@"\n"];
+        return [description copy];
+    }
+
     //try json
     NSError *jsonError;
     id jsonData = [NSJSONSerialization JSONObjectWithData:self.data options:NSJSONReadingAllowFragments error:&jsonError];
@@ -23,6 +23,7 @@
 #import "ZMTLogging.h"
 #import "ZMWebSocket.h"
 #import <WireTransport/WireTransport-Swift.h>
+#import <stdatomic.h>
 
 NSInteger const ZMTransportRequestSchedulerRequestCountUnlimited = NSIntegerMax;
 /// C.f. <https://en.wikipedia.org/wiki/List_of_HTTP_status_codes>
@@ -32,13 +33,13 @@ static NSString* ZMLogTag ZM_UNUSED = ZMT_LOG_TAG_NETWORK_LOW_LEVEL;
 
 @interface ZMTransportRequestScheduler () <ZMTimerClient>
 {
-    NSInteger _concurrentRequestCountLimit;
+    /// Read on every request the transport session considers starting, hence lock-free.
+    _Atomic(NSInteger) _concurrentRequestCountLimit;
 }
 
 @property (nonatomic, readonly) ZMExponentialBackoff *backoff;
 @property (nonatomic, readonly, weak) id<ZMTransportRequestSchedulerSession> session;
 @property (nonatomic, readonly) NSOperationQueue *workQueue;
-@property (nonatomic, readonly) dispatch_queue_t countIsolation;
 @property (nonatomic, readonly) NSMutableArray *backoffItemQueue;
 @property (nonatomic, readwrite) id<ReachabilityProvider> reachability;
 @property (nonatomic) BOOL needsTearDown;
@@ -83,7 +84,6 @@ ZM_EMPTY_ASSERTING_INIT();
         _session = session;
         _workQueue = queue;
         _group = group;
-        _countIsolation = dispatch_queue_create("ZMTransportRequestScheduler.isolation", DISPATCH_QUEUE_CONCURRENT);
         _pendingRequestsRequiringAuthentication = [NSMutableArray array];
     }
     return self;
@@ -196,11 +196,7 @@ ZM_EMPTY_ASSERTING_INIT();
 
 - (NSInteger)concurrentRequestCountLimit;
 {
-    __block NSInteger result;
-    dispatch_sync(self.countIsolation, ^{
-        result = self->_concurrentRequestCountLimit;
-    });
-    return result;
+    return atomic_load_explicit(&_concurrentRequestCountLimit, memory_order_acquire);
 }
 
 - (void)setConcurrentRequestCountLimit:(NSInteger)concurrentRequestCountLimit;
@@ -208,26 +204,25 @@ ZM_EMPTY_ASSERTING_INIT();
     if (concurrentRequestCountLimit < 0) {
         concurrentRequestCountLimit = 0;
     }
+    NSInteger const previousLimit = atomic_exchange_explicit(&_concurrentRequestCountLimit, concurrentRequestCountLimit, memory_order_acq_rel);
+    BOOL const didIncrease = (previousLimit < concurrentRequestCountLimit);
+    
     id<ZMTransportRequestSchedulerSession> session = self.session;
     [self.group enter];
-    dispatch_barrier_async(self.countIsolation, ^{
-        BOOL const didIncrease = (self->_concurrentRequestCountLimit < concurrentRequestCountLimit);
-        self->_concurrentRequestCountLimit = concurrentRequestCountLimit;
-        [self.workQueue addOperationWithBlock:^{
-            if (didIncrease) {
-                [session schedulerIncreasedMaximumNumberOfConcurrentRequests:self];
-            } else if (concurrentRequestCountLimit < (NSInteger) self.pendingRequestsRequiringAuthentication.count) {
-                NSUInteger const c = (NSUInteger) concurrentRequestCountLimit;
-                NSRange const r = NSMakeRange(c, self.pendingRequestsRequiringAuthentication.count - c);
-                NSArray *itemsToCancel = [self.pendingRequestsRequiringAuthentication subarrayWithRange:r];
-                [self.pendingRequestsRequiringAuthentication removeObjectsInRange:r];
-                for (id<ZMTransportRequestSchedulerItem> i in itemsToCancel) {
-                    [session temporarilyRejectSchedulerItem:i];
-                }
+    [self.workQueue addOperationWithBlock:^{
+        if (didIncrease) {
+            [session schedulerIncreasedMaximumNumberOfConcurrentRequests:self];
+        } else if (concurrentRequestCountLimit < (NSInteger) self.pendingRequestsRequiringAuthentication.count) {
+            NSUInteger const c = (NSUInteger) concurrentRequestCountLimit;
+            NSRange const r = NSMakeRange(c, self.pendingRequestsRequiringAuthentication.count - c);
+            NSArray *itemsToCancel = [self.pendingRequestsRequiringAuthentication subarrayWithRange:r];
+            [self.pendingRequestsRequiringAuthentication removeObjectsInRange:r];
+            for (id<ZMTransportRequestSchedulerItem> i in itemsToCancel) {
+                [session temporarilyRejectSchedulerItem:i];
             }
-            [self.group leave];
-        }];
-    });
+        }
+        [self.group leave];
+    }];
 }
 
 - (void)addItem:(id<ZMTransportRequestSchedulerItem>)item;
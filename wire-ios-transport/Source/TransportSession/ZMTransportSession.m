@@ -81,6 +81,9 @@ static NSInteger const DefaultMaximumRequests = 6;
 @property (nonatomic, readwrite) id<ReachabilityProvider, TearDownCapable> reachability;
 @property (nonatomic) id reachabilityObserverToken;
 @property (nonatomic) ZMAtomicInteger *numberOfRequestsInProgress;
+@property (nonatomic) ZMAdaptiveConcurrencyLimit *adaptiveConcurrencyLimit;
+/// Time to the first response byte of tasks whose metrics arrived but which did not complete yet
+@property (nonatomic) NSMapTable<NSURLSessionTask *, NSNumber *> *responseLatencyByTask;
 
 @property (nonatomic) NSString *minTLSVersion;
 
@@ -211,6 +214,8 @@ static NSInteger const DefaultMaximumRequests = 6;
             [self schedulerWentOffline:self.requestScheduler];
         }
         
+        self.adaptiveConcurrencyLimit = [[ZMAdaptiveConcurrencyLimit alloc] initWithMaximumLimit:DefaultMaximumRequests];
+        self.responseLatencyByTask = [NSMapTable weakToStrongObjectsMapTable];
         self.maximumConcurrentRequests = DefaultMaximumRequests;
         self.minTLSVersion = minTLSVersion;
 
@@ -325,7 +330,7 @@ static NSInteger const DefaultMaximumRequests = 6;
     }
     self.firstRequestFired = YES;
     
-    NSInteger const limit = MIN(self.maximumConcurrentRequests, self.requestScheduler.concurrentRequestCountLimit);
+    NSInteger const limit = self.concurrentRequestCountLimit;
     NSInteger const newCount = [self.numberOfRequestsInProgress increment];
     if (limit < newCount) {
         ZMLogInfo(@"Reached limit of %ld concurrent requests. Not enqueueing.", (long)limit);
@@ -493,9 +498,23 @@ static NSInteger const DefaultMaximumRequests = 6;
 }
 
 
+- (void)setMaximumConcurrentRequests:(NSInteger)maximumConcurrentRequests
+{
+    _maximumConcurrentRequests = maximumConcurrentRequests;
+    self.adaptiveConcurrencyLimit.maximumLimit = maximumConcurrentRequests;
+}
+
+/// The number of requests that may be in progress at the same time. This is read
+/// for every request we consider starting and must not block.
+- (NSInteger)concurrentRequestCountLimit
+{
+    NSInteger const adaptiveLimit = self.adaptiveConcurrencyLimit.limit;
+    return MIN(adaptiveLimit, MIN(self.maximumConcurrentRequests, self.requestScheduler.concurrentRequestCountLimit));
+}
+
 - (void)decrementNumberOfRequestsInProgressAndNotifyOperationLoop:(BOOL)notify
 {
-    NSInteger const limit = MIN(self.maximumConcurrentRequests, self.requestScheduler.concurrentRequestCountLimit);
+    NSInteger const limit = self.concurrentRequestCountLimit;
     if ([self.numberOfRequestsInProgress decrement] < limit) {
         if (notify) {
             [ZMTransportSession notifyNewRequestsAvailable:self];
@@ -693,6 +712,10 @@ static NSInteger const DefaultMaximumRequests = 6;
     NSError *error = task.error;
     NSHTTPURLResponse *HTTPResponse = (id)task.response;
     [self processCookieResponse:HTTPResponse];
+    // The time until the response started excludes the transfer of large bodies, which isn't a sign of queueing.
+    NSTimeInterval const responseLatency = [self.responseLatencyByTask objectForKey:task].doubleValue;
+    [self.responseLatencyByTask removeObjectForKey:task];
+    [self.adaptiveConcurrencyLimit recordResponseWithStatusCode:HTTPResponse.statusCode error:error roundTripTime:responseLatency];
 
     BOOL didConsume = [self.accessTokenHandler consumeRequestWithTask:task data:data session:URLSession shouldRetry:self.requestScheduler.canSendRequests apiVersion:request.apiVersion];
     if (!didConsume) {
@@ -703,6 +726,15 @@ static NSInteger const DefaultMaximumRequests = 6;
     [self.expiredTasks removeObject:task];
 }
 
+- (void)URLSession:(ZMURLSession *)URLSession task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics
+{
+    NOT_USED(URLSession);
+    NSTimeInterval const responseLatency = [ZMAdaptiveConcurrencyLimit responseLatencyFromMetrics:metrics];
+    if (responseLatency > 0) {
+        [self.responseLatencyByTask setObject:@(responseLatency) forKey:task];
+    }
+}
+
 - (void)URLSessionDidFinishEventsForBackgroundURLSession:(ZMURLSession *)URLSession
 {
     NSString *identifier = URLSession.configuration.identifier;
@@ -737,6 +769,7 @@ static NSInteger const DefaultMaximumRequests = 6;
 - (void)reachabilityDidChange:(id<ReachabilityProvider, TearDownCapable>)reachability;
 {
     ZMLogInfo(@"reachabilityDidChange -> mayBeReachable = %@", reachability.mayBeReachable ? @"YES" : @"NO");
+    [self.adaptiveConcurrencyLimit reset];
     [self.requestScheduler reachabilityDidChange:reachability];
     [self.transportPushChannel reachabilityDidChange:reachability];
 
@@ -20,22 +20,43 @@ import Foundation
 
 /// Monitors the REST requests that are sent over the network
 /// to detect suspicious request loops
+///
+/// Requests are counted in a ring of time buckets that together span
+/// `decayTimer`. Each bucket keeps hashed counters per request identifier,
+/// and a running total per identifier is kept across the whole window, so
+/// recording, decaying and checking the threshold are all O(1) (amortized).
 @objcMembers
 public final class RequestLoopDetection: NSObject {
 
     /// After this time, requests are purged from the list
     static let decayTimer: TimeInterval = 60 // 1 minute
 
+    /// Width of a single time bucket. Requests decay with this granularity.
+    static let bucketWidth: TimeInterval = 1
+
+    /// Number of buckets needed to cover `decayTimer`
+    static let bucketCount = Int((decayTimer / bucketWidth).rounded(.up))
+
     /// Repetition warning trigger threshold
     /// If a request is repeated more than this number of times,
     /// it will trigger a warning
     static let repetitionTriggerThreshold = 20
 
-    /// Hard limit of URLs to keep in the history
-    static let historyLimit = 120
+    /// Hard limit of requests to keep in the history. When exceeded,
+    /// the oldest bucket is dropped as a whole.
+    static let historyLimit = 10000
+
+    /// Ring of time buckets, indexed by `bucketIndex % bucketCount`
+    private var buckets: [Bucket]
+
+    /// Number of requests per identifier across all live buckets
+    private var totalCounts: [RequestIdentifier: Int] = [:]
 
-    /// List of requests
-    private(set) var recordedRequests: [IdentifierDate] = []
+    /// Number of requests across all live buckets
+    private(set) var recordedRequestCount = 0
+
+    /// Index of the most recent bucket that was rotated in
+    private var newestBucketIndex: Int?
 
     /// Trigger that will be invoked when a loop is detected
     /// The URL passed is the URL that created the loop
@@ -43,75 +64,155 @@ public final class RequestLoopDetection: NSObject {
 
     public init(triggerCallback: @escaping (String) -> Void) {
         self.triggerCallback = triggerCallback
+        self.buckets = Array(repeating: Bucket(), count: Self.bucketCount)
+    }
+
+    /// Recorded requests, oldest first. Each request is reported with the
+    /// start date of the bucket it was counted in.
+    /// - note: Complexity: O(n), meant for inspection only
+    var recordedRequests: [IdentifierDate] {
+        guard let newestBucketIndex else { return [] }
+
+        return ((newestBucketIndex - Self.bucketCount + 1)...newestBucketIndex).flatMap { index -> [IdentifierDate] in
+            let bucket = buckets[slot(for: index)]
+            guard bucket.index == index else { return [] }
+            let date = Date(timeIntervalSinceReferenceDate: TimeInterval(index) * Self.bucketWidth)
+            return bucket.counts.flatMap { identifier, count in
+                Array(
+                    repeating: IdentifierDate(path: identifier.path, contentHint: identifier.contentHint, date: date),
+                    count: count
+                )
+            }
+        }
     }
 
     // MARK: - Loop detection
 
     /// Resets the detector, discarding all recorder requests
     public func reset() {
-        self.recordedRequests = []
+        buckets = Array(repeating: Bucket(), count: Self.bucketCount)
+        totalCounts = [:]
+        recordedRequestCount = 0
+        newestBucketIndex = nil
     }
 
     public func recordRequest(path: String, contentHint: String, date: Date?) {
-        purgeOldRequests()
-
-        if self.recordedRequests.count == Self.historyLimit {
-            self.recordedRequests.remove(at: 0) // note, this would be more efficient with linked list
-        }
+        let now = Date()
+        purgeOldRequests(now: now)
 
         if isPathExcluded(path) {
             return
         }
 
-        let identifier = IdentifierDate(path: path, contentHint: contentHint, date: date ?? Date())
-        self.insert(identifier: identifier)
+        let date = date ?? now
+        if date.timeIntervalSince(now) <= -Self.decayTimer {
+            return // not even adding, this is too old
+        }
+
+        if recordedRequestCount >= Self.historyLimit {
+            dropOldestBucket()
+        }
+
+        // requests from the future are counted as if they happened now
+        let nowIndex = bucketIndex(for: now)
+        let index = min(bucketIndex(for: date), nowIndex)
+        if index <= nowIndex - Self.bucketCount {
+            return // falls in a bucket that already decayed
+        }
+
+        let identifier = RequestIdentifier(path: path, contentHint: contentHint)
+        insert(identifier: identifier, bucketIndex: index)
 
         triggerIfTooMany(identifier: identifier)
     }
 
-    /// Removes requests that are too old from the recorded requests
-    private func purgeOldRequests() {
-        let purgeDate = Date(timeIntervalSinceNow: -Self.decayTimer)
-        if let firstNonTooOldIndex = self.recordedRequests.firstIndex(where: {
-            $0.date > purgeDate
-        }) {
-            self.recordedRequests.removeFirst(firstNonTooOldIndex) // note, this would be more efficient with linked list
-        } else {
+    /// Rotates the ring up to `now`, removing requests that are too old
+    /// - note: Complexity: amortized O(1) per recorded request, each
+    /// bucket is cleared at most once per rotation
+    private func purgeOldRequests(now: Date) {
+        let nowIndex = bucketIndex(for: now)
+
+        guard let newestBucketIndex else {
+            self.newestBucketIndex = nowIndex
+            return
+        }
+
+        guard nowIndex > newestBucketIndex else {
+            return
+        }
+
+        if nowIndex - newestBucketIndex >= Self.bucketCount {
             // all requests are old, kill them
             reset()
+        } else {
+            for index in (newestBucketIndex + 1)...nowIndex {
+                clearBucket(at: slot(for: index))
+            }
         }
+        self.newestBucketIndex = nowIndex
     }
 
-    /// Insert request in the right date order in the array.
-    /// - note: Complexity: O(n). Could be made O(log(n)) with
-    /// binary search
-    private func insert(identifier: IdentifierDate) {
-        if identifier.date.timeIntervalSinceNow < -type(of: self).decayTimer {
-            return // not even adding, this is too old
+    private func insert(identifier: RequestIdentifier, bucketIndex index: Int) {
+        let slot = slot(for: index)
+        if buckets[slot].index != index {
+            clearBucket(at: slot)
+            buckets[slot].index = index
         }
 
-        // I assume most (if not all) request are inserted in ascending order, so I will
-        // search backwards
-        var insertionIndex = 0
-        for i in (0..<recordedRequests.count).lazy.reversed() where recordedRequests[i].date < identifier.date {
-            insertionIndex = i + 1
-            break
-        }
-        self.recordedRequests.insert(identifier, at: insertionIndex)
+        buckets[slot].counts[identifier, default: 0] += 1
+        buckets[slot].total += 1
+        totalCounts[identifier, default: 0] += 1
+        recordedRequestCount += 1
     }
 
     /// Check if there are too many occurrences of a given identifier
-    private func triggerIfTooMany(identifier: IdentifierDate) {
-        // this could be slightly faster as we don't need to count, just stop after we found N
-        // (maybe there are N+1000 entries and we don't need to go through the additional 1000)
-        let count = recordedRequests
-            .filter { $0.identifier == identifier.identifier }
-            .count
+    private func triggerIfTooMany(identifier: RequestIdentifier) {
+        guard let count = totalCounts[identifier], count >= Self.repetitionTriggerThreshold else {
+            return
+        }
+
+        triggerCallback(identifier.path)
+
+        // forget about this identifier, so that we only trigger again
+        // once it has been repeated another `repetitionTriggerThreshold` times
+        totalCounts[identifier] = nil
+        recordedRequestCount -= count
+        for slot in buckets.indices {
+            if let removed = buckets[slot].counts.removeValue(forKey: identifier) {
+                buckets[slot].total -= removed
+            }
+        }
+    }
+
+    /// Drops the oldest non-empty bucket to keep the history within `historyLimit`
+    private func dropOldestBucket() {
+        guard let newestBucketIndex else { return }
 
-        if count >= Self.repetitionTriggerThreshold {
-            triggerCallback(identifier.path)
-            recordedRequests = recordedRequests.filter { $0.identifier != identifier.identifier }
+        for index in (newestBucketIndex - Self.bucketCount + 1)...newestBucketIndex {
+            let slot = slot(for: index)
+            if buckets[slot].index == index, buckets[slot].total > 0 {
+                clearBucket(at: slot)
+                return
+            }
+        }
+    }
+
+    private func clearBucket(at slot: Int) {
+        for (identifier, count) in buckets[slot].counts {
+            let remaining = (totalCounts[identifier] ?? 0) - count
+            totalCounts[identifier] = remaining > 0 ? remaining : nil
         }
+        recordedRequestCount -= buckets[slot].total
+        buckets[slot] = Bucket()
+    }
+
+    private func bucketIndex(for date: Date) -> Int {
+        Int((date.timeIntervalSinceReferenceDate / Self.bucketWidth).rounded(.down))
+    }
+
+    private func slot(for bucketIndex: Int) -> Int {
+        let slot = bucketIndex % Self.bucketCount
+        return slot < 0 ? slot + Self.bucketCount : slot
     }
 
     func isPathExcluded(_ path: String) -> Bool {
@@ -135,6 +236,19 @@ public final class RequestLoopDetection: NSObject {
 
 // MARK: -
 
+/// Identifies a request for the purpose of loop detection
+struct RequestIdentifier: Hashable {
+    let path: String
+    let contentHint: String
+}
+
+/// Requests counted within a single time slice
+private struct Bucket {
+    var index = Int.min
+    var counts: [RequestIdentifier: Int] = [:]
+    var total = 0
+}
+
 struct IdentifierDate {
     let identifier: String
     let date: Date
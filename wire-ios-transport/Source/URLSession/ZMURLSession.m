@@ -433,10 +433,14 @@ totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics
 {
     NOT_USED(session);
-    NOT_USED(task);
     if (nil != metrics.transactionMetrics.firstObject) {
         ZMLogInfo(@"Reused connection: %d", metrics.transactionMetrics.firstObject.reusedConnection);
     }
+
+    NSObject<ZMURLSessionDelegate> *delegate = (id) self.delegate;
+    if ([delegate respondsToSelector:@selector(URLSession:task:didFinishCollectingMetrics:)]) {
+        [delegate URLSession:self task:task didFinishCollectingMetrics:metrics];
+    }
 }
 
 - (BOOL)completeRestartedRequestIfNeeded:(ZMTransportRequest *)request
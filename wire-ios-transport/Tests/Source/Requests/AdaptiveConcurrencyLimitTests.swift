@@ -0,0 +1,245 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+import XCTest
+
+@testable import WireTransport
+
+final class AdaptiveConcurrencyLimitTests: XCTestCase {
+
+    private var currentDate: Date!
+    private var sut: AdaptiveConcurrencyLimit!
+
+    override func setUp() {
+        super.setUp()
+        currentDate = Date(timeIntervalSinceReferenceDate: 0)
+        sut = makeSUT(maximumLimit: 16)
+    }
+
+    override func tearDown() {
+        sut = nil
+        currentDate = nil
+        super.tearDown()
+    }
+
+    private func makeSUT(maximumLimit: Int) -> AdaptiveConcurrencyLimit {
+        AdaptiveConcurrencyLimit(
+            maximumLimit: maximumLimit,
+            configuration: .init(),
+            currentDate: { [unowned self] in currentDate }
+        )
+    }
+
+    // MARK: - Single responses
+
+    func testThatItStartsAtTheMaximumLimit() {
+        XCTAssertEqual(sut.limit, 16)
+    }
+
+    func testThatItHalvesTheLimitWhenRateLimited() {
+        // when
+        sut.recordResponse(statusCode: TooManyRequestsStatusCode, error: nil, roundTripTime: 0.1)
+
+        // then
+        XCTAssertEqual(sut.limit, 8)
+    }
+
+    func testThatItHalvesTheLimitOnServerErrors() {
+        // when
+        sut.recordResponse(statusCode: 503, error: nil, roundTripTime: 0.1)
+
+        // then
+        XCTAssertEqual(sut.limit, 8)
+    }
+
+    func testThatItHalvesTheLimitOnTimeouts() {
+        // when
+        sut.recordResponse(
+            statusCode: 0,
+            error: NSError(domain: NSURLErrorDomain, code: NSURLErrorTimedOut),
+            roundTripTime: 60
+        )
+
+        // then
+        XCTAssertEqual(sut.limit, 8)
+    }
+
+    func testThatItIgnoresConnectivityErrors() {
+        // when
+        sut.recordResponse(
+            statusCode: 0,
+            error: NSError(domain: NSURLErrorDomain, code: NSURLErrorNotConnectedToInternet),
+            roundTripTime: 0
+        )
+
+        // then
+        XCTAssertEqual(sut.limit, 16)
+    }
+
+    func testThatItOnlyDecreasesOncePerRoundTrip() {
+        // given
+        sut.recordResponse(statusCode: 200, error: nil, roundTripTime: 1)
+
+        // when
+        sut.recordResponse(statusCode: 429, error: nil, roundTripTime: 1)
+        currentDate.addTimeInterval(0.5)
+        sut.recordResponse(statusCode: 429, error: nil, roundTripTime: 1)
+
+        // then
+        XCTAssertEqual(sut.limit, 8)
+
+        // when
+        currentDate.addTimeInterval(0.5)
+        sut.recordResponse(statusCode: 429, error: nil, roundTripTime: 1)
+
+        // then
+        XCTAssertEqual(sut.limit, 4)
+    }
+
+    func testThatItNeverGoesBelowOne() {
+        // when
+        (0..<10).forEach { _ in
+            sut.recordResponse(statusCode: 429, error: nil, roundTripTime: 0)
+        }
+
+        // then
+        XCTAssertEqual(sut.limit, 1)
+    }
+
+    func testThatItIncreasesAdditivelyOnSuccess() {
+        // given
+        sut.recordResponse(statusCode: 429, error: nil, roundTripTime: 0)
+        XCTAssertEqual(sut.limit, 8)
+
+        // when
+        (0..<10).forEach { _ in
+            sut.recordResponse(statusCode: 200, error: nil, roundTripTime: 0.1)
+        }
+
+        // then
+        XCTAssertEqual(sut.limit, 9)
+    }
+
+    func testThatItDecreasesWhenTheRoundTripTimeShowsQueueing() {
+        // given
+        sut.recordResponse(statusCode: 200, error: nil, roundTripTime: 0.1)
+
+        // when
+        sut.recordResponse(statusCode: 200, error: nil, roundTripTime: 0.5)
+
+        // then
+        XCTAssertEqual(sut.limit, 14)
+    }
+
+    func testThatAResponseWithoutLatencyDoesNotCountAsQueueing() {
+        // given
+        sut.recordResponse(statusCode: 200, error: nil, roundTripTime: 0.1)
+
+        // when
+        sut.recordResponse(statusCode: 200, error: nil, roundTripTime: 0)
+
+        // then
+        XCTAssertEqual(sut.limit, 16)
+    }
+
+    func testThatSettingTheMaximumLimitStartsOver() {
+        // given
+        sut.recordResponse(statusCode: 429, error: nil, roundTripTime: 0)
+
+        // when
+        sut.maximumLimit = 4
+
+        // then
+        XCTAssertEqual(sut.limit, 4)
+    }
+
+    // MARK: - Simulation
+
+    /// A backend that serves `capacity` requests in parallel within `baseRoundTripTime`.
+    /// Requests beyond the capacity queue up, requests beyond three times the capacity
+    /// are rate limited. Time only advances when the simulation says so.
+    private struct SimulatedBackend {
+        let capacity: Int
+        let baseRoundTripTime: TimeInterval
+
+        func response(concurrentRequests: Int) -> (statusCode: Int, roundTripTime: TimeInterval) {
+            if concurrentRequests > 3 * capacity {
+                return (TooManyRequestsStatusCode, baseRoundTripTime)
+            }
+            let queueing = max(1, Double(concurrentRequests) / Double(capacity))
+            return (200, baseRoundTripTime * queueing)
+        }
+    }
+
+    /// Sends rounds of `limit` concurrent requests and feeds the responses back into the sut
+    private func simulate(backend: SimulatedBackend, rounds: Int) -> [Int] {
+        var limits: [Int] = []
+        for _ in 0..<rounds {
+            let concurrentRequests = sut.limit
+            let response = backend.response(concurrentRequests: concurrentRequests)
+            currentDate.addTimeInterval(response.roundTripTime)
+            (0..<concurrentRequests).forEach { _ in
+                sut.recordResponse(statusCode: response.statusCode, error: nil, roundTripTime: response.roundTripTime)
+            }
+            limits.append(sut.limit)
+        }
+        return limits
+    }
+
+    func testThatItConvergesToTheCapacityOfTheBackend() {
+        // given
+        sut = makeSUT(maximumLimit: 64)
+        let backend = SimulatedBackend(capacity: 8, baseRoundTripTime: 0.2)
+        sut.recordResponse(statusCode: 200, error: nil, roundTripTime: backend.baseRoundTripTime)
+
+        // when
+        let limits = simulate(backend: backend, rounds: 100)
+
+        // then
+        let steadyState = limits.suffix(50)
+        XCTAssertLessThanOrEqual(steadyState.max()!, 3 * backend.capacity, "should not be rate limited")
+        XCTAssertGreaterThanOrEqual(steadyState.min()!, backend.capacity, "should use the available capacity")
+    }
+
+    func testThatItRecoversAfterTheBackendCapacityIncreases() {
+        // given
+        sut = makeSUT(maximumLimit: 32)
+        _ = simulate(backend: SimulatedBackend(capacity: 2, baseRoundTripTime: 0.2), rounds: 50)
+        XCTAssertLessThanOrEqual(sut.limit, 6)
+
+        // when
+        let limits = simulate(backend: SimulatedBackend(capacity: 16, baseRoundTripTime: 0.2), rounds: 300)
+
+        // then
+        XCTAssertGreaterThanOrEqual(limits.last!, 16)
+    }
+
+    func testThatTheSimulationIsDeterministic() {
+        // given
+        let backend = SimulatedBackend(capacity: 5, baseRoundTripTime: 0.1)
+
+        // when
+        let first = simulate(backend: backend, rounds: 100)
+        currentDate = Date(timeIntervalSinceReferenceDate: 0)
+        sut = makeSUT(maximumLimit: 16)
+        let second = simulate(backend: backend, rounds: 100)
+
+        // then
+        XCTAssertEqual(first, second)
+    }
+}
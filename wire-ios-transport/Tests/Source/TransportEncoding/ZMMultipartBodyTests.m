@@ -0,0 +1,341 @@
+//
+// Wire
+// Copyright (C) 2024 Wire Swiss GmbH
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see http://www.gnu.org/licenses/.
+//
+
+
+@import XCTest;
+@import WireTransport;
+
+static NSString *const Boundary = @"frontier";
+
+@interface ZMMultipartBodyTests : XCTestCase
+
+@property (nonatomic) NSURL *directoryURL;
+
+@end
+
+@implementation ZMMultipartBodyTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [[NSFileManager defaultManager] createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:nil];
+    self.directoryURL = nil;
+    [super tearDown];
+}
+
+- (NSURL *)fileURLWithData:(NSData *)data
+{
+    NSURL *url = [self.directoryURL URLByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [data writeToURL:url atomically:YES];
+    return url;
+}
+
+- (NSURL *)fileURLWithLength:(unsigned long long)length
+{
+    NSURL *url = [self fileURLWithData:[NSData data]];
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:url error:nil];
+    [fileHandle truncateFileAtOffset:length];
+    [fileHandle closeFile];
+    return url;
+}
+
+- (NSArray<ZMMultipartBodyItem *> *)itemsWithPayload:(NSData *)payload
+{
+    NSData *metadata = [@"{\"public\":true}" dataUsingEncoding:NSUTF8StringEncoding];
+    return @[
+             [[ZMMultipartBodyItem alloc] initWithData:metadata contentType:@"application/json" headers:nil],
+             [[ZMMultipartBodyItem alloc] initWithData:payload contentType:@"application/octet-stream" headers:@{@"Content-MD5": @"abc"}]
+             ];
+}
+
+#pragma mark - Encoding
+
+- (void)testThatContentLengthMatchesTheEncodedData
+{
+    // given
+    ZMMultipartBody *sut = [[ZMMultipartBody alloc] initWithItems:[self itemsWithPayload:[NSData dataWithBytes:"12345" length:5]] boundary:Boundary];
+
+    // when
+    NSData *data = [sut encodedDataWithError:nil];
+
+    // then
+    XCTAssertEqual(data.length, sut.contentLength);
+}
+
+- (void)testThatItEncodesTheSameDataAsBefore
+{
+    // given
+    ZMMultipartBodyItem *item = [[ZMMultipartBodyItem alloc] initWithData:[NSData dataWithBytes:"1" length:1] contentType:@"text" headers:@{@"key": @"value"}];
+    NSString *expected = @"--frontier\r\nContent-Type: text\r\nContent-Length: 1\r\nkey: value\r\n\r\n1\r\n--frontier--\r\n";
+
+    // when
+    NSData *data = [NSData multipartDataWithItems:@[item] boundary:Boundary];
+
+    // then
+    XCTAssertEqualObjects([[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding], expected);
+}
+
+- (void)testThatAFileBackedItemIsEncodedLikeADataItem
+{
+    // given
+    NSData *payload = [NSData dataWithBytes:"file payload" length:12];
+    ZMMultipartBodyItem *dataItem = [[ZMMultipartBodyItem alloc] initWithData:payload contentType:@"text" headers:nil];
+    ZMMultipartBodyItem *fileItem = [[ZMMultipartBodyItem alloc] initWithFileURL:[self fileURLWithData:payload] contentType:@"text" headers:nil];
+
+    // when
+    NSData *dataBody = [[[ZMMultipartBody alloc] initWithItems:@[dataItem] boundary:Boundary] encodedDataWithError:nil];
+    NSData *fileBody = [[[ZMMultipartBody alloc] initWithItems:@[fileItem] boundary:Boundary] encodedDataWithError:nil];
+
+    // then
+    XCTAssertEqual(fileItem.length, payload.length);
+    XCTAssertEqualObjects(fileItem.data, payload);
+    XCTAssertEqualObjects(fileBody, dataBody);
+}
+
+- (void)testThatItDoesNotCreateAnItemForAMissingFile
+{
+    // given
+    NSURL *url = [self.directoryURL URLByAppendingPathComponent:@"missing"];
+
+    // then
+    XCTAssertNil([[ZMMultipartBodyItem alloc] initWithFileURL:url contentType:@"text" headers:nil]);
+}
+
+- (void)testThatItWritesTheEncodedDataToAFile
+{
+    // given
+    NSData *payload = [NSData dataWithBytes:"payload" length:7];
+    ZMMultipartBody *sut = [[ZMMultipartBody alloc] initWithItems:[self itemsWithPayload:payload] boundary:Boundary];
+    NSURL *url = [self.directoryURL URLByAppendingPathComponent:@"body"];
+
+    // when
+    NSError *error;
+    BOOL success = [sut writeToURL:url error:&error];
+
+    // then
+    XCTAssertTrue(success);
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:url], [sut encodedDataWithError:nil]);
+}
+
+- (void)testThatWritingFailsWhenAFileChangedAfterCreatingTheItem
+{
+    // given
+    NSURL *fileURL = [self fileURLWithData:[NSData dataWithBytes:"1234" length:4]];
+    ZMMultipartBodyItem *item = [[ZMMultipartBodyItem alloc] initWithFileURL:fileURL contentType:@"text" headers:nil];
+    ZMMultipartBody *sut = [[ZMMultipartBody alloc] initWithItems:@[item] boundary:Boundary];
+    [[NSData dataWithBytes:"12" length:2] writeToURL:fileURL atomically:YES];
+
+    // when
+    NSError *error;
+    BOOL success = [sut writeToURL:[self.directoryURL URLByAppendingPathComponent:@"body"] error:&error];
+
+    // then
+    XCTAssertFalse(success);
+    XCTAssertNotNil(error);
+}
+
+- (void)testThatEncodingFailsWhenAFileChangedAfterCreatingTheItem
+{
+    // given
+    NSURL *fileURL = [self fileURLWithData:[NSData dataWithBytes:"1234" length:4]];
+    ZMMultipartBodyItem *item = [[ZMMultipartBodyItem alloc] initWithFileURL:fileURL contentType:@"text" headers:nil];
+    ZMMultipartBody *sut = [[ZMMultipartBody alloc] initWithItems:@[item] boundary:Boundary];
+    [[NSData dataWithBytes:"12" length:2] writeToURL:fileURL atomically:YES];
+
+    // when
+    NSError *error;
+    NSData *data = [sut encodedDataWithError:&error];
+
+    // then
+    XCTAssertNil(data);
+    XCTAssertNotNil(error);
+    XCTAssertNil([NSData multipartDataWithItems:@[item] boundary:Boundary]);
+}
+
+#pragma mark - Performance
+
+- (void)measureWritingFileBackedBodyOfLength:(unsigned long long)length
+{
+    // given
+    ZMMultipartBodyItem *item = [[ZMMultipartBodyItem alloc] initWithFileURL:[self fileURLWithLength:length] contentType:@"application/octet-stream" headers:nil];
+    ZMMultipartBody *sut = [[ZMMultipartBody alloc] initWithItems:@[item] boundary:Boundary];
+    NSURL *url = [self.directoryURL URLByAppendingPathComponent:@"body"];
+
+    // then
+    [self measureWithMetrics:@[[XCTClockMetric new], [XCTMemoryMetric new]] block:^{
+        XCTAssertTrue([sut writeToURL:url error:nil]);
+    }];
+}
+
+- (void)measureEncodingInMemoryBodyOfLength:(NSUInteger)length
+{
+    // given
+    NSData *payload = [NSMutableData dataWithLength:length];
+    NSArray *items = [self itemsWithPayload:payload];
+
+    // then
+    [self measureWithMetrics:@[[XCTClockMetric new], [XCTMemoryMetric new]] block:^{
+        NSData *data = [NSData multipartDataWithItems:items boundary:Boundary];
+        XCTAssertGreaterThan(data.length, length);
+    }];
+}
+
+- (void)testPerformanceOfWritingAFileBackedBody_1MB
+{
+    [self measureWritingFileBackedBodyOfLength:1024 * 1024];
+}
+
+- (void)testPerformanceOfWritingAFileBackedBody_100MB
+{
+    [self measureWritingFileBackedBodyOfLength:100 * 1024 * 1024];
+}
+
+- (void)testPerformanceOfWritingAFileBackedBody_500MB
+{
+    [self measureWritingFileBackedBodyOfLength:500 * 1024 * 1024];
+}
+
+- (void)testPerformanceOfEncodingAnInMemoryBody_1MB
+{
+    [self measureEncodingInMemoryBodyOfLength:1024 * 1024];
+}
+
+- (void)testPerformanceOfEncodingAnInMemoryBody_100MB
+{
+    [self measureEncodingInMemoryBodyOfLength:100 * 1024 * 1024];
+}
+
+@end
+
+
+
+@interface ZMMultipartParserTests : XCTestCase
+
+@end
+
+@implementation ZMMultipartParserTests
+
+- (NSData *)dataWithString:(NSString *)string
+{
+    return [string dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (void)testThatItReturnsThePartsOfABody
+{
+    // given
+    NSData *body = [self dataWithString:@"--frontier\r\nContent-Type: application/json\r\nContent-Length: 2\r\n\r\n{}\r\n"
+                    "--frontier\r\nContent-Type: text\r\nContent-Length: 3\r\nkey: value\r\n\r\nabc\r\n--frontier--\r\n"];
+    ZMMultipartParser *sut = [[ZMMultipartParser alloc] initWithData:body boundary:Boundary];
+
+    // when
+    ZMMultipartPart *first = [sut nextPart];
+    ZMMultipartPart *second = [sut nextPart];
+    ZMMultipartPart *third = [sut nextPart];
+
+    // then
+    XCTAssertEqualObjects(first.contentType, @"application/json");
+    XCTAssertEqualObjects(first.headers, @{});
+    XCTAssertEqualObjects([sut payloadOfPart:first], [self dataWithString:@"{}"]);
+
+    XCTAssertEqualObjects(second.contentType, @"text");
+    XCTAssertEqualObjects(second.headers, @{@"key": @"value"});
+    XCTAssertEqualObjects([sut payloadOfPart:second], [self dataWithString:@"abc"]);
+
+    XCTAssertNil(third);
+}
+
+- (void)testThatItSkipsAPayloadContainingTheBoundaryUsingTheContentLength
+{
+    // given
+    NSData *body = [self dataWithString:@"--frontier\r\nContent-Length: 16\r\n\r\na\r\n--frontier\r\nb\r\n--frontier--\r\n"];
+    ZMMultipartParser *sut = [[ZMMultipartParser alloc] initWithData:body boundary:Boundary];
+
+    // when
+    ZMMultipartPart *part = [sut nextPart];
+
+    // then
+    XCTAssertEqualObjects([sut payloadOfPart:part], [self dataWithString:@"a\r\n--frontier\r\nb"]);
+    XCTAssertNil([sut nextPart]);
+}
+
+- (void)testThatItSearchesTheNextDelimiterWhenTheContentLengthIsMissing
+{
+    // given
+    NSData *body = [self dataWithString:@"--frontier\r\nContent-Type: text\r\n\r\nabc\r\n--frontier--\r\n"];
+    ZMMultipartParser *sut = [[ZMMultipartParser alloc] initWithData:body boundary:Boundary];
+
+    // when
+    ZMMultipartPart *part = [sut nextPart];
+
+    // then
+    XCTAssertEqualObjects([sut payloadOfPart:part], [self dataWithString:@"abc"]);
+    XCTAssertNil([sut nextPart]);
+}
+
+- (void)testThatItSearchesTheNextDelimiterWhenTheContentLengthIsWrong
+{
+    // given
+    NSData *body = [self dataWithString:@"--frontier\r\nContent-Length: 1\r\n\r\nabc\r\n--frontier\r\nContent-Length: 1\r\n\r\nd\r\n--frontier--\r\n"];
+    ZMMultipartParser *sut = [[ZMMultipartParser alloc] initWithData:body boundary:Boundary];
+
+    // when
+    ZMMultipartPart *first = [sut nextPart];
+    ZMMultipartPart *second = [sut nextPart];
+
+    // then
+    XCTAssertEqualObjects([sut payloadOfPart:first], [self dataWithString:@"abc"]);
+    XCTAssertEqualObjects([sut payloadOfPart:second], [self dataWithString:@"d"]);
+    XCTAssertNil([sut nextPart]);
+}
+
+- (void)testThatItReturnsNoPartsForDataWithoutDelimiter
+{
+    // given
+    ZMMultipartParser *sut = [[ZMMultipartParser alloc] initWithData:[self dataWithString:@"abc"] boundary:Boundary];
+
+    // then
+    XCTAssertNil([sut nextPart]);
+}
+
+- (void)testPerformanceOfParsingALargeBody
+{
+    // given
+    NSData *payload = [NSMutableData dataWithLength:100 * 1024 * 1024];
+    NSArray *items = @[
+                       [[ZMMultipartBodyItem alloc] initWithData:[self dataWithString:@"{}"] contentType:@"application/json" headers:nil],
+                       [[ZMMultipartBodyItem alloc] initWithData:payload contentType:@"application/octet-stream" headers:nil]
+                       ];
+    NSData *body = [NSData multipartDataWithItems:items boundary:Boundary];
+
+    // then
+    [self measureBlock:^{
+        ZMMultipartParser *parser = [[ZMMultipartParser alloc] initWithData:body boundary:Boundary];
+        XCTAssertNotNil([parser nextPart]);
+        XCTAssertEqual([parser nextPart].payloadRange.length, payload.length);
+        XCTAssertNil([parser nextPart]);
+    }];
+}
+
+@end
@@ -190,6 +190,70 @@ final class RequestLoopDetectionTests: XCTestCase {
         XCTAssertFalse(triggered)
     }
 
+    func testThatItKeepsCountingBeyondThePreviousHistoryLimit() {
+
+        // given
+        let path = "MyURL.com"
+        var triggered = false
+        let hash = "14"
+
+        let sut = RequestLoopDetection { _ in
+            triggered = true
+        }
+
+        // when
+        (0..<(RequestLoopDetection.repetitionTriggerThreshold - 1)).forEach { _ in
+            sut.recordRequest(path: path, contentHint: hash, date: nil)
+        }
+        (0..<500).forEach {
+            sut.recordRequest(path: "url.com", contentHint: "\($0)", date: nil)
+        }
+        sut.recordRequest(path: path, contentHint: hash, date: nil)
+
+        // then
+        XCTAssertTrue(triggered)
+    }
+
+    func testThatItForgetsRequestsOnReset() {
+
+        // given
+        let sut = RequestLoopDetection { _ in
+            XCTFail()
+        }
+
+        // when
+        (0..<RequestLoopDetection.repetitionTriggerThreshold).forEach {
+            if $0 == RequestLoopDetection.repetitionTriggerThreshold / 2 {
+                sut.reset()
+            }
+            sut.recordRequest(path: "foo.com", contentHint: "14", date: nil)
+        }
+
+        // then
+        XCTAssertEqual(sut.recordedRequestCount, RequestLoopDetection.repetitionTriggerThreshold / 2)
+    }
+
+    // MARK: Performance
+
+    func testPerformanceOfRecordingTenThousandRequestsPerMinute() {
+
+        // given
+        let paths = (0..<50).map { "/v5/conversations/\($0)" }
+        let start = Date()
+
+        // when
+        measure {
+            let sut = RequestLoopDetection { _ in }
+            (0..<10000).forEach {
+                sut.recordRequest(
+                    path: paths[$0 % paths.count],
+                    contentHint: "\($0 % 7)",
+                    date: start.addingTimeInterval(-60 + TimeInterval($0) * 0.006)
+                )
+            }
+        }
+    }
+
     // MARK: Excluded URLs
 
     func testRecordRequest_givenExcludedPathTyping() {
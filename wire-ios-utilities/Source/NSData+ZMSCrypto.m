@@ -22,6 +22,63 @@
 
 static NSString* ZMLogTag ZM_UNUSED = @"SymmetricEncryption";
 
+NSString * const ZMSCryptoErrorDomain = @"ZMSCryptoErrorDomain";
+
+/// Size of the chunks that are encrypted or decrypted and hashed in turn. Small enough for a chunk
+/// to still be in the L1/L2 cache when it's read the second time.
+static size_t const ZMCryptoChunkSize = 32 * 1024;
+
+/// Runs the cryptor over a range of the data into a preallocated buffer, starting at @c *outputLength.
+/// If given, each chunk of input is added to @c inputDigest right before it's processed, and each chunk
+/// of output to @c outputDigest right after it's written, so that the data is read only once from memory.
+static CCCryptorStatus ZMCryptRange(CCCryptorRef cryptorRef, NSData *data, NSRange range, uint8_t *output, size_t outputCapacity, size_t *outputLength, CC_SHA256_CTX *inputDigest, CC_SHA256_CTX *outputDigest)
+{
+    __block CCCryptorStatus status = kCCSuccess;
+    __block size_t byteCountWritten = *outputLength;
+
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+        NSRange const intersection = NSIntersectionRange(byteRange, range);
+        if (intersection.length == 0) {
+            return;
+        }
+
+        uint8_t const *chunk = (uint8_t const *) bytes + (intersection.location - byteRange.location);
+        size_t remaining = intersection.length;
+        while (remaining > 0) {
+            size_t const chunkLength = MIN(remaining, ZMCryptoChunkSize);
+            size_t bytesWritten = 0;
+            if (inputDigest != NULL) {
+                CC_SHA256_Update(inputDigest, chunk, (CC_LONG) chunkLength);
+            }
+            status = CCCryptorUpdate(cryptorRef, chunk, chunkLength, output + byteCountWritten, outputCapacity - byteCountWritten, &bytesWritten);
+            if (status != kCCSuccess) {
+                *stop = YES;
+                return;
+            }
+            if (outputDigest != NULL) {
+                CC_SHA256_Update(outputDigest, output + byteCountWritten, (CC_LONG) bytesWritten);
+            }
+            byteCountWritten += bytesWritten;
+            chunk += chunkLength;
+            remaining -= chunkLength;
+        }
+    }];
+
+    *outputLength = byteCountWritten;
+    return status;
+}
+
+static CCCryptorStatus ZMCryptFinal(CCCryptorRef cryptorRef, uint8_t *output, size_t outputCapacity, size_t *outputLength, CC_SHA256_CTX *outputDigest)
+{
+    size_t bytesWritten = 0;
+    CCCryptorStatus const status = CCCryptorFinal(cryptorRef, output + *outputLength, outputCapacity - *outputLength, &bytesWritten);
+    if (status == kCCSuccess && outputDigest != NULL) {
+        CC_SHA256_Update(outputDigest, output + *outputLength, (CC_LONG) bytesWritten);
+    }
+    *outputLength += bytesWritten;
+    return status;
+}
+
 
 @implementation NSData (ZMMessageDigest)
 
@@ -89,152 +146,166 @@ static NSString* ZMLogTag ZM_UNUSED = @"SymmetricEncryption";
 {
     Require(key.length == kCCKeySizeAES256);
     
-    __block CCCryptorStatus status = kCCSuccess;
     CCCryptorRef cryptorRef;
-    
-    status = CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key.bytes, kCCKeySizeAES256, NULL, &cryptorRef);
+    CCCryptorStatus status = CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key.bytes, kCCKeySizeAES256, NULL, &cryptorRef);
     if (status != kCCSuccess) {
         return nil;
     }
     
-    size_t resultLength = self.length + 2 * kCCKeySizeAES256 + kCCBlockSizeAES128;
-    NSMutableData * const result = [NSMutableData dataWithLength:resultLength];
-    __block size_t byteCountWritten = 0;
+    // First, encode some random data:
+    uint8_t random[kCCBlockSizeAES128];
+    int success = SecRandomCopyBytes(kSecRandomDefault, sizeof(random), random);
+    Require(success == errSecSuccess);
     
+    size_t const resultCapacity = CCCryptorGetOutputLength(cryptorRef, sizeof(random) + self.length, true);
+    NSMutableData * const result = [NSMutableData dataWithLength:resultCapacity];
+    size_t byteCountWritten = 0;
     
-    // First, encode some random data:
-    {
-        uint8_t random[kCCBlockSizeAES128];
-        int success = SecRandomCopyBytes(kSecRandomDefault, sizeof(random), random);
-        Require(success == errSecSuccess);
-        size_t bytesWritten = 0;
-        void * const dataOut = ((uint8_t *) [result mutableBytes]) + byteCountWritten;
-        size_t const dataOutAvailable = resultLength - byteCountWritten;
-        status = CCCryptorUpdate(cryptorRef, random, sizeof(random), dataOut, dataOutAvailable, &bytesWritten);
-        Require(status == kCCSuccess);
-        byteCountWritten += bytesWritten;
+    status = CCCryptorUpdate(cryptorRef, random, sizeof(random), result.mutableBytes, resultCapacity, &byteCountWritten);
+    if (status == kCCSuccess) {
+        status = ZMCryptRange(cryptorRef, self, NSMakeRange(0, self.length), result.mutableBytes, resultCapacity, &byteCountWritten, NULL, NULL);
     }
+    if (status == kCCSuccess) {
+        status = ZMCryptFinal(cryptorRef, result.mutableBytes, resultCapacity, &byteCountWritten, NULL);
+    }
+    CCCryptorRelease(cryptorRef);
     
-    [self enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
-        size_t bytesWritten = 0;
-        while (YES) {
-            void * const dataOut = ((uint8_t *) [result mutableBytes]) + byteCountWritten;
-            size_t const dataOutAvailable = resultLength - byteCountWritten;
-            status = CCCryptorUpdate(cryptorRef, bytes, byteRange.length, dataOut, dataOutAvailable, &bytesWritten);
-            if (status == kCCBufferTooSmall) {
-                size_t const neededSize = CCCryptorGetOutputLength(cryptorRef, byteRange.length, false);
-                size_t const additionalSize = neededSize - dataOutAvailable;
-                result.length += additionalSize;
-            } else {
-                break;
-            }
-        }
-        if (status != kCCSuccess) {
-            *stop = YES;
-            return;
-        }
-        byteCountWritten += bytesWritten;
-    }];
     if (status != kCCSuccess) {
-        CCCryptorRelease(cryptorRef);
         return nil;
     }
     
-    {
-        size_t bytesWritten = 0;
-        while (YES) {
-            void * const dataOut = ((uint8_t *) [result mutableBytes]) + byteCountWritten;
-            size_t const dataOutAvailable = resultLength - byteCountWritten;
-            status = CCCryptorFinal(cryptorRef, dataOut, dataOutAvailable, &bytesWritten);
-            if (status == kCCBufferTooSmall) {
-                size_t const neededSize = CCCryptorGetOutputLength(cryptorRef, self.length, true);
-                size_t const additionalSize = neededSize - byteCountWritten;
-                result.length += additionalSize;
-            } else {
-                break;
-            }
-        }
-        if (status != kCCSuccess) {
-            CCCryptorRelease(cryptorRef);
-            return nil;
-        }
-        byteCountWritten += bytesWritten;
-        
-    }
-    CCCryptorRelease(cryptorRef);
-    
     result.length = byteCountWritten;
-    return  result;
+    return result;
 }
 
 - (NSData *)zmDecryptPrefixedIVWithKey:(NSData *)key
 {
     Require(key.length == kCCKeySizeAES256);
     
-    __block CCCryptorStatus status = kCCSuccess;
     CCCryptorRef cryptorRef;
+    CCCryptorStatus status = CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key.bytes, kCCKeySizeAES256, NULL, &cryptorRef);
+    if (status != kCCSuccess) {
+        return nil;
+    }
+    
+    size_t const resultCapacity = CCCryptorGetOutputLength(cryptorRef, self.length, true);
+    NSMutableData * const result = [NSMutableData dataWithLength:resultCapacity];
+    size_t byteCountWritten = 0;
+    
+    status = ZMCryptRange(cryptorRef, self, NSMakeRange(0, self.length), result.mutableBytes, resultCapacity, &byteCountWritten, NULL, NULL);
+    if (status == kCCSuccess) {
+        status = ZMCryptFinal(cryptorRef, result.mutableBytes, resultCapacity, &byteCountWritten, NULL);
+    }
+    CCCryptorRelease(cryptorRef);
     
-    status = CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key.bytes, kCCKeySizeAES256, NULL, &cryptorRef);
     if (status != kCCSuccess) {
         return nil;
     }
     
-    size_t resultLength = self.length + 2 * kCCKeySizeAES256;
-    NSMutableData * const result = [NSMutableData dataWithLength:resultLength];
-    __block size_t byteCountWritten = 0;
+    VerifyReturnNil(byteCountWritten >= kCCBlockSizeAES128);
     
-    [self enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
-        size_t bytesWritten = 0;
-        while (YES) {
-            void * const dataOut = ((uint8_t *) [result mutableBytes]) + byteCountWritten;
-            size_t const dataOutAvailable = resultLength - byteCountWritten;
-            status = CCCryptorUpdate(cryptorRef, bytes, byteRange.length, dataOut, dataOutAvailable, &bytesWritten);
-            if (status == kCCBufferTooSmall) {
-                size_t const neededSize = CCCryptorGetOutputLength(cryptorRef, byteRange.length, false);
-                size_t const additionalSize = neededSize - dataOutAvailable;
-                result.length += additionalSize;
-            } else {
-                break;
-            }
-        }
-        if (status != kCCSuccess) {
-            *stop = YES;
-            return;
-        }
-        byteCountWritten += bytesWritten;
-    }];
+    // Drop the decrypted random first block in place
+    result.length = byteCountWritten;
+    [result replaceBytesInRange:NSMakeRange(0, kCCBlockSizeAES128) withBytes:NULL length:0];
+    return result;
+}
+
+- (NSData *)zmEncryptPrefixingPlainTextIVWithKey:(NSData *)key sha256Digest:(NSData **)sha256Digest
+{
+    VerifyReturnNil(key.length == kCCKeySizeAES256);
+    
+    uint8_t iv[kCCBlockSizeAES128];
+    int success = SecRandomCopyBytes(kSecRandomDefault, sizeof(iv), iv);
+    Require(success == errSecSuccess);
+    
+    CCCryptorRef cryptorRef;
+    CCCryptorStatus status = CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key.bytes, kCCKeySizeAES256, iv, &cryptorRef);
     if (status != kCCSuccess) {
-        CCCryptorRelease(cryptorRef);
         return nil;
     }
     
-    {
-        size_t bytesWritten = 0;
-        while (YES) {
-            void * const dataOut = ((uint8_t *) [result mutableBytes]) + byteCountWritten;
-            size_t const dataOutAvailable = resultLength - byteCountWritten;
-            status = CCCryptorFinal(cryptorRef, dataOut, dataOutAvailable, &bytesWritten);
-            if (status == kCCBufferTooSmall) {
-                size_t const neededSize = CCCryptorGetOutputLength(cryptorRef, self.length, true);
-                size_t const additionalSize = neededSize - byteCountWritten;
-                result.length += additionalSize;
-            } else {
-                break;
-            }
+    size_t const resultCapacity = sizeof(iv) + CCCryptorGetOutputLength(cryptorRef, self.length, true);
+    NSMutableData * const result = [NSMutableData dataWithLength:resultCapacity];
+    memcpy(result.mutableBytes, iv, sizeof(iv));
+    size_t byteCountWritten = sizeof(iv);
+    
+    CC_SHA256_CTX digest;
+    CC_SHA256_Init(&digest);
+    CC_SHA256_Update(&digest, iv, sizeof(iv));
+    
+    status = ZMCryptRange(cryptorRef, self, NSMakeRange(0, self.length), result.mutableBytes, resultCapacity, &byteCountWritten, NULL, &digest);
+    if (status == kCCSuccess) {
+        status = ZMCryptFinal(cryptorRef, result.mutableBytes, resultCapacity, &byteCountWritten, &digest);
+    }
+    CCCryptorRelease(cryptorRef);
+    
+    if (status != kCCSuccess) {
+        ZMLogError(@"Error in encryption: %d", status);
+        return nil;
+    }
+    
+    result.length = byteCountWritten;
+    if (sha256Digest != NULL) {
+        NSMutableData *digestData = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+        CC_SHA256_Final(digestData.mutableBytes, &digest);
+        *sha256Digest = digestData;
+    }
+    return result;
+}
+
+- (NSData *)zmDecryptPrefixedPlainTextIVWithKey:(NSData *)key sha256Digest:(NSData *)sha256Digest error:(NSError **)error
+{
+    if (key.length != kCCKeySizeAES256 || sha256Digest.length != CC_SHA256_DIGEST_LENGTH || self.length < kCCBlockSizeAES128) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:ZMSCryptoErrorDomain code:ZMSCryptoErrorCodeDecryptionFailed userInfo:nil];
         }
-        if (status != kCCSuccess) {
-            CCCryptorRelease(cryptorRef);
-            return nil;
+        return nil;
+    }
+    
+    uint8_t iv[kCCBlockSizeAES128];
+    [self getBytes:iv range:NSMakeRange(0, sizeof(iv))];
+    
+    CCCryptorRef cryptorRef;
+    CCCryptorStatus status = CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key.bytes, kCCKeySizeAES256, iv, &cryptorRef);
+    if (status != kCCSuccess) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:ZMSCryptoErrorDomain code:ZMSCryptoErrorCodeDecryptionFailed userInfo:nil];
         }
-        byteCountWritten += bytesWritten;
-        
+        return nil;
+    }
+    
+    NSRange const encryptedRange = NSMakeRange(sizeof(iv), self.length - sizeof(iv));
+    size_t const resultCapacity = CCCryptorGetOutputLength(cryptorRef, encryptedRange.length, true);
+    NSMutableData * const result = [NSMutableData dataWithLength:resultCapacity];
+    size_t byteCountWritten = 0;
+    
+    CC_SHA256_CTX digest;
+    CC_SHA256_Init(&digest);
+    CC_SHA256_Update(&digest, iv, sizeof(iv));
+    
+    status = ZMCryptRange(cryptorRef, self, encryptedRange, result.mutableBytes, resultCapacity, &byteCountWritten, &digest, NULL);
+    
+    uint8_t computedDigest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(computedDigest, &digest);
+    BOOL const digestMatches = timingsafe_bcmp(computedDigest, sha256Digest.bytes, sizeof(computedDigest)) == 0;
+    
+    // Don't look at the padding of data that failed the digest check
+    if (status == kCCSuccess && digestMatches) {
+        status = ZMCryptFinal(cryptorRef, result.mutableBytes, resultCapacity, &byteCountWritten, NULL);
     }
     CCCryptorRelease(cryptorRef);
     
-    result.length = byteCountWritten;
+    if (!digestMatches || status != kCCSuccess) {
+        ZMLogError(@"Error in decryption: %d, digest matches: %d", status, digestMatches);
+        if (error != NULL) {
+            ZMSCryptoErrorCode const code = digestMatches ? ZMSCryptoErrorCodeDecryptionFailed : ZMSCryptoErrorCodeDigestMismatch;
+            *error = [NSError errorWithDomain:ZMSCryptoErrorDomain code:code userInfo:nil];
+        }
+        return nil;
+    }
     
-    VerifyReturnNil(result.length >= kCCBlockSizeAES128);
-    return [result subdataWithRange:NSMakeRange(kCCBlockSizeAES128, result.length - kCCBlockSizeAES128)];
+    result.length = byteCountWritten;
+    return result;
 }
 
 - (NSData *)zmDecryptPrefixedPlainTextIVWithKey:(NSData *)key
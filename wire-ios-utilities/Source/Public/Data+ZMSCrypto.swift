@@ -29,6 +29,12 @@ public enum AESError: Error {
     /// Encryption failed
     case encryptionFailed
 
+    /// Decryption failed
+    case decryptionFailed
+
+    /// The digest of the encrypted data doesn't match the expected one
+    case digestMismatch
+
 }
 
 // Mapping of @c NSData helper methods to Swift 3 @c Data. See original methods for description.
@@ -53,6 +59,21 @@ public extension Data {
         return Data(digest)
     }
 
+    /// Computes the MD5 digest of the contents of a file, reading it in chunks
+    /// instead of loading the whole file into memory.
+    static func zmMD5Digest(ofContentsOf url: URL) throws -> Data {
+        let fileHandle = try FileHandle(forReadingFrom: url)
+        defer { try? fileHandle.close() }
+
+        var md5Hash = Insecure.MD5()
+        while let chunk = try fileHandle.read(upToCount: 64 * 1024), !chunk.isEmpty {
+            md5Hash.update(data: chunk)
+        }
+
+        let digest = md5Hash.finalize()
+        return Data(digest)
+    }
+
     func zmHMACSHA256Digest(key: Data) -> Data {
         return (self as NSData).zmHMACSHA256Digest(withKey: key)
     }
@@ -135,6 +156,36 @@ public extension Data {
         return (self as NSData).zmDecryptPrefixedPlainTextIV(withKey: key)
     }
 
+    /// Encrypts the data like `zmEncryptPrefixingPlainTextIV(key:)` and computes the SHA256
+    /// digest of the encrypted data in the same pass.
+    func zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: Data) throws -> (encryptedData: Data, sha256Digest: Data) {
+        guard key.count == kCCKeySizeAES256 else {
+            throw AESError.keySizeError
+        }
+
+        var sha256Digest: NSData?
+        guard
+            let encryptedData = (self as NSData).zmEncryptPrefixingPlainTextIV(withKey: key, sha256Digest: &sha256Digest),
+            let sha256Digest
+        else {
+            throw AESError.encryptionFailed
+        }
+
+        return (encryptedData, sha256Digest as Data)
+    }
+
+    /// Verifies the SHA256 digest of the data and decrypts it like `zmDecryptPrefixedPlainTextIV(key:)`,
+    /// in a single pass.
+    func zmDecryptPrefixedPlainTextIV(key: Data, sha256Digest: Data) throws -> Data {
+        do {
+            return try (self as NSData).zmDecryptPrefixedPlainTextIV(withKey: key, sha256Digest: sha256Digest)
+        } catch let error as NSError where error.domain == ZMSCryptoErrorDomain && error.code == ZMSCryptoErrorCode.digestMismatch.rawValue {
+            throw AESError.digestMismatch
+        } catch {
+            throw AESError.decryptionFailed
+        }
+    }
+
     static func secureRandomData(length: UInt) -> Data {
         return NSData.secureRandomData(ofLength: length)
     }
@@ -18,6 +18,13 @@
 
 @import Foundation;
 
+FOUNDATION_EXPORT NSString * const ZMSCryptoErrorDomain;
+
+typedef NS_ENUM(NSInteger, ZMSCryptoErrorCode) {
+    ZMSCryptoErrorCodeDigestMismatch = 1,
+    ZMSCryptoErrorCodeDecryptionFailed = 2,
+};
+
 @interface NSData (ZMMessageDigest)
 
 /// Calculates HMAC digest of the data using SHA256
@@ -53,6 +60,16 @@
 /// This function keeps both original and encrypted data in memory. Do not use for large amount of data.
 - (NSData *)zmDecryptPrefixedPlainTextIVWithKey:(NSData *)key;
 
+/// Encodes the data using AES256 CBC Padding prefixing a random plaintext IV, and computes the SHA256 digest
+/// of the encoded data in the same pass over memory. The output buffer is allocated once with its final size.
+/// Returns nil if the key is not of AES256 length or encryption fails.
+- (NSData *)zmEncryptPrefixingPlainTextIVWithKey:(NSData *)key sha256Digest:(NSData **)sha256Digest;
+
+/// Decodes the data using AES256 CBC Padding assuming that the first block is the plaintext IV, verifying the
+/// SHA256 digest of the encoded data in the same pass over memory. The padding is only checked once the digest
+/// matched. Returns nil and a @c ZMSCryptoErrorDomain error if the digest doesn't match or decryption fails.
+- (NSData *)zmDecryptPrefixedPlainTextIVWithKey:(NSData *)key sha256Digest:(NSData *)sha256Digest error:(NSError **)error;
+
 /// Returns cryptograpically random data of a given length
 + (NSData *)secureRandomDataOfLength:(NSUInteger)length;
 
@@ -40,14 +40,12 @@
 
 - (NSInteger)increment
 {
-    atomic_fetch_add(&_atomicValue, 1);
-    return atomic_load(&_atomicValue);
+    return atomic_fetch_add(&_atomicValue, 1) + 1;
 }
 
 - (NSInteger)decrement
 {
-    atomic_fetch_sub(&_atomicValue, 1);
-    return atomic_load(&_atomicValue);
+    return atomic_fetch_sub(&_atomicValue, 1) - 1;
 }
 
 - (BOOL)setValueWithEqualityCondition:(NSInteger)condition newValue:(NSInteger)newValue;
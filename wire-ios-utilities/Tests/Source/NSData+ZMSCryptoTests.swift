@@ -105,6 +105,160 @@ extension NSData_ZMSCryptoTests {
 
 }
 
+// MARK: - Single pass encryption and hashing
+extension NSData_ZMSCryptoTests {
+
+    func testThatItEncryptsAndComputesTheDigestOfTheEncryptedData() throws {
+
+        // given
+        let data = self.sampleDecryptedImageData
+        let key = self.sampleKey
+
+        // when
+        let (encryptedData, sha256Digest) = try data.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: key)
+
+        // then
+        XCTAssertEqual(sha256Digest, encryptedData.zmSHA256Digest())
+        XCTAssertEqual(encryptedData.zmDecryptPrefixedPlainTextIV(key: key), data)
+    }
+
+    func testThatItVerifiesTheDigestAndDecryptsAndroidImage() throws {
+
+        // given
+        let encryptedImage = self.sampleEncryptedImageData
+        let sha256Digest = encryptedImage.zmSHA256Digest()
+
+        // when
+        let decryptedImage = try encryptedImage.zmDecryptPrefixedPlainTextIV(key: self.sampleKey, sha256Digest: sha256Digest)
+
+        // then
+        XCTAssertEqual(decryptedImage, self.sampleDecryptedImageData)
+    }
+
+    func testThatItThrowsWhenTheDigestDoesNotMatch() {
+
+        // given
+        let encryptedImage = self.sampleEncryptedImageData
+        let wrongDigest = Data("wrong".utf8).zmSHA256Digest()
+
+        // then
+        XCTAssertThrowsError(try encryptedImage.zmDecryptPrefixedPlainTextIV(key: self.sampleKey, sha256Digest: wrongDigest)) { error in
+            XCTAssertEqual(error as? AESError, .digestMismatch)
+        }
+    }
+
+    func testThatItThrowsWhenTheKeyIsNotOfAES256Length() {
+
+        // given
+        let encryptedImage = self.sampleEncryptedImageData
+        let badKey = self.sampleKey.subdata(in: Range(0...15))
+
+        // then
+        XCTAssertThrowsError(try encryptedImage.zmDecryptPrefixedPlainTextIV(key: badKey, sha256Digest: encryptedImage.zmSHA256Digest())) { error in
+            XCTAssertEqual(error as? AESError, .decryptionFailed)
+        }
+        XCTAssertThrowsError(try encryptedImage.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: badKey)) { error in
+            XCTAssertEqual(error as? AESError, .keySizeError)
+        }
+    }
+
+    func testThatItEncryptsAndDecryptsDataSpanningSeveralChunks() throws {
+
+        // given
+        let data = Data.secureRandomData(length: 1024 * 1024 + 7)
+        let key = Data.randomEncryptionKey()
+
+        // when
+        let (encryptedData, sha256Digest) = try data.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: key)
+        let decryptedData = try encryptedData.zmDecryptPrefixedPlainTextIV(key: key, sha256Digest: sha256Digest)
+
+        // then
+        XCTAssertEqual(decryptedData, data)
+        XCTAssertEqual(data.zmEncryptPrefixingIV(key: key).zmDecryptPrefixedIV(key: key), data)
+    }
+
+}
+
+// MARK: - Single pass benchmarks
+extension NSData_ZMSCryptoTests {
+
+    private var benchmarkData: Data {
+        return Data.secureRandomData(length: 64 * 1024 * 1024)
+    }
+
+    /// The benchmarks allocate 64 MB per iteration, so they only run when `ZM_RUN_PERFORMANCE_TESTS` is set.
+    private func skipUnlessPerformanceTestsAreEnabled() throws {
+        try XCTSkipUnless(
+            ProcessInfo.processInfo.environment["ZM_RUN_PERFORMANCE_TESTS"] != nil,
+            "Set ZM_RUN_PERFORMANCE_TESTS to run the encryption benchmarks"
+        )
+    }
+
+    /// Returns the throughput of a block processing `byteCount` bytes, in GB/s.
+    private func throughput(byteCount: Int, iterations: Int = 5, _ block: () throws -> Void) rethrows -> Double {
+        let start = CFAbsoluteTimeGetCurrent()
+        for _ in 0..<iterations {
+            try autoreleasepool {
+                try block()
+            }
+        }
+        let duration = CFAbsoluteTimeGetCurrent() - start
+        return Double(byteCount * iterations) / duration / 1_000_000_000
+    }
+
+    func testThroughputOfSinglePassComparedToTwoPasses() throws {
+        try skipUnlessPerformanceTestsAreEnabled()
+
+        // given
+        let data = benchmarkData
+        let key = Data.randomEncryptionKey()
+        let (encryptedData, sha256Digest) = try data.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: key)
+
+        // when
+        let twoPassEncryption = try throughput(byteCount: data.count) {
+            let encryptedData = try data.zmEncryptPrefixingPlainTextIV(key: key)
+            XCTAssertEqual(encryptedData.zmSHA256Digest().count, 32)
+        }
+        let singlePassEncryption = try throughput(byteCount: data.count) {
+            _ = try data.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: key)
+        }
+        let twoPassDecryption = throughput(byteCount: data.count) {
+            XCTAssertEqual(encryptedData.zmSHA256Digest(), sha256Digest)
+            XCTAssertNotNil(encryptedData.zmDecryptPrefixedPlainTextIV(key: key))
+        }
+        let singlePassDecryption = try throughput(byteCount: data.count) {
+            _ = try encryptedData.zmDecryptPrefixedPlainTextIV(key: key, sha256Digest: sha256Digest)
+        }
+
+        // then
+        XCTAssertGreaterThanOrEqual(singlePassEncryption, twoPassEncryption)
+        XCTAssertGreaterThanOrEqual(singlePassDecryption, twoPassDecryption)
+    }
+
+    func testPerformanceOfSinglePassEncryption() throws {
+        try skipUnlessPerformanceTestsAreEnabled()
+
+        let data = benchmarkData
+        let key = Data.randomEncryptionKey()
+
+        measure(metrics: [XCTClockMetric(), XCTMemoryMetric()]) {
+            _ = try? data.zmEncryptPrefixingPlainTextIVAndComputeSHA256Digest(key: key)
+        }
+    }
+
+    func testPerformanceOfTwoPassEncryption() throws {
+        try skipUnlessPerformanceTestsAreEnabled()
+
+        let data = benchmarkData
+        let key = Data.randomEncryptionKey()
+
+        measure(metrics: [XCTClockMetric(), XCTMemoryMetric()]) {
+            _ = try? data.zmEncryptPrefixingPlainTextIV(key: key).zmSHA256Digest()
+        }
+    }
+
+}
+
 // MARK: - Encrypted IV
 extension NSData_ZMSCryptoTests {
 
@@ -210,6 +364,20 @@ extension NSData_ZMSCryptoTests {
         XCTAssertEqual(digest, sampleMD5Result)
     }
 
+    func testThatItCalculatesTheMD5DigestOfAFile() throws {
+
+        // given
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try samplePlainData.write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        // when
+        let digest = try Data.zmMD5Digest(ofContentsOf: url)
+
+        // then
+        XCTAssertEqual(digest, sampleMD5Result)
+    }
+
     func testThatItCalculatesTheSHA256Digest() {
 
         // given
@@ -51,9 +51,17 @@ extension ZMConversationMessage {
 
 final class ConversationTableViewDataSource: NSObject {
     static let defaultBatchSize = 30 // Magic number: amount of messages per screen (upper bound).
+    static let maximumWindowSize = defaultBatchSize * 10
 
     private var fetchController: NSFetchedResultsController<ZMMessage>?
     private var lastFetchedObjectCount: Int = 0
+    private var window = MessageWindow(
+        limit: ConversationTableViewDataSource.defaultBatchSize,
+        pageSize: ConversationTableViewDataSource.defaultBatchSize,
+        maximumSize: ConversationTableViewDataSource.maximumWindowSize
+    )
+    /// Messages loaded ahead of the window, kept alive until the window moves.
+    private var prefetchedPages: [Range<Int>: [ZMMessage]] = [:]
 
     var registeredCells: [AnyClass] = []
     var sectionControllers: [String: ConversationMessageSectionController] = [:]
@@ -244,9 +252,20 @@ final class ConversationTableViewDataSource: NSObject {
     func loadMessages(offset: Int = 0,
                       limit: Int = ConversationTableViewDataSource.defaultBatchSize,
                       forceRecalculate: Bool = false) {
-        let fetchRequest = self.fetchRequest()
-        fetchRequest.fetchLimit = limit + 5 // We need to fetch a bit more than requested so that there is overlap between messages in different fetches
-        fetchRequest.fetchOffset = offset
+        window = MessageWindow(
+            offset: offset,
+            limit: limit,
+            pageSize: ConversationTableViewDataSource.defaultBatchSize,
+            maximumSize: ConversationTableViewDataSource.maximumWindowSize
+        )
+        loadMessages(in: window, forceRecalculate: forceRecalculate)
+    }
+
+    private func loadMessages(in window: MessageWindow, forceRecalculate: Bool = false) {
+        let previousMessages = messages
+
+        let fetchRequest = conversation.visibleMessagesFetchRequest(in: window)
+        fetchRequest.fetchLimit = window.limit + 5 // We need to fetch a bit more than requested so that there is overlap between messages in different fetches
 
         fetchController = NSFetchedResultsController<ZMMessage>(fetchRequest: fetchRequest,
                                                                 managedObjectContext: conversation.managedObjectContext!,
@@ -258,28 +277,91 @@ final class ConversationTableViewDataSource: NSObject {
 
         lastFetchedObjectCount = fetchController?.fetchedObjects?.count ?? 0
         hasOlderMessagesToLoad = messages.count == fetchRequest.fetchLimit
-        hasNewerMessagesToLoad = offset > 0
+        hasNewerMessagesToLoad = window.offset > 0
         firstUnreadMessage = conversation.firstUnreadMessage
         currentSections = calculateSections(forceRecalculate: forceRecalculate)
         tableView.reloadData()
+
+        prefetchedPages.removeAll()
+        evictMessages(Set(previousMessages).subtracting(messages))
     }
 
     private func loadOlderMessages() {
-        guard let currentOffset = fetchController?.fetchRequest.fetchOffset,
-              let currentLimit = fetchController?.fetchRequest.fetchLimit else { return }
+        guard fetchController != nil else { return }
+
+        let dropped = window.slide(.older)
 
-        let newLimit = currentLimit + ConversationTableViewDataSource.defaultBatchSize
+        if dropped.isEmpty {
+            loadMessages(in: window)
+        } else {
+            // The newest messages are dropped from the bottom of the upside down table view.
+            preservingScrollPosition {
+                loadMessages(in: window)
+            }
+        }
 
-        loadMessages(offset: currentOffset, limit: newLimit)
+        prefetchMessages(.older)
     }
 
     func loadNewerMessages() {
-        guard let currentOffset = fetchController?.fetchRequest.fetchOffset,
-            let currentLimit = fetchController?.fetchRequest.fetchLimit else { return }
+        guard fetchController != nil else { return }
+
+        window.slide(.newer)
+        loadMessages(in: window)
+        prefetchMessages(.newer)
+    }
 
-        let newOffset = max(0, currentOffset - ConversationTableViewDataSource.defaultBatchSize)
+    /// Loads the next page in the scroll direction in the background, so that
+    /// the window can move over it without waiting for the store.
+    private func prefetchMessages(_ direction: MessageWindowDirection) {
+        guard
+            let page = window.nextPage(direction),
+            prefetchedPages[page] == nil
+        else {
+            return
+        }
 
-        loadMessages(offset: newOffset, limit: currentLimit)
+        prefetchedPages[page] = []
+        conversation.prefetchVisibleMessages(in: page) { [weak self] messages in
+            guard let self, prefetchedPages[page] != nil else { return }
+            prefetchedPages[page] = messages
+        }
+    }
+
+    /// Releases the messages that are no longer part of the window, unless
+    /// they are still needed by the view.
+    private func evictMessages(_ evictedMessages: Set<ZMMessage>) {
+        guard !evictedMessages.isEmpty else { return }
+
+        let retainedMessages = [firstUnreadMessage, selectedMessage, editingMessage].compactMap { $0 as? ZMMessage }
+        let messages = evictedMessages.subtracting(retainedMessages)
+
+        for message in messages {
+            sectionControllers[message.objectIdentifier] = nil
+            actionControllers[message.objectIdentifier] = nil
+        }
+
+        conversation.managedObjectContext?.evictMessages(messages)
+    }
+
+    /// Keeps the topmost visible message in place while the sections of the
+    /// table view are replaced.
+    private func preservingScrollPosition(_ block: () -> Void) {
+        guard
+            let indexPath = tableView.indexPathsForVisibleRows?.last,
+            indexPath.section < messages.count
+        else {
+            return block()
+        }
+
+        let message = messages[indexPath.section]
+        let distance = tableView.contentOffset.y - tableView.rect(forSection: indexPath.section).minY
+
+        block()
+
+        if let section = index(of: message) {
+            tableView.contentOffset = CGPoint(x: 0, y: tableView.rect(forSection: section).minY + distance)
+        }
     }
 
     func indexOfMessage(_ message: ZMConversationMessage) -> Int {
@@ -344,13 +426,6 @@ final class ConversationTableViewDataSource: NSObject {
             scrollView.contentOffset = CGPoint(x: 0, y: indexPathRect.minY - 16)
         }
     }
-
-    private func fetchRequest() -> NSFetchRequest<ZMMessage> {
-        let fetchRequest = NSFetchRequest<ZMMessage>(entityName: ZMMessage.entityName())
-        fetchRequest.predicate = conversation.visibleMessagesPredicate
-        fetchRequest.sortDescriptors = [NSSortDescriptor(key: #keyPath(ZMMessage.serverTimestamp), ascending: false)]
-        return fetchRequest
-    }
 }
 
 extension ConversationTableViewDataSource: NSFetchedResultsControllerDelegate {